@@ -100,11 +100,17 @@ namespace Swarm2D.Cluster.Tasks
             CreatedChild.NetworkView.NetworkID = createChildResponseMessage.ChildId;
 
             _isFinished = true;
+            WakeUpCoroutine();
         }
 
         public override bool IsFinished
         {
             get { return _isFinished; }
         }
+
+        protected override CoroutineWaitMode WaitMode
+        {
+            get { return CoroutineWaitMode.WakeUp; }
+        }
     }
 }
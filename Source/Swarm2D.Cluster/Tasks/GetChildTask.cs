@@ -115,11 +115,17 @@ namespace Swarm2D.Cluster.Tasks
             }
 
             _isFinished = true;
+            WakeUpCoroutine();
         }
 
         public override bool IsFinished
         {
             get { return _isFinished; }
         }
+
+        protected override CoroutineWaitMode WaitMode
+        {
+            get { return CoroutineWaitMode.WakeUp; }
+        }
     }
 }
@@ -68,11 +68,17 @@ namespace Swarm2D.Cluster.Tasks
             //ResponseMessage = networkEntityMessageResponseMessage.Response;
 
             _isFinished = true;
+            WakeUpCoroutine();
         }
 
         public override bool IsFinished
         {
             get { return _isFinished; }
         }
+
+        protected override CoroutineWaitMode WaitMode
+        {
+            get { return CoroutineWaitMode.WakeUp; }
+        }
     }
 }
@@ -25,17 +25,47 @@ SOFTWARE.
 
 using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.Linq;
 using System.Text;
 
 namespace Swarm2D.Engine.Core
 {
+    //hosts an independent engine (e.g. a game room) inside another engine.
+    //the child engine is updated inline by default, or in parallel with other child engines if the parent engine has a ChildEngineScheduler.
+    //parent and child only talk through PostToChild and Engine.PostToParent, so they can live on different threads.
     public class ChildEngineDomain : EngineComponent
     {
         public Engine ChildEngine { get; private set; }
 
+        private MessageMailbox<DomainMessage> _messagesToChild = new MessageMailbox<DomainMessage>();
+        private MessageMailbox<EntityMessage> _messagesToParent = new MessageMailbox<EntityMessage>();
+
+        private ChildEngineScheduler _scheduler;
+
+        public long TickCount { get; private set; }
+        public float LastTickTime { get; private set; }
+        public float AverageTickTime { get; private set; }
+        public float PeakTickTime { get; private set; }
+
+        //lane of the scheduler the child engine is assigned to, -1 if it is updated inline
+        public int LaneIndex { get; internal set; }
+
+        internal bool ChildEngineHadJob { get; private set; }
+
+        public ChildEngineDomain()
+        {
+            LaneIndex = -1;
+        }
+
         protected override void OnDestroy()
         {
+            if (_scheduler != null)
+            {
+                _scheduler.Unregister(this);
+                _scheduler = null;
+            }
+
             if (ChildEngine != null)
             {
                 ChildEngine.Destroy();
@@ -49,16 +79,85 @@ namespace Swarm2D.Engine.Core
         [DomainMessageHandler(MessageType = typeof(UpdateMessage))]
         private void OnUpdate(Message message)
         {
-            if (ChildEngine != null)
+            if (ChildEngine != null && _scheduler == null)
             {
-                ChildEngine.Update();
+                Tick();
+                DeliverMessagesToParent();
             }
         }
 
         public void CreateEngine()
         {
             ChildEngine = new Engine(Engine.PooledMode);
+            ChildEngine.ParentDomain = this;
             ChildEngine.Start();
+
+            _scheduler = Engine.FindComponent<ChildEngineScheduler>();
+
+            if (_scheduler != null)
+            {
+                _scheduler.Register(this);
+            }
+        }
+
+        //delivered to the child engine as a domain message at the beginning of its next update, on its own thread
+        public void PostToChild(DomainMessage message)
+        {
+            _messagesToChild.Post(message);
+        }
+
+        internal void PostToParent(EntityMessage message)
+        {
+            _messagesToParent.Post(message);
+        }
+
+        //exceptions are not handled here, the scheduler rethrows them on the parent thread
+        internal void Tick()
+        {
+            long startTimestamp = Stopwatch.GetTimestamp();
+
+            List<DomainMessage> messages = _messagesToChild.Receive();
+
+            for (int i = 0; i < messages.Count; i++)
+            {
+                ChildEngine.SendMessage(messages[i]);
+            }
+
+            messages.Clear();
+
+            ChildEngine.Update();
+
+            ChildEngineHadJob = ChildEngine.CurrentFrameHadJob;
+
+            float tickTime = (float)((Stopwatch.GetTimestamp() - startTimestamp) * 1000.0 / Stopwatch.Frequency);
+
+            LastTickTime = tickTime;
+            AverageTickTime = TickCount == 0 ? tickTime : AverageTickTime * 0.95f + tickTime * 0.05f;
+
+            if (tickTime > PeakTickTime)
+            {
+                PeakTickTime = tickTime;
+            }
+
+            TickCount++;
+        }
+
+        //messages posted by the child engine are sent to the entity of this component on the parent thread
+        internal void DeliverMessagesToParent()
+        {
+            List<EntityMessage> messages = _messagesToParent.Receive();
+
+            for (int i = 0; i < messages.Count; i++)
+            {
+                Entity.SendMessage(messages[i]);
+            }
+
+            messages.Clear();
+        }
+
+        public void ResetPeakTickTime()
+        {
+            PeakTickTime = 0.0f;
         }
     }
 }
@@ -0,0 +1,406 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Runtime.ExceptionServices;
+using System.Text;
+using System.Threading;
+using Debug = Swarm2D.Library.Debug;
+
+namespace Swarm2D.Engine.Core
+{
+    public enum ChildEngineUpdateMode
+    {
+        JobSystem,
+        DedicatedThreads
+    }
+
+    //updates the child engines of this engine in parallel and waits for all of them in the update of the parent engine.
+    //child engines are assigned to lanes by their average tick time, a lane is a dedicated thread in DedicatedThreads mode.
+    public class ChildEngineScheduler : EngineComponent
+    {
+        public ChildEngineUpdateMode UpdateMode { get; set; }
+
+        public int LaneCount { get; set; }
+
+        public bool UseThreadAffinity { get; set; }
+
+        //lanes are rebalanced every RebalanceInterval frames if the busiest lane is RebalanceThreshold times busier than the idlest lane
+        public int RebalanceInterval { get; set; }
+        public float RebalanceThreshold { get; set; }
+
+        public long FrameCount { get; private set; }
+
+        public float LastUpdateTime { get; private set; }
+
+        private List<ChildEngineDomain> _childEngineDomains;
+
+        private List<ChildEngineDomain>[] _lanes;
+
+        private JobCounter _jobCounter;
+
+        private IThread[] _laneThreads;
+
+        private SemaphoreSlim[] _laneStartSignals;
+
+        private CountdownEvent _laneDoneSignal;
+
+        private volatile bool _laneThreadsRunning;
+
+        //first exception thrown on a lane thread in the current update, rethrown on the parent thread
+        private ExceptionDispatchInfo _laneException;
+
+        private bool _updating;
+
+        public ChildEngineScheduler()
+        {
+            UpdateMode = ChildEngineUpdateMode.JobSystem;
+            LaneCount = Environment.ProcessorCount;
+            RebalanceInterval = 60;
+            RebalanceThreshold = 1.25f;
+        }
+
+        public IEnumerable<ChildEngineDomain> ChildEngineDomains
+        {
+            get { return _childEngineDomains; }
+        }
+
+        protected override void OnAdded()
+        {
+            base.OnAdded();
+
+            _childEngineDomains = new List<ChildEngineDomain>();
+        }
+
+        protected override void OnDestroy()
+        {
+            StopLaneThreads();
+
+            base.OnDestroy();
+        }
+
+        internal void Register(ChildEngineDomain childEngineDomain)
+        {
+            Debug.Assert(!_updating, "child engines can not be created while child engines are updating");
+
+            if (_lanes == null)
+            {
+                CreateLanes();
+            }
+
+            _childEngineDomains.Add(childEngineDomain);
+
+            int laneIndex = FindIdlestLane();
+            childEngineDomain.LaneIndex = laneIndex;
+            _lanes[laneIndex].Add(childEngineDomain);
+        }
+
+        internal void Unregister(ChildEngineDomain childEngineDomain)
+        {
+            Debug.Assert(!_updating, "child engines can not be destroyed while child engines are updating");
+
+            _childEngineDomains.Remove(childEngineDomain);
+
+            if (childEngineDomain.LaneIndex >= 0)
+            {
+                _lanes[childEngineDomain.LaneIndex].Remove(childEngineDomain);
+                childEngineDomain.LaneIndex = -1;
+            }
+        }
+
+        public float GetLaneLoad(int laneIndex)
+        {
+            float load = 0.0f;
+
+            List<ChildEngineDomain> lane = _lanes[laneIndex];
+
+            for (int i = 0; i < lane.Count; i++)
+            {
+                load += lane[i].AverageTickTime;
+            }
+
+            return load;
+        }
+
+        public int GetLaneChildEngineCount(int laneIndex)
+        {
+            return _lanes[laneIndex].Count;
+        }
+
+        [DomainMessageHandler(MessageType = typeof(UpdateMessage))]
+        private void OnUpdate(Message message)
+        {
+            if (_childEngineDomains.Count == 0)
+            {
+                return;
+            }
+
+            long startTicks = Stopwatch.GetTimestamp();
+
+            _updating = true;
+
+            try
+            {
+                if (UpdateMode == ChildEngineUpdateMode.DedicatedThreads)
+                {
+                    UpdateOnLaneThreads();
+                }
+                else
+                {
+                    UpdateOnJobSystem();
+                }
+            }
+            finally
+            {
+                _updating = false;
+            }
+
+            bool hadJob = false;
+
+            for (int i = 0; i < _childEngineDomains.Count; i++)
+            {
+                ChildEngineDomain childEngineDomain = _childEngineDomains[i];
+
+                childEngineDomain.DeliverMessagesToParent();
+                hadJob |= childEngineDomain.ChildEngineHadJob;
+            }
+
+            if (hadJob)
+            {
+                Engine.DoneJob();
+            }
+
+            FrameCount++;
+
+            if (RebalanceInterval > 0 && FrameCount % RebalanceInterval == 0)
+            {
+                Rebalance();
+            }
+
+            LastUpdateTime = (float)((Stopwatch.GetTimestamp() - startTicks) * 1000.0 / Stopwatch.Frequency);
+        }
+
+        private void UpdateOnJobSystem()
+        {
+            JobSystem jobSystem = Framework.Current.JobSystem;
+
+            if (_jobCounter == null)
+            {
+                _jobCounter = new JobCounter();
+            }
+
+            //one job per lane, stealing takes care of the remaining imbalance
+            for (int i = 0; i < _lanes.Length; i++)
+            {
+                if (_lanes[i].Count > 0)
+                {
+                    int laneIndex = i;
+                    jobSystem.Schedule(() => TickLane(laneIndex), _jobCounter, null);
+                }
+            }
+
+            jobSystem.Wait(_jobCounter);
+        }
+
+        private void UpdateOnLaneThreads()
+        {
+            if (_laneThreads == null)
+            {
+                StartLaneThreads();
+            }
+
+            _laneDoneSignal.Reset(_lanes.Length);
+
+            for (int i = 0; i < _lanes.Length; i++)
+            {
+                _laneStartSignals[i].Release();
+            }
+
+            _laneDoneSignal.Wait();
+
+            ExceptionDispatchInfo laneException = Interlocked.Exchange(ref _laneException, null);
+
+            if (laneException != null)
+            {
+                laneException.Throw();
+            }
+        }
+
+        private void TickLane(int laneIndex)
+        {
+            List<ChildEngineDomain> lane = _lanes[laneIndex];
+
+            for (int i = 0; i < lane.Count; i++)
+            {
+                lane[i].Tick();
+            }
+        }
+
+        private void CreateLanes()
+        {
+            _lanes = new List<ChildEngineDomain>[Math.Max(1, LaneCount)];
+
+            for (int i = 0; i < _lanes.Length; i++)
+            {
+                _lanes[i] = new List<ChildEngineDomain>();
+            }
+        }
+
+        private int FindIdlestLane()
+        {
+            int idlestLane = 0;
+            float idlestLoad = float.MaxValue;
+
+            for (int i = 0; i < _lanes.Length; i++)
+            {
+                float load = GetLaneLoad(i);
+
+                if (load < idlestLoad || (load == idlestLoad && _lanes[i].Count < _lanes[idlestLane].Count))
+                {
+                    idlestLane = i;
+                    idlestLoad = load;
+                }
+            }
+
+            return idlestLane;
+        }
+
+        //longest processing time first assignment, busiest child engines are placed first to the idlest lane
+        private void Rebalance()
+        {
+            float minLoad = float.MaxValue;
+            float maxLoad = 0.0f;
+
+            for (int i = 0; i < _lanes.Length; i++)
+            {
+                float load = GetLaneLoad(i);
+
+                minLoad = Math.Min(minLoad, load);
+                maxLoad = Math.Max(maxLoad, load);
+            }
+
+            if (maxLoad <= minLoad * RebalanceThreshold)
+            {
+                return;
+            }
+
+            List<ChildEngineDomain> sortedChildEngineDomains = _childEngineDomains.OrderByDescending(childEngineDomain => childEngineDomain.AverageTickTime).ToList();
+
+            float[] laneLoads = new float[_lanes.Length];
+
+            for (int i = 0; i < _lanes.Length; i++)
+            {
+                _lanes[i].Clear();
+            }
+
+            foreach (ChildEngineDomain childEngineDomain in sortedChildEngineDomains)
+            {
+                int idlestLane = 0;
+
+                for (int i = 1; i < laneLoads.Length; i++)
+                {
+                    if (laneLoads[i] < laneLoads[idlestLane])
+                    {
+                        idlestLane = i;
+                    }
+                }
+
+                laneLoads[idlestLane] += childEngineDomain.AverageTickTime;
+                childEngineDomain.LaneIndex = idlestLane;
+                _lanes[idlestLane].Add(childEngineDomain);
+            }
+        }
+
+        private void StartLaneThreads()
+        {
+            _laneThreadsRunning = true;
+
+            _laneThreads = new IThread[_lanes.Length];
+            _laneStartSignals = new SemaphoreSlim[_lanes.Length];
+            _laneDoneSignal = new CountdownEvent(_lanes.Length);
+
+            for (int i = 0; i < _lanes.Length; i++)
+            {
+                int laneIndex = i;
+
+                _laneStartSignals[i] = new SemaphoreSlim(0);
+
+                _laneThreads[i] = Framework.Current.CreateThread(() => LaneThreadLoop(laneIndex));
+                _laneThreads[i].Name = "Child Engine Lane " + laneIndex;
+                _laneThreads[i].IsBackground = true;
+                _laneThreads[i].Start();
+            }
+        }
+
+        private void StopLaneThreads()
+        {
+            if (_laneThreads != null)
+            {
+                _laneThreadsRunning = false;
+
+                for (int i = 0; i < _laneStartSignals.Length; i++)
+                {
+                    _laneStartSignals[i].Release();
+                }
+
+                _laneThreads = null;
+            }
+        }
+
+        private void LaneThreadLoop(int laneIndex)
+        {
+            if (UseThreadAffinity)
+            {
+                Framework.Current.SetCurrentThreadAffinity(laneIndex % Environment.ProcessorCount);
+            }
+
+            SemaphoreSlim startSignal = _laneStartSignals[laneIndex];
+
+            while (true)
+            {
+                startSignal.Wait();
+
+                if (!_laneThreadsRunning)
+                {
+                    break;
+                }
+
+                try
+                {
+                    TickLane(laneIndex);
+                }
+                catch (Exception exception)
+                {
+                    Interlocked.CompareExchange(ref _laneException, ExceptionDispatchInfo.Capture(exception), null);
+                }
+
+                _laneDoneSignal.Signal();
+            }
+        }
+    }
+}
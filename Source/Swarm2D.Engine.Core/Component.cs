@@ -60,6 +60,11 @@ namespace Swarm2D.Engine.Core
             private set;
         }
 
+        public ComponentHandle Handle { get; internal set; }
+
+        //true once the message handler delegates of this object are created
+        internal bool MessageHandlersBound { get; set; }
+
         protected Component()
         {
             GlobalMessageHandlers = new Dictionary<int, List<MessageHandlerDelegate>>();
@@ -158,9 +163,14 @@ namespace Swarm2D.Engine.Core
                 }
             }
 
-            GlobalMessageHandlers.Clear();
-            DomainMessageHandlers.Clear();
-            EntityMessageHandlers.Clear();
+            //the handler delegates stay bound to this object, the pool gives it to an entity of the same engine again
+            if (!engine.PooledMode)
+            {
+                GlobalMessageHandlers.Clear();
+                DomainMessageHandlers.Clear();
+                EntityMessageHandlers.Clear();
+                MessageHandlersBound = false;
+            }
 
             NodeOnAllComponentList = null;
             Entity = null;
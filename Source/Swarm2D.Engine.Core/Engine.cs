@@ -49,6 +49,40 @@ namespace Swarm2D.Engine.Core
 
         private bool _started = false;
 
+        [NonSerialized]
+        private ChildEngineDomain _parentDomain;
+
+        private IdleScheduler _idleScheduler;
+
+        //the domain hosting this engine if it is a child engine
+        public ChildEngineDomain ParentDomain
+        {
+            get { return _parentDomain; }
+            internal set { _parentDomain = value; }
+        }
+
+        internal bool CurrentFrameHadJob
+        {
+            get { return _currentFrameHadJob; }
+        }
+
+        //waits on IdleScheduler after an update without job,
+        //frameworks updating several domains in one loop turn this off and wait once for all of them
+        public bool WaitWhenIdle { get; set; }
+
+        //every engine waits on a scheduler of its own unless a framework updating several engines on one thread gives
+        //them the one it waits on. child engines share the scheduler of their root engine
+        public IdleScheduler IdleScheduler
+        {
+            get { return _parentDomain != null ? _parentDomain.Engine.IdleScheduler : _idleScheduler; }
+            set { _idleScheduler = value; }
+        }
+
+        public override bool IsIdle
+        {
+            get { return !_currentFrameHadJob; }
+        }
+
         public int UpdatePerSecond { get; private set; }
         public int UpdateMessageTimePerSecond { get; private set; }
         public int LateUpdateMessageTimePerSecond { get; private set; }
@@ -63,6 +97,22 @@ namespace Swarm2D.Engine.Core
         [NonSerialized]
         private Stopwatch _timer;
 
+        [NonSerialized]
+        private EngineProfiler _profiler;
+
+        public EngineProfiler Profiler
+        {
+            get
+            {
+                if (_profiler == null)
+                {
+                    _profiler = new EngineProfiler(EngineProfiler.DefaultFrameCapacity);
+                }
+
+                return _profiler;
+            }
+        }
+
         private Stopwatch Timer
         {
             get
@@ -95,27 +145,29 @@ namespace Swarm2D.Engine.Core
         private Dictionary<Type, LinkedList<Component>> _components; //all created components
         private EngineController _engineController;
 
-        private Stack<Entity> _freeEntities;
-        private Dictionary<Type, Stack<Component>> _freeComponents;
+        private HandleTable<Entity> _entityHandles;
+        private HandleTable<Component> _componentHandles;
+
+        private ObjectPool<Entity> _entityPool;
+        private Dictionary<Type, ObjectPool<Component>> _componentPools;
+
+        private const int EntityPoolChunkShift = 10;
+        private const int ComponentPoolChunkShift = 6;
 
         public Engine(bool pooledMode)
         {
             PooledMode = pooledMode;
+            WaitWhenIdle = true;
+            _idleScheduler = new IdleScheduler();
 
             _components = new Dictionary<Type, LinkedList<Component>>();
             GlobalMessageHandlers = new Dictionary<int, List<MessageHandlerDelegate>>();
 
-            if (PooledMode)
-            {
-                _freeEntities = new Stack<Entity>(16384);
-
-                for (int i = 0; i < 16384; i++)
-                {
-                    _freeEntities.Push(new Entity(this));
-                }
+            _entityHandles = new HandleTable<Entity>();
+            _componentHandles = new HandleTable<Component>();
 
-                _freeComponents = new Dictionary<Type, Stack<Component>>();
-            }
+            _entityPool = new ObjectPool<Entity>(typeof(Entity), EntityPoolChunkShift);
+            _componentPools = new Dictionary<Type, ObjectPool<Component>>();
 
             InitializePrefabManager();
             InitializeGlobalVariables();
@@ -128,7 +180,7 @@ namespace Swarm2D.Engine.Core
 
         private void CreateRootEntity()
         {
-            _rootEntity = new Entity(this);
+            _rootEntity = CreateEntity();
             _rootEntity.Reset("Engine");
 
             _engineController = _rootEntity.AddComponent<EngineController>();
@@ -146,6 +198,9 @@ namespace Swarm2D.Engine.Core
                 _currentFrameHadJob = true;
             }
 
+            EngineProfiler profiler = Profiler;
+            profiler.BeginFrame(CurrentFrame);
+
             long elapsedTickBeforeUpdate = Timer.ElapsedTicks;
 
             SendMessage(new UpdateMessage());
@@ -160,13 +215,16 @@ namespace Swarm2D.Engine.Core
 
             long elapsedTickAfterLastUpdate = Timer.ElapsedTicks;
 
+            profiler.EndFrame();
+
             _lastCountedElapsedTicksForUpdatePerSecond += elapsedTickBeforeLateUpdate - elapsedTickBeforeUpdate;
             _lastCountedElapsedTicksForLateUpdatePerSecond += elapsedTickAfterLateUpdate - elapsedTickBeforeLateUpdate;
             _lastCountedElapsedTicksForLastUpdatePerSecond += elapsedTickAfterLastUpdate - elapsedTickAfterLateUpdate;
 
-            if (!_currentFrameHadJob)
+            //child engines are paced by their parent, frame driven frameworks by their host
+            if (!_currentFrameHadJob && _parentDomain == null && WaitWhenIdle && !Framework.Current.TicksAreFrameDriven)
             {
-                Framework.Current.Sleep(1);
+                _idleScheduler.Wait();
             }
 
             _countedUpdateLastSecond++;
@@ -220,10 +278,29 @@ namespace Swarm2D.Engine.Core
             if (GlobalMessageHandlers.ContainsKey(message.Id))
             {
                 List<MessageHandlerDelegate> delegates = GlobalMessageHandlers[message.Id];
+                EngineProfiler profiler = Profiler;
 
                 foreach (MessageHandlerDelegate messageHandlerDelegate in delegates)
                 {
-                    messageHandlerDelegate.Invoke(message);
+                    bool recording = profiler.IsRecording;
+
+                    if (recording)
+                    {
+                        profiler.BeginHandlerSample(message, messageHandlerDelegate, this);
+                    }
+
+                    //global handlers are not guarded, the sample is closed before the exception leaves
+                    try
+                    {
+                        messageHandlerDelegate.Invoke(message);
+                    }
+                    finally
+                    {
+                        if (recording)
+                        {
+                            profiler.EndSample();
+                        }
+                    }
                 }
             }
         }
@@ -233,6 +310,14 @@ namespace Swarm2D.Engine.Core
             ((IEntityDomain)_engineController).SendMessage(message);
         }
 
+        //sends the message to the entity of the parent domain on the parent engine's thread, after the current update of this engine
+        public void PostToParent(EntityMessage message)
+        {
+            Debug.Assert(_parentDomain != null, "PostToParent is called on an engine which is not a child engine");
+
+            _parentDomain.PostToParent(message);
+        }
+
         internal void OnComponentCreated(Component component)
         {
             if (!_components.ContainsKey(component.GetType()))
@@ -241,11 +326,27 @@ namespace Swarm2D.Engine.Core
             }
 
             component.NodeOnAllComponentList = _components[component.GetType()].AddLast(component);
+
+            //only pooled objects can be reused behind a reference, so only they need handles
+            if (PooledMode)
+            {
+                component.Handle = new ComponentHandle(_componentHandles.Add(component));
+            }
+
+            GetComponentPool(component.GetType()).OnAllocated();
         }
 
         internal void OnComponentDestroyed(Component component)
         {
             _components[component.GetType()].Remove(component.NodeOnAllComponentList);
+
+            if (PooledMode)
+            {
+                _componentHandles.Remove(component.Handle.Value);
+                component.Handle = ComponentHandle.Null;
+            }
+
+            GetComponentPool(component.GetType()).OnReleased();
         }
 
         public T FindComponent<T>() where T : Component
@@ -312,7 +413,7 @@ namespace Swarm2D.Engine.Core
 
         public Entity CreatePrefab(string name)
         {
-            Entity prefab = new Entity(this);
+            Entity prefab = CreateEntity();
             prefab.ResetAsPrefab(name);
 
             _prefabs.Add(name, prefab);
@@ -330,6 +431,19 @@ namespace Swarm2D.Engine.Core
             return clonedPrefab;
         }
 
+        internal PrefabSpawnPlan GetPrefabSpawnPlan(Entity prefab)
+        {
+            PrefabSpawnPlan spawnPlan = prefab.SpawnPlan;
+
+            if (spawnPlan == null || !spawnPlan.IsValidFor(prefab))
+            {
+                spawnPlan = new PrefabSpawnPlan(prefab);
+                prefab.SpawnPlan = spawnPlan;
+            }
+
+            return spawnPlan;
+        }
+
         #endregion
 
         #region Global Variables
@@ -358,40 +472,69 @@ namespace Swarm2D.Engine.Core
 
         #endregion
 
+        #region Pools
+
         internal Entity CreateEntity()
         {
+            Entity entity = null;
+
             if (PooledMode)
             {
-                if (_freeEntities.Count > 0)
-                {
-                    return _freeEntities.Pop();
-                }
+                entity = _entityPool.Take();
             }
 
-            return new Entity(this);
+            if (entity == null)
+            {
+                entity = new Entity(this);
+            }
+
+            if (PooledMode)
+            {
+                entity.Handle = new EntityHandle(_entityHandles.Add(entity));
+            }
+
+            _entityPool.OnAllocated();
+
+            return entity;
         }
 
         internal void FreeEntity(Entity entity)
         {
+            Debug.Assert(entity.Engine == this, "entity.Engine == this");
+
+            _entityPool.OnReleased();
+
             if (PooledMode)
             {
-                Debug.Assert(entity.Engine == this, "entity.Engine == this");
-                _freeEntities.Push(entity);
+                _entityHandles.Remove(entity.Handle.Value);
+                entity.Handle = EntityHandle.Null;
+
+                _entityPool.Return(entity);
             }
         }
 
+        private ObjectPool<Component> GetComponentPool(Type type)
+        {
+            ObjectPool<Component> pool;
+
+            if (!_componentPools.TryGetValue(type, out pool))
+            {
+                pool = new ObjectPool<Component>(type, ComponentPoolChunkShift);
+                _componentPools.Add(type, pool);
+            }
+
+            return pool;
+        }
+
         internal Component CreateComponentIfExists(Type type)
         {
             if (PooledMode)
             {
-                Stack<Component> _freComponentsOfType;
+                ObjectPool<Component> pool;
 
-                if (_freeComponents.TryGetValue(type, out _freComponentsOfType))
+                if (_componentPools.TryGetValue(type, out pool))
                 {
-                    if (_freComponentsOfType.Count > 0)
-                    {
-                        return _freComponentsOfType.Pop();
-                    }
+                    return pool.Take();
                 }
             }
 
@@ -400,21 +543,69 @@ namespace Swarm2D.Engine.Core
 
         internal void FreeComponent(Component component)
         {
-            if (PooledMode)
+            if (PooledMode && component.GetComponentInfo().Poolable)
             {
-                Stack<Component> _freComponentsOfType;
-                Type type = component.GetType();
+                GetComponentPool(component.GetType()).Return(component);
+            }
+        }
 
-                if (!_freeComponents.TryGetValue(type, out _freComponentsOfType))
-                {
-                    _freComponentsOfType = new Stack<Component>();
-                    _freeComponents.Add(type, _freComponentsOfType);
-                }
+        //returns null if the entity of the handle is destroyed. handles are given only in pooled mode, they are null otherwise
+        public Entity GetEntity(EntityHandle handle)
+        {
+            return _entityHandles.Get(handle.Value);
+        }
+
+        //returns null if the component of the handle is destroyed
+        public Component GetComponent(ComponentHandle handle)
+        {
+            return _componentHandles.Get(handle.Value);
+        }
+
+        public T GetComponent<T>(ComponentHandle handle) where T : Component
+        {
+            return _componentHandles.Get(handle.Value) as T;
+        }
+
+        public PoolStatistics GetEntityPoolStatistics()
+        {
+            return _entityPool.GetStatistics();
+        }
+
+        public PoolStatistics[] GetComponentPoolStatistics()
+        {
+            PoolStatistics[] statistics = new PoolStatistics[_componentPools.Count];
 
-                _freComponentsOfType.Push(component);
+            int i = 0;
+
+            foreach (ObjectPool<Component> pool in _componentPools.Values)
+            {
+                statistics[i] = pool.GetStatistics();
+                i++;
             }
+
+            return statistics;
         }
 
+        //releases pooled objects above maxFreePerType, e.g. after a level with lots of entities is unloaded
+        public int TrimPools(int maxFreePerType)
+        {
+            int removed = _entityPool.Trim(maxFreePerType);
+
+            foreach (ObjectPool<Component> pool in _componentPools.Values)
+            {
+                removed += pool.Trim(maxFreePerType);
+            }
+
+            return removed;
+        }
+
+        public int TrimPools()
+        {
+            return TrimPools(0);
+        }
+
+        #endregion
+
         internal LinkedListNode<Component> GetComponentNode(Component component)
         {
             LinkedList<Component> components = _components[component.GetType()];
@@ -110,6 +110,7 @@ namespace Swarm2D.Engine.Core
             IsPrefab = false;
             IsInstantiatedFromPrefab = false;
             PrefabName = "";
+            SpawnPlan = null;
         }
 
         internal void ResetAsPrefab(string name)
@@ -121,8 +122,12 @@ namespace Swarm2D.Engine.Core
             IsPrefab = true;
             IsInstantiatedFromPrefab = false;
             PrefabName = "";
+            SpawnPlan = null;
         }
 
+        //set on prefabs once they are instantiated
+        internal PrefabSpawnPlan SpawnPlan { get; set; }
+
         internal void SetAsInstantiatedFromPrefab(string prefabName)
         {
             Debug.Assert(!IsDestroyed, "!IsDestroyed");
@@ -131,7 +136,7 @@ namespace Swarm2D.Engine.Core
             PrefabName = prefabName;
         }
 
-        private Component AddComponentWithInfo(ComponentInfo componentInfo)
+        internal Component AddComponent(ComponentInfo componentInfo)
         {
             Component component = componentInfo.CreateComponent(this);
 
@@ -164,7 +169,7 @@ namespace Swarm2D.Engine.Core
 
             if (componentInfo != null)
             {
-                return AddComponentWithInfo(componentInfo);
+                return AddComponent(componentInfo);
             }
 
             return null;
@@ -176,7 +181,7 @@ namespace Swarm2D.Engine.Core
 
             if (componentInfo != null)
             {
-                return AddComponentWithInfo(componentInfo);
+                return AddComponent(componentInfo);
             }
 
             return null;
@@ -196,14 +201,14 @@ namespace Swarm2D.Engine.Core
 
         public T AddComponent<T>() where T : Component
         {
-            T component = AddComponentWithInfo(ComponentInfo.GetComponentInfo(typeof(T))) as T;
+            T component = AddComponent(ComponentInfo.GetComponentInfo(typeof(T))) as T;
 
             return component;
         }
 
         public T1 AddComponent<T1, T2>(T2 parameter) where T1 : Component, IConstructableComponent<T2>
         {
-            T1 component = (T1)AddComponentWithInfo(ComponentInfo.GetComponentInfo(typeof(T1)));
+            T1 component = (T1)AddComponent(ComponentInfo.GetComponentInfo(typeof(T1)));
             component.OnConstruct(parameter);
 
             return component;
@@ -357,10 +362,17 @@ namespace Swarm2D.Engine.Core
             if (EntityMessageHandlers.ContainsKey(message.Id))
             {
                 List<MessageHandlerDelegate> messageHandlers = EntityMessageHandlers[message.Id];
+                EngineProfiler profiler = Engine.Profiler;
 
                 for (int i = 0; i < messageHandlers.Count; i++)
                 {
                     MessageHandlerDelegate messageHandlerDelegate = messageHandlers[i];
+                    bool recording = profiler.IsRecording;
+
+                    if (recording)
+                    {
+                        profiler.BeginHandlerSample(message, messageHandlerDelegate, Domain);
+                    }
 
                     try
                     {
@@ -372,6 +384,13 @@ namespace Swarm2D.Engine.Core
                         Debug.Log("exception:" + ex.Message);
                         Debug.Log("printing exception over...");
                     }
+                    finally
+                    {
+                        if (recording)
+                        {
+                            profiler.EndSample();
+                        }
+                    }
                 }
             }
         }
@@ -409,6 +428,8 @@ namespace Swarm2D.Engine.Core
 
         public Engine Engine { get; private set; }
 
+        public EntityHandle Handle { get; internal set; }
+
         public IEntityDomain Domain { get; set; }
 
         public IEntityDomain ChildDomain { get; set; }
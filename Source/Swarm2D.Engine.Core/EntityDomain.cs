@@ -54,12 +54,19 @@ namespace Swarm2D.Engine.Core
             if (_domainMessageHandlerDelegates.ContainsKey(message.Id))
             {
                 List<MessageHandlerDelegate> messageHandlers = _domainMessageHandlerDelegates[message.Id];
+                EngineProfiler profiler = _entity.Engine.Profiler;
 
                 for (int index = 0; index < messageHandlers.Count; index++)
                 {
                     InitializeNonInitializedEntityComponents();
 
                     MessageHandlerDelegate messageHandlerDelegate = messageHandlers[index];
+                    bool recording = profiler.IsRecording;
+
+                    if (recording)
+                    {
+                        profiler.BeginHandlerSample(message, messageHandlerDelegate, _entity.ChildDomain);
+                    }
 
                     try
                     {
@@ -71,6 +78,13 @@ namespace Swarm2D.Engine.Core
                         Debug.Log(e.Message);
                         Debug.Log("Stack:" + e.StackTrace);
                     }
+                    finally
+                    {
+                        if (recording)
+                        {
+                            profiler.EndSample();
+                        }
+                    }
 
                     InitializeNonInitializedEntityComponents();
                 }
@@ -144,37 +158,13 @@ namespace Swarm2D.Engine.Core
 
         public Entity InstantiatePrefab(Entity prefab)
         {
-            Entity clonedPrefab = null;
+            PrefabSpawnPlan spawnPlan = _entity.Engine.GetPrefabSpawnPlan(prefab);
 
-            //TODO: hmm
-            //if (prefab.GetComponent<SceneEntity>() != null)
-            {
-                clonedPrefab = _entity.CreateChildEntity(prefab.Name + "(Clone)-" + _lastClonedPrefabId);
-                clonedPrefab.SetAsInstantiatedFromPrefab(prefab.Name);
-                _lastClonedPrefabId++;
-
-                foreach (Component componentPrefab in prefab.Components)
-                {
-                    Component clonedComponent = clonedPrefab.GetComponent(componentPrefab.GetType());
+            Entity clonedPrefab = _entity.CreateChildEntity(prefab.Name + "(Clone)-" + _lastClonedPrefabId);
+            clonedPrefab.SetAsInstantiatedFromPrefab(prefab.Name);
+            _lastClonedPrefabId++;
 
-                    if (clonedComponent == null)
-                    {
-                        clonedComponent = clonedPrefab.AddComponent(componentPrefab.GetType());
-                    }
-                    else
-                    {
-
-                    }
-
-                    ComponentInfo componentInfo = componentPrefab.GetComponentInfo();
-
-                    foreach (ComponentPropertyInfo propertyInfo in componentInfo.ComponentPropertyInfos.Values)
-                    {
-                        object value = propertyInfo.GetValueAsObjectFrom(componentPrefab);
-                        propertyInfo.SetValueTo(clonedComponent, value);
-                    }
-                }
-            }
+            spawnPlan.Apply(clonedPrefab);
 
             return clonedPrefab;
         }
@@ -28,6 +28,7 @@ using System.Collections.Generic;
 using System.Linq;
 using System.Reflection;
 using System.Text;
+using System.Threading;
 using System.Xml;
 using Swarm2D.Engine.Core;
 using Swarm2D.Library;
@@ -94,5 +95,71 @@ namespace Swarm2D.Engine.Core
         public abstract long ElapsedTicks { get; }
 
         public abstract long TicksPerSecond { get; }
+
+        //true if ElapsedTicks only advance with the frames of a host loop (e.g. Unity), the host paces the updates
+        //so engines do not wait on the idle scheduler
+        public virtual bool TicksAreFrameDriven
+        {
+            get { return false; }
+        }
+
+        #region Jobs
+
+        private JobSystem _jobSystem;
+
+        //created by the framework on its main thread, which runs jobs with thread index 0
+        public JobSystem JobSystem
+        {
+            get
+            {
+                Debug.Assert(_jobSystem != null, "the job system is used before the framework created it");
+
+                return _jobSystem;
+            }
+        }
+
+        protected void CreateJobSystem()
+        {
+            Debug.Assert(_jobSystem == null, "the job system is already created");
+
+            _jobSystem = new JobSystem(CreateJobSystemSettings());
+        }
+
+        protected virtual JobSystemSettings CreateJobSystemSettings()
+        {
+            return new JobSystemSettings();
+        }
+
+        public virtual void SetCurrentThreadAffinity(int processorIndex)
+        {
+        }
+
+        #endregion
+
+        #region Idle
+
+        private IdleScheduler _idleScheduler;
+
+        //waited on by framework loops updating several engines on one thread, the engines are given this scheduler
+        public IdleScheduler IdleScheduler
+        {
+            get
+            {
+                if (_idleScheduler == null)
+                {
+                    _idleScheduler = new IdleScheduler();
+                }
+
+                return _idleScheduler;
+            }
+        }
+
+        //returns true if the handle is signaled before the timeout
+        public virtual bool WaitForWakeUp(WaitHandle waitHandle, int miliSeconds)
+        {
+            return waitHandle.WaitOne(miliSeconds);
+        }
+
+        #endregion
     }
 }
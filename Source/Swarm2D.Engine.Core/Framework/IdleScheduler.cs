@@ -0,0 +1,174 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Text;
+using System.Threading;
+
+namespace Swarm2D.Engine.Core
+{
+    //blocks an idle update loop until the earliest requested deadline or until WakeUp is called (e.g. by a network thread).
+    //deadlines are in Framework ticks and have to be requested again on every update, the wait itself is timed with
+    //Stopwatch since framework ticks may not advance while the loop is blocked.
+    //only the thread of the loop calls Wait, so one wake up signal and the statistics belong to that thread.
+    public sealed class IdleScheduler
+    {
+        private AutoResetEvent _wakeSignal;
+
+        private long _nextDeadline;
+
+        //used when no deadline is requested, polling components are still updated at least this often
+        public int MaxIdleMilliseconds { get; set; }
+
+        //the last part of a wait is spun instead of blocked, timers of most platforms are not more precise than that
+        public double SpinMilliseconds { get; set; }
+
+        public long WaitCount { get; private set; }
+        public long DeadlineWakeUpCount { get; private set; }
+        public long SignalWakeUpCount { get; private set; }
+
+        //how late the loop woke up for a requested deadline
+        public double LastJitterMilliseconds { get; private set; }
+        public double AverageJitterMilliseconds { get; private set; }
+        public double MaxJitterMilliseconds { get; private set; }
+
+        public double TotalIdleMilliseconds { get; private set; }
+
+        public IdleScheduler()
+        {
+            _wakeSignal = new AutoResetEvent(false);
+            _nextDeadline = long.MaxValue;
+
+            MaxIdleMilliseconds = 10;
+            SpinMilliseconds = 1.0;
+        }
+
+        //thread safe
+        public void RequestWakeUpAt(long tick)
+        {
+            long currentDeadline = Interlocked.Read(ref _nextDeadline);
+
+            while (tick < currentDeadline)
+            {
+                long previousDeadline = Interlocked.CompareExchange(ref _nextDeadline, tick, currentDeadline);
+
+                if (previousDeadline == currentDeadline)
+                {
+                    break;
+                }
+
+                currentDeadline = previousDeadline;
+            }
+        }
+
+        //thread safe, ends the current or the next wait immediately
+        public void WakeUp()
+        {
+            _wakeSignal.Set();
+        }
+
+        public void Wait()
+        {
+            Framework framework = Framework.Current;
+
+            long ticksPerSecond = framework.TicksPerSecond;
+            long startTick = framework.ElapsedTicks;
+
+            long deadline = Interlocked.Exchange(ref _nextDeadline, long.MaxValue);
+            bool hasDeadline = deadline != long.MaxValue;
+
+            long maxIdleDeadline = startTick + MaxIdleMilliseconds * ticksPerSecond / 1000;
+
+            if (!hasDeadline || deadline > maxIdleDeadline)
+            {
+                deadline = maxIdleDeadline;
+            }
+
+            WaitCount++;
+
+            bool signaled = false;
+            double remainingMilliseconds = (deadline - startTick) * 1000.0 / ticksPerSecond;
+
+            long startTimestamp = Stopwatch.GetTimestamp();
+            long deadlineTimestamp = startTimestamp + (long)(remainingMilliseconds * Stopwatch.Frequency / 1000.0);
+
+            if (remainingMilliseconds > SpinMilliseconds)
+            {
+                signaled = framework.WaitForWakeUp(_wakeSignal, (int)(remainingMilliseconds - SpinMilliseconds));
+            }
+
+            if (!signaled)
+            {
+                SpinWait spinWait = new SpinWait();
+
+                while (Stopwatch.GetTimestamp() < deadlineTimestamp)
+                {
+                    if (_wakeSignal.WaitOne(0))
+                    {
+                        signaled = true;
+                        break;
+                    }
+
+                    spinWait.SpinOnce();
+                }
+            }
+
+            long endTimestamp = Stopwatch.GetTimestamp();
+
+            TotalIdleMilliseconds += (endTimestamp - startTimestamp) * 1000.0 / Stopwatch.Frequency;
+
+            if (signaled)
+            {
+                SignalWakeUpCount++;
+            }
+            else if (hasDeadline)
+            {
+                DeadlineWakeUpCount++;
+
+                double jitter = (endTimestamp - deadlineTimestamp) * 1000.0 / Stopwatch.Frequency;
+
+                LastJitterMilliseconds = jitter;
+                AverageJitterMilliseconds = DeadlineWakeUpCount == 1 ? jitter : AverageJitterMilliseconds * 0.95 + jitter * 0.05;
+                MaxJitterMilliseconds = Math.Max(MaxJitterMilliseconds, jitter);
+            }
+        }
+
+        public void ResetStatistics()
+        {
+            WaitCount = 0;
+            DeadlineWakeUpCount = 0;
+            SignalWakeUpCount = 0;
+
+            LastJitterMilliseconds = 0.0;
+            AverageJitterMilliseconds = 0.0;
+            MaxJitterMilliseconds = 0.0;
+
+            TotalIdleMilliseconds = 0.0;
+        }
+    }
+}
@@ -35,5 +35,11 @@ namespace Swarm2D.Engine.Core
     {
         public abstract void Update();
         public abstract void Destroy();
+
+        //true if the last update had nothing to do
+        public virtual bool IsIdle
+        {
+            get { return false; }
+        }
     }
 }
\ No newline at end of file
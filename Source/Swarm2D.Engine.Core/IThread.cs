@@ -33,6 +33,7 @@ namespace Swarm2D.Engine.Core
     public interface IThread
     {
         string Name { get; set; }
+        bool IsBackground { get; set; }
         void Start();
     }
 
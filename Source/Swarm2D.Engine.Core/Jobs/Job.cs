@@ -0,0 +1,60 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Core
+{
+    public delegate void JobDelegate();
+
+    //startIndex is inclusive, endIndex is exclusive.
+    //threadIndex is 0 for the thread that created the job system and 1..WorkerCount for workers, it can be used to index per thread buffers.
+    //without workers every thread runs its jobs with index 0, one thread at a time
+    public delegate void ParallelForDelegate(int startIndex, int endIndex, int threadIndex);
+
+    internal struct Job
+    {
+        public JobDelegate Work;
+        public ParallelForDelegate ParallelForWork;
+        public int StartIndex;
+        public int EndIndex;
+        public JobCounter Counter;
+
+        public void Execute(int threadIndex)
+        {
+            if (Work != null)
+            {
+                Work();
+            }
+            else
+            {
+                ParallelForWork(StartIndex, EndIndex, threadIndex);
+            }
+        }
+    }
+}
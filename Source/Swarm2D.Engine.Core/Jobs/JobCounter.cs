@@ -0,0 +1,136 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.ExceptionServices;
+using System.Text;
+using System.Threading;
+
+namespace Swarm2D.Engine.Core
+{
+    //counts the unfinished jobs of a batch, jobs scheduled with this counter as dependency start when it reaches zero
+    public sealed class JobCounter
+    {
+        private int _count;
+
+        private JobSystem _jobSystem;
+        private List<Job> _dependentJobs;
+
+        private ExceptionDispatchInfo _exception;
+
+        public bool IsDone
+        {
+            get { return Volatile.Read(ref _count) == 0; }
+        }
+
+        public int Count
+        {
+            get { return Volatile.Read(ref _count); }
+        }
+
+        //the first exception thrown by a job of the counter, waiting for the counter throws it on the waiting thread
+        public Exception Exception
+        {
+            get
+            {
+                ExceptionDispatchInfo exception = Volatile.Read(ref _exception);
+                return exception != null ? exception.SourceException : null;
+            }
+        }
+
+        internal void SetException(Exception exception)
+        {
+            Interlocked.CompareExchange(ref _exception, ExceptionDispatchInfo.Capture(exception), null);
+        }
+
+        //counters are reused, the exception is thrown only once
+        internal void ThrowException()
+        {
+            ExceptionDispatchInfo exception = Interlocked.Exchange(ref _exception, null);
+
+            if (exception != null)
+            {
+                exception.Throw();
+            }
+        }
+
+        internal void Increment()
+        {
+            Interlocked.Increment(ref _count);
+        }
+
+        internal void Decrement()
+        {
+            if (Interlocked.Decrement(ref _count) == 0)
+            {
+                List<Job> dependentJobs = null;
+                JobSystem jobSystem = null;
+
+                lock (this)
+                {
+                    if (_dependentJobs != null && _dependentJobs.Count > 0)
+                    {
+                        dependentJobs = _dependentJobs;
+                        jobSystem = _jobSystem;
+
+                        _dependentJobs = null;
+                    }
+                }
+
+                if (dependentJobs != null)
+                {
+                    for (int i = 0; i < dependentJobs.Count; i++)
+                    {
+                        jobSystem.Submit(dependentJobs[i]);
+                    }
+                }
+            }
+        }
+
+        //returns false if the counter is already done, the job should be submitted right away in that case
+        internal bool TryAddDependentJob(JobSystem jobSystem, Job job)
+        {
+            lock (this)
+            {
+                if (IsDone)
+                {
+                    return false;
+                }
+
+                if (_dependentJobs == null)
+                {
+                    _dependentJobs = new List<Job>();
+                }
+
+                _jobSystem = jobSystem;
+                _dependentJobs.Add(job);
+
+                return true;
+            }
+        }
+    }
+}
@@ -0,0 +1,459 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Threading;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Core
+{
+    //work stealing job scheduler, every worker owns a deque and steals from the others when its own deque is empty.
+    //the thread which creates the job system owns deque 0 and runs jobs while it waits on a counter.
+    //jobs scheduled from other threads go to a shared queue and are run by the workers and the owner thread. without
+    //workers every thread runs its jobs itself, one thread at a time as they all run them with thread index 0.
+    //an exception thrown by a job is thrown again on the thread waiting for its counter.
+    public sealed class JobSystem
+    {
+        private const int SpinCountBeforeSleep = 64;
+
+        [ThreadStatic]
+        private static JobSystem _currentThreadJobSystem;
+
+        [ThreadStatic]
+        private static int _currentThreadIndex;
+
+        private WorkStealingDeque<Job>[] _deques;
+        private Queue<Job> _externalJobs;
+
+        private IThread[] _workers;
+        private SemaphoreSlim _wakeSignal;
+        private int _sleepingWorkerCount;
+        private volatile bool _running;
+
+        private long[] _executedJobCounts;
+        private long[] _stolenJobCounts;
+
+        private object _inlineLock;
+
+        public int WorkerCount { get; private set; }
+
+        //worker count + the owner thread
+        public int ThreadCount
+        {
+            get { return WorkerCount + 1; }
+        }
+
+        public bool Deterministic { get; private set; }
+
+        public int BatchesPerThread { get; private set; }
+
+        public JobSystem(JobSystemSettings settings)
+        {
+            Deterministic = settings.Deterministic;
+            WorkerCount = Deterministic ? 0 : Math.Max(0, settings.WorkerCount);
+            BatchesPerThread = Math.Max(1, settings.BatchesPerThread);
+
+            _currentThreadJobSystem = this;
+            _currentThreadIndex = 0;
+
+            _deques = new WorkStealingDeque<Job>[ThreadCount];
+
+            for (int i = 0; i < ThreadCount; i++)
+            {
+                _deques[i] = new WorkStealingDeque<Job>(256);
+            }
+
+            _externalJobs = new Queue<Job>();
+            _wakeSignal = new SemaphoreSlim(0);
+
+            _executedJobCounts = new long[ThreadCount];
+            _stolenJobCounts = new long[ThreadCount];
+
+            _inlineLock = new object();
+
+            _running = true;
+            _workers = new IThread[WorkerCount];
+
+            for (int i = 0; i < WorkerCount; i++)
+            {
+                int threadIndex = i + 1;
+                bool useThreadAffinity = settings.UseThreadAffinity;
+
+                IThread worker = Framework.Current.CreateThread(() => WorkerLoop(threadIndex, useThreadAffinity));
+                worker.Name = "Job Worker " + threadIndex;
+                worker.IsBackground = true;
+
+                _workers[i] = worker;
+            }
+
+            for (int i = 0; i < WorkerCount; i++)
+            {
+                _workers[i].Start();
+            }
+        }
+
+        //-1 if the current thread does not run jobs of this job system
+        public int CurrentThreadIndex
+        {
+            get
+            {
+                if (_currentThreadJobSystem == this)
+                {
+                    return _currentThreadIndex;
+                }
+
+                return -1;
+            }
+        }
+
+        public JobCounter Schedule(JobDelegate work)
+        {
+            JobCounter counter = new JobCounter();
+            Schedule(work, counter, null);
+
+            return counter;
+        }
+
+        public JobCounter Schedule(JobDelegate work, JobCounter dependency)
+        {
+            JobCounter counter = new JobCounter();
+            Schedule(work, counter, dependency);
+
+            return counter;
+        }
+
+        //adds the job to an existing counter, so one counter can be waited for many jobs
+        public void Schedule(JobDelegate work, JobCounter counter, JobCounter dependency)
+        {
+            Job job = new Job();
+            job.Work = work;
+            job.Counter = counter;
+
+            Schedule(job, dependency);
+        }
+
+        public JobCounter ScheduleParallelFor(int count, int minimumBatchSize, ParallelForDelegate work)
+        {
+            return ScheduleParallelFor(count, minimumBatchSize, work, null);
+        }
+
+        public JobCounter ScheduleParallelFor(int count, int minimumBatchSize, ParallelForDelegate work, JobCounter dependency)
+        {
+            JobCounter counter = new JobCounter();
+
+            if (count <= 0)
+            {
+                return counter;
+            }
+
+            int batchSize = CalculateBatchSize(count, minimumBatchSize);
+
+            for (int startIndex = 0; startIndex < count; startIndex += batchSize)
+            {
+                Job job = new Job();
+                job.ParallelForWork = work;
+                job.StartIndex = startIndex;
+                job.EndIndex = Math.Min(count, startIndex + batchSize);
+                job.Counter = counter;
+
+                Schedule(job, dependency);
+            }
+
+            return counter;
+        }
+
+        public void ParallelFor(int count, ParallelForDelegate work)
+        {
+            ParallelFor(count, 1, work);
+        }
+
+        public void ParallelFor(int count, int minimumBatchSize, ParallelForDelegate work)
+        {
+            if (count <= 0)
+            {
+                return;
+            }
+
+            //nothing to share the work with, skip the scheduling
+            if (WorkerCount == 0)
+            {
+                lock (_inlineLock)
+                {
+                    JobSystem previousJobSystem;
+                    int previousThreadIndex;
+
+                    BeginInline(out previousJobSystem, out previousThreadIndex);
+
+                    try
+                    {
+                        work(0, count, 0);
+                    }
+                    finally
+                    {
+                        EndInline(previousJobSystem, previousThreadIndex);
+                    }
+                }
+
+                return;
+            }
+
+            int threadIndex = CurrentThreadIndex;
+
+            if (threadIndex >= 0 && count <= minimumBatchSize)
+            {
+                work(0, count, threadIndex);
+                return;
+            }
+
+            Wait(ScheduleParallelFor(count, minimumBatchSize, work));
+        }
+
+        //runs other jobs while waiting if the current thread belongs to this job system
+        public void Wait(JobCounter counter)
+        {
+            int threadIndex = CurrentThreadIndex;
+
+            if (threadIndex < 0)
+            {
+                SpinWait externalSpinWait = new SpinWait();
+
+                while (!counter.IsDone)
+                {
+                    externalSpinWait.SpinOnce();
+                }
+
+                counter.ThrowException();
+                return;
+            }
+
+            SpinWait spinWait = new SpinWait();
+
+            while (!counter.IsDone)
+            {
+                Job job;
+
+                if (TryGetJob(threadIndex, out job))
+                {
+                    ExecuteJob(job, threadIndex);
+                    spinWait.Reset();
+                }
+                else
+                {
+                    spinWait.SpinOnce();
+                }
+            }
+
+            counter.ThrowException();
+        }
+
+        public void Shutdown()
+        {
+            _running = false;
+            _wakeSignal.Release(WorkerCount + 1);
+        }
+
+        public long GetExecutedJobCount(int threadIndex)
+        {
+            return Interlocked.Read(ref _executedJobCounts[threadIndex]);
+        }
+
+        public long GetStolenJobCount(int threadIndex)
+        {
+            return Interlocked.Read(ref _stolenJobCounts[threadIndex]);
+        }
+
+        private int CalculateBatchSize(int count, int minimumBatchSize)
+        {
+            int batchCount = ThreadCount * BatchesPerThread;
+            int batchSize = (count + batchCount - 1) / batchCount;
+
+            return Math.Max(Math.Max(1, minimumBatchSize), batchSize);
+        }
+
+        private void Schedule(Job job, JobCounter dependency)
+        {
+            job.Counter.Increment();
+
+            if (dependency != null && dependency.TryAddDependentJob(this, job))
+            {
+                return;
+            }
+
+            Submit(job);
+        }
+
+        internal void Submit(Job job)
+        {
+            if (WorkerCount == 0)
+            {
+                //no workers, run in submission order on the current thread
+                lock (_inlineLock)
+                {
+                    JobSystem previousJobSystem;
+                    int previousThreadIndex;
+
+                    BeginInline(out previousJobSystem, out previousThreadIndex);
+                    ExecuteJob(job, 0);
+                    EndInline(previousJobSystem, previousThreadIndex);
+                }
+
+                return;
+            }
+
+            if (_currentThreadJobSystem == this)
+            {
+                _deques[_currentThreadIndex].Push(job);
+            }
+            else
+            {
+                lock (_externalJobs)
+                {
+                    _externalJobs.Enqueue(job);
+                }
+            }
+
+            Interlocked.MemoryBarrier();
+
+            if (Volatile.Read(ref _sleepingWorkerCount) > 0)
+            {
+                _wakeSignal.Release();
+            }
+        }
+
+        private bool TryGetJob(int threadIndex, out Job job)
+        {
+            if (_deques[threadIndex].TryPop(out job))
+            {
+                return true;
+            }
+
+            if (_externalJobs.Count > 0)
+            {
+                lock (_externalJobs)
+                {
+                    if (_externalJobs.Count > 0)
+                    {
+                        job = _externalJobs.Dequeue();
+                        return true;
+                    }
+                }
+            }
+
+            for (int i = 1; i < ThreadCount; i++)
+            {
+                int victimIndex = (threadIndex + i) % ThreadCount;
+
+                if (_deques[victimIndex].TrySteal(out job))
+                {
+                    _stolenJobCounts[threadIndex]++;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        private void ExecuteJob(Job job, int threadIndex)
+        {
+            try
+            {
+                job.Execute(threadIndex);
+            }
+            catch (Exception exception)
+            {
+                job.Counter.SetException(exception);
+            }
+
+            _executedJobCounts[threadIndex]++;
+            job.Counter.Decrement();
+        }
+
+        //a thread running jobs without workers takes thread index 0 until they are done, then gets back the index it had
+        private void BeginInline(out JobSystem previousJobSystem, out int previousThreadIndex)
+        {
+            previousJobSystem = _currentThreadJobSystem;
+            previousThreadIndex = _currentThreadIndex;
+
+            _currentThreadJobSystem = this;
+            _currentThreadIndex = 0;
+        }
+
+        private static void EndInline(JobSystem previousJobSystem, int previousThreadIndex)
+        {
+            _currentThreadJobSystem = previousJobSystem;
+            _currentThreadIndex = previousThreadIndex;
+        }
+
+        private void WorkerLoop(int threadIndex, bool useThreadAffinity)
+        {
+            _currentThreadJobSystem = this;
+            _currentThreadIndex = threadIndex;
+
+            if (useThreadAffinity)
+            {
+                Framework.Current.SetCurrentThreadAffinity(threadIndex % Environment.ProcessorCount);
+            }
+
+            int idleSpinCount = 0;
+
+            while (_running)
+            {
+                Job job;
+
+                if (TryGetJob(threadIndex, out job))
+                {
+                    ExecuteJob(job, threadIndex);
+                    idleSpinCount = 0;
+                }
+                else if (idleSpinCount < SpinCountBeforeSleep)
+                {
+                    idleSpinCount++;
+                    Thread.SpinWait(32);
+                }
+                else
+                {
+                    Interlocked.Increment(ref _sleepingWorkerCount);
+
+                    //check again after announcing the sleep, a job pushed before that would not wake us
+                    if (TryGetJob(threadIndex, out job))
+                    {
+                        Interlocked.Decrement(ref _sleepingWorkerCount);
+                        ExecuteJob(job, threadIndex);
+                    }
+                    else
+                    {
+                        _wakeSignal.Wait(10);
+                        Interlocked.Decrement(ref _sleepingWorkerCount);
+                    }
+
+                    idleSpinCount = 0;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Core
+{
+    public sealed class JobSystemSettings
+    {
+        //number of worker threads, the thread which creates the job system also runs jobs while waiting
+        public int WorkerCount { get; set; }
+
+        //runs every job inline on the scheduling thread in submission order, for debugging and replays
+        public bool Deterministic { get; set; }
+
+        //pins worker n to processor n using Framework.SetCurrentThreadAffinity
+        public bool UseThreadAffinity { get; set; }
+
+        //parallel for splits its range to this many batches per thread unless batches get smaller than the minimum batch size
+        public int BatchesPerThread { get; set; }
+
+        public JobSystemSettings()
+        {
+            WorkerCount = Math.Max(0, Environment.ProcessorCount - 1);
+            Deterministic = false;
+            UseThreadAffinity = false;
+            BatchesPerThread = 4;
+        }
+    }
+}
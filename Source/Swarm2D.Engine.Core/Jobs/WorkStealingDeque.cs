@@ -0,0 +1,152 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Threading;
+
+namespace Swarm2D.Engine.Core
+{
+    //Chase-Lev deque, only the owner thread pushes and pops at the bottom, other threads steal from the top
+    internal sealed class WorkStealingDeque<T>
+    {
+        private T[] _items;
+
+        private long _top;
+        private long _bottom;
+
+        public WorkStealingDeque(int initialCapacity)
+        {
+            int capacity = 1;
+
+            while (capacity < initialCapacity)
+            {
+                capacity <<= 1;
+            }
+
+            _items = new T[capacity];
+        }
+
+        public bool IsEmpty
+        {
+            get { return Volatile.Read(ref _bottom) <= Volatile.Read(ref _top); }
+        }
+
+        public void Push(T item)
+        {
+            long bottom = Volatile.Read(ref _bottom);
+            long top = Volatile.Read(ref _top);
+
+            T[] items = _items;
+
+            if (bottom - top >= items.Length)
+            {
+                items = Grow(items, top, bottom);
+            }
+
+            items[bottom & (items.Length - 1)] = item;
+
+            Volatile.Write(ref _bottom, bottom + 1);
+        }
+
+        public bool TryPop(out T item)
+        {
+            long bottom = Volatile.Read(ref _bottom) - 1;
+            T[] items = _items;
+
+            Interlocked.Exchange(ref _bottom, bottom);
+
+            long top = Volatile.Read(ref _top);
+
+            if (top > bottom)
+            {
+                Volatile.Write(ref _bottom, top);
+
+                item = default(T);
+                return false;
+            }
+
+            long index = bottom & (items.Length - 1);
+            item = items[index];
+
+            if (top == bottom)
+            {
+                //last item, race with thieves
+                bool won = Interlocked.CompareExchange(ref _top, top + 1, top) == top;
+
+                Volatile.Write(ref _bottom, top + 1);
+
+                if (!won)
+                {
+                    item = default(T);
+                    return false;
+                }
+            }
+
+            items[index] = default(T);
+
+            return true;
+        }
+
+        public bool TrySteal(out T item)
+        {
+            long top = Volatile.Read(ref _top);
+
+            Interlocked.MemoryBarrier();
+
+            long bottom = Volatile.Read(ref _bottom);
+
+            if (top < bottom)
+            {
+                T[] items = Volatile.Read(ref _items);
+                item = items[top & (items.Length - 1)];
+
+                if (Interlocked.CompareExchange(ref _top, top + 1, top) == top)
+                {
+                    return true;
+                }
+            }
+
+            item = default(T);
+            return false;
+        }
+
+        private T[] Grow(T[] items, long top, long bottom)
+        {
+            T[] newItems = new T[items.Length * 2];
+
+            for (long i = top; i < bottom; i++)
+            {
+                newItems[i & (newItems.Length - 1)] = items[i & (items.Length - 1)];
+            }
+
+            Volatile.Write(ref _items, newItems);
+
+            return newItems;
+        }
+    }
+}
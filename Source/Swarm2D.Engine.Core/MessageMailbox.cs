@@ -0,0 +1,68 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Core
+{
+    //thread safe message queue between engines running on different threads, receiver takes all posted messages at once
+    internal sealed class MessageMailbox<T> where T : Message
+    {
+        private List<T> _postedMessages;
+        private List<T> _receivedMessages;
+
+        public MessageMailbox()
+        {
+            _postedMessages = new List<T>();
+            _receivedMessages = new List<T>();
+        }
+
+        public void Post(T message)
+        {
+            lock (this)
+            {
+                _postedMessages.Add(message);
+            }
+        }
+
+        //returned list is valid until the next call
+        public List<T> Receive()
+        {
+            _receivedMessages.Clear();
+
+            lock (this)
+            {
+                List<T> postedMessages = _postedMessages;
+                _postedMessages = _receivedMessages;
+                _receivedMessages = postedMessages;
+            }
+
+            return _receivedMessages;
+        }
+    }
+}
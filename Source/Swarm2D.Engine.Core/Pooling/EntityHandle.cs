@@ -0,0 +1,92 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Core
+{
+    //32 bit handle to an entity, stays invalid after the entity is destroyed even if the entity object is reused by the pool
+    [Serializable]
+    public struct EntityHandle : IEquatable<EntityHandle>
+    {
+        public static readonly EntityHandle Null = new EntityHandle(0);
+
+        public uint Value { get; private set; }
+
+        internal EntityHandle(uint value)
+            : this()
+        {
+            Value = value;
+        }
+
+        public bool IsNull
+        {
+            get { return Value == 0; }
+        }
+
+        public int Index
+        {
+            get { return HandleTable<Entity>.GetIndex(Value); }
+        }
+
+        public int Generation
+        {
+            get { return HandleTable<Entity>.GetGeneration(Value); }
+        }
+
+        public bool Equals(EntityHandle other)
+        {
+            return Value == other.Value;
+        }
+
+        public override bool Equals(object obj)
+        {
+            return obj is EntityHandle && Equals((EntityHandle)obj);
+        }
+
+        public override int GetHashCode()
+        {
+            return (int)Value;
+        }
+
+        public static bool operator ==(EntityHandle a, EntityHandle b)
+        {
+            return a.Value == b.Value;
+        }
+
+        public static bool operator !=(EntityHandle a, EntityHandle b)
+        {
+            return a.Value != b.Value;
+        }
+
+        public override string ToString()
+        {
+            return "Entity(" + Index + ":" + Generation + ")";
+        }
+    }
+}
@@ -0,0 +1,169 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Core
+{
+    //maps 32 bit handles (20 bit slot index, 12 bit generation) to live objects.
+    //slots are stored in fixed size chunks so growing never copies existing slots.
+    //generations are never released, otherwise a stale handle could alias a new object after a regrow.
+    [Serializable]
+    internal sealed class HandleTable<T> where T : class
+    {
+        private const int IndexBits = 20;
+        private const int GenerationBits = 12;
+        private const uint IndexMask = (1u << IndexBits) - 1;
+        private const uint GenerationMask = (1u << GenerationBits) - 1;
+
+        private const int ChunkShift = 10;
+        private const int ChunkSize = 1 << ChunkShift;
+        private const int ChunkMask = ChunkSize - 1;
+
+        public const int MaxCapacity = 1 << IndexBits;
+
+        private List<T[]> _items;
+        private List<ushort[]> _generations;
+        private Stack<int> _freeSlots;
+
+        public int Count { get; private set; }
+        public int HighWater { get; private set; }
+
+        public int Capacity
+        {
+            get { return _items.Count * ChunkSize; }
+        }
+
+        public HandleTable()
+        {
+            _items = new List<T[]>();
+            _generations = new List<ushort[]>();
+            _freeSlots = new Stack<int>();
+        }
+
+        public static int GetIndex(uint handle)
+        {
+            return (int)(handle & IndexMask);
+        }
+
+        public static int GetGeneration(uint handle)
+        {
+            return (int)((handle >> IndexBits) & GenerationMask);
+        }
+
+        public uint Add(T item)
+        {
+            Debug.Assert(item != null, "item != null");
+
+            if (_freeSlots.Count == 0)
+            {
+                Grow();
+            }
+
+            int index = _freeSlots.Pop();
+            int chunk = index >> ChunkShift;
+            int slot = index & ChunkMask;
+
+            ushort[] generations = _generations[chunk];
+
+            //generation 0 is never handed out so a zero handle is always null
+            if (generations[slot] == 0)
+            {
+                generations[slot] = 1;
+            }
+
+            _items[chunk][slot] = item;
+
+            Count++;
+
+            if (Count > HighWater)
+            {
+                HighWater = Count;
+            }
+
+            return ((uint)generations[slot] << IndexBits) | (uint)index;
+        }
+
+        public bool Remove(uint handle)
+        {
+            int index = GetIndex(handle);
+            int chunk = index >> ChunkShift;
+            int slot = index & ChunkMask;
+
+            if (handle == 0 || chunk >= _items.Count || _generations[chunk][slot] != GetGeneration(handle) || _items[chunk][slot] == null)
+            {
+                return false;
+            }
+
+            _items[chunk][slot] = null;
+
+            ushort generation = (ushort)((_generations[chunk][slot] + 1) & GenerationMask);
+            _generations[chunk][slot] = generation == 0 ? (ushort)1 : generation;
+
+            _freeSlots.Push(index);
+            Count--;
+
+            return true;
+        }
+
+        public T Get(uint handle)
+        {
+            int index = GetIndex(handle);
+            int chunk = index >> ChunkShift;
+            int slot = index & ChunkMask;
+
+            if (handle == 0 || chunk >= _items.Count || _generations[chunk][slot] != GetGeneration(handle))
+            {
+                return null;
+            }
+
+            return _items[chunk][slot];
+        }
+
+        private void Grow()
+        {
+            int firstIndex = _items.Count * ChunkSize;
+
+            //a slot index past the index bits would alias an existing slot
+            if (firstIndex >= MaxCapacity)
+            {
+                throw new InvalidOperationException("HandleTable can not hold more than " + MaxCapacity + " live objects");
+            }
+
+            _items.Add(new T[ChunkSize]);
+            _generations.Add(new ushort[ChunkSize]);
+
+            //pushed in reverse so lower indices are used first
+            for (int i = ChunkSize - 1; i >= 0; i--)
+            {
+                _freeSlots.Push(firstIndex + i);
+            }
+        }
+    }
+}
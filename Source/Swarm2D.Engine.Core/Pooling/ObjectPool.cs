@@ -0,0 +1,144 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Core
+{
+    //free list of reusable objects of one type, stored in chunks that are allocated on demand and released by Trim
+    [Serializable]
+    internal sealed class ObjectPool<T> where T : class
+    {
+        private readonly int _chunkShift;
+        private readonly int _chunkSize;
+        private readonly int _chunkMask;
+
+        private List<T[]> _chunks;
+
+        public Type Type { get; private set; }
+
+        public int Free { get; private set; }
+        public int Live { get; private set; }
+        public int HighWater { get; private set; }
+        public long Allocated { get; private set; }
+        public long Reused { get; private set; }
+
+        public ObjectPool(Type type, int chunkShift)
+        {
+            Type = type;
+
+            _chunkShift = chunkShift;
+            _chunkSize = 1 << chunkShift;
+            _chunkMask = _chunkSize - 1;
+
+            _chunks = new List<T[]>();
+        }
+
+        public int Capacity
+        {
+            get { return _chunks.Count * _chunkSize; }
+        }
+
+        public T Take()
+        {
+            if (Free == 0)
+            {
+                return null;
+            }
+
+            Free--;
+
+            T[] chunk = _chunks[Free >> _chunkShift];
+            int slot = Free & _chunkMask;
+
+            T item = chunk[slot];
+            chunk[slot] = null;
+
+            Reused++;
+
+            return item;
+        }
+
+        public void Return(T item)
+        {
+            int chunkIndex = Free >> _chunkShift;
+
+            if (chunkIndex == _chunks.Count)
+            {
+                _chunks.Add(new T[_chunkSize]);
+            }
+
+            _chunks[chunkIndex][Free & _chunkMask] = item;
+            Free++;
+        }
+
+        //live counts are tracked here for both pooled and newly created objects, also when the engine is not in pooled mode
+        public void OnAllocated()
+        {
+            Allocated++;
+            Live++;
+
+            if (Live > HighWater)
+            {
+                HighWater = Live;
+            }
+        }
+
+        public void OnReleased()
+        {
+            Live--;
+        }
+
+        //drops free objects above maxFree and the chunks that are no longer needed to hold them
+        public int Trim(int maxFree)
+        {
+            int removed = 0;
+
+            while (Free > maxFree)
+            {
+                Free--;
+                _chunks[Free >> _chunkShift][Free & _chunkMask] = null;
+                removed++;
+            }
+
+            int neededChunks = (Free + _chunkSize - 1) >> _chunkShift;
+
+            if (_chunks.Count > neededChunks)
+            {
+                _chunks.RemoveRange(neededChunks, _chunks.Count - neededChunks);
+            }
+
+            return removed;
+        }
+
+        public PoolStatistics GetStatistics()
+        {
+            return new PoolStatistics(Type, Live, Free, HighWater, Capacity, Allocated - Reused, Reused);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Core
+{
+    [Serializable]
+    public struct PoolStatistics
+    {
+        public Type Type { get; private set; }
+
+        public int Live { get; private set; }
+        public int Free { get; private set; }
+        public int HighWater { get; private set; }
+        public int Capacity { get; private set; }
+
+        public long Created { get; private set; }
+        public long Reused { get; private set; }
+
+        public PoolStatistics(Type type, int live, int free, int highWater, int capacity, long created, long reused)
+            : this()
+        {
+            Type = type;
+            Live = live;
+            Free = free;
+            HighWater = highWater;
+            Capacity = capacity;
+            Created = created;
+            Reused = reused;
+        }
+
+        public override string ToString()
+        {
+            return Type.Name + " live:" + Live + " free:" + Free + " highWater:" + HighWater + " capacity:" + Capacity + " created:" + Created + " reused:" + Reused;
+        }
+    }
+}
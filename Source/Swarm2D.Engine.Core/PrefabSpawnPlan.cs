@@ -0,0 +1,122 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Core
+{
+    //a prefab compiled for instantiation: component infos in prefab order with property copiers for each of them.
+    //built on the first instantiation and rebuilt if the components of the prefab change.
+    internal sealed class PrefabSpawnPlan
+    {
+        private struct ComponentStep
+        {
+            public ComponentInfo ComponentInfo;
+            public ComponentPropertyCopier[] Copiers;
+        }
+
+        public Entity Prefab { get; private set; }
+
+        private ComponentStep[] _steps;
+
+        public PrefabSpawnPlan(Entity prefab)
+        {
+            Prefab = prefab;
+
+            List<Component> prefabComponents = prefab.Components;
+
+            _steps = new ComponentStep[prefabComponents.Count];
+
+            for (int i = 0; i < prefabComponents.Count; i++)
+            {
+                ComponentInfo componentInfo = prefabComponents[i].GetComponentInfo();
+
+                ComponentStep step = new ComponentStep();
+                step.ComponentInfo = componentInfo;
+                step.Copiers = new ComponentPropertyCopier[componentInfo.ComponentPropertyInfos.Count];
+
+                int copierIndex = 0;
+
+                foreach (ComponentPropertyInfo componentPropertyInfo in componentInfo.ComponentPropertyInfos.Values)
+                {
+                    step.Copiers[copierIndex] = componentPropertyInfo.Copier;
+                    copierIndex++;
+                }
+
+                _steps[i] = step;
+            }
+        }
+
+        public bool IsValidFor(Entity prefab)
+        {
+            List<Component> prefabComponents = prefab.Components;
+
+            if (prefab != Prefab || prefabComponents.Count != _steps.Length)
+            {
+                return false;
+            }
+
+            for (int i = 0; i < _steps.Length; i++)
+            {
+                if (prefabComponents[i].GetType() != _steps[i].ComponentInfo.ComponentType)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        //adds the components of the prefab to the entity, components the domain already added are reused
+        public void Apply(Entity clonedPrefab)
+        {
+            List<Component> prefabComponents = Prefab.Components;
+
+            for (int i = 0; i < _steps.Length; i++)
+            {
+                ComponentStep step = _steps[i];
+                Component prefabComponent = prefabComponents[i];
+
+                Component clonedComponent = clonedPrefab.GetComponent(step.ComponentInfo.ComponentType);
+
+                if (clonedComponent == null)
+                {
+                    clonedComponent = clonedPrefab.AddComponent(step.ComponentInfo);
+                }
+
+                ComponentPropertyCopier[] copiers = step.Copiers;
+
+                for (int j = 0; j < copiers.Length; j++)
+                {
+                    copiers[j].Copy(prefabComponent, clonedComponent);
+                }
+            }
+        }
+    }
+}
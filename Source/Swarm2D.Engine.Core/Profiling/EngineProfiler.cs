@@ -0,0 +1,367 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.Linq;
+using System.Text;
+using System.Threading;
+using Debug = Swarm2D.Library.Debug;
+
+namespace Swarm2D.Engine.Core
+{
+    //records message handler timings of an engine into a ring buffer of frames.
+    //when disabled, dispatching a message only checks IsRecording. the ring is allocated the first time it is enabled.
+    //not thread safe, samples are only taken on the thread updating the engine.
+    public sealed class EngineProfiler
+    {
+        public const int DefaultFrameCapacity = 300;
+
+        private ProfilerFrame[] _frames;
+        private int _frameCapacity;
+        private long _recordedFrameCount;
+
+        private ProfilerFrame _currentFrame;
+
+        private int[] _openSamples;
+        private int _openSampleCount;
+
+        private bool _enabled;
+
+        public bool Enabled
+        {
+            get { return _enabled; }
+            set
+            {
+                _enabled = value;
+
+                if (value && _frames == null)
+                {
+                    _frames = new ProfilerFrame[_frameCapacity];
+
+                    for (int i = 0; i < _frameCapacity; i++)
+                    {
+                        _frames[i] = new ProfilerFrame();
+                    }
+                }
+            }
+        }
+
+        //records only every SampleInterval'th frame to keep the overhead low on production servers
+        public int SampleInterval { get; set; }
+
+        public bool IsRecording { get; private set; }
+
+        public EngineProfiler(int frameCapacity)
+        {
+            _frameCapacity = frameCapacity;
+
+            _openSamples = new int[64];
+            SampleInterval = 1;
+        }
+
+        public int FrameCapacity
+        {
+            get { return _frameCapacity; }
+        }
+
+        //number of frames in the ring buffer
+        public int FrameCount
+        {
+            get { return (int)Math.Min(_recordedFrameCount, _frameCapacity); }
+        }
+
+        //0 is the last recorded frame
+        public ProfilerFrame GetFrame(int age)
+        {
+            Debug.Assert(age >= 0 && age < FrameCount, "age >= 0 && age < FrameCount");
+
+            return _frames[(_recordedFrameCount - 1 - age) % _frames.Length];
+        }
+
+        public void Clear()
+        {
+            _recordedFrameCount = 0;
+        }
+
+        internal void BeginFrame(long frameIndex)
+        {
+            IsRecording = Enabled && frameIndex % Math.Max(1, SampleInterval) == 0;
+
+            if (IsRecording)
+            {
+                _currentFrame = _frames[_recordedFrameCount % _frames.Length];
+                _currentFrame.Samples.Clear();
+                _currentFrame.FrameIndex = frameIndex;
+                _currentFrame.ThreadId = Thread.CurrentThread.ManagedThreadId;
+                _currentFrame.StartTicks = Stopwatch.GetTimestamp();
+
+                _openSampleCount = 0;
+            }
+        }
+
+        internal void EndFrame()
+        {
+            if (IsRecording)
+            {
+                while (_openSampleCount > 0)
+                {
+                    EndSample();
+                }
+
+                _currentFrame.EndTicks = Stopwatch.GetTimestamp();
+                _currentFrame = null;
+
+                _recordedFrameCount++;
+                IsRecording = false;
+            }
+        }
+
+        internal void BeginHandlerSample(Message message, MessageHandlerDelegate messageHandler, object domain)
+        {
+            ProfilerSample sample = new ProfilerSample();
+            sample.Name = messageHandler.Method.Name;
+            sample.MessageType = message.GetType();
+            sample.ComponentType = messageHandler.Target != null ? messageHandler.Target.GetType() : null;
+            sample.DomainType = domain != null ? domain.GetType() : null;
+
+            PushSample(sample);
+        }
+
+        public void BeginSample(string name)
+        {
+            if (IsRecording)
+            {
+                ProfilerSample sample = new ProfilerSample();
+                sample.Name = name;
+
+                PushSample(sample);
+            }
+        }
+
+        public void EndSample()
+        {
+            if (IsRecording && _openSampleCount > 0)
+            {
+                _openSampleCount--;
+
+                int sampleIndex = _openSamples[_openSampleCount];
+
+                ProfilerSample sample = _currentFrame.Samples[sampleIndex];
+                sample.EndTicks = Stopwatch.GetTimestamp();
+                _currentFrame.Samples[sampleIndex] = sample;
+            }
+        }
+
+        private void PushSample(ProfilerSample sample)
+        {
+            if (_openSampleCount == _openSamples.Length)
+            {
+                Array.Resize(ref _openSamples, _openSamples.Length * 2);
+            }
+
+            sample.Depth = _openSampleCount;
+            sample.ParentIndex = _openSampleCount > 0 ? _openSamples[_openSampleCount - 1] : -1;
+            sample.StartTicks = Stopwatch.GetTimestamp();
+
+            _openSamples[_openSampleCount] = _currentFrame.Samples.Count;
+            _openSampleCount++;
+
+            _currentFrame.Samples.Add(sample);
+        }
+
+        //accumulates the last frameCount frames by message type, component type, domain type and name, busiest first
+        public List<ProfilerSummaryEntry> GetSummary(int frameCount)
+        {
+            frameCount = Math.Min(frameCount, FrameCount);
+
+            Dictionary<string, ProfilerSummaryEntry> entries = new Dictionary<string, ProfilerSummaryEntry>();
+            List<double> childTimes = new List<double>();
+
+            for (int age = 0; age < frameCount; age++)
+            {
+                List<ProfilerSample> samples = GetFrame(age).Samples;
+
+                childTimes.Clear();
+
+                for (int i = 0; i < samples.Count; i++)
+                {
+                    childTimes.Add(0.0);
+                }
+
+                for (int i = 0; i < samples.Count; i++)
+                {
+                    ProfilerSample sample = samples[i];
+
+                    if (sample.ParentIndex >= 0)
+                    {
+                        childTimes[sample.ParentIndex] += ToMilliseconds(sample.EndTicks - sample.StartTicks);
+                    }
+                }
+
+                for (int i = 0; i < samples.Count; i++)
+                {
+                    ProfilerSample sample = samples[i];
+
+                    string key = GetTypeName(sample.MessageType) + "|" + GetTypeName(sample.ComponentType) + "|" + GetTypeName(sample.DomainType) + "|" + sample.Name;
+
+                    ProfilerSummaryEntry entry;
+
+                    if (!entries.TryGetValue(key, out entry))
+                    {
+                        entry = new ProfilerSummaryEntry();
+                        entry.Name = sample.DisplayName;
+                        entry.MessageType = sample.MessageType;
+                        entry.ComponentType = sample.ComponentType;
+                        entry.DomainType = sample.DomainType;
+
+                        entries.Add(key, entry);
+                    }
+
+                    double milliseconds = ToMilliseconds(sample.EndTicks - sample.StartTicks);
+
+                    entry.CallCount++;
+                    entry.TotalMilliseconds += milliseconds;
+                    entry.SelfMilliseconds += milliseconds - childTimes[i];
+                    entry.MaxMilliseconds = Math.Max(entry.MaxMilliseconds, milliseconds);
+                }
+            }
+
+            List<ProfilerSummaryEntry> result = entries.Values.OrderByDescending(entry => entry.SelfMilliseconds).ToList();
+
+            foreach (ProfilerSummaryEntry entry in result)
+            {
+                entry.MillisecondsPerFrame = frameCount > 0 ? entry.TotalMilliseconds / frameCount : 0.0;
+            }
+
+            return result;
+        }
+
+        //trace event format, can be opened with chrome://tracing or perfetto
+        public string ExportChromeTrace()
+        {
+            StringBuilder builder = new StringBuilder();
+            builder.Append("{\"traceEvents\":[");
+
+            long originTicks = FrameCount > 0 ? GetFrame(FrameCount - 1).StartTicks : 0;
+            bool first = true;
+
+            for (int age = FrameCount - 1; age >= 0; age--)
+            {
+                ProfilerFrame frame = GetFrame(age);
+
+                AppendTraceEvent(builder, ref first, "Frame " + frame.FrameIndex, "Frame", frame.StartTicks - originTicks, frame.EndTicks - frame.StartTicks, frame.ThreadId, null);
+
+                for (int i = 0; i < frame.Samples.Count; i++)
+                {
+                    ProfilerSample sample = frame.Samples[i];
+
+                    string category = sample.IsMessageHandler ? "Handler" : "Sample";
+
+                    AppendTraceEvent(builder, ref first, sample.DisplayName, category, sample.StartTicks - originTicks, sample.EndTicks - sample.StartTicks, frame.ThreadId, sample);
+                }
+            }
+
+            builder.Append("],\"displayTimeUnit\":\"ms\"}");
+
+            return builder.ToString();
+        }
+
+        private static void AppendTraceEvent(StringBuilder builder, ref bool first, string name, string category, long startTicks, long durationTicks, int threadId, ProfilerSample? sample)
+        {
+            if (!first)
+            {
+                builder.Append(',');
+            }
+
+            first = false;
+
+            builder.Append("{\"name\":\"");
+            AppendEscaped(builder, name);
+            builder.Append("\",\"cat\":\"");
+            builder.Append(category);
+            builder.Append("\",\"ph\":\"X\",\"ts\":");
+            builder.Append(ToMicroseconds(startTicks).ToString("0.###", CultureInfo.InvariantCulture));
+            builder.Append(",\"dur\":");
+            builder.Append(ToMicroseconds(durationTicks).ToString("0.###", CultureInfo.InvariantCulture));
+            builder.Append(",\"pid\":1,\"tid\":");
+            builder.Append(threadId);
+
+            if (sample.HasValue && sample.Value.IsMessageHandler)
+            {
+                builder.Append(",\"args\":{\"message\":\"");
+                AppendEscaped(builder, GetTypeName(sample.Value.MessageType));
+                builder.Append("\",\"component\":\"");
+                AppendEscaped(builder, GetTypeName(sample.Value.ComponentType));
+                builder.Append("\",\"domain\":\"");
+                AppendEscaped(builder, GetTypeName(sample.Value.DomainType));
+                builder.Append("\"}");
+            }
+
+            builder.Append('}');
+        }
+
+        private static void AppendEscaped(StringBuilder builder, string text)
+        {
+            for (int i = 0; i < text.Length; i++)
+            {
+                char c = text[i];
+
+                if (c == '"' || c == '\\')
+                {
+                    builder.Append('\\');
+                    builder.Append(c);
+                }
+                else if (c < ' ')
+                {
+                    //control characters are not allowed in json strings
+                    builder.Append("\\u");
+                    builder.Append(((int)c).ToString("x4", CultureInfo.InvariantCulture));
+                }
+                else
+                {
+                    builder.Append(c);
+                }
+            }
+        }
+
+        private static string GetTypeName(Type type)
+        {
+            return type != null ? type.Name : "";
+        }
+
+        private static double ToMilliseconds(long ticks)
+        {
+            return ticks * 1000.0 / Stopwatch.Frequency;
+        }
+
+        private static double ToMicroseconds(long ticks)
+        {
+            return ticks * 1000000.0 / Stopwatch.Frequency;
+        }
+    }
+}
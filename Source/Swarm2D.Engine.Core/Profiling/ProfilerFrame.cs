@@ -0,0 +1,56 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Core
+{
+    public sealed class ProfilerFrame
+    {
+        public long FrameIndex { get; internal set; }
+
+        public long StartTicks { get; internal set; }
+        public long EndTicks { get; internal set; }
+
+        public int ThreadId { get; internal set; }
+
+        //in the order they were started, children always come after their parent
+        public List<ProfilerSample> Samples { get; private set; }
+
+        internal ProfilerFrame()
+        {
+            Samples = new List<ProfilerSample>(256);
+        }
+
+        public double Milliseconds
+        {
+            get { return (EndTicks - StartTicks) * 1000.0 / Stopwatch.Frequency; }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Core
+{
+    public struct ProfilerSample
+    {
+        //name of the handler method or the name given to BeginSample
+        public string Name { get; internal set; }
+
+        //null for samples which are not message handlers
+        public Type MessageType { get; internal set; }
+        public Type ComponentType { get; internal set; }
+        public Type DomainType { get; internal set; }
+
+        public long StartTicks { get; internal set; }
+        public long EndTicks { get; internal set; }
+
+        public int Depth { get; internal set; }
+
+        //index of the enclosing sample in the frame, -1 for top level samples
+        public int ParentIndex { get; internal set; }
+
+        public bool IsMessageHandler
+        {
+            get { return MessageType != null; }
+        }
+
+        public string DisplayName
+        {
+            get
+            {
+                if (ComponentType != null)
+                {
+                    return ComponentType.Name + "." + Name;
+                }
+
+                return Name;
+            }
+        }
+    }
+}
@@ -0,0 +1,58 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Core
+{
+    //timings of one handler (or named sample) accumulated over the summarized frames
+    public sealed class ProfilerSummaryEntry
+    {
+        public string Name { get; internal set; }
+
+        public Type MessageType { get; internal set; }
+        public Type ComponentType { get; internal set; }
+        public Type DomainType { get; internal set; }
+
+        public int CallCount { get; internal set; }
+
+        public double TotalMilliseconds { get; internal set; }
+
+        //total time without the time spent in nested samples
+        public double SelfMilliseconds { get; internal set; }
+
+        public double MaxMilliseconds { get; internal set; }
+
+        public double MillisecondsPerFrame { get; internal set; }
+
+        public override string ToString()
+        {
+            return Name + " calls:" + CallCount + " total:" + TotalMilliseconds.ToString("0.000") + "ms self:" + SelfMilliseconds.ToString("0.000") + "ms max:" + MaxMilliseconds.ToString("0.000") + "ms perFrame:" + MillisecondsPerFrame.ToString("0.000") + "ms";
+        }
+    }
+}
@@ -28,6 +28,7 @@ using System.Collections.Generic;
 using System.Linq;
 using System.Text;
 using System.Reflection;
+using System.Threading;
 using Swarm2D.Library;
 
 namespace Swarm2D.Engine.Core
@@ -37,6 +38,10 @@ namespace Swarm2D.Engine.Core
         public static List<ComponentInfo> ComponentInfos { get; private set; }
         private static Dictionary<Type, ComponentInfo> _componentInfosWithTypes;
 
+        // child engines may look components up from several threads, so the collections are
+        // replaced as a whole under this lock and never modified after they are published
+        private static readonly object CollectLock = new object();
+
         private static readonly object[] ConstructorParameters = new object[0];
 
         private ConstructorInfo _componentConstructor;
@@ -62,7 +67,7 @@ namespace Swarm2D.Engine.Core
         private static ComponentInfo GetComponentInfoWithoutCollectingAgain(Type componentType)
         {
             ComponentInfo componentInfo = null;
-            _componentInfosWithTypes.TryGetValue(componentType, out componentInfo);
+            Volatile.Read(ref _componentInfosWithTypes).TryGetValue(componentType, out componentInfo);
 
             return componentInfo;
         }
@@ -112,6 +117,20 @@ namespace Swarm2D.Engine.Core
         }
 
         private static void CollectComponentInformations()
+        {
+            lock (CollectLock)
+            {
+                List<ComponentInfo> componentInfos = new List<ComponentInfo>(ComponentInfos);
+                Dictionary<Type, ComponentInfo> componentInfosWithTypes = new Dictionary<Type, ComponentInfo>(_componentInfosWithTypes);
+
+                CollectComponentInformations(componentInfos, componentInfosWithTypes);
+
+                ComponentInfos = componentInfos.OrderBy(componentInfo => componentInfo.Name).ToList();
+                Volatile.Write(ref _componentInfosWithTypes, componentInfosWithTypes);
+            }
+        }
+
+        private static void CollectComponentInformations(List<ComponentInfo> componentInfos, Dictionary<Type, ComponentInfo> componentInfosWithTypes)
         {
             Assembly[] assemblies = PlatformHelper.GetGameAssemblies();
 
@@ -123,18 +142,16 @@ namespace Swarm2D.Engine.Core
                 {
                     if (PlatformHelper.IsSubclassOf(type, typeof(Component)) && !PlatformHelper.IsAbstract(type))
                     {
-                        if (GetComponentInfoWithoutCollectingAgain(type) == null)
+                        if (!componentInfosWithTypes.ContainsKey(type))
                         {
                             ComponentInfo componentInfo = new ComponentInfo();
                             componentInfo.FillInformationsFromComponent(type);
-                            ComponentInfos.Add(componentInfo);
-                            _componentInfosWithTypes.Add(type, componentInfo);
+                            componentInfos.Add(componentInfo);
+                            componentInfosWithTypes.Add(type, componentInfo);
                         }
                     }
                 }
             }
-
-            ComponentInfos = ComponentInfos.OrderBy(componentInfo => componentInfo.Name).ToList();
         }
 
         internal void FillInformationsFromComponent(Type type)
@@ -239,89 +256,82 @@ namespace Swarm2D.Engine.Core
 
             component.Reset(entity);
 
-            foreach (KeyValuePair<Type, MethodInfo> globalMessageHandler in GlobalMessageHandlers)
+            //a pooled component keeps the delegates bound to it, they are only registered again
+            if (!component.MessageHandlersBound)
             {
-                Type globalMessageType = globalMessageHandler.Key;
-                MethodInfo globalMessageHandlerMethod = globalMessageHandler.Value;
-
-                MessageHandlerDelegate messageHandler = (MessageHandlerDelegate)PlatformHelper.CreateDelegate(typeof(MessageHandlerDelegate), component, globalMessageHandlerMethod);
+                BindMessageHandlers(component);
+            }
 
-                int globalMessageId = Message.GetMessageId(globalMessageType);
+            RegisterMessageHandlers(component, engine, entity);
 
-                {
-                    if (!component.GlobalMessageHandlers.ContainsKey(globalMessageId))
-                    {
-                        component.GlobalMessageHandlers.Add(globalMessageId, new List<MessageHandlerDelegate>());
-                    }
+            engine.OnComponentCreated(component);
 
-                    component.GlobalMessageHandlers[globalMessageId].Add(messageHandler);
-                }
+            if (entity.Domain != null)
+            {
+                entity.Domain.OnComponentCreated(component);
+            }
 
-                {
-                    if (!engine.GlobalMessageHandlers.ContainsKey(globalMessageId))
-                    {
-                        engine.GlobalMessageHandlers.Add(globalMessageId, new List<MessageHandlerDelegate>());
-                    }
+            return component;
+        }
 
-                    engine.GlobalMessageHandlers[globalMessageId].Add(messageHandler);
-                }
+        private void BindMessageHandlers(Component component)
+        {
+            foreach (KeyValuePair<Type, MethodInfo> globalMessageHandler in GlobalMessageHandlers)
+            {
+                MessageHandlerDelegate messageHandler = (MessageHandlerDelegate)PlatformHelper.CreateDelegate(typeof(MessageHandlerDelegate), component, globalMessageHandler.Value);
+                AddMessageHandler(component.GlobalMessageHandlers, Message.GetMessageId(globalMessageHandler.Key), messageHandler);
             }
 
             foreach (KeyValuePair<Type, MethodInfo> domainMessageHandler in DomainMessageHandlers)
             {
-                Type domainMessageType = domainMessageHandler.Key;
-                MethodInfo domainMessageHandlerMethod = domainMessageHandler.Value;
-
-                MessageHandlerDelegate messageHandler = (MessageHandlerDelegate)PlatformHelper.CreateDelegate(typeof(MessageHandlerDelegate), component, domainMessageHandlerMethod);
-
-                int entityMessageId = Message.GetMessageId(domainMessageType);
-
-                {
-                    if (!component.DomainMessageHandlers.ContainsKey(entityMessageId))
-                    {
-                        component.DomainMessageHandlers.Add(entityMessageId, new List<MessageHandlerDelegate>());
-                    }
-
-                    component.DomainMessageHandlers[entityMessageId].Add(messageHandler);
-                }
+                MessageHandlerDelegate messageHandler = (MessageHandlerDelegate)PlatformHelper.CreateDelegate(typeof(MessageHandlerDelegate), component, domainMessageHandler.Value);
+                AddMessageHandler(component.DomainMessageHandlers, Message.GetMessageId(domainMessageHandler.Key), messageHandler);
             }
 
             foreach (KeyValuePair<Type, MethodInfo> entityMessageHandler in EntityMessageHandlers)
             {
-                Type entityMessageType = entityMessageHandler.Key;
-                MethodInfo entityMessageHandlerMethod = entityMessageHandler.Value;
+                MessageHandlerDelegate messageHandler = (MessageHandlerDelegate)PlatformHelper.CreateDelegate(typeof(MessageHandlerDelegate), component, entityMessageHandler.Value);
+                AddMessageHandler(component.EntityMessageHandlers, Message.GetMessageId(entityMessageHandler.Key), messageHandler);
+            }
 
-                MessageHandlerDelegate messageHandler = (MessageHandlerDelegate)PlatformHelper.CreateDelegate(typeof(MessageHandlerDelegate), component, entityMessageHandlerMethod);
+            component.MessageHandlersBound = true;
+        }
 
-                int entityMessageId = Message.GetMessageId(entityMessageType);
+        //domain handlers are registered by the domain in OnComponentCreated
+        private static void RegisterMessageHandlers(Component component, Engine engine, Entity entity)
+        {
+            foreach (KeyValuePair<int, List<MessageHandlerDelegate>> globalMessageHandlers in component.GlobalMessageHandlers)
+            {
+                List<MessageHandlerDelegate> messageHandlers = globalMessageHandlers.Value;
 
+                for (int i = 0; i < messageHandlers.Count; i++)
                 {
-                    if (!component.EntityMessageHandlers.ContainsKey(entityMessageId))
-                    {
-                        component.EntityMessageHandlers.Add(entityMessageId, new List<MessageHandlerDelegate>());
-                    }
-
-                    component.EntityMessageHandlers[entityMessageId].Add(messageHandler);
+                    AddMessageHandler(engine.GlobalMessageHandlers, globalMessageHandlers.Key, messageHandlers[i]);
                 }
+            }
 
-                {
-                    if (!entity.EntityMessageHandlers.ContainsKey(entityMessageId))
-                    {
-                        entity.EntityMessageHandlers.Add(entityMessageId, new List<MessageHandlerDelegate>());
-                    }
+            foreach (KeyValuePair<int, List<MessageHandlerDelegate>> entityMessageHandlers in component.EntityMessageHandlers)
+            {
+                List<MessageHandlerDelegate> messageHandlers = entityMessageHandlers.Value;
 
-                    entity.EntityMessageHandlers[entityMessageId].Add(messageHandler);
+                for (int i = 0; i < messageHandlers.Count; i++)
+                {
+                    AddMessageHandler(entity.EntityMessageHandlers, entityMessageHandlers.Key, messageHandlers[i]);
                 }
             }
+        }
 
-            engine.OnComponentCreated(component);
+        private static void AddMessageHandler(Dictionary<int, List<MessageHandlerDelegate>> messageHandlers, int messageId, MessageHandlerDelegate messageHandler)
+        {
+            List<MessageHandlerDelegate> messageHandlerList;
 
-            if (entity.Domain != null)
+            if (!messageHandlers.TryGetValue(messageId, out messageHandlerList))
             {
-                entity.Domain.OnComponentCreated(component);
+                messageHandlerList = new List<MessageHandlerDelegate>();
+                messageHandlers.Add(messageId, messageHandlerList);
             }
 
-            return component;
+            messageHandlerList.Add(messageHandler);
         }
 
         private void AddProperty(string name, PropertyInfo propertyInfo)
@@ -0,0 +1,118 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Reflection;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Core
+{
+    //copies one component property from a component to another, used when instantiating prefabs
+    internal abstract class ComponentPropertyCopier
+    {
+        public abstract void Copy(Component source, Component destination);
+
+        //getter and setter are bound once as open instance delegates so copying does not go through MethodInfo.Invoke,
+        //falls back to reflection if the platform can not create the delegates
+        public static ComponentPropertyCopier Create(ComponentPropertyInfo componentPropertyInfo)
+        {
+            PropertyInfo propertyInfo = componentPropertyInfo.PropertyInfo;
+
+            MethodInfo getMethod = propertyInfo.GetGetMethod();
+            MethodInfo setMethod = propertyInfo.GetSetMethod();
+
+            if (getMethod != null && setMethod != null)
+            {
+                try
+                {
+                    Type copierType = typeof(ComponentPropertyCopier<,>).MakeGenericType(propertyInfo.DeclaringType, propertyInfo.PropertyType);
+                    ComponentPropertyCopier copier = (ComponentPropertyCopier)Activator.CreateInstance(copierType);
+
+                    copier.Bind(getMethod, setMethod);
+
+                    return copier;
+                }
+                catch (Exception e)
+                {
+                    Debug.Log("Could not create property copier for " + propertyInfo.DeclaringType.Name + "." + propertyInfo.Name + ", using reflection");
+                    Debug.Log(e.Message);
+                }
+            }
+
+            return new ReflectionComponentPropertyCopier(componentPropertyInfo);
+        }
+
+        protected virtual void Bind(MethodInfo getMethod, MethodInfo setMethod)
+        {
+        }
+    }
+
+    //typed setter of a property, lets loaders assign values without boxing them
+    internal interface IComponentPropertySetter<TValue>
+    {
+        void SetValue(Component component, TValue value);
+    }
+
+    internal sealed class ComponentPropertyCopier<TComponent, TValue> : ComponentPropertyCopier, IComponentPropertySetter<TValue> where TComponent : Component
+    {
+        private Func<TComponent, TValue> _getter;
+        private Action<TComponent, TValue> _setter;
+
+        protected override void Bind(MethodInfo getMethod, MethodInfo setMethod)
+        {
+            _getter = (Func<TComponent, TValue>)PlatformHelper.CreateDelegate(typeof(Func<TComponent, TValue>), null, getMethod);
+            _setter = (Action<TComponent, TValue>)PlatformHelper.CreateDelegate(typeof(Action<TComponent, TValue>), null, setMethod);
+        }
+
+        public override void Copy(Component source, Component destination)
+        {
+            _setter((TComponent)destination, _getter((TComponent)source));
+        }
+
+        public void SetValue(Component component, TValue value)
+        {
+            _setter((TComponent)component, value);
+        }
+    }
+
+    internal sealed class ReflectionComponentPropertyCopier : ComponentPropertyCopier
+    {
+        private ComponentPropertyInfo _componentPropertyInfo;
+
+        public ReflectionComponentPropertyCopier(ComponentPropertyInfo componentPropertyInfo)
+        {
+            _componentPropertyInfo = componentPropertyInfo;
+        }
+
+        public override void Copy(Component source, Component destination)
+        {
+            object value = _componentPropertyInfo.GetValueAsObjectFrom(source);
+            _componentPropertyInfo.SetValueTo(destination, value);
+        }
+    }
+}
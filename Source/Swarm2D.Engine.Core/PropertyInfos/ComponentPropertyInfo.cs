@@ -38,6 +38,21 @@ namespace Swarm2D.Engine.Core
 
         public ComponentPropertyType PropertyType { get; internal set; }
 
+        private ComponentPropertyCopier _copier;
+
+        internal ComponentPropertyCopier Copier
+        {
+            get
+            {
+                if (_copier == null)
+                {
+                    _copier = ComponentPropertyCopier.Create(this);
+                }
+
+                return _copier;
+            }
+        }
+
         internal ComponentPropertyInfo()
         {
             
@@ -174,6 +189,21 @@ namespace Swarm2D.Engine.Core
             }
         }
 
+        //same as SetValueTo(component, object) without boxing when the property type is T
+        public void SetTypedValueTo<T>(Component component, T value)
+        {
+            IComponentPropertySetter<T> setter = Copier as IComponentPropertySetter<T>;
+
+            if (setter != null)
+            {
+                setter.SetValue(component, value);
+            }
+            else
+            {
+                SetValueTo(component, (object)value);
+            }
+        }
+
         public string GetValueAsStringFrom(Component component)
         {
             string result = "";
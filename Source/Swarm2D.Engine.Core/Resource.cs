@@ -38,6 +38,9 @@ namespace Swarm2D.Engine.Core
 
         private static Dictionary<Type, Dictionary<string, Resource>> _resourcesWithTypes = new Dictionary<Type, Dictionary<string, Resource>>();
 
+        // resources are created and looked up from child engines updating in parallel
+        private static readonly object ResourcesLock = new object();
+
         public string Name { get; private set; }
 
         protected Resource(string name)
@@ -68,37 +71,32 @@ namespace Swarm2D.Engine.Core
 
         private static void AddResource(Resource resource)
         {
-            _resources.Add(resource);
+            lock (ResourcesLock)
+            {
+                _resources.Add(resource);
 
-            AddResource(resource.GetType(), resource);
+                AddResource(resource.GetType(), resource);
+            }
         }
 
         public static T GetResource<T>(string name) where T : Resource
         {
-            EnsureType(typeof(T));
-
-            Dictionary<string, Resource> resourceTypes = _resourcesWithTypes[typeof(T)];
-
-            if (resourceTypes.ContainsKey(name))
-            {
-                return resourceTypes[name] as T;
-            }
-
-            return null;
+            return GetResource(typeof(T), name) as T;
         }
 
         public static Resource GetResource(Type type, string name)
         {
-            EnsureType(type);
+            lock (ResourcesLock)
+            {
+                EnsureType(type);
 
-            Dictionary<string, Resource> resourceTypes = _resourcesWithTypes[type];
+                Dictionary<string, Resource> resourceTypes = _resourcesWithTypes[type];
 
-            if (resourceTypes.ContainsKey(name))
-            {
-                return resourceTypes[name];
-            }
+                Resource resource;
+                resourceTypes.TryGetValue(name, out resource);
 
-            return null;
+                return resource;
+            }
         }
 
         private static void EnsureType(Type type)
@@ -111,11 +109,14 @@ namespace Swarm2D.Engine.Core
 
         public static string GenerateName<T>() where T : Resource
         {
-            EnsureType(typeof(T));
+            lock (ResourcesLock)
+            {
+                EnsureType(typeof(T));
 
-            Dictionary<string, Resource> resourceTypes = _resourcesWithTypes[typeof(T)];
+                Dictionary<string, Resource> resourceTypes = _resourcesWithTypes[typeof(T)];
 
-            return typeof(T).FullName + resourceTypes.Count;
+                return typeof(T).FullName + resourceTypes.Count;
+            }
         }
     }
 }
@@ -38,16 +38,102 @@ namespace Swarm2D.Engine.Logic
 
         private CoroutineTask _currentTask;
 
+        internal CoroutineTask CurrentTask
+        {
+            get { return _currentTask; }
+        }
+
         internal bool IsFinished { get; private set; }
 
         public object Parameter { get; internal set; }
-        internal Component Owner { get; set; }
 
-        internal void DoJob()
+        private Component _owner;
+        private ComponentHandle _ownerHandle;
+
+        internal Component Owner
+        {
+            get { return _owner; }
+            set
+            {
+                _owner = value;
+                _ownerHandle = value != null ? value.Handle : ComponentHandle.Null;
+            }
+        }
+
+        //a destroyed component has no entity, in pooled mode it can be given to another entity with a new handle
+        internal bool IsOwnerDestroyed
+        {
+            get { return _owner.IsDestroyed || _owner.Handle != _ownerHandle; }
+        }
+
+        internal CoroutineManager Manager { get; set; }
+        internal CoroutineState State { get; set; }
+
+        //index in the waiting list of the manager while State is Waiting
+        internal int WaitingIndex { get; set; }
+
+        //when the coroutine leaves the timer wheel while State is Sleeping
+        internal long DueTime { get; set; }
+
+        //incremented every time the coroutine is recycled so old references can tell it is over
+        internal int Generation { get; private set; }
+
+        private List<Coroutine> _waitingCoroutines;
+
+        internal void Reset()
+        {
+            _enumerator = null;
+            _currentTask = null;
+            CoroutineMethod = null;
+            Parameter = null;
+            Owner = null;
+            IsFinished = false;
+            State = CoroutineState.Ready;
+            WaitingIndex = -1;
+            Generation++;
+        }
+
+        //wakes the coroutine up if it sleeps until its current task finishes
+        internal void WakeUp()
+        {
+            if (State == CoroutineState.Waiting)
+            {
+                Manager.OnCoroutineWokeUp(this);
+            }
+        }
+
+        internal void AddWaitingCoroutine(Coroutine coroutine)
+        {
+            if (_waitingCoroutines == null)
+            {
+                _waitingCoroutines = new List<Coroutine>();
+            }
+
+            _waitingCoroutines.Add(coroutine);
+        }
+
+        internal void WakeUpWaitingCoroutines()
+        {
+            if (_waitingCoroutines != null)
+            {
+                for (int i = 0; i < _waitingCoroutines.Count; i++)
+                {
+                    _waitingCoroutines[i].WakeUp();
+                }
+
+                _waitingCoroutines.Clear();
+            }
+        }
+
+        //returns true if the coroutine moved to its next task
+        internal bool DoJob()
         {
-            if (Owner.Entity.IsDestroyed)
+            bool progressed = false;
+
+            if (IsOwnerDestroyed)
             {
                 IsFinished = true;
+                progressed = true;
             }
             else
             {
@@ -66,7 +152,14 @@ namespace Swarm2D.Engine.Logic
                     }
 
                     IsFinished = !_enumerator.MoveNext();
-                    _currentTask = _enumerator.Current;
+                    _currentTask = IsFinished ? null : _enumerator.Current;
+
+                    if (_currentTask != null)
+                    {
+                        _currentTask.Coroutine = this;
+                    }
+
+                    progressed = true;
                 }
 
                 if (!IsFinished)
@@ -74,12 +167,30 @@ namespace Swarm2D.Engine.Logic
                     _currentTask.DoTask();
                 }
             }
+
+            return progressed;
         }
 
         public T AddTask<T>() where T : CoroutineTask
         {
             return this.AddComponent<T>();
         }
+
+        public TimerCoroutineTask Wait(float seconds)
+        {
+            TimerCoroutineTask timerTask = AddTask<TimerCoroutineTask>();
+            timerTask.Initialize(seconds);
+
+            return timerTask;
+        }
+    }
+
+    internal enum CoroutineState
+    {
+        Ready,
+        Waiting,
+        Sleeping,
+        Finished
     }
 
     public delegate IEnumerator<CoroutineTask> CoroutineMethod(Coroutine coroutine);
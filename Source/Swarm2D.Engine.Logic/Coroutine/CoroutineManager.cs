@@ -33,16 +33,56 @@ using Swarm2D.Library;
 
 namespace Swarm2D.Engine.Logic
 {
+    //runs coroutines from a ready queue. coroutines that wait for a task are kept out of it, tasks with
+    //CoroutineWaitMode.WakeUp put them back once they finish and timer tasks sleep in a timer wheel, so a frame
+    //costs as much as the coroutines that can progress. finished coroutine entities are reused for new coroutines.
     public class CoroutineManager : Component, IEntityDomain
     {
+        //waiting coroutines checked in a frame for destroyed owners
+        private const int OwnerCheckCountPerFrame = 64;
+
         private EntityDomain _entityDomain;
 
+        private List<Coroutine> _readyCoroutines;
+        private List<Coroutine> _runningCoroutines;
+        private List<Coroutine> _waitingCoroutines;
+        private Stack<Coroutine> _freeCoroutines;
+        private CoroutineTimerWheel _timerWheel;
+
+        private int _nextOwnerCheckIndex;
+
+        public int ReadyCoroutineCount
+        {
+            get { return _readyCoroutines.Count; }
+        }
+
+        public int WaitingCoroutineCount
+        {
+            get { return _waitingCoroutines.Count; }
+        }
+
+        public int SleepingCoroutineCount
+        {
+            get { return _timerWheel.Count; }
+        }
+
+        public int PooledCoroutineCount
+        {
+            get { return _freeCoroutines.Count; }
+        }
+
         protected override void OnAdded()
         {
             base.OnAdded();
 
             _entityDomain = new EntityDomain(Entity);
             Entity.ChildDomain = this;
+
+            _readyCoroutines = new List<Coroutine>();
+            _runningCoroutines = new List<Coroutine>();
+            _waitingCoroutines = new List<Coroutine>();
+            _freeCoroutines = new Stack<Coroutine>();
+            _timerWheel = new CoroutineTimerWheel();
         }
 
         public void SendMessage(DomainMessage message)
@@ -53,33 +93,175 @@ namespace Swarm2D.Engine.Logic
         [DomainMessageHandler(MessageType = typeof(UpdateMessage))]
         private void OnUpdate(Message message)
         {
-            if (Entity.Children.Count > 0)
+            //otherwise destroying a task searches every task created so far
+            _entityDomain.InitializeNonInitializedEntityComponents();
+
+            _timerWheel.Advance(CoroutineTimerWheel.CurrentTime, _readyCoroutines);
+
+            CheckOwnersOfWaitingCoroutines();
+
+            if (_readyCoroutines.Count > 0)
+            {
+                //coroutines that become ready while running these are run on the next update
+                List<Coroutine> runningCoroutines = _readyCoroutines;
+                _readyCoroutines = _runningCoroutines;
+                _runningCoroutines = runningCoroutines;
+
+                for (int i = 0; i < runningCoroutines.Count; i++)
+                {
+                    Coroutine coroutine = runningCoroutines[i];
+                    coroutine.State = CoroutineState.Ready;
+
+                    if (coroutine.DoJob())
+                    {
+                        Engine.DoneJob();
+                    }
+
+                    if (coroutine.IsFinished)
+                    {
+                        FinishCoroutine(coroutine);
+                    }
+                    else
+                    {
+                        Schedule(coroutine);
+                    }
+                }
+
+                runningCoroutines.Clear();
+            }
+        }
+
+        private void Schedule(Coroutine coroutine)
+        {
+            CoroutineTask currentTask = coroutine.CurrentTask;
+
+            CoroutineWaitMode waitMode = currentTask.IsFinished ? CoroutineWaitMode.Poll : currentTask.WaitMode;
+
+            switch (waitMode)
+            {
+                case CoroutineWaitMode.WakeUp:
+                    {
+                        coroutine.State = CoroutineState.Waiting;
+                        coroutine.WaitingIndex = _waitingCoroutines.Count;
+                        _waitingCoroutines.Add(coroutine);
+                    }
+                    break;
+                case CoroutineWaitMode.Timer:
+                    {
+                        TimerCoroutineTask timerTask = (TimerCoroutineTask)currentTask;
+
+                        coroutine.State = CoroutineState.Sleeping;
+                        _timerWheel.Add(coroutine, timerTask.DueTime);
+                    }
+                    break;
+                default:
+                    {
+                        _readyCoroutines.Add(coroutine);
+                    }
+                    break;
+            }
+        }
+
+        internal void OnCoroutineWokeUp(Coroutine coroutine)
+        {
+            RemoveFromWaitingCoroutines(coroutine);
+
+            coroutine.State = CoroutineState.Ready;
+            _readyCoroutines.Add(coroutine);
+        }
+
+        private void RemoveFromWaitingCoroutines(Coroutine coroutine)
+        {
+            int index = coroutine.WaitingIndex;
+            int lastIndex = _waitingCoroutines.Count - 1;
+
+            Coroutine lastCoroutine = _waitingCoroutines[lastIndex];
+            _waitingCoroutines[index] = lastCoroutine;
+            lastCoroutine.WaitingIndex = index;
+
+            _waitingCoroutines.RemoveAt(lastIndex);
+            coroutine.WaitingIndex = -1;
+        }
+
+        //waiting coroutines are not run, so the ones with destroyed owners are found a few at a time here
+        private void CheckOwnersOfWaitingCoroutines()
+        {
+            int checkCount = Math.Min(OwnerCheckCountPerFrame, _waitingCoroutines.Count);
+
+            for (int i = 0; i < checkCount; i++)
             {
-                Entity[] coroutineEntities = Entity.Children.ToArray();
+                if (_nextOwnerCheckIndex >= _waitingCoroutines.Count)
+                {
+                    _nextOwnerCheckIndex = 0;
+                }
+
+                Coroutine coroutine = _waitingCoroutines[_nextOwnerCheckIndex];
 
-                foreach (var coroutineEntity in coroutineEntities)
+                if (coroutine.IsOwnerDestroyed)
                 {
-                    Coroutine currentCoroutine = coroutineEntity.GetComponent<Coroutine>();
+                    OnCoroutineWokeUp(coroutine);
+                }
+                else
+                {
+                    _nextOwnerCheckIndex++;
+                }
+            }
+        }
 
-                    currentCoroutine.DoJob();
+        private void FinishCoroutine(Coroutine coroutine)
+        {
+            coroutine.State = CoroutineState.Finished;
+            coroutine.WakeUpWaitingCoroutines();
+
+            CoroutineTask currentTask = coroutine.CurrentTask;
+
+            if (currentTask != null && !currentTask.IsFinished)
+            {
+                //stopped while waiting for a task, a late network response could reach a reused entity
+                coroutine.Entity.Destroy();
+            }
+            else
+            {
+                Entity coroutineEntity = coroutine.Entity;
 
-                    if (currentCoroutine.IsFinished)
+                for (int i = coroutineEntity.Components.Count - 1; i >= 0; i--)
+                {
+                    Component component = coroutineEntity.Components[i];
+
+                    if (component != coroutine)
                     {
-                        coroutineEntity.Destroy();
+                        coroutineEntity.DeleteComponent(component);
                     }
                 }
+
+                coroutine.Reset();
+                _freeCoroutines.Push(coroutine);
             }
         }
 
         public Coroutine StartCoroutine(Component coroutineOwner, CoroutineMethod coroutineMethod, object parameter = null)
         {
-            Entity coroutineEntity = Entity.CreateChildEntity("Coroutine");
+            Coroutine coroutine;
+
+            if (_freeCoroutines.Count > 0)
+            {
+                coroutine = _freeCoroutines.Pop();
+            }
+            else
+            {
+                Entity coroutineEntity = Entity.CreateChildEntity("Coroutine");
+
+                coroutine = coroutineEntity.GetComponent<Coroutine>();
+                coroutine.Manager = this;
+                coroutine.Reset();
+            }
 
-            Coroutine coroutine = coroutineEntity.GetComponent<Coroutine>();
             coroutine.Owner = coroutineOwner;
             coroutine.Parameter = parameter;
             coroutine.CoroutineMethod = coroutineMethod;
 
+            _readyCoroutines.Add(coroutine);
+
             return coroutine;
         }
 
@@ -37,11 +37,35 @@ namespace Swarm2D.Engine.Logic
         {
         }
 
+        internal Coroutine Coroutine { get; set; }
+
         protected internal virtual void DoTask()
         {
 
         }
 
         public virtual bool IsFinished { get { return true; } }
+
+        //how the coroutine waits while this task is not finished
+        protected internal virtual CoroutineWaitMode WaitMode { get { return CoroutineWaitMode.Poll; } }
+
+        //tasks with CoroutineWaitMode.WakeUp call this once they are finished
+        protected void WakeUpCoroutine()
+        {
+            if (Coroutine != null)
+            {
+                Coroutine.WakeUp();
+            }
+        }
+    }
+
+    public enum CoroutineWaitMode
+    {
+        //IsFinished is checked every frame
+        Poll,
+        //the coroutine sleeps until the task calls WakeUpCoroutine
+        WakeUp,
+        //the coroutine sleeps in the timer wheel until TimerCoroutineTask.DueTime
+        Timer
     }
 }
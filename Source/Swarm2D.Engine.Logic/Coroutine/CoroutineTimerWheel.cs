@@ -0,0 +1,194 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+
+namespace Swarm2D.Engine.Logic
+{
+    //hierarchical timer wheel with millisecond resolution. the first level has a slot for each of the next 256 milliseconds,
+    //every other level has 64 slots each covering a whole turn of the level below, so adding and expiring a timer is O(1)
+    //and coroutines in far slots are moved down a level only when the wheel reaches them.
+    internal sealed class CoroutineTimerWheel
+    {
+        private const int FirstLevelBits = 8;
+        private const int LevelBits = 6;
+        private const int LevelCount = 4;
+
+        private const int FirstLevelSize = 1 << FirstLevelBits;
+        private const int LevelSize = 1 << LevelBits;
+
+        private const long MaxDelay = (1L << (FirstLevelBits + LevelBits * (LevelCount - 1))) - 1;
+
+        private List<Coroutine>[][] _levels;
+        private List<Coroutine> _cascadedCoroutines;
+        private long _currentTick;
+
+        public int Count { get; private set; }
+
+        public static long CurrentTime
+        {
+            get { return Time.ElapsedTicks * 1000 / Time.TicksPerSecond; }
+        }
+
+        public CoroutineTimerWheel()
+        {
+            _levels = new List<Coroutine>[LevelCount][];
+
+            for (int i = 0; i < LevelCount; i++)
+            {
+                int slotCount = i == 0 ? FirstLevelSize : LevelSize;
+
+                _levels[i] = new List<Coroutine>[slotCount];
+
+                for (int j = 0; j < slotCount; j++)
+                {
+                    _levels[i][j] = new List<Coroutine>();
+                }
+            }
+
+            _cascadedCoroutines = new List<Coroutine>();
+            _currentTick = CurrentTime;
+        }
+
+        public void Add(Coroutine coroutine, long dueTime)
+        {
+            //the slot of the current tick is already expired
+            coroutine.DueTime = Math.Max(dueTime, _currentTick + 1);
+
+            Insert(coroutine);
+
+            Count++;
+        }
+
+        private void Insert(Coroutine coroutine)
+        {
+            long dueTime = coroutine.DueTime;
+            long delay = dueTime - _currentTick;
+
+            if (delay < 0)
+            {
+                dueTime = _currentTick;
+                delay = 0;
+            }
+            else if (delay > MaxDelay)
+            {
+                //parked in the last slot of the wheel, it is inserted again when that slot is reached
+                dueTime = _currentTick + MaxDelay;
+                delay = MaxDelay;
+            }
+
+            if (delay < FirstLevelSize)
+            {
+                _levels[0][dueTime & (FirstLevelSize - 1)].Add(coroutine);
+                return;
+            }
+
+            for (int level = 1; level < LevelCount; level++)
+            {
+                int shift = FirstLevelBits + LevelBits * (level - 1);
+
+                if (delay < 1L << (shift + LevelBits) || level == LevelCount - 1)
+                {
+                    _levels[level][(dueTime >> shift) & (LevelSize - 1)].Add(coroutine);
+                    return;
+                }
+            }
+        }
+
+        //moves every coroutine whose time has come to expiredCoroutines
+        public void Advance(long time, List<Coroutine> expiredCoroutines)
+        {
+            if (Count == 0)
+            {
+                _currentTick = Math.Max(_currentTick, time);
+                return;
+            }
+
+            while (_currentTick < time && Count > 0)
+            {
+                _currentTick++;
+
+                int firstLevelIndex = (int)(_currentTick & (FirstLevelSize - 1));
+
+                if (firstLevelIndex == 0)
+                {
+                    Cascade(1);
+                }
+
+                List<Coroutine> slot = _levels[0][firstLevelIndex];
+
+                for (int i = 0; i < slot.Count; i++)
+                {
+                    Coroutine coroutine = slot[i];
+
+                    //parked coroutines with delays longer than the wheel go around again
+                    if (coroutine.DueTime > _currentTick)
+                    {
+                        Insert(coroutine);
+                    }
+                    else
+                    {
+                        expiredCoroutines.Add(coroutine);
+                        Count--;
+                    }
+                }
+
+                slot.Clear();
+            }
+
+            _currentTick = Math.Max(_currentTick, time);
+        }
+
+        private void Cascade(int level)
+        {
+            int shift = FirstLevelBits + LevelBits * (level - 1);
+            int index = (int)((_currentTick >> shift) & (LevelSize - 1));
+
+            if (index == 0 && level + 1 < LevelCount)
+            {
+                Cascade(level + 1);
+            }
+
+            List<Coroutine> slot = _levels[level][index];
+
+            if (slot.Count > 0)
+            {
+                _cascadedCoroutines.AddRange(slot);
+                slot.Clear();
+
+                for (int i = 0; i < _cascadedCoroutines.Count; i++)
+                {
+                    Insert(_cascadedCoroutines[i]);
+                }
+
+                _cascadedCoroutines.Clear();
+            }
+        }
+    }
+}
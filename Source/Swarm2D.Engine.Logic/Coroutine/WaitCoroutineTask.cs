@@ -33,15 +33,35 @@ namespace Swarm2D.Engine.Logic
     public class WaitCoroutineTask : CoroutineTask
     {
         private Coroutine _coroutineToWait;
+        private int _generationToWait;
+        private bool _registered;
 
         public void Initialize(Coroutine coroutine)
         {
             _coroutineToWait = coroutine;
+            _generationToWait = coroutine.Generation;
         }
 
+        protected internal override void DoTask()
+        {
+            base.DoTask();
+
+            if (!_registered && !IsFinished)
+            {
+                _coroutineToWait.AddWaitingCoroutine(Coroutine);
+                _registered = true;
+            }
+        }
+
+        //the waited coroutine is recycled by the manager once it is over
         public override bool IsFinished
         {
-            get { return _coroutineToWait.IsFinished; }
+            get { return _coroutineToWait.Generation != _generationToWait || _coroutineToWait.IsFinished; }
+        }
+
+        protected internal override CoroutineWaitMode WaitMode
+        {
+            get { return CoroutineWaitMode.WakeUp; }
         }
     }
 }
@@ -166,6 +166,10 @@ namespace Swarm2D.Engine.Logic
                     {
                         _firstFrame = false;
                     }
+
+                    //wake up the idle engine exactly when the next game frame is due
+                    long nextFrameTick = _startTick + _delayTick + ((ExecutedFrame + 1)*Time.TicksPerSecond + FrameRate - 1)/FrameRate;
+                    Engine.IdleScheduler.RequestWakeUpAt(nextFrameTick);
                 }
                 else
                 {
@@ -0,0 +1,78 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+
+namespace Swarm2D.Engine.Logic
+{
+    //yield returning this task waits for a path from the pathfinding service without blocking the frame,
+    //the request is cancelled if the coroutine is over before the path is found
+    public class FindPathTask : CoroutineTask
+    {
+        public PathRequest Request { get; private set; }
+
+        public void Initialize(PathfindingService pathfindingService, INavigableNode startNode, INavigableNode endNode, int priority = 0)
+        {
+            Request = pathfindingService.RequestPath(startNode, endNode, priority);
+            Request.Task = this;
+        }
+
+        public NavigationPath Path
+        {
+            get { return Request.Path; }
+        }
+
+        internal void OnRequestCompleted()
+        {
+            WakeUpCoroutine();
+        }
+
+        protected override void OnDestroy()
+        {
+            //the coroutine deletes the task before it reads the path
+            if (Request != null && !Request.IsDone)
+            {
+                Request.Task = null;
+                Request.Cancel();
+            }
+
+            base.OnDestroy();
+        }
+
+        public override bool IsFinished
+        {
+            get { return Request == null || Request.IsDone; }
+        }
+
+        protected internal override CoroutineWaitMode WaitMode
+        {
+            get { return CoroutineWaitMode.WakeUp; }
+        }
+    }
+}
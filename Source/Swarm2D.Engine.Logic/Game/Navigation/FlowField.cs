@@ -0,0 +1,450 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //distance of every cell of a navigation grid to one goal, and the neighbour to step to from each cell. the
+    //distances spread from the goal as a wavefront with the moves of GridPathfindingContext, so any number of agents
+    //heading to the goal only look up the cell they are on
+    public sealed class FlowField
+    {
+        private const byte NoDirection = 255;
+
+        //past this many changed areas integrating again is cheaper than patching
+        private const int MaxUpdateChangeCount = 64;
+
+        //even directions are straight, odd ones diagonal, the opposite of a direction is 4 away
+        private static readonly int[] OffsetsX = { 1, 1, 0, -1, -1, -1, 0, 1 };
+        private static readonly int[] OffsetsY = { 0, 1, 1, 1, 0, -1, -1, -1 };
+        private static readonly Vector2[] Directions = CreateDirections();
+
+        private NavigationGrid _grid;
+
+        private float[] _costs;
+        private byte[] _directions;
+
+        private ParallelForDelegate _directionJob;
+
+        public int GoalX { get; private set; }
+        public int GoalY { get; private set; }
+
+        internal int GoalCell { get; private set; }
+
+        //version of the grid the field is up to date with, -1 before it is integrated
+        internal int GridVersion { get; set; }
+
+        internal FlowField(NavigationGrid grid, int goalCell)
+        {
+            _grid = grid;
+
+            _costs = new float[grid.Width * grid.Height];
+            _directions = new byte[grid.Width * grid.Height];
+
+            _directionJob = UpdateDirections;
+
+            SetGoal(goalCell);
+        }
+
+        private static Vector2[] CreateDirections()
+        {
+            Vector2[] directions = new Vector2[8];
+
+            for (int i = 0; i < directions.Length; i++)
+            {
+                directions[i] = new Vector2(OffsetsX[i], OffsetsY[i]);
+                directions[i].Normalize();
+            }
+
+            return directions;
+        }
+
+        //unit vector towards the next cell, zero on the goal, outside of the grid and where the goal can not be reached
+        public Vector2 GetDirection(Vector2 position)
+        {
+            int x;
+            int y;
+
+            if (!_grid.WorldToCell(position, out x, out y))
+            {
+                return Vector2.Zero;
+            }
+
+            byte direction = _directions[y * _grid.Width + x];
+
+            return direction != NoDirection ? Directions[direction] : Vector2.Zero;
+        }
+
+        //the next cell from the cell, false on the goal and where the goal can not be reached
+        public bool GetNextCell(int x, int y, out int nextX, out int nextY)
+        {
+            nextX = x;
+            nextY = y;
+
+            if (x < 0 || y < 0 || x >= _grid.Width || y >= _grid.Height)
+            {
+                return false;
+            }
+
+            byte direction = _directions[y * _grid.Width + x];
+
+            if (direction == NoDirection)
+            {
+                return false;
+            }
+
+            nextX += OffsetsX[direction];
+            nextY += OffsetsY[direction];
+
+            return true;
+        }
+
+        //in world units, infinity where the goal can not be reached
+        public float GetDistance(int x, int y)
+        {
+            if (x < 0 || y < 0 || x >= _grid.Width || y >= _grid.Height)
+            {
+                return float.PositiveInfinity;
+            }
+
+            return _costs[y * _grid.Width + x] * _grid.CellSize;
+        }
+
+        public float GetDistance(Vector2 position)
+        {
+            int x;
+            int y;
+
+            return _grid.WorldToCell(position, out x, out y) ? GetDistance(x, y) : float.PositiveInfinity;
+        }
+
+        internal void SetGoal(int goalCell)
+        {
+            GoalCell = goalCell;
+            GoalX = goalCell % _grid.Width;
+            GoalY = goalCell / _grid.Width;
+            GridVersion = -1;
+        }
+
+        internal void Integrate(FlowFieldIntegrator integrator, bool parallelDirections)
+        {
+            for (int i = 0; i < _costs.Length; i++)
+            {
+                _costs[i] = float.PositiveInfinity;
+            }
+
+            if (_grid.IsWalkable(GoalCell))
+            {
+                _costs[GoalCell] = 0.0f;
+                integrator.Push(0.0f, GoalCell);
+
+                Spread(integrator, false);
+            }
+
+            //every cell picks its direction alone, the rows can be shared by threads
+            if (parallelDirections)
+            {
+                Framework.Current.JobSystem.ParallelFor(_grid.Height, 16, _directionJob);
+            }
+            else
+            {
+                UpdateDirections(0, _grid.Height, 0);
+            }
+        }
+
+        //brings the field up to date with the changed areas. cells whose way to the goal went through a changed cell
+        //forget their distance, then the wavefront spreads again from the cells around them and from the changed cells
+        internal void Update(FlowFieldIntegrator integrator, List<GridArea> changes)
+        {
+            int width = _grid.Width;
+            int height = _grid.Height;
+
+            if (changes.Count > MaxUpdateChangeCount)
+            {
+                Integrate(integrator, false);
+                return;
+            }
+
+            for (int i = 0; i < changes.Count; i++)
+            {
+                GridArea area = changes[i];
+
+                if (GoalX >= area.MinX && GoalX <= area.MaxX && GoalY >= area.MinY && GoalY <= area.MaxY)
+                {
+                    Integrate(integrator, false);
+                    return;
+                }
+            }
+
+            integrator.BeginUpdate(_costs.Length);
+
+            for (int i = 0; i < changes.Count; i++)
+            {
+                GridArea area = Expand(changes[i]);
+
+                for (int y = area.MinY; y <= area.MaxY; y++)
+                {
+                    for (int x = area.MinX; x <= area.MaxX; x++)
+                    {
+                        int cell = y * width + x;
+
+                        //walls and the cells whose step is blocked now, diagonal steps also need the cells beside them
+                        if (cell != GoalCell && !float.IsPositiveInfinity(_costs[cell]) &&
+                            (!_grid.IsWalkable(cell) || _directions[cell] == NoDirection || !CanMove(x, y, _directions[cell])))
+                        {
+                            integrator.Reset(cell);
+                        }
+                    }
+                }
+            }
+
+            List<int> resetCells = integrator.ResetCells;
+
+            //the cells stepping into a forgotten cell forget theirs too
+            for (int i = 0; i < resetCells.Count; i++)
+            {
+                int cell = resetCells[i];
+                int x = cell % width;
+                int y = cell / width;
+
+                for (int direction = 0; direction < 8; direction++)
+                {
+                    int neighbourX = x + OffsetsX[direction];
+                    int neighbourY = y + OffsetsY[direction];
+
+                    if (neighbourX < 0 || neighbourY < 0 || neighbourX >= width || neighbourY >= height)
+                    {
+                        continue;
+                    }
+
+                    int neighbour = neighbourY * width + neighbourX;
+
+                    if (_directions[neighbour] == ((direction + 4) & 7) && !integrator.IsReset(neighbour))
+                    {
+                        integrator.Reset(neighbour);
+                    }
+                }
+            }
+
+            for (int i = 0; i < resetCells.Count; i++)
+            {
+                _costs[resetCells[i]] = float.PositiveInfinity;
+                _directions[resetCells[i]] = NoDirection;
+            }
+
+            //the known cells around the forgotten ones and the changed ones spread their distances again
+            for (int i = 0; i < resetCells.Count; i++)
+            {
+                int cell = resetCells[i];
+                PushNeighbours(integrator, cell % width, cell / width);
+            }
+
+            for (int i = 0; i < changes.Count; i++)
+            {
+                GridArea area = Expand(changes[i]);
+
+                for (int y = area.MinY; y <= area.MaxY; y++)
+                {
+                    for (int x = area.MinX; x <= area.MaxX; x++)
+                    {
+                        int cell = y * width + x;
+
+                        if (!float.IsPositiveInfinity(_costs[cell]))
+                        {
+                            integrator.Push(_costs[cell], cell);
+                        }
+
+                        integrator.MarkDirection(cell);
+                    }
+                }
+            }
+
+            Spread(integrator, true);
+
+            //cells that got closer may be the better step for their neighbours
+            List<int> directionCells = integrator.DirectionCells;
+            int changedCellCount = directionCells.Count;
+
+            for (int i = 0; i < changedCellCount; i++)
+            {
+                int cell = directionCells[i];
+                int x = cell % width;
+                int y = cell / width;
+
+                for (int direction = 0; direction < 8; direction++)
+                {
+                    int neighbourX = x + OffsetsX[direction];
+                    int neighbourY = y + OffsetsY[direction];
+
+                    if (neighbourX >= 0 && neighbourY >= 0 && neighbourX < width && neighbourY < height)
+                    {
+                        integrator.MarkDirection(neighbourY * width + neighbourX);
+                    }
+                }
+            }
+
+            for (int i = 0; i < directionCells.Count; i++)
+            {
+                int cell = directionCells[i];
+                _directions[cell] = FindDirection(cell % width, cell / width);
+            }
+        }
+
+        private void PushNeighbours(FlowFieldIntegrator integrator, int x, int y)
+        {
+            for (int direction = 0; direction < 8; direction++)
+            {
+                int neighbourX = x + OffsetsX[direction];
+                int neighbourY = y + OffsetsY[direction];
+
+                if (neighbourX < 0 || neighbourY < 0 || neighbourX >= _grid.Width || neighbourY >= _grid.Height)
+                {
+                    continue;
+                }
+
+                int neighbour = neighbourY * _grid.Width + neighbourX;
+
+                if (!float.IsPositiveInfinity(_costs[neighbour]))
+                {
+                    integrator.Push(_costs[neighbour], neighbour);
+                }
+            }
+        }
+
+        //dijkstra from the cells in the heap, a cell only takes a cost lower than the one it has
+        private void Spread(FlowFieldIntegrator integrator, bool markChangedCells)
+        {
+            int width = _grid.Width;
+
+            float cost;
+            int cell;
+
+            while (integrator.TryPop(out cost, out cell))
+            {
+                if (cost > _costs[cell])
+                {
+                    continue;
+                }
+
+                int x = cell % width;
+                int y = cell / width;
+
+                for (int direction = 0; direction < 8; direction++)
+                {
+                    if (!CanMove(x, y, direction))
+                    {
+                        continue;
+                    }
+
+                    int neighbour = (y + OffsetsY[direction]) * width + x + OffsetsX[direction];
+                    float neighbourCost = cost + ((direction & 1) == 0 ? GridPathfindingContext.StraightCost : GridPathfindingContext.DiagonalCost);
+
+                    if (neighbourCost < _costs[neighbour])
+                    {
+                        _costs[neighbour] = neighbourCost;
+                        integrator.Push(neighbourCost, neighbour);
+
+                        if (markChangedCells)
+                        {
+                            integrator.MarkDirection(neighbour);
+                        }
+                    }
+                }
+            }
+        }
+
+        private void UpdateDirections(int startRow, int endRow, int threadIndex)
+        {
+            int width = _grid.Width;
+
+            for (int y = startRow; y < endRow; y++)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    _directions[y * width + x] = FindDirection(x, y);
+                }
+            }
+        }
+
+        //the neighbour the way to the goal is shortest through
+        private byte FindDirection(int x, int y)
+        {
+            int cell = y * _grid.Width + x;
+
+            if (cell == GoalCell || float.IsPositiveInfinity(_costs[cell]) || !_grid.IsWalkable(cell))
+            {
+                return NoDirection;
+            }
+
+            byte bestDirection = NoDirection;
+            float bestCost = float.PositiveInfinity;
+
+            for (int direction = 0; direction < 8; direction++)
+            {
+                if (!CanMove(x, y, direction))
+                {
+                    continue;
+                }
+
+                int neighbour = (y + OffsetsY[direction]) * _grid.Width + x + OffsetsX[direction];
+                float cost = _costs[neighbour] + ((direction & 1) == 0 ? GridPathfindingContext.StraightCost : GridPathfindingContext.DiagonalCost);
+
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestDirection = (byte)direction;
+                }
+            }
+
+            return bestDirection;
+        }
+
+        private bool CanMove(int x, int y, int direction)
+        {
+            int offsetX = OffsetsX[direction];
+            int offsetY = OffsetsY[direction];
+
+            if (!_grid.IsWalkable(x + offsetX, y + offsetY))
+            {
+                return false;
+            }
+
+            return (direction & 1) == 0 || (_grid.IsWalkable(x + offsetX, y) && _grid.IsWalkable(x, y + offsetY));
+        }
+
+        //a changed cell also changes the diagonal steps of the cells around it
+        private GridArea Expand(GridArea area)
+        {
+            return new GridArea(Math.Max(0, area.MinX - 1), Math.Max(0, area.MinY - 1),
+                Math.Min(_grid.Width - 1, area.MaxX + 1), Math.Min(_grid.Height - 1, area.MaxY + 1));
+        }
+    }
+}
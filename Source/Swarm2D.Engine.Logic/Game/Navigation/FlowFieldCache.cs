@@ -0,0 +1,217 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //the flow fields of the goals used lately, the least recently used one is given to a new goal when the cache is
+    //full. fields catch up with the grid changes only when they are asked for
+    public sealed class FlowFieldCache
+    {
+        private NavigationGrid _grid;
+
+        private Dictionary<int, LinkedListNode<FlowField>> _fieldsByGoal;
+
+        //most recently used first
+        private LinkedList<FlowField> _fields;
+
+        private FlowFieldIntegrator[] _integrators;
+
+        private List<FlowField> _preparedFields;
+        private ParallelForDelegate _prepareJob;
+
+        public int Capacity { get; private set; }
+
+        public int Count
+        {
+            get { return _fields.Count; }
+        }
+
+        public int HitCount { get; private set; }
+        public int MissCount { get; private set; }
+
+        public FlowFieldCache(NavigationGrid grid, int capacity = 8)
+        {
+            Debug.Assert(capacity > 0, "flow field cache needs room for at least one field");
+
+            _grid = grid;
+            Capacity = Math.Max(1, capacity);
+
+            _fieldsByGoal = new Dictionary<int, LinkedListNode<FlowField>>();
+            _fields = new LinkedList<FlowField>();
+
+            _integrators = new FlowFieldIntegrator[] { new FlowFieldIntegrator() };
+
+            _preparedFields = new List<FlowField>();
+            _prepareJob = PrepareFields;
+        }
+
+        //null if the goal is outside of the grid
+        public FlowField GetFlowField(Vector2 goal)
+        {
+            int x;
+            int y;
+
+            return _grid.WorldToCell(goal, out x, out y) ? GetFlowField(x, y) : null;
+        }
+
+        public FlowField GetFlowField(int goalX, int goalY)
+        {
+            if (goalX < 0 || goalY < 0 || goalX >= _grid.Width || goalY >= _grid.Height)
+            {
+                return null;
+            }
+
+            FlowField field = FindOrAddField(goalY * _grid.Width + goalX);
+
+            if (field.GridVersion != _grid.Version)
+            {
+                CatchUp(field, _integrators[0], true);
+            }
+
+            return field;
+        }
+
+        //brings the fields of the goals up to date together, one field per thread. a wavefront only moves on from its
+        //closest cell, so the fields of different goals is what threads can share
+        public void Prepare(IList<Vector2> goals)
+        {
+            _preparedFields.Clear();
+
+            for (int i = 0; i < goals.Count && _preparedFields.Count < Capacity; i++)
+            {
+                int x;
+                int y;
+
+                if (!_grid.WorldToCell(goals[i], out x, out y))
+                {
+                    continue;
+                }
+
+                FlowField field = FindOrAddField(y * _grid.Width + x);
+
+                if (field.GridVersion != _grid.Version && !_preparedFields.Contains(field))
+                {
+                    _preparedFields.Add(field);
+                }
+            }
+
+            if (_preparedFields.Count == 0)
+            {
+                return;
+            }
+
+            JobSystem jobSystem = Framework.Current.JobSystem;
+
+            if (_integrators.Length < jobSystem.ThreadCount)
+            {
+                int oldLength = _integrators.Length;
+                Array.Resize(ref _integrators, jobSystem.ThreadCount);
+
+                for (int i = oldLength; i < _integrators.Length; i++)
+                {
+                    _integrators[i] = new FlowFieldIntegrator();
+                }
+            }
+
+            jobSystem.ParallelFor(_preparedFields.Count, 1, _prepareJob);
+
+            _preparedFields.Clear();
+        }
+
+        public void Clear()
+        {
+            _fieldsByGoal.Clear();
+            _fields.Clear();
+        }
+
+        private void PrepareFields(int startIndex, int endIndex, int threadIndex)
+        {
+            for (int i = startIndex; i < endIndex; i++)
+            {
+                CatchUp(_preparedFields[i], _integrators[threadIndex], false);
+            }
+        }
+
+        private FlowField FindOrAddField(int goalCell)
+        {
+            LinkedListNode<FlowField> node;
+
+            if (_fieldsByGoal.TryGetValue(goalCell, out node))
+            {
+                HitCount++;
+
+                _fields.Remove(node);
+                _fields.AddFirst(node);
+
+                return node.Value;
+            }
+
+            MissCount++;
+
+            if (_fields.Count == Capacity)
+            {
+                node = _fields.Last;
+
+                _fields.RemoveLast();
+                _fieldsByGoal.Remove(node.Value.GoalCell);
+
+                node.Value.SetGoal(goalCell);
+            }
+            else
+            {
+                node = new LinkedListNode<FlowField>(new FlowField(_grid, goalCell));
+            }
+
+            _fields.AddFirst(node);
+            _fieldsByGoal.Add(goalCell, node);
+
+            return node.Value;
+        }
+
+        private void CatchUp(FlowField field, FlowFieldIntegrator integrator, bool parallelDirections)
+        {
+            List<GridArea> changes = integrator.Changes;
+            changes.Clear();
+
+            if (field.GridVersion < 0 || !_grid.GetChanges(field.GridVersion, changes))
+            {
+                field.Integrate(integrator, parallelDirections);
+            }
+            else
+            {
+                field.Update(integrator, changes);
+            }
+
+            field.GridVersion = _grid.Version;
+        }
+    }
+}
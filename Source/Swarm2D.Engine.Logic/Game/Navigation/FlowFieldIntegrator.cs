@@ -0,0 +1,187 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Logic
+{
+    //scratch of a thread integrating flow fields, the wavefront heap and the cells an update has to visit again.
+    //the wavefront only grows at its border, so a plain heap which skips outdated entries stays small
+    internal sealed class FlowFieldIntegrator
+    {
+        private float[] _heapCosts;
+        private int[] _heapCells;
+        private int _heapCount;
+
+        private int[] _resetStamps;
+        private int[] _directionStamps;
+        private int _stamp;
+
+        public List<int> ResetCells { get; private set; }
+        public List<int> DirectionCells { get; private set; }
+        public List<GridArea> Changes { get; private set; }
+
+        public FlowFieldIntegrator()
+        {
+            _heapCosts = new float[256];
+            _heapCells = new int[256];
+
+            _resetStamps = new int[0];
+            _directionStamps = new int[0];
+
+            ResetCells = new List<int>();
+            DirectionCells = new List<int>();
+            Changes = new List<GridArea>();
+        }
+
+        public void BeginUpdate(int cellCount)
+        {
+            if (_resetStamps.Length < cellCount)
+            {
+                _resetStamps = new int[cellCount];
+                _directionStamps = new int[cellCount];
+                _stamp = 0;
+            }
+
+            _stamp++;
+
+            if (_stamp == int.MaxValue)
+            {
+                Array.Clear(_resetStamps, 0, _resetStamps.Length);
+                Array.Clear(_directionStamps, 0, _directionStamps.Length);
+                _stamp = 1;
+            }
+
+            ResetCells.Clear();
+            DirectionCells.Clear();
+        }
+
+        public bool IsReset(int cell)
+        {
+            return _resetStamps[cell] == _stamp;
+        }
+
+        public void Reset(int cell)
+        {
+            if (_resetStamps[cell] != _stamp)
+            {
+                _resetStamps[cell] = _stamp;
+                ResetCells.Add(cell);
+            }
+        }
+
+        public void MarkDirection(int cell)
+        {
+            if (_directionStamps[cell] != _stamp)
+            {
+                _directionStamps[cell] = _stamp;
+                DirectionCells.Add(cell);
+            }
+        }
+
+        public void Push(float cost, int cell)
+        {
+            if (_heapCount == _heapCosts.Length)
+            {
+                Array.Resize(ref _heapCosts, _heapCosts.Length * 2);
+                Array.Resize(ref _heapCells, _heapCells.Length * 2);
+            }
+
+            int heapIndex = _heapCount;
+            _heapCount++;
+
+            while (heapIndex > 0)
+            {
+                int parentIndex = (heapIndex - 1) >> 1;
+
+                if (_heapCosts[parentIndex] <= cost)
+                {
+                    break;
+                }
+
+                _heapCosts[heapIndex] = _heapCosts[parentIndex];
+                _heapCells[heapIndex] = _heapCells[parentIndex];
+
+                heapIndex = parentIndex;
+            }
+
+            _heapCosts[heapIndex] = cost;
+            _heapCells[heapIndex] = cell;
+        }
+
+        public bool TryPop(out float cost, out int cell)
+        {
+            if (_heapCount == 0)
+            {
+                cost = 0.0f;
+                cell = -1;
+
+                return false;
+            }
+
+            cost = _heapCosts[0];
+            cell = _heapCells[0];
+
+            _heapCount--;
+
+            float lastCost = _heapCosts[_heapCount];
+            int lastCell = _heapCells[_heapCount];
+            int heapIndex = 0;
+
+            while (true)
+            {
+                int childIndex = heapIndex * 2 + 1;
+
+                if (childIndex >= _heapCount)
+                {
+                    break;
+                }
+
+                if (childIndex + 1 < _heapCount && _heapCosts[childIndex + 1] < _heapCosts[childIndex])
+                {
+                    childIndex++;
+                }
+
+                if (lastCost <= _heapCosts[childIndex])
+                {
+                    break;
+                }
+
+                _heapCosts[heapIndex] = _heapCosts[childIndex];
+                _heapCells[heapIndex] = _heapCells[childIndex];
+
+                heapIndex = childIndex;
+            }
+
+            _heapCosts[heapIndex] = lastCost;
+            _heapCells[heapIndex] = lastCell;
+
+            return true;
+        }
+    }
+}
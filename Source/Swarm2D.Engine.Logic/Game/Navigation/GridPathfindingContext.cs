@@ -0,0 +1,219 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //A* over the cells of a NavigationGrid. moves go to the 8 neighbours, a diagonal move needs both of the cells
+    //beside it to be walkable. the hierarchical pathfinder also runs it inside single clusters, so the state is only
+    //as large as the searched area
+    public sealed class GridPathfindingContext
+    {
+        internal const float StraightCost = 1.0f;
+        internal const float DiagonalCost = 1.41421356f;
+
+        private NavigationSearchState _state;
+
+        private NavigationGrid _grid;
+        private GridArea _area;
+        private int _areaWidth;
+
+        private int _startCell;
+        private int _endCell;
+        private bool _found;
+
+        public GridPathfindingContext()
+        {
+            _state = new NavigationSearchState(1024);
+        }
+
+        //in world units, infinity when the last search found no path
+        public float PathCost
+        {
+            get { return _found ? _state.GetMovementCost(ToLocal(_endCell)) * _grid.CellSize : float.PositiveInfinity; }
+        }
+
+        public bool FindPath(NavigationGrid grid, int startX, int startY, int endX, int endY)
+        {
+            _grid = grid;
+            _found = false;
+
+            if (!grid.IsWalkable(startX, startY) || !grid.IsWalkable(endX, endY))
+            {
+                return false;
+            }
+
+            return Search(grid, new GridArea(0, 0, grid.Width - 1, grid.Height - 1), startY * grid.Width + startX, endY * grid.Width + endX);
+        }
+
+        //centers of the cells from the start to the end of the last path found
+        public void GetPath(List<Vector2> result)
+        {
+            if (!_found)
+            {
+                return;
+            }
+
+            int firstIndex = result.Count;
+
+            for (int local = ToLocal(_endCell); local >= 0; local = _state.GetParent(local))
+            {
+                result.Add(_grid.CellToWorld(ToCell(local)));
+            }
+
+            result.Reverse(firstIndex, result.Count - firstIndex);
+        }
+
+        //searches only the cells of the area. without an end cell every reachable cell of the area is expanded, so
+        //GetCellCost gives the distance to each of them
+        internal bool Search(NavigationGrid grid, GridArea area, int startCell, int endCell)
+        {
+            _grid = grid;
+            _area = area;
+            _areaWidth = area.MaxX - area.MinX + 1;
+            _startCell = startCell;
+            _endCell = endCell;
+            _found = false;
+
+            int width = grid.Width;
+            int endLocal = endCell >= 0 ? ToLocal(endCell) : -1;
+            int endX = endCell % width;
+            int endY = endCell / width;
+
+            _state.BeginSearch(_areaWidth * (area.MaxY - area.MinY + 1));
+            _state.Relax(ToLocal(startCell), -1, 0.0f, endCell >= 0 ? Heuristic(startCell % width, startCell / width, endX, endY) : 0.0f);
+
+            while (_state.OpenCount > 0)
+            {
+                int local = _state.Pop();
+
+                if (local == endLocal)
+                {
+                    _found = true;
+                    break;
+                }
+
+                float movementCost = _state.GetMovementCost(local);
+
+                int x = area.MinX + local % _areaWidth;
+                int y = area.MinY + local / _areaWidth;
+
+                for (int offsetY = -1; offsetY <= 1; offsetY++)
+                {
+                    int neighbourY = y + offsetY;
+
+                    if (neighbourY < area.MinY || neighbourY > area.MaxY)
+                    {
+                        continue;
+                    }
+
+                    for (int offsetX = -1; offsetX <= 1; offsetX++)
+                    {
+                        int neighbourX = x + offsetX;
+
+                        if ((offsetX == 0 && offsetY == 0) || neighbourX < area.MinX || neighbourX > area.MaxX ||
+                            !grid.IsWalkable(neighbourY * width + neighbourX))
+                        {
+                            continue;
+                        }
+
+                        float cost = StraightCost;
+
+                        if (offsetX != 0 && offsetY != 0)
+                        {
+                            if (!grid.IsWalkable(y * width + neighbourX) || !grid.IsWalkable(neighbourY * width + x))
+                            {
+                                continue;
+                            }
+
+                            cost = DiagonalCost;
+                        }
+
+                        int neighbourLocal = (neighbourY - area.MinY) * _areaWidth + (neighbourX - area.MinX);
+
+                        if (!_state.IsClosed(neighbourLocal))
+                        {
+                            float heuristic = endCell >= 0 ? Heuristic(neighbourX, neighbourY, endX, endY) : 0.0f;
+                            _state.Relax(neighbourLocal, local, movementCost + cost, heuristic);
+                        }
+                    }
+                }
+            }
+
+            return _found;
+        }
+
+        //in cells, infinity for the cells the last search did not reach
+        internal float GetCellCost(int cell)
+        {
+            int x = cell % _grid.Width;
+            int y = cell / _grid.Width;
+
+            if (x < _area.MinX || x > _area.MaxX || y < _area.MinY || y > _area.MaxY)
+            {
+                return float.PositiveInfinity;
+            }
+
+            return _state.GetMovementCost(ToLocal(cell));
+        }
+
+        //cells after the start up to the end cell
+        internal void AddPathCells(int endCell, List<int> result)
+        {
+            int firstIndex = result.Count;
+
+            for (int local = ToLocal(endCell); local >= 0 && ToCell(local) != _startCell; local = _state.GetParent(local))
+            {
+                result.Add(ToCell(local));
+            }
+
+            result.Reverse(firstIndex, result.Count - firstIndex);
+        }
+
+        //octile distance, exact on an empty grid
+        internal static float Heuristic(int x, int y, int endX, int endY)
+        {
+            int distanceX = Math.Abs(endX - x);
+            int distanceY = Math.Abs(endY - y);
+
+            return Math.Max(distanceX, distanceY) + (DiagonalCost - StraightCost) * Math.Min(distanceX, distanceY);
+        }
+
+        private int ToLocal(int cell)
+        {
+            return (cell / _grid.Width - _area.MinY) * _areaWidth + (cell % _grid.Width - _area.MinX);
+        }
+
+        private int ToCell(int local)
+        {
+            return (_area.MinY + local / _areaWidth) * _grid.Width + _area.MinX + local % _areaWidth;
+        }
+    }
+}
@@ -0,0 +1,120 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //waypoints of a path found by a HierarchicalPathfinder, from the start to the end. the cells between two waypoints
+    //are only searched when they are asked for, usually a segment ahead of the one being walked
+    public sealed class HierarchicalPath
+    {
+        private HierarchicalPathfinder _pathfinder;
+        private List<int> _waypoints;
+        private List<int> _cells;
+
+        public HierarchicalPath()
+        {
+            _waypoints = new List<int>();
+            _cells = new List<int>();
+
+            Cost = float.PositiveInfinity;
+        }
+
+        //in world units, infinity when there is no path
+        public float Cost { get; internal set; }
+
+        public int WaypointCount
+        {
+            get { return _waypoints.Count; }
+        }
+
+        public Vector2 GetWaypoint(int index)
+        {
+            return _pathfinder.Grid.CellToWorld(_waypoints[index]);
+        }
+
+        //adds the centers of the cells after the waypoint up to the next one. the grid may have changed since the path
+        //was found, false means the segment is blocked now and the path should be found again
+        public bool RefineSegment(int index, List<Vector2> result)
+        {
+            _cells.Clear();
+
+            if (!_pathfinder.RefineSegment(_waypoints[index], _waypoints[index + 1], _cells))
+            {
+                return false;
+            }
+
+            for (int i = 0; i < _cells.Count; i++)
+            {
+                result.Add(_pathfinder.Grid.CellToWorld(_cells[i]));
+            }
+
+            return true;
+        }
+
+        //every cell of the path at once
+        public bool Refine(List<Vector2> result)
+        {
+            if (_waypoints.Count == 0)
+            {
+                return false;
+            }
+
+            result.Add(GetWaypoint(0));
+
+            for (int i = 0; i < _waypoints.Count - 1; i++)
+            {
+                if (!RefineSegment(i, result))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        internal void Reset(HierarchicalPathfinder pathfinder)
+        {
+            _pathfinder = pathfinder;
+            _waypoints.Clear();
+
+            Cost = float.PositiveInfinity;
+        }
+
+        //the start or the end may be on a transition node
+        internal void AddWaypoint(int cell)
+        {
+            if (_waypoints.Count == 0 || _waypoints[_waypoints.Count - 1] != cell)
+            {
+                _waypoints.Add(cell);
+            }
+        }
+    }
+}
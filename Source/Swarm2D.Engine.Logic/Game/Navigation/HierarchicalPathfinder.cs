@@ -0,0 +1,776 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //HPA*, the grid is split into square clusters. where two clusters touch, every run of cells open on both sides gets
+    //transition nodes, and the nodes of a cluster are linked with their distances inside it. a query links the start and
+    //the end to the nodes of their clusters, searches this small graph and leaves the cell level path to HierarchicalPath,
+    //which refines it a segment at a time. changed cells only rebuild the clusters around them.
+    //uses one search state for everything, so a pathfinder serves one thread
+    public sealed class HierarchicalPathfinder
+    {
+        //runs shorter than this get one transition in their middle, longer ones one at each end
+        private const int SplitEntranceLength = 6;
+
+        private NavigationGrid _grid;
+
+        private int _clusterCountX;
+        private int _clusterCountY;
+        private Cluster[] _clusters;
+
+        //transition node pairs, the first of a pair is in the lower cluster. vertical borders are between the clusters
+        //at x and x + 1, horizontal borders between the ones at y and y + 1
+        private List<int>[] _verticalBorders;
+        private List<int>[] _horizontalBorders;
+
+        private List<AbstractNode> _nodes;
+        private Stack<int> _freeNodes;
+        private Dictionary<int, int> _nodesByCell;
+
+        private int _gridVersion;
+        private List<GridArea> _changedAreas;
+
+        private bool[] _changedClusters;
+        private bool[] _clustersToLink;
+        private List<int> _changedClusterList;
+        private List<int> _clustersToLinkList;
+
+        private GridPathfindingContext _localSearch;
+        private NavigationSearchState _abstractSearch;
+        private List<int> _startNodes;
+        private List<float> _startCosts;
+        private List<int> _pathNodes;
+        private Dictionary<int, float> _endCosts;
+
+        public NavigationGrid Grid
+        {
+            get { return _grid; }
+        }
+
+        public int ClusterSize { get; private set; }
+
+        public int NodeCount
+        {
+            get { return _nodes.Count - _freeNodes.Count; }
+        }
+
+        //clusters whose links were searched again on the last update
+        public int LastRebuiltClusterCount { get; private set; }
+
+        public HierarchicalPathfinder(NavigationGrid grid, int clusterSize = 16)
+        {
+            _grid = grid;
+            ClusterSize = Math.Max(2, clusterSize);
+
+            _clusterCountX = (grid.Width + ClusterSize - 1) / ClusterSize;
+            _clusterCountY = (grid.Height + ClusterSize - 1) / ClusterSize;
+            _clusters = new Cluster[_clusterCountX * _clusterCountY];
+
+            for (int clusterY = 0; clusterY < _clusterCountY; clusterY++)
+            {
+                for (int clusterX = 0; clusterX < _clusterCountX; clusterX++)
+                {
+                    int minX = clusterX * ClusterSize;
+                    int minY = clusterY * ClusterSize;
+                    GridArea area = new GridArea(minX, minY, Math.Min(grid.Width, minX + ClusterSize) - 1, Math.Min(grid.Height, minY + ClusterSize) - 1);
+
+                    _clusters[clusterY * _clusterCountX + clusterX] = new Cluster(area);
+                }
+            }
+
+            _verticalBorders = CreateBorders((_clusterCountX - 1) * _clusterCountY);
+            _horizontalBorders = CreateBorders(_clusterCountX * (_clusterCountY - 1));
+
+            _nodes = new List<AbstractNode>();
+            _freeNodes = new Stack<int>();
+            _nodesByCell = new Dictionary<int, int>();
+
+            _changedAreas = new List<GridArea>();
+            _changedClusters = new bool[_clusters.Length];
+            _clustersToLink = new bool[_clusters.Length];
+            _changedClusterList = new List<int>();
+            _clustersToLinkList = new List<int>();
+
+            _localSearch = new GridPathfindingContext();
+            _abstractSearch = new NavigationSearchState(1024);
+            _startNodes = new List<int>();
+            _startCosts = new List<float>();
+            _pathNodes = new List<int>();
+            _endCosts = new Dictionary<int, float>();
+
+            Rebuild();
+        }
+
+        private static List<int>[] CreateBorders(int count)
+        {
+            List<int>[] borders = new List<int>[Math.Max(0, count)];
+
+            for (int i = 0; i < borders.Length; i++)
+            {
+                borders[i] = new List<int>();
+            }
+
+            return borders;
+        }
+
+        public void Rebuild()
+        {
+            _gridVersion = _grid.Version;
+
+            _nodes.Clear();
+            _freeNodes.Clear();
+            _nodesByCell.Clear();
+
+            for (int i = 0; i < _clusters.Length; i++)
+            {
+                _clusters[i].Nodes.Clear();
+            }
+
+            for (int i = 0; i < _verticalBorders.Length; i++)
+            {
+                _verticalBorders[i].Clear();
+                BuildVerticalBorder(i);
+            }
+
+            for (int i = 0; i < _horizontalBorders.Length; i++)
+            {
+                _horizontalBorders[i].Clear();
+                BuildHorizontalBorder(i);
+            }
+
+            for (int i = 0; i < _clusters.Length; i++)
+            {
+                LinkCluster(i);
+            }
+
+            LastRebuiltClusterCount = _clusters.Length;
+        }
+
+        //rebuilds the clusters with changed cells, the transitions on their borders and the links of the clusters on the
+        //other sides of those borders. queries call it themselves
+        public void Update()
+        {
+            LastRebuiltClusterCount = 0;
+
+            if (_gridVersion == _grid.Version)
+            {
+                return;
+            }
+
+            List<GridArea> changedAreas = _changedAreas;
+
+            if (!_grid.GetChanges(_gridVersion, changedAreas))
+            {
+                Rebuild();
+                return;
+            }
+
+            _gridVersion = _grid.Version;
+
+            for (int i = 0; i < changedAreas.Count; i++)
+            {
+                GridArea area = changedAreas[i];
+
+                for (int clusterY = area.MinY / ClusterSize; clusterY <= area.MaxY / ClusterSize; clusterY++)
+                {
+                    for (int clusterX = area.MinX / ClusterSize; clusterX <= area.MaxX / ClusterSize; clusterX++)
+                    {
+                        int cluster = clusterY * _clusterCountX + clusterX;
+
+                        if (!_changedClusters[cluster])
+                        {
+                            _changedClusters[cluster] = true;
+                            _changedClusterList.Add(cluster);
+                        }
+                    }
+                }
+            }
+
+            changedAreas.Clear();
+
+            //every transition on the borders is removed before any is added, so a node on two borders is not dropped
+            //by one of them while the other one adds it
+            for (int pass = 0; pass < 2; pass++)
+            {
+                for (int i = 0; i < _changedClusterList.Count; i++)
+                {
+                    int cluster = _changedClusterList[i];
+                    int clusterX = cluster % _clusterCountX;
+                    int clusterY = cluster / _clusterCountX;
+
+                    UpdateBorder(pass, clusterX - 1, clusterY, true);
+                    UpdateBorder(pass, clusterX, clusterY, true);
+                    UpdateBorder(pass, clusterX, clusterY - 1, false);
+                    UpdateBorder(pass, clusterX, clusterY, false);
+                }
+            }
+
+            for (int i = 0; i < _clustersToLinkList.Count; i++)
+            {
+                LinkCluster(_clustersToLinkList[i]);
+                _clustersToLink[_clustersToLinkList[i]] = false;
+            }
+
+            LastRebuiltClusterCount = _clustersToLinkList.Count;
+
+            for (int i = 0; i < _changedClusterList.Count; i++)
+            {
+                _changedClusters[_changedClusterList[i]] = false;
+            }
+
+            _changedClusterList.Clear();
+            _clustersToLinkList.Clear();
+        }
+
+        //the first pass clears the border, the second builds it again. a border between two changed clusters is
+        //visited twice in a pass, the second visit finds it empty or already built and marks the same clusters
+        private void UpdateBorder(int pass, int clusterX, int clusterY, bool vertical)
+        {
+            int border;
+            int otherCluster;
+
+            if (vertical)
+            {
+                if (clusterX < 0 || clusterX >= _clusterCountX - 1)
+                {
+                    return;
+                }
+
+                border = clusterY * (_clusterCountX - 1) + clusterX;
+                otherCluster = clusterY * _clusterCountX + clusterX + 1;
+            }
+            else
+            {
+                if (clusterY < 0 || clusterY >= _clusterCountY - 1)
+                {
+                    return;
+                }
+
+                border = clusterY * _clusterCountX + clusterX;
+                otherCluster = (clusterY + 1) * _clusterCountX + clusterX;
+            }
+
+            List<int> transitions = vertical ? _verticalBorders[border] : _horizontalBorders[border];
+
+            if (pass == 0)
+            {
+                ClearBorder(transitions);
+
+                MarkClusterToLink(clusterY * _clusterCountX + clusterX);
+                MarkClusterToLink(otherCluster);
+            }
+            else if (transitions.Count == 0)
+            {
+                if (vertical)
+                {
+                    BuildVerticalBorder(border);
+                }
+                else
+                {
+                    BuildHorizontalBorder(border);
+                }
+            }
+        }
+
+        private void MarkClusterToLink(int cluster)
+        {
+            if (!_clustersToLink[cluster])
+            {
+                _clustersToLink[cluster] = true;
+                _clustersToLinkList.Add(cluster);
+            }
+        }
+
+        private void BuildVerticalBorder(int border)
+        {
+            int clusterX = border % (_clusterCountX - 1);
+            int clusterY = border / (_clusterCountX - 1);
+
+            GridArea area = _clusters[clusterY * _clusterCountX + clusterX].Area;
+
+            int width = _grid.Width;
+            int x = area.MaxX;
+
+            BuildBorder(_verticalBorders[border], area.MinY * width + x, area.MinY * width + x + 1, width, area.MaxY - area.MinY + 1);
+        }
+
+        private void BuildHorizontalBorder(int border)
+        {
+            int clusterX = border % _clusterCountX;
+            int clusterY = border / _clusterCountX;
+
+            GridArea area = _clusters[clusterY * _clusterCountX + clusterX].Area;
+
+            int width = _grid.Width;
+            int y = area.MaxY;
+
+            BuildBorder(_horizontalBorders[border], y * width + area.MinX, (y + 1) * width + area.MinX, 1, area.MaxX - area.MinX + 1);
+        }
+
+        //walks the cell pairs facing each other over the border, step is the distance between two pairs in cells
+        private void BuildBorder(List<int> transitions, int firstCell, int firstOtherCell, int step, int length)
+        {
+            int runStart = -1;
+
+            for (int i = 0; i <= length; i++)
+            {
+                bool open = i < length && _grid.IsWalkable(firstCell + i * step) && _grid.IsWalkable(firstOtherCell + i * step);
+
+                if (open && runStart < 0)
+                {
+                    runStart = i;
+                }
+                else if (!open && runStart >= 0)
+                {
+                    int runLength = i - runStart;
+
+                    if (runLength < SplitEntranceLength)
+                    {
+                        int middle = runStart + runLength / 2;
+                        AddTransition(transitions, firstCell + middle * step, firstOtherCell + middle * step);
+                    }
+                    else
+                    {
+                        AddTransition(transitions, firstCell + runStart * step, firstOtherCell + runStart * step);
+                        AddTransition(transitions, firstCell + (i - 1) * step, firstOtherCell + (i - 1) * step);
+                    }
+
+                    runStart = -1;
+                }
+            }
+        }
+
+        private void AddTransition(List<int> transitions, int cell, int otherCell)
+        {
+            int node = GetOrCreateNode(cell);
+            int otherNode = GetOrCreateNode(otherCell);
+
+            _nodes[node].BorderCount++;
+            _nodes[otherNode].BorderCount++;
+
+            _nodes[node].Edges.Add(new AbstractEdge(otherNode, GridPathfindingContext.StraightCost));
+            _nodes[otherNode].Edges.Add(new AbstractEdge(node, GridPathfindingContext.StraightCost));
+
+            transitions.Add(node);
+            transitions.Add(otherNode);
+        }
+
+        private void ClearBorder(List<int> transitions)
+        {
+            for (int i = 0; i < transitions.Count; i += 2)
+            {
+                int node = transitions[i];
+                int otherNode = transitions[i + 1];
+
+                RemoveEdge(node, otherNode);
+                RemoveEdge(otherNode, node);
+
+                ReleaseNode(node);
+                ReleaseNode(otherNode);
+            }
+
+            transitions.Clear();
+        }
+
+        private int GetOrCreateNode(int cell)
+        {
+            int node;
+
+            if (_nodesByCell.TryGetValue(cell, out node))
+            {
+                return node;
+            }
+
+            if (_freeNodes.Count > 0)
+            {
+                node = _freeNodes.Pop();
+            }
+            else
+            {
+                node = _nodes.Count;
+                _nodes.Add(new AbstractNode());
+            }
+
+            int cluster = GetCluster(cell);
+
+            _nodes[node].Cell = cell;
+            _nodes[node].Cluster = cluster;
+            _nodes[node].BorderCount = 0;
+
+            _clusters[cluster].Nodes.Add(node);
+            _nodesByCell.Add(cell, node);
+
+            return node;
+        }
+
+        //a node stays while any border still has a transition on it
+        private void ReleaseNode(int node)
+        {
+            AbstractNode abstractNode = _nodes[node];
+            abstractNode.BorderCount--;
+
+            if (abstractNode.BorderCount > 0)
+            {
+                return;
+            }
+
+            //edges go both ways, so the ones leading here are found from this end
+            for (int i = 0; i < abstractNode.Edges.Count; i++)
+            {
+                RemoveEdge(abstractNode.Edges[i].Node, node);
+            }
+
+            abstractNode.Edges.Clear();
+
+            _clusters[abstractNode.Cluster].Nodes.Remove(node);
+            _nodesByCell.Remove(abstractNode.Cell);
+
+            abstractNode.Cell = -1;
+            _freeNodes.Push(node);
+        }
+
+        private void RemoveEdge(int node, int target)
+        {
+            List<AbstractEdge> edges = _nodes[node].Edges;
+
+            for (int i = 0; i < edges.Count; i++)
+            {
+                if (edges[i].Node == target)
+                {
+                    edges[i] = edges[edges.Count - 1];
+                    edges.RemoveAt(edges.Count - 1);
+                    return;
+                }
+            }
+        }
+
+        //links every pair of nodes of the cluster that reach each other without leaving it
+        private void LinkCluster(int cluster)
+        {
+            List<int> nodes = _clusters[cluster].Nodes;
+
+            for (int i = 0; i < nodes.Count; i++)
+            {
+                List<AbstractEdge> edges = _nodes[nodes[i]].Edges;
+                int edgeCount = 0;
+
+                for (int j = 0; j < edges.Count; j++)
+                {
+                    if (_nodes[edges[j].Node].Cluster != cluster)
+                    {
+                        edges[edgeCount] = edges[j];
+                        edgeCount++;
+                    }
+                }
+
+                edges.RemoveRange(edgeCount, edges.Count - edgeCount);
+            }
+
+            GridArea area = _clusters[cluster].Area;
+
+            for (int i = 0; i < nodes.Count - 1; i++)
+            {
+                int node = nodes[i];
+
+                _localSearch.Search(_grid, area, _nodes[node].Cell, -1);
+
+                for (int j = i + 1; j < nodes.Count; j++)
+                {
+                    int otherNode = nodes[j];
+                    float cost = _localSearch.GetCellCost(_nodes[otherNode].Cell);
+
+                    if (!float.IsPositiveInfinity(cost))
+                    {
+                        _nodes[node].Edges.Add(new AbstractEdge(otherNode, cost));
+                        _nodes[otherNode].Edges.Add(new AbstractEdge(node, cost));
+                    }
+                }
+            }
+        }
+
+        public bool FindPath(Vector2 start, Vector2 end, HierarchicalPath path)
+        {
+            int startX;
+            int startY;
+            int endX;
+            int endY;
+
+            if (!_grid.WorldToCell(start, out startX, out startY) || !_grid.WorldToCell(end, out endX, out endY))
+            {
+                path.Reset(this);
+                return false;
+            }
+
+            return FindPath(startX, startY, endX, endY, path);
+        }
+
+        public bool FindPath(int startX, int startY, int endX, int endY, HierarchicalPath path)
+        {
+            path.Reset(this);
+
+            Update();
+
+            if (!_grid.IsWalkable(startX, startY) || !_grid.IsWalkable(endX, endY))
+            {
+                return false;
+            }
+
+            int width = _grid.Width;
+            int startCell = startY * width + startX;
+            int endCell = endY * width + endX;
+
+            if (startCell == endCell)
+            {
+                path.AddWaypoint(startCell);
+                path.Cost = 0.0f;
+
+                return true;
+            }
+
+            int startCluster = GetCluster(startCell);
+            int endCluster = GetCluster(endCell);
+
+            //close ends may be joined best without leaving their cluster
+            float directCost = float.PositiveInfinity;
+
+            if (startCluster == endCluster && _localSearch.Search(_grid, _clusters[startCluster].Area, startCell, endCell))
+            {
+                directCost = _localSearch.GetCellCost(endCell);
+            }
+
+            LinkEnds(startCell, startCluster, endCell, endCluster);
+
+            int startIndex = _nodes.Count;
+            int endIndex = _nodes.Count + 1;
+
+            _abstractSearch.BeginSearch(_nodes.Count + 2);
+            _abstractSearch.Relax(startIndex, -1, 0.0f, Heuristic(startCell, endCell));
+
+            bool found = false;
+
+            while (_abstractSearch.OpenCount > 0)
+            {
+                int index = _abstractSearch.Pop();
+
+                if (index == endIndex)
+                {
+                    found = true;
+                    break;
+                }
+
+                float movementCost = _abstractSearch.GetMovementCost(index);
+
+                if (index == startIndex)
+                {
+                    for (int i = 0; i < _startNodes.Count; i++)
+                    {
+                        int node = _startNodes[i];
+                        _abstractSearch.Relax(node, startIndex, _startCosts[i], Heuristic(_nodes[node].Cell, endCell));
+                    }
+
+                    continue;
+                }
+
+                AbstractNode abstractNode = _nodes[index];
+
+                if (movementCost + Heuristic(abstractNode.Cell, endCell) >= directCost)
+                {
+                    break;
+                }
+
+                List<AbstractEdge> edges = abstractNode.Edges;
+
+                for (int i = 0; i < edges.Count; i++)
+                {
+                    int target = edges[i].Node;
+
+                    if (!_abstractSearch.IsClosed(target))
+                    {
+                        _abstractSearch.Relax(target, index, movementCost + edges[i].Cost, Heuristic(_nodes[target].Cell, endCell));
+                    }
+                }
+
+                float endCost;
+
+                if (abstractNode.Cluster == endCluster && _endCosts.TryGetValue(index, out endCost))
+                {
+                    _abstractSearch.Relax(endIndex, index, movementCost + endCost, 0.0f);
+                }
+            }
+
+            if (found && _abstractSearch.GetMovementCost(endIndex) < directCost)
+            {
+                _pathNodes.Clear();
+
+                for (int index = _abstractSearch.GetParent(endIndex); index != startIndex; index = _abstractSearch.GetParent(index))
+                {
+                    _pathNodes.Add(index);
+                }
+
+                path.AddWaypoint(startCell);
+
+                for (int i = _pathNodes.Count - 1; i >= 0; i--)
+                {
+                    path.AddWaypoint(_nodes[_pathNodes[i]].Cell);
+                }
+
+                path.AddWaypoint(endCell);
+                path.Cost = _abstractSearch.GetMovementCost(endIndex) * _grid.CellSize;
+
+                return true;
+            }
+
+            if (!float.IsPositiveInfinity(directCost))
+            {
+                path.AddWaypoint(startCell);
+                path.AddWaypoint(endCell);
+                path.Cost = directCost * _grid.CellSize;
+
+                return true;
+            }
+
+            return false;
+        }
+
+        //distances from the start to the nodes of its cluster and from the nodes of the end cluster to the end
+        private void LinkEnds(int startCell, int startCluster, int endCell, int endCluster)
+        {
+            _startNodes.Clear();
+            _startCosts.Clear();
+            _endCosts.Clear();
+
+            List<int> nodes = _clusters[startCluster].Nodes;
+
+            _localSearch.Search(_grid, _clusters[startCluster].Area, startCell, -1);
+
+            for (int i = 0; i < nodes.Count; i++)
+            {
+                float cost = _localSearch.GetCellCost(_nodes[nodes[i]].Cell);
+
+                if (!float.IsPositiveInfinity(cost))
+                {
+                    _startNodes.Add(nodes[i]);
+                    _startCosts.Add(cost);
+                }
+            }
+
+            nodes = _clusters[endCluster].Nodes;
+
+            _localSearch.Search(_grid, _clusters[endCluster].Area, endCell, -1);
+
+            for (int i = 0; i < nodes.Count; i++)
+            {
+                float cost = _localSearch.GetCellCost(_nodes[nodes[i]].Cell);
+
+                if (!float.IsPositiveInfinity(cost))
+                {
+                    _endCosts.Add(nodes[i], cost);
+                }
+            }
+        }
+
+        //waypoints next to each other are either in one cluster or a step over a border
+        internal bool RefineSegment(int fromCell, int toCell, List<int> result)
+        {
+            if (!_grid.IsWalkable(fromCell) || !_grid.IsWalkable(toCell))
+            {
+                return false;
+            }
+
+            int cluster = GetCluster(fromCell);
+
+            if (cluster != GetCluster(toCell))
+            {
+                result.Add(toCell);
+                return true;
+            }
+
+            if (!_localSearch.Search(_grid, _clusters[cluster].Area, fromCell, toCell))
+            {
+                return false;
+            }
+
+            _localSearch.AddPathCells(toCell, result);
+
+            return true;
+        }
+
+        private int GetCluster(int cell)
+        {
+            int width = _grid.Width;
+
+            return (cell / width / ClusterSize) * _clusterCountX + (cell % width) / ClusterSize;
+        }
+
+        private float Heuristic(int cell, int endCell)
+        {
+            int width = _grid.Width;
+
+            return GridPathfindingContext.Heuristic(cell % width, cell / width, endCell % width, endCell / width);
+        }
+
+        private sealed class Cluster
+        {
+            public GridArea Area { get; private set; }
+            public List<int> Nodes { get; private set; }
+
+            public Cluster(GridArea area)
+            {
+                Area = area;
+                Nodes = new List<int>();
+            }
+        }
+
+        private sealed class AbstractNode
+        {
+            public int Cell;
+            public int Cluster;
+
+            //transitions on this cell, a cell at the corner of a cluster may be on two borders
+            public int BorderCount;
+
+            public List<AbstractEdge> Edges = new List<AbstractEdge>(8);
+        }
+
+        private struct AbstractEdge
+        {
+            public int Node;
+            public float Cost;
+
+            public AbstractEdge(int node, float cost)
+            {
+                Node = node;
+                Cost = cost;
+            }
+        }
+    }
+}
@@ -31,39 +31,11 @@ using Swarm2D.Library;
 
 namespace Swarm2D.Engine.Logic
 {
+    //nodes are shared by every search, so they keep no search state. searches keep it by NavigationIndex,
+    //which must be unique, non negative and small within the world of the node
     public interface INavigableNode
     {
-        void ResetPathfinding();
-
-        INavigableNode ParentNode
-        {
-            get;
-            set;
-        }
-
-        LinkedListNode<INavigableNode> ListNode
-        {
-            get;
-            set;
-        }
-
-        NodePathInfo PathInfo
-        {
-            get;
-            set;
-        }
-
-        float HeuristicCostToEnd
-        {
-            get;
-            set;
-        }
-
-        float MovementCostToHere
-        {
-            get;
-            set;
-        }
+        int NavigationIndex { get; }
 
         List<INavigableNode> Neighbours
         {
@@ -74,18 +46,4 @@ namespace Swarm2D.Engine.Logic
 
         INavigableWorld NavigableWorld { get; }
     }
-
-    static class NavigableNodeExtensions
-    {
-        internal static float GetTotalCost(this INavigableNode navigableNode)
-        {
-            return navigableNode.MovementCostToHere + navigableNode.HeuristicCostToEnd;
-        }
-    }
-    public enum NodePathInfo
-    {
-        Undefined,
-        Closed,
-        Opened
-    }
 }
@@ -34,15 +34,4 @@ namespace Swarm2D.Engine.Logic
     {
         IEnumerable<INavigableNode> NavigableNodes { get; }
     }
-
-    static class NavigableWorldExtensions
-    {
-        internal static void ResetPathCalculations(this INavigableWorld navigableWorld)
-        {
-            foreach (INavigableNode navigableNode in navigableWorld.NavigableNodes)
-            {
-                navigableNode.ResetPathfinding();
-            }
-        }
-    }
 }
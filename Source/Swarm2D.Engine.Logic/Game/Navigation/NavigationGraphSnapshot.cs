@@ -0,0 +1,120 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //copy of the nodes and the links of a world taken on the main thread. worker threads search on it while the game
+    //changes the world, it is never modified after it is built
+    internal sealed class NavigationGraphSnapshot : INavigableWorld
+    {
+        private SnapshotNode[] _nodes;
+        private List<INavigableNode> _nodeList;
+
+        public NavigationGraphSnapshot(INavigableWorld navigableWorld)
+        {
+            _nodes = new SnapshotNode[64];
+            _nodeList = new List<INavigableNode>();
+
+            foreach (INavigableNode sourceNode in navigableWorld.NavigableNodes)
+            {
+                int index = sourceNode.NavigationIndex;
+
+                if (index >= _nodes.Length)
+                {
+                    Array.Resize(ref _nodes, Math.Max(index + 1, _nodes.Length * 2));
+                }
+
+                SnapshotNode node = new SnapshotNode(this, sourceNode);
+
+                _nodes[index] = node;
+                _nodeList.Add(node);
+            }
+
+            for (int i = 0; i < _nodeList.Count; i++)
+            {
+                SnapshotNode node = (SnapshotNode)_nodeList[i];
+                List<INavigableNode> sourceNeighbours = node.Source.Neighbours;
+
+                for (int j = 0; j < sourceNeighbours.Count; j++)
+                {
+                    //links to nodes the world does not list are dropped
+                    SnapshotNode neighbour = sourceNeighbours[j] != null ? Find(sourceNeighbours[j]) : null;
+
+                    if (neighbour != null)
+                    {
+                        node.Neighbours.Add(neighbour);
+                    }
+                }
+            }
+        }
+
+        public IEnumerable<INavigableNode> NavigableNodes
+        {
+            get { return _nodeList; }
+        }
+
+        public int NodeCount
+        {
+            get { return _nodeList.Count; }
+        }
+
+        public SnapshotNode Find(INavigableNode sourceNode)
+        {
+            int index = sourceNode.NavigationIndex;
+
+            if (index < 0 || index >= _nodes.Length || _nodes[index] == null || _nodes[index].Source != sourceNode)
+            {
+                return null;
+            }
+
+            return _nodes[index];
+        }
+    }
+
+    internal sealed class SnapshotNode : INavigableNode
+    {
+        public INavigableNode Source { get; private set; }
+
+        public int NavigationIndex { get; private set; }
+        public List<INavigableNode> Neighbours { get; private set; }
+        public Vector2 Position { get; private set; }
+        public INavigableWorld NavigableWorld { get; private set; }
+
+        public SnapshotNode(NavigationGraphSnapshot snapshot, INavigableNode source)
+        {
+            Source = source;
+            NavigationIndex = source.NavigationIndex;
+            Neighbours = new List<INavigableNode>(source.Neighbours.Count);
+            Position = source.Position;
+            NavigableWorld = snapshot;
+        }
+    }
+}
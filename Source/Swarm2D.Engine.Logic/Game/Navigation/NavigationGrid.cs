@@ -0,0 +1,219 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //walkable cells of a bounded map. a cell is blocked if it is a wall or any obstacle covers it, obstacles are counted
+    //so overlapping ones can be removed in any order. the recent changed areas are kept in a log, so everything built
+    //on the grid can catch up from the version it has seen
+    public sealed class NavigationGrid
+    {
+        //older changes are dropped, a reader further behind builds itself again
+        private const int MaxChangeCount = 4096;
+
+        private bool[] _walls;
+        private ushort[] _obstacleCounts;
+
+        private List<GridArea> _changes;
+        private int _firstChangeVersion;
+
+        public int Width { get; private set; }
+        public int Height { get; private set; }
+
+        public float CellSize { get; private set; }
+
+        //world position of the lower corner of the cell at 0, 0
+        public Vector2 Origin { get; private set; }
+
+        //counts the changes made so far
+        public int Version
+        {
+            get { return _firstChangeVersion + _changes.Count; }
+        }
+
+        public NavigationGrid(int width, int height, float cellSize, Vector2 origin)
+        {
+            Width = Math.Max(1, width);
+            Height = Math.Max(1, height);
+            CellSize = cellSize;
+            Origin = origin;
+
+            _walls = new bool[Width * Height];
+            _obstacleCounts = new ushort[Width * Height];
+
+            _changes = new List<GridArea>();
+            _firstChangeVersion = 0;
+        }
+
+        public bool IsWalkable(int x, int y)
+        {
+            return x >= 0 && y >= 0 && x < Width && y < Height && IsWalkable(y * Width + x);
+        }
+
+        internal bool IsWalkable(int cell)
+        {
+            return !_walls[cell] && _obstacleCounts[cell] == 0;
+        }
+
+        public void SetWalkable(int x, int y, bool walkable)
+        {
+            if (x < 0 || y < 0 || x >= Width || y >= Height)
+            {
+                return;
+            }
+
+            int cell = y * Width + x;
+
+            if (_walls[cell] == walkable)
+            {
+                _walls[cell] = !walkable;
+                AddChange(new GridArea(x, y, x, y));
+            }
+        }
+
+        //blocks the cells the box touches until the same box is removed
+        public void AddObstacle(Box box)
+        {
+            GridArea area;
+
+            if (GetArea(box, out area))
+            {
+                for (int y = area.MinY; y <= area.MaxY; y++)
+                {
+                    for (int x = area.MinX; x <= area.MaxX; x++)
+                    {
+                        Debug.Assert(_obstacleCounts[y * Width + x] < ushort.MaxValue, "too many obstacles on a navigation cell");
+
+                        _obstacleCounts[y * Width + x]++;
+                    }
+                }
+
+                AddChange(area);
+            }
+        }
+
+        public void RemoveObstacle(Box box)
+        {
+            GridArea area;
+
+            if (GetArea(box, out area))
+            {
+                for (int y = area.MinY; y <= area.MaxY; y++)
+                {
+                    for (int x = area.MinX; x <= area.MaxX; x++)
+                    {
+                        Debug.Assert(_obstacleCounts[y * Width + x] > 0, "removed an obstacle which was not added");
+
+                        _obstacleCounts[y * Width + x]--;
+                    }
+                }
+
+                AddChange(area);
+            }
+        }
+
+        //adds the areas changed since the version, false if the log does not go back that far
+        internal bool GetChanges(int version, List<GridArea> result)
+        {
+            if (version < _firstChangeVersion)
+            {
+                return false;
+            }
+
+            for (int i = version - _firstChangeVersion; i < _changes.Count; i++)
+            {
+                result.Add(_changes[i]);
+            }
+
+            return true;
+        }
+
+        private void AddChange(GridArea area)
+        {
+            if (_changes.Count == MaxChangeCount)
+            {
+                _changes.RemoveRange(0, MaxChangeCount / 2);
+                _firstChangeVersion += MaxChangeCount / 2;
+            }
+
+            _changes.Add(area);
+        }
+
+        //false if the position is outside of the grid
+        public bool WorldToCell(Vector2 position, out int x, out int y)
+        {
+            x = (int)Math.Floor((position.X - Origin.X) / CellSize);
+            y = (int)Math.Floor((position.Y - Origin.Y) / CellSize);
+
+            return x >= 0 && y >= 0 && x < Width && y < Height;
+        }
+
+        //center of the cell
+        public Vector2 CellToWorld(int x, int y)
+        {
+            return new Vector2(Origin.X + (x + 0.5f) * CellSize, Origin.Y + (y + 0.5f) * CellSize);
+        }
+
+        internal Vector2 CellToWorld(int cell)
+        {
+            return CellToWorld(cell % Width, cell / Width);
+        }
+
+        private bool GetArea(Box box, out GridArea area)
+        {
+            int minX = Math.Max(0, (int)Math.Floor((box.Position.X - Origin.X) / CellSize));
+            int minY = Math.Max(0, (int)Math.Floor((box.Position.Y - Origin.Y) / CellSize));
+            int maxX = Math.Min(Width - 1, (int)Math.Floor((box.Position.X + box.Size.X - Origin.X) / CellSize));
+            int maxY = Math.Min(Height - 1, (int)Math.Floor((box.Position.Y + box.Size.Y - Origin.Y) / CellSize));
+
+            area = new GridArea(minX, minY, maxX, maxY);
+
+            return minX <= maxX && minY <= maxY;
+        }
+    }
+
+    //inclusive rectangle of cells
+    internal struct GridArea
+    {
+        public int MinX;
+        public int MinY;
+        public int MaxX;
+        public int MaxY;
+
+        public GridArea(int minX, int minY, int maxX, int maxY)
+        {
+            MinX = minX;
+            MinY = minY;
+            MaxX = maxX;
+            MaxY = maxY;
+        }
+    }
+}
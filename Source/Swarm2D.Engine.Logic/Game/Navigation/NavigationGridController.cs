@@ -0,0 +1,156 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //keeps a navigation grid, its hierarchical pathfinder and flow fields in step with the static physics objects of
+    //the scene. a static body blocks the cells under its bounding box as it was when the body was added
+    public class NavigationGridController : SceneController
+    {
+        private PhysicsWorld _physicsWorld;
+        private int _staticBodyVersion;
+
+        private Dictionary<PhysicsObject, Obstacle> _obstacles;
+        private HashSet<PhysicsObject> _staticBodies;
+        private List<PhysicsObject> _removedObstacles;
+
+        public NavigationGrid Grid { get; private set; }
+        public HierarchicalPathfinder Pathfinder { get; private set; }
+        public FlowFieldCache FlowFields { get; private set; }
+
+        protected override void OnAdded()
+        {
+            base.OnAdded();
+
+            _physicsWorld = null;
+            _obstacles = new Dictionary<PhysicsObject, Obstacle>();
+            _staticBodies = new HashSet<PhysicsObject>();
+            _removedObstacles = new List<PhysicsObject>();
+
+            Grid = null;
+            Pathfinder = null;
+            FlowFields = null;
+        }
+
+        public void Initialize(int width, int height, float cellSize, Vector2 origin, int clusterSize = 16, int flowFieldCapacity = 8)
+        {
+            Grid = new NavigationGrid(width, height, cellSize, origin);
+
+            _physicsWorld = GetComponent<PhysicsWorld>();
+            _obstacles.Clear();
+
+            if (_physicsWorld != null)
+            {
+                _staticBodyVersion = _physicsWorld.StaticBodyVersion - 1;
+            }
+
+            UpdateObstacles();
+
+            Pathfinder = new HierarchicalPathfinder(Grid, clusterSize);
+            FlowFields = new FlowFieldCache(Grid, flowFieldCapacity);
+        }
+
+        [EntityMessageHandler(MessageType = typeof(SceneControllerUpdateMessage))]
+        private void OnUpdate(Message message)
+        {
+            if (Grid != null)
+            {
+                UpdateObstacles();
+                Pathfinder.Update();
+            }
+        }
+
+        //runs on every update, static bodies added in this frame need it before a query in the same frame
+        public void UpdateObstacles()
+        {
+            if (_physicsWorld == null || _physicsWorld.StaticBodyVersion == _staticBodyVersion)
+            {
+                return;
+            }
+
+            _staticBodyVersion = _physicsWorld.StaticBodyVersion;
+            _staticBodies.Clear();
+
+            foreach (PhysicsObject staticBody in _physicsWorld.StaticBodies)
+            {
+                _staticBodies.Add(staticBody);
+
+                Obstacle obstacle;
+
+                //a pooled physics object may have come back as another body, its generation is new then
+                if (_obstacles.TryGetValue(staticBody, out obstacle))
+                {
+                    if (obstacle.PhysicsGeneration == staticBody.PhysicsGeneration)
+                    {
+                        continue;
+                    }
+
+                    Grid.RemoveObstacle(obstacle.Bounds);
+                }
+
+                staticBody.CheckAndMakeTransformation();
+
+                ShapeInstance shapeData = staticBody.ShapeData;
+
+                obstacle.PhysicsGeneration = staticBody.PhysicsGeneration;
+                obstacle.Bounds.Position = new Vector2(shapeData.MinX, shapeData.MinY);
+                obstacle.Bounds.Size = new Vector2(shapeData.MaxX - shapeData.MinX, shapeData.MaxY - shapeData.MinY);
+
+                Grid.AddObstacle(obstacle.Bounds);
+                _obstacles[staticBody] = obstacle;
+            }
+
+            foreach (KeyValuePair<PhysicsObject, Obstacle> pair in _obstacles)
+            {
+                if (!_staticBodies.Contains(pair.Key))
+                {
+                    _removedObstacles.Add(pair.Key);
+                }
+            }
+
+            for (int i = 0; i < _removedObstacles.Count; i++)
+            {
+                Grid.RemoveObstacle(_obstacles[_removedObstacles[i]].Bounds);
+                _obstacles.Remove(_removedObstacles[i]);
+            }
+
+            _removedObstacles.Clear();
+            _staticBodies.Clear();
+        }
+
+        private struct Obstacle
+        {
+            public int PhysicsGeneration;
+            public Box Bounds;
+        }
+    }
+}
@@ -33,163 +33,47 @@ namespace Swarm2D.Engine.Logic
 {
     public class NavigationPath
     {
-        private INavigableNode _startNode;
-        private INavigableNode _endNode;
+        //searches without a context of their own share one per thread
+        [ThreadStatic]
+        private static PathfindingContext _threadContext;
 
         private List<INavigableNode> _pathNodes;
-        private LinkedList<INavigableNode> _openNodes;
-
-        private INavigableWorld _navigableWorld;
 
         public NavigationPath(INavigableNode startNode, INavigableNode endNode)
+            : this(startNode, endNode, GetThreadContext())
         {
-            _navigableWorld = startNode.NavigableWorld;
-
-            _startNode = startNode;
-            _endNode = endNode;
-
-            _pathNodes = new List<INavigableNode>(512);
-            _openNodes = new LinkedList<INavigableNode>();
-
-            GeneratePath();
-        }
-
-        private void GeneratePath()
-        {
-            CloseNode(_startNode);
-
-            while (true)
-            {
-                INavigableNode currentNode = GetMinimalCostNode();
-
-                if (currentNode == _endNode)
-                {
-                    //found path
-                    CalculatePath();
-                    break;
-                }
-                else if (currentNode == null)
-                {
-                    // no possible path to there
-                    break;
-                }
-                else
-                {
-                    CloseNode(currentNode);
-                }
-            }
-
-            while (_openNodes.Count > 0)
-            {
-                _openNodes.RemoveLast();
-            }
-
-            _navigableWorld.ResetPathCalculations();
         }
 
-        protected void CalculatePath()
+        public NavigationPath(INavigableNode startNode, INavigableNode endNode, PathfindingContext context)
         {
-            INavigableNode currentNode = _endNode;
-
-            while (currentNode != null)
-            {
-                _pathNodes.Add(currentNode);
-                currentNode = currentNode.ParentNode;
-            }
-        }
-
-        private INavigableNode GetMinimalCostNode()
-        {
-            INavigableNode selectedNode = null;
-
-            if (_openNodes.Count > 0)
-            {
-                selectedNode = _openNodes.First.Value;
-            }
+            _pathNodes = new List<INavigableNode>(512);
 
-            return selectedNode;
+            context.FindPath(startNode, endNode, _pathNodes);
         }
 
-        private void CloseNode(INavigableNode closedNode)
+        //nodes of a path found elsewhere, from the end node to the start node
+        internal NavigationPath(List<INavigableNode> pathNodes)
         {
-            closedNode.PathInfo = NodePathInfo.Closed;
-
-            if (closedNode.ListNode != null)
-            {
-                _openNodes.Remove(closedNode.ListNode);
-                closedNode.ListNode = null;
-            }
-
-            foreach (INavigableNode navigableNode in closedNode.Neighbours)
-            {
-                OpenNode(closedNode, navigableNode);
-            }
+            _pathNodes = pathNodes;
         }
 
-        private void OpenNode(INavigableNode parentNode, INavigableNode openedNode)
+        private static PathfindingContext GetThreadContext()
         {
-            if (openedNode == null) return;
-            //if (!this.pathMap.IsMoveableByObject(OpenedCell.X, OpenedCell.Y)) return;
-
-            float newMovementCost = MovementCost(parentNode, openedNode) + parentNode.MovementCostToHere;
-            float newHeuristicCost = HeuristicFunction(openedNode, _endNode);
-            
-            if (openedNode.PathInfo == NodePathInfo.Opened)
+            if (_threadContext == null)
             {
-                float newTotalCost = newMovementCost + newHeuristicCost;
-
-                if (newTotalCost < openedNode.GetTotalCost())
-                {
-                    openedNode.HeuristicCostToEnd = newHeuristicCost;
-                    openedNode.MovementCostToHere = newMovementCost;
-                    openedNode.ParentNode = parentNode;
-                }
+                _threadContext = new PathfindingContext();
             }
-            else if (openedNode.PathInfo == NodePathInfo.Undefined)
-            {
-                openedNode.PathInfo = NodePathInfo.Opened;
-
-                INavigableNode foundNode = null;
-
-                openedNode.HeuristicCostToEnd = newHeuristicCost;
-                openedNode.MovementCostToHere = newMovementCost;
-                openedNode.ParentNode = parentNode;
-
-                foreach (INavigableNode currentNode in _openNodes)
-                {
-                    if (currentNode.GetTotalCost() > openedNode.GetTotalCost())
-                    {
-                        foundNode = currentNode;
-                        break;
-                    }
-                }
-
-                if (foundNode != null)
-                {
-                    openedNode.ListNode = _openNodes.AddBefore(foundNode.ListNode, openedNode);
-                }
-                else
-                {
-                    openedNode.ListNode = _openNodes.AddLast(openedNode);
-                }
-            }
-        }
 
-        private static float HeuristicFunction(INavigableNode currentNode, INavigableNode endNode)
-        {
-            return Vector2.Distance(currentNode.Position, endNode.Position);
-        }
-
-        private static float MovementCost(INavigableNode currentNode, INavigableNode neighbourNode)
-        {
-            return Vector2.Distance(currentNode.Position, neighbourNode.Position);
+            return _threadContext;
         }
 
+        //from the end node to the start node
         public INavigableNode this[int index]
         {
             get { return _pathNodes[index]; }
         }
 
+        //zero when there is no path
         public int NodeCount
         {
             get { return _pathNodes.Count; }
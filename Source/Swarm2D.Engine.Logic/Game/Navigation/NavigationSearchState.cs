@@ -0,0 +1,247 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Logic
+{
+    //the generation stamped node state and the indexed open heap of every A* search. nodes are plain indices, like the
+    //NavigationIndex of PathfindingContext, grid cells or the nodes of the hierarchical graph
+    internal sealed class NavigationSearchState
+    {
+        private const int ClosedHeapIndex = -1;
+
+        private int _search;
+
+        private int[] _searches;
+        private float[] _movementCosts;
+        private float[] _totalCosts;
+        private int[] _heapIndices;
+        private int[] _parents;
+
+        private int[] _heap;
+        private int _heapCount;
+
+        public NavigationSearchState(int capacity)
+        {
+            capacity = Math.Max(1, capacity);
+
+            _searches = new int[capacity];
+            _movementCosts = new float[capacity];
+            _totalCosts = new float[capacity];
+            _heapIndices = new int[capacity];
+            _parents = new int[capacity];
+
+            _heap = new int[64];
+        }
+
+        public int OpenCount
+        {
+            get { return _heapCount; }
+        }
+
+        public int Capacity
+        {
+            get { return _searches.Length; }
+        }
+
+        public void BeginSearch(int capacity)
+        {
+            EnsureCapacity(capacity);
+
+            _search++;
+
+            //on wrap around every node would look visited by an old search, so the stamps are cleared once
+            if (_search == int.MaxValue)
+            {
+                Array.Clear(_searches, 0, _searches.Length);
+                _search = 1;
+            }
+
+            _heapCount = 0;
+        }
+
+        //may be called during a search, the state of the visited nodes is kept
+        public void EnsureCapacity(int capacity)
+        {
+            if (capacity > _searches.Length)
+            {
+                capacity = Math.Max(capacity, _searches.Length * 2);
+
+                Array.Resize(ref _searches, capacity);
+                Array.Resize(ref _movementCosts, capacity);
+                Array.Resize(ref _totalCosts, capacity);
+                Array.Resize(ref _heapIndices, capacity);
+                Array.Resize(ref _parents, capacity);
+            }
+        }
+
+        public bool IsVisited(int index)
+        {
+            return _searches[index] == _search;
+        }
+
+        public bool IsClosed(int index)
+        {
+            return _searches[index] == _search && _heapIndices[index] == ClosedHeapIndex;
+        }
+
+        public float GetMovementCost(int index)
+        {
+            return _searches[index] == _search ? _movementCosts[index] : float.PositiveInfinity;
+        }
+
+        //-1 for the first node of the search
+        public int GetParent(int index)
+        {
+            return _parents[index];
+        }
+
+        //opens the node, or moves it up if it is open and this way is cheaper. with a consistent heuristic a closed node
+        //never gets cheaper, so it is left alone
+        public void Relax(int index, int parent, float movementCost, float heuristic)
+        {
+            if (_searches[index] != _search)
+            {
+                _searches[index] = _search;
+                _movementCosts[index] = movementCost;
+                _totalCosts[index] = movementCost + heuristic;
+                _parents[index] = parent;
+
+                if (_heapCount == _heap.Length)
+                {
+                    Array.Resize(ref _heap, _heap.Length * 2);
+                }
+
+                _heap[_heapCount] = index;
+                _heapIndices[index] = _heapCount;
+                _heapCount++;
+
+                SiftUp(_heapCount - 1);
+            }
+            else if (_heapIndices[index] != ClosedHeapIndex && movementCost < _movementCosts[index])
+            {
+                _totalCosts[index] = movementCost + heuristic;
+                _movementCosts[index] = movementCost;
+                _parents[index] = parent;
+
+                SiftUp(_heapIndices[index]);
+            }
+        }
+
+        public int Pop()
+        {
+            int result = _heap[0];
+            _heapIndices[result] = ClosedHeapIndex;
+
+            _heapCount--;
+
+            if (_heapCount > 0)
+            {
+                int last = _heap[_heapCount];
+
+                _heap[0] = last;
+                _heapIndices[last] = 0;
+
+                SiftDown(0);
+            }
+
+            return result;
+        }
+
+        private void SiftUp(int heapIndex)
+        {
+            int index = _heap[heapIndex];
+
+            while (heapIndex > 0)
+            {
+                int parentIndex = (heapIndex - 1) >> 1;
+                int parent = _heap[parentIndex];
+
+                if (!IsBefore(index, parent))
+                {
+                    break;
+                }
+
+                _heap[heapIndex] = parent;
+                _heapIndices[parent] = heapIndex;
+
+                heapIndex = parentIndex;
+            }
+
+            _heap[heapIndex] = index;
+            _heapIndices[index] = heapIndex;
+        }
+
+        private void SiftDown(int heapIndex)
+        {
+            int index = _heap[heapIndex];
+
+            while (true)
+            {
+                int childIndex = heapIndex * 2 + 1;
+
+                if (childIndex >= _heapCount)
+                {
+                    break;
+                }
+
+                if (childIndex + 1 < _heapCount && IsBefore(_heap[childIndex + 1], _heap[childIndex]))
+                {
+                    childIndex++;
+                }
+
+                int child = _heap[childIndex];
+
+                if (!IsBefore(child, index))
+                {
+                    break;
+                }
+
+                _heap[heapIndex] = child;
+                _heapIndices[child] = heapIndex;
+
+                heapIndex = childIndex;
+            }
+
+            _heap[heapIndex] = index;
+            _heapIndices[index] = heapIndex;
+        }
+
+        //ties go to the node farther from the start, which is usually closer to the end
+        private bool IsBefore(int a, int b)
+        {
+            if (_totalCosts[a] != _totalCosts[b])
+            {
+                return _totalCosts[a] < _totalCosts[b];
+            }
+
+            return _movementCosts[a] > _movementCosts[b];
+        }
+    }
+}
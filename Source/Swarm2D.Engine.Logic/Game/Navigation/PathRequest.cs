@@ -0,0 +1,102 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Logic
+{
+    //the result of a path asked from a PathfindingService, filled on the main thread when its search is over.
+    //identical requests share a search but each has a request of its own, cancelling one leaves the others as they are
+    public sealed class PathRequest
+    {
+        private PathfindingService _service;
+
+        internal PathSearch Search { get; set; }
+        internal FindPathTask Task { get; set; }
+
+        public INavigableNode StartNode { get; private set; }
+        public INavigableNode EndNode { get; private set; }
+        public int Priority { get; private set; }
+
+        public PathRequestStatus Status { get; private set; }
+
+        //set when the status is Found
+        public NavigationPath Path { get; private set; }
+
+        //called on the main thread once the request is found, not found or cancelled
+        public Action<PathRequest> Completed { get; set; }
+
+        internal PathRequest(PathfindingService service, INavigableNode startNode, INavigableNode endNode, int priority)
+        {
+            _service = service;
+
+            StartNode = startNode;
+            EndNode = endNode;
+            Priority = priority;
+            Status = PathRequestStatus.Pending;
+        }
+
+        public bool IsDone
+        {
+            get { return Status != PathRequestStatus.Pending; }
+        }
+
+        public void Cancel()
+        {
+            if (!IsDone)
+            {
+                _service.Cancel(this);
+            }
+        }
+
+        internal void Complete(PathRequestStatus status, NavigationPath path)
+        {
+            Status = status;
+            Path = path;
+            Search = null;
+
+            if (Completed != null)
+            {
+                Completed(this);
+            }
+
+            if (Task != null)
+            {
+                Task.OnRequestCompleted();
+            }
+        }
+    }
+
+    public enum PathRequestStatus
+    {
+        Pending,
+        Found,
+        NotFound,
+        Cancelled
+    }
+}
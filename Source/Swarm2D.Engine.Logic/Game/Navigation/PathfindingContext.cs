@@ -0,0 +1,181 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //A* over INavigableNodes. the state of the nodes is kept in a NavigationSearchState by NavigationIndex, so a new
+    //search starts without clearing anything and a cheaper way to an open node moves it up the heap in place.
+    //a context runs one search at a time, concurrent searches need one context each. a search may be stepped a few
+    //nodes at a time, so it can be spread over frames
+    public sealed class PathfindingContext
+    {
+        private NavigationSearchState _state;
+
+        //the node of every NavigationIndex the state has seen
+        private INavigableNode[] _nodes;
+
+        private INavigableNode _endNode;
+        private Vector2 _endPosition;
+
+        public PathfindingStatus Status { get; private set; }
+
+        public PathfindingContext()
+            : this(1024)
+        {
+        }
+
+        public PathfindingContext(int nodeCapacity)
+        {
+            _state = new NavigationSearchState(nodeCapacity);
+            _nodes = new INavigableNode[_state.Capacity];
+        }
+
+        //nodes from the end to the start are added to the result, nothing is added when there is no path
+        public bool FindPath(INavigableNode startNode, INavigableNode endNode, List<INavigableNode> result)
+        {
+            BeginSearch(startNode, endNode);
+            Step(int.MaxValue);
+
+            return GetPath(result);
+        }
+
+        public void BeginSearch(INavigableNode startNode, INavigableNode endNode)
+        {
+            //a search may have been left before it was over, the state drops its open nodes
+            _state.BeginSearch(0);
+            _endNode = endNode;
+            _endPosition = endNode.Position;
+
+            int startIndex = startNode.NavigationIndex;
+            EnsureCapacity(startIndex);
+
+            _nodes[startIndex] = startNode;
+            _state.Relax(startIndex, -1, 0.0f, Vector2.Distance(startNode.Position, _endPosition));
+
+            Status = PathfindingStatus.Searching;
+        }
+
+        //expands at most the given number of nodes and returns what the search came to
+        public PathfindingStatus Step(int maxExpandedNodeCount)
+        {
+            if (Status != PathfindingStatus.Searching)
+            {
+                return Status;
+            }
+
+            NavigationSearchState state = _state;
+            INavigableNode endNode = _endNode;
+            Vector2 endPosition = _endPosition;
+
+            for (int expandedNodeCount = 0; expandedNodeCount < maxExpandedNodeCount; expandedNodeCount++)
+            {
+                if (state.OpenCount == 0)
+                {
+                    Status = PathfindingStatus.NotFound;
+                    break;
+                }
+
+                int currentIndex = state.Pop();
+                INavigableNode currentNode = _nodes[currentIndex];
+
+                if (currentNode == endNode)
+                {
+                    Status = PathfindingStatus.Found;
+                    break;
+                }
+
+                float movementCost = state.GetMovementCost(currentIndex);
+                Vector2 position = currentNode.Position;
+
+                List<INavigableNode> neighbours = currentNode.Neighbours;
+
+                for (int i = 0; i < neighbours.Count; i++)
+                {
+                    INavigableNode neighbour = neighbours[i];
+
+                    if (neighbour == null)
+                    {
+                        continue;
+                    }
+
+                    int index = neighbour.NavigationIndex;
+                    EnsureCapacity(index);
+
+                    float newMovementCost = movementCost + Vector2.Distance(position, neighbour.Position);
+
+                    //unvisited nodes cost infinity, so the heuristic is only computed for nodes that are relaxed
+                    if (newMovementCost < state.GetMovementCost(index))
+                    {
+                        _nodes[index] = neighbour;
+                        state.Relax(index, currentIndex, newMovementCost, Vector2.Distance(neighbour.Position, endPosition));
+                    }
+                }
+            }
+
+            return Status;
+        }
+
+        //nodes from the end to the start are added to the result if the search found a path
+        public bool GetPath(List<INavigableNode> result)
+        {
+            if (Status != PathfindingStatus.Found)
+            {
+                return false;
+            }
+
+            for (int index = _endNode.NavigationIndex; index >= 0; index = _state.GetParent(index))
+            {
+                result.Add(_nodes[index]);
+            }
+
+            return true;
+        }
+
+        private void EnsureCapacity(int index)
+        {
+            Debug.Assert(index >= 0, "NavigationIndex must not be negative");
+
+            if (index >= _nodes.Length)
+            {
+                _state.EnsureCapacity(index + 1);
+                Array.Resize(ref _nodes, _state.Capacity);
+            }
+        }
+    }
+
+    public enum PathfindingStatus
+    {
+        Idle,
+        Searching,
+        Found,
+        NotFound
+    }
+}
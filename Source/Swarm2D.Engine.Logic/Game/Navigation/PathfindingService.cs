@@ -0,0 +1,502 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //finds paths on the worker threads of the job system against a snapshot of the navigable world and hands the
+    //results over on the main thread. a job steps its search once and schedules itself again, so the main thread
+    //running jobs while it waits for its own never runs more than one step of a search. without worker threads the searches are stepped on the main thread within
+    //TimeSliceMilliseconds each frame
+    public class PathfindingService : SceneController
+    {
+        private const int WorkerStepNodeCount = 1024;
+        private const int TimeSliceStepNodeCount = 256;
+
+        private INavigableWorld _navigableWorld;
+        private NavigationGraphSnapshot _snapshot;
+        private bool _snapshotDirty;
+
+        //searches that are not over yet, by their start and end nodes, so identical requests share one search
+        private Dictionary<long, PathSearch> _searches;
+
+        //sorted so the search to start next is at the end
+        private List<PathSearch> _pendingSearches;
+        private bool _pendingSearchesDirty;
+        private Comparison<PathSearch> _pendingSearchComparison;
+
+        private List<PathSearch> _runningSearches;
+        private long _nextSequence;
+
+        //contexts of the finished searches, a running search keeps its context from job to job
+        private Stack<PathfindingContext> _searchContexts;
+        private PathfindingContext _mainThreadContext;
+        private PathSearch _timeSlicedSearch;
+
+        //the world the paths are searched on, call InvalidateNavigationGraph after its nodes or links change
+        public INavigableWorld NavigableWorld
+        {
+            get { return _navigableWorld; }
+            set
+            {
+                _navigableWorld = value;
+                InvalidateNavigationGraph();
+            }
+        }
+
+        [ComponentProperty]
+        public bool UseWorkerThreads { get; set; }
+
+        //main thread time spent on searches each frame when they can not run on worker threads
+        [ComponentProperty]
+        public float TimeSliceMilliseconds { get; set; }
+
+        public int PendingSearchCount
+        {
+            get { return _pendingSearches.Count; }
+        }
+
+        public int RunningSearchCount
+        {
+            get { return _runningSearches.Count + (_timeSlicedSearch != null ? 1 : 0); }
+        }
+
+        protected override void OnAdded()
+        {
+            base.OnAdded();
+
+            _navigableWorld = null;
+            _snapshot = null;
+            _snapshotDirty = false;
+
+            _searches = new Dictionary<long, PathSearch>();
+            _pendingSearches = new List<PathSearch>();
+            _pendingSearchesDirty = false;
+            _pendingSearchComparison = ComparePendingSearches;
+            _runningSearches = new List<PathSearch>();
+            _nextSequence = 0;
+
+            _searchContexts = new Stack<PathfindingContext>();
+            _mainThreadContext = new PathfindingContext();
+            _timeSlicedSearch = null;
+
+            UseWorkerThreads = true;
+            TimeSliceMilliseconds = 2.0f;
+        }
+
+        protected override void OnDestroy()
+        {
+            CancelAll();
+
+            base.OnDestroy();
+        }
+
+        //searches already started keep the graph they started with, the next requests see the new one
+        public void InvalidateNavigationGraph()
+        {
+            _snapshotDirty = true;
+            _searches.Clear();
+        }
+
+        public PathRequest RequestPath(INavigableNode startNode, INavigableNode endNode, int priority = 0)
+        {
+            UpdateSnapshot();
+
+            PathRequest request = new PathRequest(this, startNode, endNode, priority);
+
+            SnapshotNode start = _snapshot != null && startNode != null ? _snapshot.Find(startNode) : null;
+            SnapshotNode end = _snapshot != null && endNode != null ? _snapshot.Find(endNode) : null;
+
+            PathSearch search;
+
+            if (start == null || end == null)
+            {
+                //nodes that are not in the navigable world are reported as not found on the next update
+                search = new PathSearch(this, null, null, priority, _nextSequence++);
+                search.IsCompleted = true;
+                _runningSearches.Add(search);
+            }
+            else
+            {
+                long key = ((long)start.NavigationIndex << 32) | (uint)end.NavigationIndex;
+
+                if (_searches.TryGetValue(key, out search))
+                {
+                    if (priority > search.Priority && !search.IsStarted)
+                    {
+                        search.Priority = priority;
+                        _pendingSearchesDirty = true;
+                    }
+                }
+                else
+                {
+                    search = new PathSearch(this, start, end, priority, _nextSequence++);
+                    search.Key = key;
+
+                    _searches.Add(key, search);
+                    _pendingSearches.Add(search);
+                    _pendingSearchesDirty = true;
+                }
+            }
+
+            search.Requests.Add(request);
+            request.Search = search;
+
+            return request;
+        }
+
+        internal void Cancel(PathRequest request)
+        {
+            PathSearch search = request.Search;
+
+            search.Requests.Remove(request);
+
+            if (search.Requests.Count == 0)
+            {
+                //a running search stops at its next step, a pending one is skipped when it comes up
+                search.IsCancelled = true;
+                RemoveSearch(search);
+            }
+
+            request.Complete(PathRequestStatus.Cancelled, null);
+        }
+
+        public void CancelAll()
+        {
+            CancelSearches(_pendingSearches);
+            CancelSearches(_runningSearches);
+
+            if (_timeSlicedSearch != null)
+            {
+                _timeSlicedSearch.IsCancelled = true;
+                CompleteRequests(_timeSlicedSearch, PathRequestStatus.Cancelled, null);
+                _timeSlicedSearch = null;
+            }
+
+            _searches.Clear();
+        }
+
+        private void CancelSearches(List<PathSearch> searches)
+        {
+            for (int i = 0; i < searches.Count; i++)
+            {
+                searches[i].IsCancelled = true;
+                CompleteRequests(searches[i], PathRequestStatus.Cancelled, null);
+            }
+
+            searches.Clear();
+        }
+
+        [EntityMessageHandler(MessageType = typeof(SceneControllerUpdateMessage))]
+        private void OnUpdate(Message message)
+        {
+            UpdateSnapshot();
+
+            JobSystem jobSystem = Framework.Current.JobSystem;
+
+            if (UseWorkerThreads && jobSystem.WorkerCount > 0)
+            {
+                DeliverCompletedSearches();
+                StartSearches(jobSystem);
+            }
+            else
+            {
+                DeliverCompletedSearches();
+                StepTimeSlicedSearches();
+            }
+        }
+
+        private void UpdateSnapshot()
+        {
+            if (_snapshotDirty)
+            {
+                _snapshot = _navigableWorld != null ? new NavigationGraphSnapshot(_navigableWorld) : null;
+                _snapshotDirty = false;
+            }
+        }
+
+        private void StartSearches(JobSystem jobSystem)
+        {
+            //a few searches in flight keep the workers busy while the rest wait in the order of their priority
+            int maxRunningSearchCount = jobSystem.WorkerCount * 2;
+
+            while (_runningSearches.Count < maxRunningSearchCount)
+            {
+                PathSearch search = PopPendingSearch();
+
+                if (search == null)
+                {
+                    break;
+                }
+
+                search.Context = _searchContexts.Count > 0 ? _searchContexts.Pop() : new PathfindingContext();
+                search.Context.BeginSearch(search.StartNode, search.EndNode);
+
+                search.IsStarted = true;
+                _runningSearches.Add(search);
+                jobSystem.Schedule(search.Job);
+            }
+        }
+
+        //runs on any thread of the job system, it only reads the snapshot and writes the search
+        internal void RunSearch(PathSearch search)
+        {
+            PathfindingContext context = search.Context;
+            PathfindingStatus status = PathfindingStatus.Searching;
+
+            if (!search.IsCancelled)
+            {
+                status = context.Step(WorkerStepNodeCount);
+
+                if (status == PathfindingStatus.Searching)
+                {
+                    Framework.Current.JobSystem.Schedule(search.Job);
+                    return;
+                }
+            }
+
+            if (status == PathfindingStatus.Found)
+            {
+                context.GetPath(search.Result);
+                search.IsFound = true;
+            }
+
+            search.IsCompleted = true;
+        }
+
+        private void StepTimeSlicedSearches()
+        {
+            long startTicks = Stopwatch.GetTimestamp();
+            long budgetTicks = (long)(TimeSliceMilliseconds * Stopwatch.Frequency / 1000.0);
+
+            do
+            {
+                if (_timeSlicedSearch == null)
+                {
+                    _timeSlicedSearch = PopPendingSearch();
+
+                    if (_timeSlicedSearch == null)
+                    {
+                        break;
+                    }
+
+                    _timeSlicedSearch.IsStarted = true;
+                    _mainThreadContext.BeginSearch(_timeSlicedSearch.StartNode, _timeSlicedSearch.EndNode);
+                }
+                else if (_timeSlicedSearch.IsCancelled)
+                {
+                    _timeSlicedSearch = null;
+                    continue;
+                }
+
+                PathfindingStatus status = _mainThreadContext.Step(TimeSliceStepNodeCount);
+
+                if (status != PathfindingStatus.Searching)
+                {
+                    PathSearch search = _timeSlicedSearch;
+                    _timeSlicedSearch = null;
+
+                    if (status == PathfindingStatus.Found)
+                    {
+                        _mainThreadContext.GetPath(search.Result);
+                        search.IsFound = true;
+                    }
+
+                    search.IsCompleted = true;
+                    DeliverSearch(search);
+                }
+            }
+            while (Stopwatch.GetTimestamp() - startTicks < budgetTicks);
+        }
+
+        private PathSearch PopPendingSearch()
+        {
+            if (_pendingSearchesDirty)
+            {
+                _pendingSearches.Sort(_pendingSearchComparison);
+                _pendingSearchesDirty = false;
+            }
+
+            while (_pendingSearches.Count > 0)
+            {
+                PathSearch search = _pendingSearches[_pendingSearches.Count - 1];
+                _pendingSearches.RemoveAt(_pendingSearches.Count - 1);
+
+                if (!search.IsCancelled)
+                {
+                    return search;
+                }
+            }
+
+            return null;
+        }
+
+        //higher priorities and then older searches go to the end
+        private static int ComparePendingSearches(PathSearch a, PathSearch b)
+        {
+            if (a.Priority != b.Priority)
+            {
+                return a.Priority.CompareTo(b.Priority);
+            }
+
+            return b.Sequence.CompareTo(a.Sequence);
+        }
+
+        private void DeliverCompletedSearches()
+        {
+            int runningSearchCount = 0;
+
+            for (int i = 0; i < _runningSearches.Count; i++)
+            {
+                PathSearch search = _runningSearches[i];
+
+                if (search.IsCompleted)
+                {
+                    DeliverSearch(search);
+                }
+                else
+                {
+                    _runningSearches[runningSearchCount] = search;
+                    runningSearchCount++;
+                }
+            }
+
+            _runningSearches.RemoveRange(runningSearchCount, _runningSearches.Count - runningSearchCount);
+        }
+
+        private void DeliverSearch(PathSearch search)
+        {
+            RemoveSearch(search);
+
+            if (search.Context != null)
+            {
+                _searchContexts.Push(search.Context);
+                search.Context = null;
+            }
+
+            if (search.IsCancelled)
+            {
+                return;
+            }
+
+            if (search.IsFound)
+            {
+                //back from the snapshot to the nodes of the world
+                List<INavigableNode> pathNodes = new List<INavigableNode>(search.Result.Count);
+
+                for (int i = 0; i < search.Result.Count; i++)
+                {
+                    pathNodes.Add(((SnapshotNode)search.Result[i]).Source);
+                }
+
+                CompleteRequests(search, PathRequestStatus.Found, new NavigationPath(pathNodes));
+            }
+            else
+            {
+                CompleteRequests(search, PathRequestStatus.NotFound, null);
+            }
+        }
+
+        private void RemoveSearch(PathSearch search)
+        {
+            PathSearch sharedSearch;
+
+            if (search.StartNode != null && _searches.TryGetValue(search.Key, out sharedSearch) && sharedSearch == search)
+            {
+                _searches.Remove(search.Key);
+            }
+        }
+
+        private static void CompleteRequests(PathSearch search, PathRequestStatus status, NavigationPath path)
+        {
+            //completion callbacks may request or cancel paths
+            PathRequest[] requests = search.Requests.ToArray();
+            search.Requests.Clear();
+
+            for (int i = 0; i < requests.Length; i++)
+            {
+                requests[i].Complete(status, path);
+            }
+        }
+    }
+
+    //one search shared by the identical requests made before it is over
+    internal sealed class PathSearch
+    {
+        public SnapshotNode StartNode { get; private set; }
+        public SnapshotNode EndNode { get; private set; }
+
+        public long Key { get; set; }
+        public int Priority { get; set; }
+        public long Sequence { get; private set; }
+
+        public List<PathRequest> Requests { get; private set; }
+        public bool IsStarted { get; set; }
+
+        //written by the thread running the search, the result is complete once IsCompleted is seen
+        public List<INavigableNode> Result { get; private set; }
+        public bool IsFound { get; set; }
+
+        //owned by the search while its jobs run
+        public PathfindingContext Context { get; set; }
+
+        private volatile bool _isCompleted;
+        private volatile bool _isCancelled;
+
+        public JobDelegate Job { get; private set; }
+
+        public PathSearch(PathfindingService service, SnapshotNode startNode, SnapshotNode endNode, int priority, long sequence)
+        {
+            StartNode = startNode;
+            EndNode = endNode;
+            Priority = priority;
+            Sequence = sequence;
+
+            Requests = new List<PathRequest>(1);
+            Result = new List<INavigableNode>();
+
+            Job = () => service.RunSearch(this);
+        }
+
+        public bool IsCompleted
+        {
+            get { return _isCompleted; }
+            set { _isCompleted = value; }
+        }
+
+        public bool IsCancelled
+        {
+            get { return _isCancelled; }
+            set { _isCancelled = value; }
+        }
+    }
+}
@@ -135,6 +135,41 @@ namespace Swarm2D.Engine.Logic
             return (worldPosition - CurrentCenter).Length <= RadiusWithTransformation;
         }
 
+        internal override bool Raycast(Vector2 origin, Vector2 displacement, out float fraction, out Vector2 normal)
+        {
+            fraction = 0.0f;
+            normal = Vector2.Zero;
+
+            Vector2 offset = origin - CurrentCenter;
+
+            float a = displacement.Dot(displacement);
+            float b = offset.Dot(displacement);
+            float c = offset.Dot(offset) - RadiusWithTransformation * RadiusWithTransformation;
+
+            if (c <= 0.0f)
+            {
+                normal = -1.0f * displacement.Normalized;
+                return true;
+            }
+
+            float discriminant = b * b - a * c;
+
+            if (b >= 0.0f || discriminant < 0.0f || Mathf.IsZero(a))
+            {
+                return false;
+            }
+
+            fraction = (-b - Mathf.Sqrt(discriminant)) / a;
+
+            if (fraction > 1.0f)
+            {
+                return false;
+            }
+
+            normal = (offset + displacement * fraction).Normalized;
+            return true;
+        }
+
         public override bool IsIntersects(LineSegment lineSegment)
         {
             Vector2 closestPoint = lineSegment.GetClosestPoint(CurrentCenter);
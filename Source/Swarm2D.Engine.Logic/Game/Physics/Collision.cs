@@ -40,15 +40,59 @@ namespace Swarm2D.Engine.Logic
         public PhysicsObject PhysicsObjectA { get; internal set; }
         public PhysicsObject PhysicsObjectB { get; internal set; }
 
-        internal LinkedListNode<Collision> NodeOnA { get; set; }
-        internal LinkedListNode<Collision> NodeOnB { get; set; }
-        internal LinkedListNode<Collision> NodeOnList { get; set; }
+        //packed ids of the pair, see ContactCache.GetKey
+        internal ulong Key { get; set; }
 
-        internal bool FoundOnCurrentUpdate { get; set; }
-        internal bool NewlyFoundOnCurrentUpdate { get; set; }
+        //index on the dense contact array of the cache and on the Collisions lists of both physics objects
+        internal int Index { get; set; }
+        internal int IndexOnA { get; set; }
+        internal int IndexOnB { get; set; }
+
+        internal int FirstFoundStep { get; set; }
+        internal int LastFoundStep { get; set; }
 
         internal Vector2 MinimumTranslation { get; set; }
 
+        //results of the previous step the contact was found on, kept for warm starting
+        internal Vector2 PreviousNormal { get; private set; }
+        internal Vector2 PreviousMinimumTranslation { get; private set; }
+
+        internal void Reset(PhysicsObject physicsObjectA, PhysicsObject physicsObjectB)
+        {
+            PhysicsObjectA = physicsObjectA;
+            PhysicsObjectB = physicsObjectB;
+
+            Key = 0;
+            Index = -1;
+            IndexOnA = -1;
+            IndexOnB = -1;
+            FirstFoundStep = 0;
+            LastFoundStep = 0;
+
+            IntersectionPoint = Vector2.Zero;
+            Normal = Vector2.Zero;
+            MinimumTranslation = Vector2.Zero;
+            PreviousNormal = Vector2.Zero;
+            PreviousMinimumTranslation = Vector2.Zero;
+        }
+
+        internal void Update(int step, Vector2 minimumTranslation, Vector2 intersectionPoint)
+        {
+            PreviousMinimumTranslation = MinimumTranslation;
+
+            //triggers produce no translation, a zero normal would only overwrite a useful one
+            if (!Mathf.IsZero(MinimumTranslation))
+            {
+                PreviousNormal = Normal;
+            }
+
+            MinimumTranslation = minimumTranslation;
+            Normal = minimumTranslation.Normalized;
+            IntersectionPoint = intersectionPoint;
+
+            LastFoundStep = step;
+        }
+
         private Vector2 _collisionPointOnA;
         private Vector2 _collisionPointOnB;
         private Vector2 _relativeVelocity;
@@ -0,0 +1,237 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //persistent contacts of a physics world, found by the packed ids of their physics objects in an open addressing table.
+    //contacts are also kept in a dense array for walking them, removed ones are released to a pool by the world
+    internal class ContactCache
+    {
+        //physics ids start from 1 so no pair packs to 0
+        private const ulong EmptyKey = 0;
+
+        private ulong[] _keys;
+        private Collision[] _values;
+        private int _shift;
+        private int _usedSlotCount;
+
+        private Collision[] _contacts;
+
+        private Stack<Collision> _freeContacts;
+
+        public int Count { get; private set; }
+
+        public int PooledCount
+        {
+            get { return _freeContacts.Count; }
+        }
+
+        internal ContactCache()
+        {
+            _keys = new ulong[1024];
+            _values = new Collision[1024];
+            _shift = 64 - 10;
+
+            _contacts = new Collision[512];
+            _freeContacts = new Stack<Collision>();
+        }
+
+        internal Collision this[int index]
+        {
+            get { return _contacts[index]; }
+        }
+
+        internal static ulong GetKey(PhysicsObject physicsObjectA, PhysicsObject physicsObjectB)
+        {
+            uint idA = (uint)physicsObjectA.PhysicsId;
+            uint idB = (uint)physicsObjectB.PhysicsId;
+
+            return idA < idB ? ((ulong)idA << 32) | idB : ((ulong)idB << 32) | idA;
+        }
+
+        private int GetSlot(ulong key)
+        {
+            //fibonacci hashing, the high bits of the product are well mixed
+            return (int)((key * 11400714819323198485UL) >> _shift);
+        }
+
+        internal Collision Find(PhysicsObject physicsObjectA, PhysicsObject physicsObjectB)
+        {
+            ulong key = GetKey(physicsObjectA, physicsObjectB);
+            int mask = _keys.Length - 1;
+
+            for (int slot = GetSlot(key); ; slot = (slot + 1) & mask)
+            {
+                ulong slotKey = _keys[slot];
+
+                if (slotKey == key)
+                {
+                    return _values[slot];
+                }
+
+                if (slotKey == EmptyKey)
+                {
+                    return null;
+                }
+            }
+        }
+
+        //the pair must not have a contact already
+        internal Collision Add(PhysicsObject physicsObjectA, PhysicsObject physicsObjectB)
+        {
+            if ((_usedSlotCount + 1) * 2 > _keys.Length)
+            {
+                Rehash(_keys.Length * 2);
+            }
+
+            Collision collision = _freeContacts.Count > 0 ? _freeContacts.Pop() : new Collision();
+            collision.Reset(physicsObjectA, physicsObjectB);
+            collision.Key = GetKey(physicsObjectA, physicsObjectB);
+
+            Insert(collision);
+
+            if (Count == _contacts.Length)
+            {
+                Array.Resize(ref _contacts, _contacts.Length * 2);
+            }
+
+            collision.Index = Count;
+            _contacts[Count] = collision;
+            Count++;
+
+            return collision;
+        }
+
+        private void Insert(Collision collision)
+        {
+            int mask = _keys.Length - 1;
+            int slot = GetSlot(collision.Key);
+
+            while (_keys[slot] != EmptyKey)
+            {
+                Debug.Assert(_keys[slot] != collision.Key, "contact pair is already in the cache");
+                slot = (slot + 1) & mask;
+            }
+
+            _keys[slot] = collision.Key;
+            _values[slot] = collision;
+            _usedSlotCount++;
+        }
+
+        //the contact keeps its data until it is released, so messages can still be sent for it
+        internal void Remove(Collision collision)
+        {
+            Debug.Assert(collision.Index >= 0 && _contacts[collision.Index] == collision, "contact is not in the cache");
+
+            RemoveKey(collision.Key);
+
+            Count--;
+
+            Collision lastCollision = _contacts[Count];
+            _contacts[collision.Index] = lastCollision;
+            lastCollision.Index = collision.Index;
+            _contacts[Count] = null;
+
+            collision.Index = -1;
+        }
+
+        internal void Release(Collision collision)
+        {
+            Debug.Assert(collision.Index < 0, "a contact in the cache is released");
+
+            collision.Reset(null, null);
+            _freeContacts.Push(collision);
+        }
+
+        private void RemoveKey(ulong key)
+        {
+            int mask = _keys.Length - 1;
+            int slot = GetSlot(key);
+
+            while (_keys[slot] != key)
+            {
+                slot = (slot + 1) & mask;
+            }
+
+            //backward shift deletion, entries after the hole move back unless they are already at or after their home slot
+            int current = (slot + 1) & mask;
+
+            while (_keys[current] != EmptyKey)
+            {
+                int home = GetSlot(_keys[current]);
+
+                bool staysInPlace = slot <= current ? (slot < home && home <= current) : (slot < home || home <= current);
+
+                if (!staysInPlace)
+                {
+                    _keys[slot] = _keys[current];
+                    _values[slot] = _values[current];
+                    slot = current;
+                }
+
+                current = (current + 1) & mask;
+            }
+
+            _keys[slot] = EmptyKey;
+            _values[slot] = null;
+            _usedSlotCount--;
+        }
+
+        private void Rehash(int capacity)
+        {
+            _keys = new ulong[capacity];
+            _values = new Collision[capacity];
+            _shift--;
+            _usedSlotCount = 0;
+
+            for (int i = 0; i < Count; i++)
+            {
+                Insert(_contacts[i]);
+            }
+        }
+
+        internal void Clear()
+        {
+            for (int i = 0; i < Count; i++)
+            {
+                _contacts[i].Index = -1;
+                Release(_contacts[i]);
+                _contacts[i] = null;
+            }
+
+            Array.Clear(_keys, 0, _keys.Length);
+            Array.Clear(_values, 0, _values.Length);
+
+            Count = 0;
+            _usedSlotCount = 0;
+        }
+    }
+}
@@ -0,0 +1,623 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Logic
+{
+    //bounding volume hierarchy of fattened AABBs, leaves are reinserted only when a body leaves its fat AABB.
+    //unbounded and insensitive to object size, suits sparse worlds, large static maps and mixed sizes
+    internal class DynamicAabbTreeBroadphase : IBroadphase
+    {
+        private const int NullNode = -1;
+
+        private struct TreeNode
+        {
+            public float MinX;
+            public float MinY;
+            public float MaxX;
+            public float MaxY;
+
+            //next free node while the node is in the free list
+            public int Parent;
+
+            public int Child1;
+            public int Child2;
+
+            //leaf = 0, free node = -1
+            public int Height;
+
+            public PhysicsObject PhysicsObject;
+
+            public bool IsLeaf
+            {
+                get { return Child1 == NullNode; }
+            }
+        }
+
+        private TreeNode[] _nodes;
+        private int _nodeCount;
+        private int _freeList;
+        private int _root;
+
+        private int[] _stack;
+
+        internal float Margin { get; private set; }
+
+        internal DynamicAabbTreeBroadphase(float margin)
+        {
+            Margin = margin;
+
+            _root = NullNode;
+            _nodes = new TreeNode[256];
+            _stack = new int[256];
+
+            BuildFreeList(0);
+        }
+
+        private void BuildFreeList(int start)
+        {
+            for (int i = start; i < _nodes.Length - 1; i++)
+            {
+                _nodes[i].Parent = i + 1;
+                _nodes[i].Height = -1;
+            }
+
+            _nodes[_nodes.Length - 1].Parent = NullNode;
+            _nodes[_nodes.Length - 1].Height = -1;
+
+            _freeList = start;
+        }
+
+        private int AllocateNode()
+        {
+            if (_freeList == NullNode)
+            {
+                int oldLength = _nodes.Length;
+
+                Array.Resize(ref _nodes, oldLength * 2);
+                BuildFreeList(oldLength);
+            }
+
+            int node = _freeList;
+            _freeList = _nodes[node].Parent;
+
+            _nodes[node].Parent = NullNode;
+            _nodes[node].Child1 = NullNode;
+            _nodes[node].Child2 = NullNode;
+            _nodes[node].Height = 0;
+            _nodes[node].PhysicsObject = null;
+
+            _nodeCount++;
+
+            return node;
+        }
+
+        private void FreeNode(int node)
+        {
+            _nodes[node].Parent = _freeList;
+            _nodes[node].Height = -1;
+            _nodes[node].PhysicsObject = null;
+
+            _freeList = node;
+            _nodeCount--;
+        }
+
+        public void AddPhysicsObject(PhysicsObject physicsObject)
+        {
+            //the leaf is created on the first transformation
+            physicsObject.BroadphaseProxy = NullNode;
+        }
+
+        public void RemovePhysicsObject(PhysicsObject physicsObject)
+        {
+            int leaf = physicsObject.BroadphaseProxy;
+
+            if (leaf != NullNode)
+            {
+                RemoveLeaf(leaf);
+                FreeNode(leaf);
+
+                physicsObject.BroadphaseProxy = NullNode;
+            }
+        }
+
+        public void UpdatePhysicsObject(PhysicsObject physicsObject)
+        {
+            ShapeInstance shapeData = physicsObject.ShapeData;
+
+            int leaf = physicsObject.BroadphaseProxy;
+
+            if (leaf == NullNode)
+            {
+                leaf = AllocateNode();
+
+                _nodes[leaf].PhysicsObject = physicsObject;
+                physicsObject.BroadphaseProxy = leaf;
+            }
+            else
+            {
+                if (_nodes[leaf].MinX <= shapeData.MinX && _nodes[leaf].MinY <= shapeData.MinY &&
+                    shapeData.MaxX <= _nodes[leaf].MaxX && shapeData.MaxY <= _nodes[leaf].MaxY)
+                {
+                    return;
+                }
+
+                RemoveLeaf(leaf);
+            }
+
+            _nodes[leaf].MinX = shapeData.MinX - Margin;
+            _nodes[leaf].MinY = shapeData.MinY - Margin;
+            _nodes[leaf].MaxX = shapeData.MaxX + Margin;
+            _nodes[leaf].MaxY = shapeData.MaxY + Margin;
+
+            InsertLeaf(leaf);
+        }
+
+        public void CollectPairs(LinkedList<PhysicsObject> rigidBodies, List<BroadphasePair> pairs)
+        {
+            LinkedListNode<PhysicsObject> currentRigidBodyNode = rigidBodies.First;
+
+            while (currentRigidBodyNode != null)
+            {
+                PhysicsObject rigidBody = currentRigidBodyNode.Value;
+
+                if (rigidBody.BroadphaseProxy != NullNode && !rigidBody.IsSleeping)
+                {
+                    CollectPairsOf(rigidBody, pairs);
+                }
+
+                currentRigidBodyNode = currentRigidBodyNode.Next;
+            }
+        }
+
+        private void CollectPairsOf(PhysicsObject rigidBody, List<BroadphasePair> pairs)
+        {
+            ShapeInstance shapeData = rigidBody.ShapeData;
+
+            float minX = shapeData.MinX;
+            float minY = shapeData.MinY;
+            float maxX = shapeData.MaxX;
+            float maxY = shapeData.MaxY;
+
+            TreeNode[] nodes = _nodes;
+
+            int stackCount = 0;
+            _stack[stackCount++] = _root;
+
+            while (stackCount > 0)
+            {
+                int node = _stack[--stackCount];
+
+                if (nodes[node].MinX > maxX || minX > nodes[node].MaxX || nodes[node].MinY > maxY || minY > nodes[node].MaxY)
+                {
+                    continue;
+                }
+
+                if (nodes[node].Child1 == NullNode)
+                {
+                    PhysicsObject physicsObject = nodes[node].PhysicsObject;
+
+                    //tight boxes are compared so both rigid bodies of a pair agree on it, then the smaller id adds it.
+                    //sleeping rigid bodies add no pairs, they are met like static bodies
+                    if (physicsObject != rigidBody &&
+                        (!physicsObject.IsAwakeRigidBody || rigidBody.PhysicsId < physicsObject.PhysicsId) &&
+                        rigidBody.CheckAABBWith(physicsObject))
+                    {
+                        pairs.Add(new BroadphasePair(rigidBody, physicsObject));
+                    }
+                }
+                else
+                {
+                    PushChildren(node, ref stackCount);
+                }
+            }
+        }
+
+        public void Query(float minX, float minY, float maxX, float maxY, List<PhysicsObject> result)
+        {
+            if (_root == NullNode)
+            {
+                return;
+            }
+
+            int stackCount = 0;
+            _stack[stackCount++] = _root;
+
+            while (stackCount > 0)
+            {
+                int node = _stack[--stackCount];
+
+                if (_nodes[node].MinX > maxX || minX > _nodes[node].MaxX || _nodes[node].MinY > maxY || minY > _nodes[node].MaxY)
+                {
+                    continue;
+                }
+
+                if (_nodes[node].IsLeaf)
+                {
+                    ShapeInstance shapeData = _nodes[node].PhysicsObject.ShapeData;
+
+                    if (shapeData.MinX <= maxX && minX <= shapeData.MaxX && shapeData.MinY <= maxY && minY <= shapeData.MaxY)
+                    {
+                        result.Add(_nodes[node].PhysicsObject);
+                    }
+                }
+                else
+                {
+                    PushChildren(node, ref stackCount);
+                }
+            }
+        }
+
+        public void Query(float minX, float minY, float maxX, float maxY, PhysicsObjectMarker marker, List<PhysicsObject> result)
+        {
+            int start = result.Count;
+
+            Query(minX, minY, maxX, maxY, result);
+
+            int count = start;
+
+            for (int i = start; i < result.Count; i++)
+            {
+                if (marker.Mark(result[i]))
+                {
+                    result[count++] = result[i];
+                }
+            }
+
+            result.RemoveRange(count, result.Count - count);
+        }
+
+        //the tree is not walked along the ray, the objects in the bounding box of the ray are tested
+        public void Raycast(RaycastQuery query)
+        {
+            float startX = query.Origin.X;
+            float startY = query.Origin.Y;
+            float endX = startX + query.Displacement.X;
+            float endY = startY + query.Displacement.Y;
+
+            query.Candidates.Clear();
+            Query(Math.Min(startX, endX), Math.Min(startY, endY), Math.Max(startX, endX), Math.Max(startY, endY), query.Candidates);
+
+            for (int i = 0; i < query.Candidates.Count; i++)
+            {
+                query.Test(query.Candidates[i]);
+            }
+        }
+
+        //the query shares one stack
+        public bool CanQueryInParallel
+        {
+            get { return false; }
+        }
+
+
+        private void PushChildren(int node, ref int stackCount)
+        {
+            if (stackCount + 2 > _stack.Length)
+            {
+                Array.Resize(ref _stack, _stack.Length * 2);
+            }
+
+            _stack[stackCount++] = _nodes[node].Child1;
+            _stack[stackCount++] = _nodes[node].Child2;
+        }
+
+        public void Reset()
+        {
+            for (int i = 0; i < _nodes.Length; i++)
+            {
+                if (_nodes[i].Height >= 0 && _nodes[i].PhysicsObject != null)
+                {
+                    _nodes[i].PhysicsObject.BroadphaseProxy = NullNode;
+                }
+
+                _nodes[i] = new TreeNode();
+            }
+
+            _root = NullNode;
+            _nodeCount = 0;
+
+            BuildFreeList(0);
+        }
+
+        #region Tree Maintenance
+
+        private static float Perimeter(float minX, float minY, float maxX, float maxY)
+        {
+            return 2.0f * ((maxX - minX) + (maxY - minY));
+        }
+
+        private float CombinedPerimeter(int nodeA, int nodeB)
+        {
+            return Perimeter(Math.Min(_nodes[nodeA].MinX, _nodes[nodeB].MinX), Math.Min(_nodes[nodeA].MinY, _nodes[nodeB].MinY),
+                Math.Max(_nodes[nodeA].MaxX, _nodes[nodeB].MaxX), Math.Max(_nodes[nodeA].MaxY, _nodes[nodeB].MaxY));
+        }
+
+        private void SetCombinedAabb(int node, int nodeA, int nodeB)
+        {
+            _nodes[node].MinX = Math.Min(_nodes[nodeA].MinX, _nodes[nodeB].MinX);
+            _nodes[node].MinY = Math.Min(_nodes[nodeA].MinY, _nodes[nodeB].MinY);
+            _nodes[node].MaxX = Math.Max(_nodes[nodeA].MaxX, _nodes[nodeB].MaxX);
+            _nodes[node].MaxY = Math.Max(_nodes[nodeA].MaxY, _nodes[nodeB].MaxY);
+        }
+
+        private float DescendCost(int child, int leaf, float inheritanceCost)
+        {
+            float cost = CombinedPerimeter(child, leaf) + inheritanceCost;
+
+            if (!_nodes[child].IsLeaf)
+            {
+                cost -= Perimeter(_nodes[child].MinX, _nodes[child].MinY, _nodes[child].MaxX, _nodes[child].MaxY);
+            }
+
+            return cost;
+        }
+
+        private void InsertLeaf(int leaf)
+        {
+            if (_root == NullNode)
+            {
+                _root = leaf;
+                _nodes[_root].Parent = NullNode;
+                return;
+            }
+
+            //finds the best sibling by the surface area heuristic, perimeter in 2d
+            int index = _root;
+
+            while (!_nodes[index].IsLeaf)
+            {
+                int child1 = _nodes[index].Child1;
+                int child2 = _nodes[index].Child2;
+
+                float perimeter = Perimeter(_nodes[index].MinX, _nodes[index].MinY, _nodes[index].MaxX, _nodes[index].MaxY);
+                float combinedPerimeter = CombinedPerimeter(index, leaf);
+
+                float cost = 2.0f * combinedPerimeter;
+                float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+                float cost1 = DescendCost(child1, leaf, inheritanceCost);
+                float cost2 = DescendCost(child2, leaf, inheritanceCost);
+
+                if (cost < cost1 && cost < cost2)
+                {
+                    break;
+                }
+
+                index = cost1 < cost2 ? child1 : child2;
+            }
+
+            int sibling = index;
+
+            int oldParent = _nodes[sibling].Parent;
+            int newParent = AllocateNode();
+
+            _nodes[newParent].Parent = oldParent;
+            _nodes[newParent].Height = _nodes[sibling].Height + 1;
+            SetCombinedAabb(newParent, sibling, leaf);
+
+            if (oldParent != NullNode)
+            {
+                if (_nodes[oldParent].Child1 == sibling)
+                {
+                    _nodes[oldParent].Child1 = newParent;
+                }
+                else
+                {
+                    _nodes[oldParent].Child2 = newParent;
+                }
+            }
+            else
+            {
+                _root = newParent;
+            }
+
+            _nodes[newParent].Child1 = sibling;
+            _nodes[newParent].Child2 = leaf;
+            _nodes[sibling].Parent = newParent;
+            _nodes[leaf].Parent = newParent;
+
+            RefitAncestors(_nodes[leaf].Parent);
+        }
+
+        private void RemoveLeaf(int leaf)
+        {
+            if (leaf == _root)
+            {
+                _root = NullNode;
+                return;
+            }
+
+            int parent = _nodes[leaf].Parent;
+            int grandParent = _nodes[parent].Parent;
+            int sibling = _nodes[parent].Child1 == leaf ? _nodes[parent].Child2 : _nodes[parent].Child1;
+
+            if (grandParent != NullNode)
+            {
+                if (_nodes[grandParent].Child1 == parent)
+                {
+                    _nodes[grandParent].Child1 = sibling;
+                }
+                else
+                {
+                    _nodes[grandParent].Child2 = sibling;
+                }
+
+                _nodes[sibling].Parent = grandParent;
+                FreeNode(parent);
+
+                RefitAncestors(grandParent);
+            }
+            else
+            {
+                _root = sibling;
+                _nodes[sibling].Parent = NullNode;
+                FreeNode(parent);
+            }
+        }
+
+        private void RefitAncestors(int index)
+        {
+            while (index != NullNode)
+            {
+                index = Balance(index);
+
+                int child1 = _nodes[index].Child1;
+                int child2 = _nodes[index].Child2;
+
+                _nodes[index].Height = 1 + Math.Max(_nodes[child1].Height, _nodes[child2].Height);
+                SetCombinedAabb(index, child1, child2);
+
+                index = _nodes[index].Parent;
+            }
+        }
+
+        private void ReplaceChild(int parent, int oldChild, int newChild)
+        {
+            if (parent == NullNode)
+            {
+                _root = newChild;
+            }
+            else if (_nodes[parent].Child1 == oldChild)
+            {
+                _nodes[parent].Child1 = newChild;
+            }
+            else
+            {
+                _nodes[parent].Child2 = newChild;
+            }
+        }
+
+        //rotates the higher child up if the subtree of a is imbalanced, returns the new subtree root
+        private int Balance(int a)
+        {
+            if (_nodes[a].IsLeaf || _nodes[a].Height < 2)
+            {
+                return a;
+            }
+
+            int b = _nodes[a].Child1;
+            int c = _nodes[a].Child2;
+
+            int balance = _nodes[c].Height - _nodes[b].Height;
+
+            if (balance > 1)
+            {
+                int f = _nodes[c].Child1;
+                int g = _nodes[c].Child2;
+
+                _nodes[c].Child1 = a;
+                _nodes[c].Parent = _nodes[a].Parent;
+                _nodes[a].Parent = c;
+
+                ReplaceChild(_nodes[c].Parent, a, c);
+
+                if (_nodes[f].Height > _nodes[g].Height)
+                {
+                    _nodes[c].Child2 = f;
+                    _nodes[a].Child2 = g;
+                    _nodes[g].Parent = a;
+
+                    SetCombinedAabb(a, b, g);
+                    SetCombinedAabb(c, a, f);
+
+                    _nodes[a].Height = 1 + Math.Max(_nodes[b].Height, _nodes[g].Height);
+                    _nodes[c].Height = 1 + Math.Max(_nodes[a].Height, _nodes[f].Height);
+                }
+                else
+                {
+                    _nodes[c].Child2 = g;
+                    _nodes[a].Child2 = f;
+                    _nodes[f].Parent = a;
+
+                    SetCombinedAabb(a, b, f);
+                    SetCombinedAabb(c, a, g);
+
+                    _nodes[a].Height = 1 + Math.Max(_nodes[b].Height, _nodes[f].Height);
+                    _nodes[c].Height = 1 + Math.Max(_nodes[a].Height, _nodes[g].Height);
+                }
+
+                return c;
+            }
+
+            if (balance < -1)
+            {
+                int d = _nodes[b].Child1;
+                int e = _nodes[b].Child2;
+
+                _nodes[b].Child1 = a;
+                _nodes[b].Parent = _nodes[a].Parent;
+                _nodes[a].Parent = b;
+
+                ReplaceChild(_nodes[b].Parent, a, b);
+
+                if (_nodes[d].Height > _nodes[e].Height)
+                {
+                    _nodes[b].Child2 = d;
+                    _nodes[a].Child1 = e;
+                    _nodes[e].Parent = a;
+
+                    SetCombinedAabb(a, c, e);
+                    SetCombinedAabb(b, a, d);
+
+                    _nodes[a].Height = 1 + Math.Max(_nodes[c].Height, _nodes[e].Height);
+                    _nodes[b].Height = 1 + Math.Max(_nodes[a].Height, _nodes[d].Height);
+                }
+                else
+                {
+                    _nodes[b].Child2 = e;
+                    _nodes[a].Child1 = d;
+                    _nodes[d].Parent = a;
+
+                    SetCombinedAabb(a, c, d);
+                    SetCombinedAabb(b, a, e);
+
+                    _nodes[a].Height = 1 + Math.Max(_nodes[c].Height, _nodes[d].Height);
+                    _nodes[b].Height = 1 + Math.Max(_nodes[a].Height, _nodes[e].Height);
+                }
+
+                return b;
+            }
+
+            return a;
+        }
+
+        #endregion
+
+        internal int Height
+        {
+            get { return _root == NullNode ? 0 : _nodes[_root].Height; }
+        }
+
+        internal int NodeCount
+        {
+            get { return _nodeCount; }
+        }
+    }
+}
@@ -0,0 +1,289 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Logic
+{
+    //uniform grid, cheap when objects are similar in size
+    internal class GridBroadphase : IBroadphase
+    {
+        internal PhysicsWorldGrid Grid { get; private set; }
+
+        private int _queryStamp;
+
+        internal GridBroadphase(float length)
+        {
+            Grid = new PhysicsWorldGrid(length);
+        }
+
+        public void AddPhysicsObject(PhysicsObject physicsObject)
+        {
+            //cells are assigned on the first transformation
+        }
+
+        public void RemovePhysicsObject(PhysicsObject physicsObject)
+        {
+            for (int i = 0; i < physicsObject.CurrentGrids.Count; i++)
+            {
+                PhysicsWorldGridCell physicsWorldGridCell = physicsObject.CurrentGrids[i];
+
+                physicsWorldGridCell.RemovePhysicsObject(physicsObject);
+            }
+
+            physicsObject.CurrentGrids.Clear();
+        }
+
+        public void UpdatePhysicsObject(PhysicsObject physicsObject)
+        {
+            physicsObject.UpdateOnGrid(Grid);
+        }
+
+        public void CollectPairs(LinkedList<PhysicsObject> rigidBodies, List<BroadphasePair> pairs)
+        {
+            //once a step, every object is in the cells of its current AABB here
+            Grid.RemoveEmptyCells();
+
+            LinkedListNode<PhysicsObject> currentRigidBodyNode = rigidBodies.First;
+
+            while (currentRigidBodyNode != null)
+            {
+                PhysicsObject rigidBody = currentRigidBodyNode.Value;
+
+                if (rigidBody.IsSleeping)
+                {
+                    currentRigidBodyNode = currentRigidBodyNode.Next;
+                    continue;
+                }
+
+                //objects spanning several cells are met more than once, the stamp filters them
+                _queryStamp++;
+                rigidBody.BroadphaseQueryStamp = _queryStamp;
+
+                for (int i = 0; i < rigidBody.CurrentGrids.Count; i++)
+                {
+                    LinkedListNode<PhysicsObject> currentNode = rigidBody.CurrentGrids[i].PhysicsObjects.First;
+
+                    while (currentNode != null)
+                    {
+                        PhysicsObject physicsObject = currentNode.Value;
+
+                        if (physicsObject.BroadphaseQueryStamp != _queryStamp)
+                        {
+                            physicsObject.BroadphaseQueryStamp = _queryStamp;
+
+                            //a pair of awake rigid bodies is added by the one with the smaller id, sleeping ones are met like static bodies
+                            if ((!physicsObject.IsAwakeRigidBody || rigidBody.PhysicsId < physicsObject.PhysicsId)
+                                && rigidBody.CheckAABBWith(physicsObject))
+                            {
+                                pairs.Add(new BroadphasePair(rigidBody, physicsObject));
+                            }
+                        }
+
+                        currentNode = currentNode.Next;
+                    }
+                }
+
+                currentRigidBodyNode = currentRigidBodyNode.Next;
+            }
+        }
+
+        public void Query(float minX, float minY, float maxX, float maxY, List<PhysicsObject> result)
+        {
+            _queryStamp++;
+
+            Query(minX, minY, maxX, maxY, null, result);
+        }
+
+        //reads the grid only, the marker filters objects spanning several cells
+        public void Query(float minX, float minY, float maxX, float maxY, PhysicsObjectMarker marker, List<PhysicsObject> result)
+        {
+            float inverseGridLength = 1.0f / Grid.Length;
+
+            int minGridX = (int)(minX * inverseGridLength);
+            int minGridY = (int)(minY * inverseGridLength);
+
+            int maxGridX = (int)(maxX * inverseGridLength);
+            int maxGridY = (int)(maxY * inverseGridLength);
+
+            IList<PhysicsWorldGridCell> cells = Grid.Cells;
+
+            //a query larger than the used part of the grid walks the created cells instead of its whole range
+            if ((long)(maxGridX - minGridX + 1) * (maxGridY - minGridY + 1) > cells.Count)
+            {
+                for (int i = 0; i < cells.Count; i++)
+                {
+                    PhysicsWorldGridCell cell = cells[i];
+
+                    if (cell.X >= minGridX && cell.X <= maxGridX && cell.Y >= minGridY && cell.Y <= maxGridY)
+                    {
+                        AddPhysicsObjects(cell, minX, minY, maxX, maxY, marker, result);
+                    }
+                }
+
+                return;
+            }
+
+            for (int x = minGridX; x <= maxGridX; x++)
+            {
+                for (int y = minGridY; y <= maxGridY; y++)
+                {
+                    PhysicsWorldGridCell cell = Grid.Find(x, y);
+
+                    if (cell != null)
+                    {
+                        AddPhysicsObjects(cell, minX, minY, maxX, maxY, marker, result);
+                    }
+                }
+            }
+        }
+
+        //objects met before are skipped by the marker if there is one, by the stamps on the objects otherwise
+        private void AddPhysicsObjects(PhysicsWorldGridCell cell, float minX, float minY, float maxX, float maxY, PhysicsObjectMarker marker, List<PhysicsObject> result)
+        {
+            LinkedListNode<PhysicsObject> currentNode = cell.PhysicsObjects.First;
+
+            while (currentNode != null)
+            {
+                PhysicsObject physicsObject = currentNode.Value;
+                currentNode = currentNode.Next;
+
+                if (marker != null)
+                {
+                    if (!marker.Mark(physicsObject))
+                    {
+                        continue;
+                    }
+                }
+                else
+                {
+                    if (physicsObject.BroadphaseQueryStamp == _queryStamp)
+                    {
+                        continue;
+                    }
+
+                    physicsObject.BroadphaseQueryStamp = _queryStamp;
+                }
+
+                ShapeInstance shapeData = physicsObject.ShapeData;
+
+                if (shapeData.MinX <= maxX && minX <= shapeData.MaxX && shapeData.MinY <= maxY && minY <= shapeData.MaxY)
+                {
+                    result.Add(physicsObject);
+                }
+            }
+        }
+
+        //walks the cells in ray order (Amanatides and Woo), objects of a cell can not hit nearer than where the ray
+        //enters it, so the walk ends on the first cell entered after the nearest hit. it only reads the grid, the
+        //query keeps what it tested
+        public void Raycast(RaycastQuery query)
+        {
+            float length = Grid.Length;
+
+            float originX = query.Origin.X;
+            float originY = query.Origin.Y;
+            float displacementX = query.Displacement.X;
+            float displacementY = query.Displacement.Y;
+
+            //cells are walked on floor boundaries, the grid truncates toward zero so two of them around zero map to one
+            int cellX = (int)Math.Floor(originX / length);
+            int cellY = (int)Math.Floor(originY / length);
+
+            int endCellX = (int)Math.Floor((originX + displacementX) / length);
+            int endCellY = (int)Math.Floor((originY + displacementY) / length);
+
+            int stepX = Math.Sign(displacementX);
+            int stepY = Math.Sign(displacementY);
+
+            float deltaX = stepX != 0 ? length / Math.Abs(displacementX) : float.MaxValue;
+            float deltaY = stepY != 0 ? length / Math.Abs(displacementY) : float.MaxValue;
+
+            float nextX = stepX != 0 ? ((cellX + (stepX > 0 ? 1 : 0)) * length - originX) / displacementX : float.MaxValue;
+            float nextY = stepY != 0 ? ((cellY + (stepY > 0 ? 1 : 0)) * length - originY) / displacementY : float.MaxValue;
+
+            int lastGridX = int.MinValue;
+            int lastGridY = int.MinValue;
+
+            while (true)
+            {
+                int gridX = cellX < 0 ? cellX + 1 : cellX;
+                int gridY = cellY < 0 ? cellY + 1 : cellY;
+
+                PhysicsWorldGridCell cell = gridX != lastGridX || gridY != lastGridY ? Grid.Find(gridX, gridY) : null;
+
+                if (cell != null)
+                {
+                    LinkedListNode<PhysicsObject> currentNode = cell.PhysicsObjects.First;
+
+                    while (currentNode != null)
+                    {
+                        query.Test(currentNode.Value);
+                        currentNode = currentNode.Next;
+                    }
+                }
+
+                lastGridX = gridX;
+                lastGridY = gridY;
+
+                if (cellX == endCellX && cellY == endCellY)
+                {
+                    break;
+                }
+
+                float next = Math.Min(nextX, nextY);
+
+                if (next > 1.0f || next > query.Fraction)
+                {
+                    break;
+                }
+
+                if (nextX < nextY)
+                {
+                    cellX += stepX;
+                    nextX += deltaX;
+                }
+                else
+                {
+                    cellY += stepY;
+                    nextY += deltaY;
+                }
+            }
+        }
+
+        public bool CanQueryInParallel
+        {
+            get { return true; }
+        }
+
+        public void Reset()
+        {
+            Grid.Reset();
+        }
+    }
+}
@@ -0,0 +1,78 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Logic
+{
+    public enum BroadphaseType
+    {
+        Grid,
+        SweepAndPrune,
+        DynamicAabbTree
+    }
+
+    //PhysicsObjectA is always a rigid body, PhysicsObjectB may be a rigid body, static body or trigger
+    internal struct BroadphasePair
+    {
+        public PhysicsObject PhysicsObjectA;
+        public PhysicsObject PhysicsObjectB;
+
+        public BroadphasePair(PhysicsObject physicsObjectA, PhysicsObject physicsObjectB)
+        {
+            PhysicsObjectA = physicsObjectA;
+            PhysicsObjectB = physicsObjectB;
+        }
+    }
+
+    internal interface IBroadphase
+    {
+        void AddPhysicsObject(PhysicsObject physicsObject);
+        void RemovePhysicsObject(PhysicsObject physicsObject);
+
+        //called after the shape of the physics object is transformed, its AABB may have changed
+        void UpdatePhysicsObject(PhysicsObject physicsObject);
+
+        //every overlapping pair which has at least one rigid body is added once, layers are not checked here
+        void CollectPairs(LinkedList<PhysicsObject> rigidBodies, List<BroadphasePair> pairs);
+
+        //every physics object whose AABB overlaps the given one is added once
+        void Query(float minX, float minY, float maxX, float maxY, List<PhysicsObject> result);
+
+        //same as Query but the objects are filtered and marked by the given marker instead of the stamps on the objects
+        void Query(float minX, float minY, float maxX, float maxY, PhysicsObjectMarker marker, List<PhysicsObject> result);
+
+        //passes the objects near the ray to the query, the walk may stop once nothing left can be nearer than its hit
+        void Raycast(RaycastQuery query);
+
+        //true if Raycast and the marked Query can run on several threads at the same time, each with its own marker
+        bool CanQueryInParallel { get; }
+
+        void Reset();
+    }
+}
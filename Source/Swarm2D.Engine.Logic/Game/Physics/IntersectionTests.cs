@@ -28,6 +28,7 @@ using System.Collections.Generic;
 using System.Linq;
 using System.Text;
 using Swarm2D.Library;
+using Vector4 = System.Numerics.Vector4;
 
 namespace Swarm2D.Engine.Logic
 {
@@ -152,6 +153,243 @@ namespace Swarm2D.Engine.Logic
             return true;
         }
 
+        private static void Project(float[] verticesX, float[] verticesY, int vertexCount, float axisX, float axisY, out float min, out float max)
+        {
+            min = verticesX[0] * axisX + verticesY[0] * axisY;
+            max = min;
+
+            for (int i = 1; i < vertexCount; i++)
+            {
+                float p = verticesX[i] * axisX + verticesY[i] * axisY;
+
+                if (p < min)
+                {
+                    min = p;
+                }
+                else if (p > max)
+                {
+                    max = p;
+                }
+            }
+        }
+
+        //projects four vertices at a time, System.Numerics.Vector4 is a SIMD register on RyuJIT and a plain struct elsewhere.
+        //each lane computes the same products as the scalar Project so the results are bit identical
+        private static void Project(PolygonInstance polygon, float axisX, float axisY, out float min, out float max)
+        {
+            Vector4[] packedVerticesX = polygon.PackedVerticesX;
+            Vector4[] packedVerticesY = polygon.PackedVerticesY;
+
+            Vector4 axisXs = new Vector4(axisX);
+            Vector4 axisYs = new Vector4(axisY);
+
+            Vector4 projection = packedVerticesX[0] * axisXs + packedVerticesY[0] * axisYs;
+            Vector4 mins = projection;
+            Vector4 maxs = projection;
+
+            for (int i = 1; i < polygon.PackedVertexCount; i++)
+            {
+                projection = packedVerticesX[i] * axisXs + packedVerticesY[i] * axisYs;
+                mins = Vector4.Min(mins, projection);
+                maxs = Vector4.Max(maxs, projection);
+            }
+
+            min = Math.Min(Math.Min(mins.X, mins.Y), Math.Min(mins.Z, mins.W));
+            max = Math.Max(Math.Max(maxs.X, maxs.Y), Math.Max(maxs.Z, maxs.W));
+        }
+
+        //separating axis test over the flat arrays of both polygons, returns false as soon as an axis separates them
+        private static bool FindMinimumOverlap(PolygonInstance polygonA, PolygonInstance polygonB, out float overlap, out float directionX, out float directionY)
+        {
+            overlap = float.MaxValue;
+            directionX = 0.0f;
+            directionY = 0.0f;
+
+            for (int k = 0; k < 2; k++)
+            {
+                PolygonInstance axisOwner = k == 0 ? polygonA : polygonB;
+
+                float[] normalsX = axisOwner.NormalsX;
+                float[] normalsY = axisOwner.NormalsY;
+                int axisCount = axisOwner.VertexCount;
+
+                for (int i = 0; i < axisCount; i++)
+                {
+                    float axisX = normalsX[i];
+                    float axisY = normalsY[i];
+
+                    float minA, maxA, minB, maxB;
+
+                    Project(polygonA, axisX, axisY, out minA, out maxA);
+                    Project(polygonB, axisX, axisY, out minB, out maxB);
+
+                    if (maxA < minB || maxB < minA)
+                    {
+                        return false;
+                    }
+
+                    float o = Mathf.Abs((maxA <= maxB ? maxA : maxB) - (minA >= minB ? minA : minB));
+
+                    if (o < overlap)
+                    {
+                        overlap = o;
+                        directionX = axisX;
+                        directionY = axisY;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        //average of the crossing points of the polygon edges
+        private static Vector2 CalculateIntersectionPoint(PolygonInstance polygonA, PolygonInstance polygonB)
+        {
+            float[] verticesXA = polygonA.VerticesX;
+            float[] verticesYA = polygonA.VerticesY;
+            float[] edgesXA = polygonA.EdgesX;
+            float[] edgesYA = polygonA.EdgesY;
+
+            float[] verticesXB = polygonB.VerticesX;
+            float[] verticesYB = polygonB.VerticesY;
+            float[] edgesXB = polygonB.EdgesX;
+            float[] edgesYB = polygonB.EdgesY;
+
+            float sumX = 0.0f;
+            float sumY = 0.0f;
+            int intersectionPointCount = 0;
+
+            for (int i = 0; i < polygonA.VertexCount; i++)
+            {
+                float px = verticesXA[i];
+                float py = verticesYA[i];
+                float rx = edgesXA[i];
+                float ry = edgesYA[i];
+
+                for (int j = 0; j < polygonB.VertexCount; j++)
+                {
+                    float sx = edgesXB[j];
+                    float sy = edgesYB[j];
+
+                    float rCrossS = rx * sy - ry * sx;
+
+                    if (!Mathf.IsZero(rCrossS))
+                    {
+                        float qpx = verticesXB[j] - px;
+                        float qpy = verticesYB[j] - py;
+
+                        float t = (qpx * sy - qpy * sx) / rCrossS;
+                        float u = (qpx * ry - qpy * rx) / rCrossS;
+
+                        if (t >= 0.0f && t <= 1.0f && u >= 0.0f && u <= 1.0f)
+                        {
+                            sumX += px + rx * t;
+                            sumY += py + ry * t;
+                            intersectionPointCount++;
+                        }
+                    }
+                }
+            }
+
+            Vector2 intersectionPoint = new Vector2(sumX, sumY);
+
+            if (intersectionPointCount > 1)
+            {
+                intersectionPoint = intersectionPoint * (1.0f / (float)intersectionPointCount);
+            }
+
+            return intersectionPoint;
+        }
+
+        public static bool CheckIntersectionAndProduceResult(PolygonInstance polygonA, PolygonInstance polygonB, out Vector2 minimumTranslation, out Vector2 intersectionPoint)
+        {
+            minimumTranslation = Vector2.Zero;
+            intersectionPoint = Vector2.Zero;
+
+            float overlap;
+            float directionX, directionY;
+
+            if (!FindMinimumOverlap(polygonA, polygonB, out overlap, out directionX, out directionY) || Mathf.IsZero(overlap))
+            {
+                return false;
+            }
+
+            Vector2 direction = new Vector2(directionX, directionY);
+            Vector2 centerDirection = polygonA.CurrentCenter - polygonB.CurrentCenter;
+
+            if (direction.Dot(centerDirection) < 0)
+            {
+                direction = direction * (-1.0f);
+            }
+
+            minimumTranslation = direction * overlap;
+
+            intersectionPoint = CalculateIntersectionPoint(polygonA, polygonB);
+
+            return true;
+        }
+
+        public static bool CheckIntersectionAndProduceResult(PolygonInstance polygonA, CircleInstance circleB, out Vector2 minimumTranslation, out Vector2 intersectionPoint)
+        {
+            minimumTranslation = Vector2.Zero;
+            intersectionPoint = Vector2.Zero;
+
+            float overlap;
+            Vector2 direction;
+
+            if (!FindMinimumOverlap(polygonA, circleB, out overlap, out direction) || Mathf.IsZero(overlap))
+            {
+                return false;
+            }
+
+            Vector2 centerDirection = polygonA.CurrentCenter - circleB.CurrentCenter;
+
+            if (direction.Dot(centerDirection) < 0)
+            {
+                direction = direction * (-1.0f);
+            }
+
+            minimumTranslation = direction * overlap;
+
+            intersectionPoint = circleB.CurrentCenter + direction * (circleB.RadiusWithTransformation - overlap * 0.5f);
+
+            return true;
+        }
+
+        private static bool FindMinimumOverlap(PolygonInstance polygonA, CircleInstance circleB, out float overlap, out Vector2 direction)
+        {
+            overlap = float.MaxValue;
+            direction = Vector2.Zero;
+
+            float[] normalsX = polygonA.NormalsX;
+            float[] normalsY = polygonA.NormalsY;
+
+            for (int i = 0; i < polygonA.VertexCount; i++)
+            {
+                Vector2 axis = new Vector2(normalsX[i], normalsY[i]);
+
+                float minA, maxA;
+
+                Project(polygonA, axis.X, axis.Y, out minA, out maxA);
+                Vector2 p2 = circleB.ProjectTo(axis);
+
+                if (maxA < p2.X || p2.Y < minA)
+                {
+                    return false;
+                }
+
+                float o = Mathf.Abs((maxA <= p2.Y ? maxA : p2.Y) - (minA >= p2.X ? minA : p2.X));
+
+                if (o < overlap)
+                {
+                    overlap = o;
+                    direction = axis;
+                }
+            }
+
+            return true;
+        }
+
         public static bool CheckIntersectionAndProduceResult(IPolygonInstance polygonA, CircleInstance circleB, out Vector2 minimumTranslation, out Vector2 intersectionPoint)
         {
             minimumTranslation = Vector2.Zero;
@@ -230,117 +468,323 @@ namespace Swarm2D.Engine.Logic
             return false;
         }
 
-        public static bool CheckIntersection(ShapeInstance shapeA, ShapeInstance shapeB)
+        //time of the first touch while shapeA moves by the displacement and shapeB stands still, shapeA is given where
+        //the motion ends. rotation is not swept, and shapes already overlapping where the motion starts are left to
+        //the discrete test
+        internal static bool CalculateTimeOfImpact(ShapeInstance shapeA, ShapeInstance shapeB, Vector2 displacement, out float timeOfImpact)
         {
-            bool isIntersection = false;
+            PolygonInstance polygonA = shapeA as PolygonInstance;
+            PolygonInstance polygonB = shapeB as PolygonInstance;
+            CircleInstance circleA = shapeA as CircleInstance;
+            CircleInstance circleB = shapeB as CircleInstance;
 
-            if (shapeA is PolygonInstance && shapeB is PolygonInstance)
+            if (polygonA != null && polygonB != null)
             {
-                isIntersection = CheckIntersection((PolygonInstance)shapeA, (PolygonInstance)shapeB);
+                return CalculateTimeOfImpact(polygonA, polygonB, displacement, out timeOfImpact);
             }
-            else if (shapeA is CircleInstance && shapeB is CircleInstance)
+
+            if (circleA != null && polygonB != null)
             {
-                isIntersection = CheckIntersection((CircleInstance)shapeA, (CircleInstance)shapeB);
+                return CalculateTimeOfImpact(circleA.CurrentCenter - displacement, displacement, circleA.RadiusWithTransformation, polygonB, out timeOfImpact);
             }
-            else if (shapeA is PolygonInstance && shapeB is CircleInstance)
+
+            //the circle moves the other way around the polygon, the time is the same
+            if (polygonA != null && circleB != null)
             {
-                isIntersection = CheckIntersection((PolygonInstance)shapeA, (CircleInstance)shapeB);
+                return CalculateTimeOfImpact(circleB.CurrentCenter + displacement, -1.0f * displacement, circleB.RadiusWithTransformation, polygonA, out timeOfImpact);
             }
-            else if (shapeA is CircleInstance && shapeB is PolygonInstance)
+
+            if (circleA != null && circleB != null)
             {
-                isIntersection = CheckIntersection((PolygonInstance)shapeB, (CircleInstance)shapeA);
+                return CalculateTimeOfImpact(circleA.CurrentCenter - displacement, displacement, circleA.RadiusWithTransformation + circleB.RadiusWithTransformation, circleB.CurrentCenter, out timeOfImpact);
             }
 
-            return isIntersection;
+            timeOfImpact = 0.0f;
+            return false;
         }
 
-        private static bool CheckIntersection(PolygonInstance polygonA, PolygonInstance polygonB)
+        //separating axis test over the motion, on every axis the projections overlap for an interval of time and
+        //the polygons touch first when the last of those intervals starts
+        private static bool CalculateTimeOfImpact(PolygonInstance polygonA, PolygonInstance polygonB, Vector2 displacement, out float timeOfImpact)
         {
-            float overlap = float.MaxValue;
+            float enterTime = float.MinValue;
+            float exitTime = float.MaxValue;
 
-            int edgeCount = polygonA.Edges.Count + polygonB.Edges.Count;
+            timeOfImpact = 0.0f;
 
-            for (int i = 0; i < edgeCount; i++)
+            for (int k = 0; k < 2; k++)
             {
-                LineSegment edge = null;
+                PolygonInstance axisOwner = k == 0 ? polygonA : polygonB;
 
-                if (i < polygonA.Edges.Count)
+                for (int i = 0; i < axisOwner.VertexCount; i++)
                 {
-                    edge = polygonA.Edges[i];
-                }
-                else
-                {
-                    int j = i - polygonA.Edges.Count;
+                    float axisX = axisOwner.NormalsX[i];
+                    float axisY = axisOwner.NormalsY[i];
 
-                    edge = polygonB.Edges[j];
+                    float minA, maxA, minB, maxB;
+
+                    Project(polygonA, axisX, axisY, out minA, out maxA);
+                    Project(polygonB, axisX, axisY, out minB, out maxB);
+
+                    float speed = displacement.X * axisX + displacement.Y * axisY;
+
+                    if (Mathf.IsZero(speed))
+                    {
+                        if (maxA < minB || maxB < minA)
+                        {
+                            return false;
+                        }
+
+                        continue;
+                    }
+
+                    //A is projected at (t - 1) * speed from where it is now
+                    float enter = 1.0f + (speed > 0.0f ? minB - maxA : maxB - minA) / speed;
+                    float exit = 1.0f + (speed > 0.0f ? maxB - minA : minB - maxA) / speed;
+
+                    if (enter > enterTime)
+                    {
+                        enterTime = enter;
+                    }
+
+                    if (exit < exitTime)
+                    {
+                        exitTime = exit;
+                    }
+
+                    if (enterTime > exitTime || enterTime > 1.0f || exitTime < 0.0f)
+                    {
+                        return false;
+                    }
                 }
+            }
 
-                Vector2 axis = edge.NormalOnWorld;
-                axis.Normalize();
+            if (enterTime < 0.0f)
+            {
+                return false;
+            }
 
-                Vector2 p1 = polygonA.ProjectTo(axis);
-                Vector2 p2 = polygonB.ProjectTo(axis);
+            timeOfImpact = enterTime;
+            return true;
+        }
 
-                if (!DoesOverlap(p1, p2))
+        //the circle center is cast against the polygon grown by the radius, its edges pushed out and its corners rounded
+        private static bool CalculateTimeOfImpact(Vector2 origin, Vector2 displacement, float radius, PolygonInstance polygon, out float timeOfImpact)
+        {
+            timeOfImpact = float.MaxValue;
+
+            float[] verticesX = polygon.VerticesX;
+            float[] verticesY = polygon.VerticesY;
+            int vertexCount = polygon.VertexCount;
+
+            for (int i = 0; i < vertexCount; i++)
+            {
+                int next = i + 1 != vertexCount ? i + 1 : 0;
+
+                float normalX = polygon.NormalsX[i];
+                float normalY = polygon.NormalsY[i];
+
+                //normals follow the winding, the outward one points away from the center
+                if ((verticesX[i] - polygon.CurrentCenter.X) * normalX + (verticesY[i] - polygon.CurrentCenter.Y) * normalY < 0.0f)
                 {
-                    return false;
+                    normalX = -normalX;
+                    normalY = -normalY;
                 }
-                else
+
+                float speed = displacement.X * normalX + displacement.Y * normalY;
+                float distance = (origin.X - verticesX[i]) * normalX + (origin.Y - verticesY[i]) * normalY - radius;
+
+                if (speed < 0.0f && distance >= 0.0f && distance <= -speed)
                 {
-                    float o = Mathf.Abs(GetOverlap(p1, p2));
+                    float t = distance / -speed;
 
-                    if (o < overlap)
+                    float edgeX = verticesX[next] - verticesX[i];
+                    float edgeY = verticesY[next] - verticesY[i];
+
+                    float along = ((origin.X + displacement.X * t - verticesX[i]) * edgeX + (origin.Y + displacement.Y * t - verticesY[i]) * edgeY) / (edgeX * edgeX + edgeY * edgeY);
+
+                    if (along >= 0.0f && along <= 1.0f && t < timeOfImpact)
                     {
-                        overlap = o;
+                        timeOfImpact = t;
                     }
                 }
+
+                float corner;
+
+                if (CalculateTimeOfImpact(origin, displacement, radius, new Vector2(verticesX[i], verticesY[i]), out corner) && corner < timeOfImpact)
+                {
+                    timeOfImpact = corner;
+                }
             }
 
-            if (Mathf.IsZero(overlap))
+            return timeOfImpact <= 1.0f;
+        }
+
+        //the origin is cast against a circle, false if it starts inside
+        private static bool CalculateTimeOfImpact(Vector2 origin, Vector2 displacement, float radius, Vector2 center, out float timeOfImpact)
+        {
+            timeOfImpact = 0.0f;
+
+            Vector2 offset = origin - center;
+
+            float a = displacement.Dot(displacement);
+            float b = 2.0f * offset.Dot(displacement);
+            float c = offset.Dot(offset) - radius * radius;
+
+            if (c < 0.0f || Mathf.IsZero(a))
             {
                 return false;
             }
 
-            return true;
+            float discriminant = b * b - 4.0f * a * c;
+
+            if (discriminant < 0.0f)
+            {
+                return false;
+            }
+
+            timeOfImpact = (-b - Mathf.Sqrt(discriminant)) / (2.0f * a);
+
+            return timeOfImpact >= 0.0f && timeOfImpact <= 1.0f;
         }
 
-        private static bool CheckIntersection(PolygonInstance polygonA, CircleInstance circleB)
+        public static bool CheckIntersection(ShapeInstance shapeA, ShapeInstance shapeB)
         {
-            float overlap = float.MaxValue;
+            bool isIntersection = false;
 
-            int edgeCount = polygonA.Edges.Count;
+            if (shapeA is PolygonInstance && shapeB is PolygonInstance)
+            {
+                isIntersection = CheckIntersection((PolygonInstance)shapeA, (PolygonInstance)shapeB);
+            }
+            else if (shapeA is CircleInstance && shapeB is CircleInstance)
+            {
+                isIntersection = CheckIntersection((CircleInstance)shapeA, (CircleInstance)shapeB);
+            }
+            else if (shapeA is PolygonInstance && shapeB is CircleInstance)
+            {
+                isIntersection = CheckIntersection((PolygonInstance)shapeA, (CircleInstance)shapeB);
+            }
+            else if (shapeA is CircleInstance && shapeB is PolygonInstance)
+            {
+                isIntersection = CheckIntersection((PolygonInstance)shapeB, (CircleInstance)shapeA);
+            }
 
-            for (int i = 0; i < edgeCount; i++)
+            return isIntersection;
+        }
+
+        //overlap tests against query shapes given in world space, touching counts as overlapping
+        internal static bool CheckOverlap(ShapeInstance shape, Vector2 center, float radius)
+        {
+            PolygonInstance polygon = shape as PolygonInstance;
+
+            if (polygon != null)
             {
-                LineSegment edge = polygonA.Edges[i];
+                return CheckOverlap(polygon.VerticesX, polygon.VerticesY, polygon.NormalsX, polygon.NormalsY, polygon.VertexCount, center, radius);
+            }
 
-                Vector2 axis = edge.NormalOnWorld;
-                axis.Normalize();
+            CircleInstance circle = (CircleInstance)shape;
 
-                Vector2 p1 = polygonA.ProjectTo(axis);
-                Vector2 p2 = circleB.ProjectTo(axis);
+            float sumOfRadiuses = circle.RadiusWithTransformation + radius;
 
-                if (!DoesOverlap(p1, p2))
+            return (circle.CurrentCenter - center).LengthSquared <= sumOfRadiuses * sumOfRadiuses;
+        }
+
+        internal static bool CheckOverlap(ShapeInstance shape, float[] verticesX, float[] verticesY, float[] normalsX, float[] normalsY, int vertexCount)
+        {
+            PolygonInstance polygon = shape as PolygonInstance;
+
+            if (polygon != null)
+            {
+                return !IsSeparated(polygon.VerticesX, polygon.VerticesY, polygon.VertexCount, verticesX, verticesY, vertexCount, normalsX, normalsY, vertexCount) &&
+                    !IsSeparated(polygon.VerticesX, polygon.VerticesY, polygon.VertexCount, verticesX, verticesY, vertexCount, polygon.NormalsX, polygon.NormalsY, polygon.VertexCount);
+            }
+
+            CircleInstance circle = (CircleInstance)shape;
+
+            return CheckOverlap(verticesX, verticesY, normalsX, normalsY, vertexCount, circle.CurrentCenter, circle.RadiusWithTransformation);
+        }
+
+        //the axes are the normals of the polygon and the one from its nearest vertex to the center
+        private static bool CheckOverlap(float[] verticesX, float[] verticesY, float[] normalsX, float[] normalsY, int vertexCount, Vector2 center, float radius)
+        {
+            float nearestDistanceSquared = float.MaxValue;
+            int nearestVertex = 0;
+
+            for (int i = 0; i < vertexCount; i++)
+            {
+                float min, max;
+
+                Project(verticesX, verticesY, vertexCount, normalsX[i], normalsY[i], out min, out max);
+
+                float centerProjection = center.X * normalsX[i] + center.Y * normalsY[i];
+
+                if (max < centerProjection - radius || centerProjection + radius < min)
                 {
                     return false;
                 }
-                else
-                {
-                    float o = Mathf.Abs(GetOverlap(p1, p2));
 
-                    if (o < overlap)
-                    {
-                        overlap = o;
-                    }
+                float distanceX = center.X - verticesX[i];
+                float distanceY = center.Y - verticesY[i];
+                float distanceSquared = distanceX * distanceX + distanceY * distanceY;
+
+                if (distanceSquared < nearestDistanceSquared)
+                {
+                    nearestDistanceSquared = distanceSquared;
+                    nearestVertex = i;
                 }
             }
 
-            if (Mathf.IsZero(overlap))
+            if (Mathf.IsZero(nearestDistanceSquared))
             {
-                return false;
+                return true;
             }
 
-            return true;
+            float distance = Mathf.Sqrt(nearestDistanceSquared);
+            float axisX = (center.X - verticesX[nearestVertex]) / distance;
+            float axisY = (center.Y - verticesY[nearestVertex]) / distance;
+
+            float vertexMin, vertexMax;
+
+            Project(verticesX, verticesY, vertexCount, axisX, axisY, out vertexMin, out vertexMax);
+
+            float projection = center.X * axisX + center.Y * axisY;
+
+            return vertexMax >= projection - radius && projection + radius >= vertexMin;
+        }
+
+        private static bool IsSeparated(float[] verticesAX, float[] verticesAY, int vertexCountA, float[] verticesBX, float[] verticesBY, int vertexCountB,
+            float[] normalsX, float[] normalsY, int axisCount)
+        {
+            for (int i = 0; i < axisCount; i++)
+            {
+                float minA, maxA, minB, maxB;
+
+                Project(verticesAX, verticesAY, vertexCountA, normalsX[i], normalsY[i], out minA, out maxA);
+                Project(verticesBX, verticesBY, vertexCountB, normalsX[i], normalsY[i], out minB, out maxB);
+
+                if (maxA < minB || maxB < minA)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        private static bool CheckIntersection(PolygonInstance polygonA, PolygonInstance polygonB)
+        {
+            float overlap;
+            float directionX, directionY;
+
+            return FindMinimumOverlap(polygonA, polygonB, out overlap, out directionX, out directionY) && !Mathf.IsZero(overlap);
+        }
+
+        private static bool CheckIntersection(PolygonInstance polygonA, CircleInstance circleB)
+        {
+            float overlap;
+            Vector2 direction;
+
+            return FindMinimumOverlap(polygonA, circleB, out overlap, out direction) && !Mathf.IsZero(overlap);
         }
 
         private static bool CheckIntersection(CircleInstance circleA, CircleInstance circleB)
@@ -367,8 +811,8 @@ namespace Swarm2D.Engine.Logic
 
         bool IIntersectionChecker.CheckIntersection(ShapeInstance shapeA, ShapeInstance shapeB, out Vector2 minimumTranslation, out Vector2 intersectionPoint)
         {
-            var polygonA = (IPolygonInstance)shapeA;
-            var polygonB = (IPolygonInstance)shapeB;
+            var polygonA = (PolygonInstance)shapeA;
+            var polygonB = (PolygonInstance)shapeB;
 
             return IntersectionTests.CheckIntersectionAndProduceResult(polygonA, polygonB, out minimumTranslation, out intersectionPoint);
         }
@@ -381,7 +825,7 @@ namespace Swarm2D.Engine.Logic
 
         bool IIntersectionChecker.CheckIntersection(ShapeInstance shapeA, ShapeInstance shapeB, out Vector2 minimumTranslation, out Vector2 intersectionPoint)
         {
-            var polygon = (IPolygonInstance)shapeA;
+            var polygon = (PolygonInstance)shapeA;
             var circle = (CircleInstance)shapeB;
 
             return IntersectionTests.CheckIntersectionAndProduceResult(polygon, circle, out minimumTranslation, out intersectionPoint);
@@ -396,7 +840,7 @@ namespace Swarm2D.Engine.Logic
         bool IIntersectionChecker.CheckIntersection(ShapeInstance shapeA, ShapeInstance shapeB, out Vector2 minimumTranslation, out Vector2 intersectionPoint)
         {
             var circle = (CircleInstance)shapeA;
-            var polygon = (IPolygonInstance)shapeB;
+            var polygon = (PolygonInstance)shapeB;
 
             bool intersection = IntersectionTests.CheckIntersectionAndProduceResult(polygon, circle, out minimumTranslation, out intersectionPoint);
 
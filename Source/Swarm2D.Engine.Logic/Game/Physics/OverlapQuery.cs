@@ -0,0 +1,101 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    public enum OverlapShapeType
+    {
+        Circle,
+        Box,
+        Polygon
+    }
+
+    //a shape in world space tested against the physics objects by PhysicsWorld.OverlapBatch
+    public struct OverlapQuery
+    {
+        public const int AllLayers = -1;
+
+        public OverlapShapeType Type;
+
+        //circle
+        public Vector2 Position;
+        public float Radius;
+
+        //box
+        public Vector2 Min;
+        public Vector2 Max;
+
+        //convex polygon, the array belongs to the caller and must not change while the batch runs
+        public Vector2[] Vertices;
+        public int VertexCount;
+
+        //a bit for each layer, objects on the other layers are skipped
+        public int LayerMask;
+
+        public bool IncludeTriggers;
+
+        public static OverlapQuery Circle(Vector2 position, float radius, int layerMask = AllLayers)
+        {
+            OverlapQuery query = new OverlapQuery();
+
+            query.Type = OverlapShapeType.Circle;
+            query.Position = position;
+            query.Radius = radius;
+            query.LayerMask = layerMask;
+
+            return query;
+        }
+
+        public static OverlapQuery Box(Vector2 min, Vector2 max, int layerMask = AllLayers)
+        {
+            OverlapQuery query = new OverlapQuery();
+
+            query.Type = OverlapShapeType.Box;
+            query.Min = min;
+            query.Max = max;
+            query.LayerMask = layerMask;
+
+            return query;
+        }
+
+        public static OverlapQuery Polygon(Vector2[] vertices, int vertexCount, int layerMask = AllLayers)
+        {
+            OverlapQuery query = new OverlapQuery();
+
+            query.Type = OverlapShapeType.Polygon;
+            query.Vertices = vertices;
+            query.VertexCount = vertexCount;
+            query.LayerMask = layerMask;
+
+            return query;
+        }
+    }
+}
@@ -0,0 +1,171 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //what a thread needs to run overlap queries, the query polygon is kept flat like the ones of PolygonInstance
+    internal class OverlapQueryContext
+    {
+        private PhysicsObjectMarker _marker;
+        private List<PhysicsObject> _candidates;
+
+        private float[] _verticesX;
+        private float[] _verticesY;
+        private float[] _normalsX;
+        private float[] _normalsY;
+        private int _vertexCount;
+
+        internal OverlapQueryContext()
+        {
+            _marker = new PhysicsObjectMarker();
+            _candidates = new List<PhysicsObject>();
+
+            _verticesX = new float[8];
+            _verticesY = new float[8];
+            _normalsX = new float[8];
+            _normalsY = new float[8];
+        }
+
+        //writes at most capacity objects starting from offset, returns how many are written
+        internal int Execute(IBroadphase broadphase, ref OverlapQuery query, PhysicsObject[] results, int offset, int capacity)
+        {
+            float minX, minY, maxX, maxY;
+
+            if (query.Type == OverlapShapeType.Circle)
+            {
+                minX = query.Position.X - query.Radius;
+                minY = query.Position.Y - query.Radius;
+                maxX = query.Position.X + query.Radius;
+                maxY = query.Position.Y + query.Radius;
+            }
+            else
+            {
+                PreparePolygon(ref query);
+
+                minX = float.MaxValue;
+                minY = float.MaxValue;
+                maxX = float.MinValue;
+                maxY = float.MinValue;
+
+                for (int i = 0; i < _vertexCount; i++)
+                {
+                    minX = Math.Min(minX, _verticesX[i]);
+                    minY = Math.Min(minY, _verticesY[i]);
+                    maxX = Math.Max(maxX, _verticesX[i]);
+                    maxY = Math.Max(maxY, _verticesY[i]);
+                }
+            }
+
+            _marker.NextGeneration();
+            _candidates.Clear();
+
+            broadphase.Query(minX, minY, maxX, maxY, _marker, _candidates);
+
+            int count = 0;
+
+            for (int i = 0; i < _candidates.Count && count < capacity; i++)
+            {
+                PhysicsObject physicsObject = _candidates[i];
+
+                if ((query.LayerMask & (1 << physicsObject.Layer)) == 0 ||
+                    !query.IncludeTriggers && physicsObject.Type == PhysicsObject.PhysicsType.Trigger)
+                {
+                    continue;
+                }
+
+                bool overlaps;
+
+                if (query.Type == OverlapShapeType.Circle)
+                {
+                    overlaps = IntersectionTests.CheckOverlap(physicsObject.ShapeData, query.Position, query.Radius);
+                }
+                else
+                {
+                    overlaps = IntersectionTests.CheckOverlap(physicsObject.ShapeData, _verticesX, _verticesY, _normalsX, _normalsY, _vertexCount);
+                }
+
+                if (overlaps)
+                {
+                    results[offset + count] = physicsObject;
+                    count++;
+                }
+            }
+
+            return count;
+        }
+
+        private void PreparePolygon(ref OverlapQuery query)
+        {
+            if (query.Type == OverlapShapeType.Box)
+            {
+                _vertexCount = 4;
+
+                _verticesX[0] = query.Min.X;
+                _verticesY[0] = query.Min.Y;
+                _verticesX[1] = query.Max.X;
+                _verticesY[1] = query.Min.Y;
+                _verticesX[2] = query.Max.X;
+                _verticesY[2] = query.Max.Y;
+                _verticesX[3] = query.Min.X;
+                _verticesY[3] = query.Max.Y;
+            }
+            else
+            {
+                _vertexCount = query.VertexCount;
+
+                if (_vertexCount > _verticesX.Length)
+                {
+                    _verticesX = new float[_vertexCount];
+                    _verticesY = new float[_vertexCount];
+                    _normalsX = new float[_vertexCount];
+                    _normalsY = new float[_vertexCount];
+                }
+
+                for (int i = 0; i < _vertexCount; i++)
+                {
+                    _verticesX[i] = query.Vertices[i].X;
+                    _verticesY[i] = query.Vertices[i].Y;
+                }
+            }
+
+            for (int i = 0; i < _vertexCount; i++)
+            {
+                int next = i + 1 != _vertexCount ? i + 1 : 0;
+
+                Vector2 normal = new Vector2(_verticesX[next] - _verticesX[i], _verticesY[next] - _verticesY[i]).Perpendicular;
+                normal.Normalize();
+
+                _normalsX[i] = normal.X;
+                _normalsY[i] = normal.Y;
+            }
+        }
+    }
+}
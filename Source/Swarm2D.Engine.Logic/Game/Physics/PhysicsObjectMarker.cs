@@ -0,0 +1,77 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Logic
+{
+    //remembers which physics objects a query has already met. starting a new generation forgets all of them at once,
+    //the stamps are kept by physics id so every thread can have its own marker
+    internal class PhysicsObjectMarker
+    {
+        private int[] _stamps;
+        private int _generation;
+
+        internal PhysicsObjectMarker()
+        {
+            _stamps = new int[256];
+        }
+
+        internal void NextGeneration()
+        {
+            _generation++;
+
+            if (_generation == int.MaxValue)
+            {
+                Array.Clear(_stamps, 0, _stamps.Length);
+                _generation = 1;
+            }
+        }
+
+        //false if the object is already marked in this generation
+        internal bool Mark(PhysicsObject physicsObject)
+        {
+            int physicsId = physicsObject.PhysicsId;
+
+            if (physicsId >= _stamps.Length)
+            {
+                int[] stamps = new int[Math.Max(_stamps.Length * 2, physicsId + 1)];
+                Array.Copy(_stamps, stamps, _stamps.Length);
+                _stamps = stamps;
+            }
+
+            if (_stamps[physicsId] == _generation)
+            {
+                return false;
+            }
+
+            _stamps[physicsId] = _generation;
+            return true;
+        }
+    }
+}
@@ -30,31 +30,26 @@ using System.Text;
 
 namespace Swarm2D.Engine.Logic
 {
+    //cell x covers the positions whose x / Length truncates to x, so cell 0 is twice as wide as the others. cells
+    //are created when an object enters them, the grid has no bounds
     internal class PhysicsWorldGrid
     {
         internal float Length { get; private set; }
-        internal int Size { get; private set; }
 
-        private PhysicsWorldGridCell[,] _grid;
+        private SparseGrid<PhysicsWorldGridCell> _grid;
+        private Predicate<PhysicsWorldGridCell> _isCellEmpty;
 
-        private PhysicsWorldGridCell _outterGridCell;
-
-        internal PhysicsWorldGrid(int size, float length)
+        internal PhysicsWorldGrid(float length)
         {
-            Size = size;
             Length = length;
 
-            _grid = new PhysicsWorldGridCell[Size, Size];
-
-            _outterGridCell = new PhysicsWorldGridCell();
+            _grid = new SparseGrid<PhysicsWorldGridCell>((x, y) => new PhysicsWorldGridCell(x, y));
+            _isCellEmpty = cell => cell.PhysicsObjects.Count == 0;
+        }
 
-            for (int i = 0; i < Size; i++)
-            {
-                for (int j = 0; j < Size; j++)
-                {
-                    _grid[i, j] = new PhysicsWorldGridCell(i, j);
-                }
-            }
+        internal IList<PhysicsWorldGridCell> Cells
+        {
+            get { return _grid.Cells; }
         }
 
         internal void UpdatePhysicsObject(IList<PhysicsWorldGridCell> oldCells, IList<PhysicsWorldGridCell> newCells, PhysicsObject physicsObject)
@@ -70,28 +65,28 @@ namespace Swarm2D.Engine.Logic
             }
         }
 
+        //objects only keep the cells they are in, so the empty ones can go while no object is being moved between cells
+        internal void RemoveEmptyCells()
+        {
+            _grid.RemoveEmptyChunks(_isCellEmpty);
+        }
+
+        //the world is emptied on reset, so the cells are dropped instead of cleared one by one
         internal void Reset()
         {
-            for (int i = 0; i < Size; i++)
-            {
-                for (int j = 0; j < Size; j++)
-                {
-                    _grid[i, j].Reset();
-                }
-            }
+            _grid.Clear();
         }
 
+        //creates the cell if it is not there yet
         internal PhysicsWorldGridCell this[int x, int y]
         {
-            get
-            {
-                if (x < 0 || x >= Size || y < 0 || y >= Size)
-                {
-                    return _outterGridCell;
-                }
+            get { return _grid[x, y]; }
+        }
 
-                return _grid[x, y];
-            }
+        //null if no object has entered the cell, safe to call from several threads while nothing moves
+        internal PhysicsWorldGridCell Find(int x, int y)
+        {
+            return _grid.Find(x, y);
         }
     }
 }
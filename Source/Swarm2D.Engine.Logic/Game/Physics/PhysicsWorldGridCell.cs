@@ -33,7 +33,6 @@ namespace Swarm2D.Engine.Logic
 {
     internal class PhysicsWorldGridCell
     {
-        internal bool Outter { get; private set; }
         internal int X { get; private set; }
         internal int Y { get; private set; }
 
@@ -46,20 +45,9 @@ namespace Swarm2D.Engine.Logic
         private List<LinkedListNode<PhysicsObject>> _freeLinkedListNodes;
 
         internal PhysicsWorldGridCell(int x, int y)
-        {
-            Configure(x, y, false);
-        }
-
-        internal PhysicsWorldGridCell()
-        {
-            Configure(0, 0, true);
-        }
-
-        private void Configure(int x, int y, bool outter)
         {
             X = x;
             Y = y;
-            Outter = outter;
             RigidBodies = new LinkedList<PhysicsObject>();
             StaticBodies = new LinkedList<PhysicsObject>();
             Triggers = new LinkedList<PhysicsObject>();
@@ -143,14 +131,6 @@ namespace Swarm2D.Engine.Logic
                     break;
             }
         }
-
-        internal void Reset()
-        {
-            RigidBodies.Clear();
-            StaticBodies.Clear();
-            Triggers.Clear();
-            PhysicsObjects.Clear();
-        }
     }
 
 }
@@ -28,6 +28,7 @@ using System.Collections.Generic;
 using System.Linq;
 using System.Text;
 using Swarm2D.Library;
+using Vector4 = System.Numerics.Vector4;
 
 namespace Swarm2D.Engine.Logic
 {
@@ -67,6 +68,25 @@ namespace Swarm2D.Engine.Logic
         internal List<LineSegment> Edges { get; private set; }
         internal Vector2 CurrentCenter { get; private set; }
 
+        //world space vertices, edge vectors and normalized edge normals kept flat for the intersection tests,
+        //edge i goes from vertex i to vertex i + 1
+        internal int VertexCount { get; private set; }
+        internal float[] VerticesX { get; private set; }
+        internal float[] VerticesY { get; private set; }
+        internal float[] EdgesX { get; private set; }
+        internal float[] EdgesY { get; private set; }
+        internal float[] NormalsX { get; private set; }
+        internal float[] NormalsY { get; private set; }
+
+        //the world vertices again in groups of four for the projection kernel in IntersectionTests,
+        //the last group is filled up with copies of the last vertex which do not change a projection
+        internal int PackedVertexCount { get; private set; }
+        internal Vector4[] PackedVerticesX { get; private set; }
+        internal Vector4[] PackedVerticesY { get; private set; }
+
+        private float[] _localVerticesX;
+        private float[] _localVerticesY;
+
         private IPolygon _polygon;
 
         public PolygonInstance(IPolygon polygon)
@@ -79,6 +99,24 @@ namespace Swarm2D.Engine.Logic
         {
             Edges.Clear();
 
+            VertexCount = _polygon.Vertices.Count;
+
+            if (_localVerticesX == null || _localVerticesX.Length != VertexCount)
+            {
+                _localVerticesX = new float[VertexCount];
+                _localVerticesY = new float[VertexCount];
+                VerticesX = new float[VertexCount];
+                VerticesY = new float[VertexCount];
+                EdgesX = new float[VertexCount];
+                EdgesY = new float[VertexCount];
+                NormalsX = new float[VertexCount];
+                NormalsY = new float[VertexCount];
+
+                PackedVertexCount = (VertexCount + 3) / 4;
+                PackedVerticesX = new Vector4[PackedVertexCount];
+                PackedVerticesY = new Vector4[PackedVertexCount];
+            }
+
             float boundingCircleRadiusSquared = float.MinValue;
 
             for (int i = 0; i < _polygon.Vertices.Count; i++)
@@ -90,6 +128,9 @@ namespace Swarm2D.Engine.Logic
 
                 Edges.Add(lineSegment);
 
+                _localVerticesX[i] = currentVertex.X;
+                _localVerticesY[i] = currentVertex.Y;
+
                 if (currentVertex.LengthSquared > boundingCircleRadiusSquared)
                 {
                     boundingCircleRadiusSquared = currentVertex.LengthSquared;
@@ -113,50 +154,83 @@ namespace Swarm2D.Engine.Logic
 
             float boundingCircleRadiusSquared = float.MinValue;
 
-            for (int i = 0; i < Edges.Count; i++)
-            {
-                LineSegment edge = Edges[i];
+            int vertexCount = VertexCount;
 
-                if (i != 0)
-                {
-                    LineSegment previousEdge = Edges[i - 1];
-                    edge.P1OnWorld = previousEdge.P2OnWorld;
-                }
-                else
-                {
-                    edge.P1OnWorld = transform * edge.P1;
-                }
+            float[] localVerticesX = _localVerticesX;
+            float[] localVerticesY = _localVerticesY;
+            float[] verticesX = VerticesX;
+            float[] verticesY = VerticesY;
+
+            for (int i = 0; i < vertexCount; i++)
+            {
+                float x = transform.M00 * localVerticesX[i] + transform.M01 * localVerticesY[i] + transform.M03;
+                float y = transform.M10 * localVerticesX[i] + transform.M11 * localVerticesY[i] + transform.M13;
 
-                edge.P2OnWorld = transform * edge.P2;
-                edge.EdgeVectorOnWorld = edge.P2OnWorld - edge.P1OnWorld;
-                edge.NormalOnWorld = edge.EdgeVectorOnWorld.Perpendicular;
+                verticesX[i] = x;
+                verticesY[i] = y;
 
-                if (MinX > edge.P1OnWorld.X)
+                if (MinX > x)
                 {
-                    MinX = edge.P1OnWorld.X;
+                    MinX = x;
                 }
 
-                if (MinY > edge.P1OnWorld.Y)
+                if (MinY > y)
                 {
-                    MinY = edge.P1OnWorld.Y;
+                    MinY = y;
                 }
 
-                if (MaxX < edge.P1OnWorld.X)
+                if (MaxX < x)
                 {
-                    MaxX = edge.P1OnWorld.X;
+                    MaxX = x;
                 }
 
-                if (MaxY < edge.P1OnWorld.Y)
+                if (MaxY < y)
                 {
-                    MaxY = edge.P1OnWorld.Y;
+                    MaxY = y;
                 }
 
-                if (edge.P1OnWorld.LengthSquared > boundingCircleRadiusSquared)
+                float lengthSquared = x * x + y * y;
+
+                if (lengthSquared > boundingCircleRadiusSquared)
                 {
-                    boundingCircleRadiusSquared = edge.P1OnWorld.LengthSquared;
+                    boundingCircleRadiusSquared = lengthSquared;
                 }
             }
 
+            Vector4[] packedVerticesX = PackedVerticesX;
+            Vector4[] packedVerticesY = PackedVerticesY;
+            int last = vertexCount - 1;
+
+            for (int i = 0; i < PackedVertexCount; i++)
+            {
+                int first = i * 4;
+
+                packedVerticesX[i] = new Vector4(verticesX[first], verticesX[Math.Min(first + 1, last)], verticesX[Math.Min(first + 2, last)], verticesX[Math.Min(first + 3, last)]);
+                packedVerticesY[i] = new Vector4(verticesY[first], verticesY[Math.Min(first + 1, last)], verticesY[Math.Min(first + 2, last)], verticesY[Math.Min(first + 3, last)]);
+            }
+
+            for (int i = 0; i < vertexCount; i++)
+            {
+                int next = i + 1 != vertexCount ? i + 1 : 0;
+
+                Vector2 edgeVector = new Vector2(verticesX[next] - verticesX[i], verticesY[next] - verticesY[i]);
+                Vector2 normal = edgeVector.Perpendicular;
+
+                LineSegment edge = Edges[i];
+                edge.P1OnWorld = new Vector2(verticesX[i], verticesY[i]);
+                edge.P2OnWorld = new Vector2(verticesX[next], verticesY[next]);
+                edge.EdgeVectorOnWorld = edgeVector;
+                edge.NormalOnWorld = normal;
+
+                //normalized once here instead of on every axis test
+                normal.Normalize();
+
+                EdgesX[i] = edgeVector.X;
+                EdgesY[i] = edgeVector.Y;
+                NormalsX[i] = normal.X;
+                NormalsY[i] = normal.Y;
+            }
+
             BoundingCircleRadius = Mathf.Sqrt(boundingCircleRadiusSquared);
         }
 
@@ -230,6 +304,73 @@ namespace Swarm2D.Engine.Logic
             return true;
         }
 
+        //the segment is clipped by the half planes of the edges, it hits where it enters the last of them
+        internal override bool Raycast(Vector2 origin, Vector2 displacement, out float fraction, out Vector2 normal)
+        {
+            fraction = 0.0f;
+            normal = Vector2.Zero;
+
+            float enterFraction = 0.0f;
+            float exitFraction = 1.0f;
+
+            int enterEdge = -1;
+
+            for (int i = 0; i < VertexCount; i++)
+            {
+                float normalX = NormalsX[i];
+                float normalY = NormalsY[i];
+
+                //normals follow the winding, the outward one points away from the center
+                if ((VerticesX[i] - CurrentCenter.X) * normalX + (VerticesY[i] - CurrentCenter.Y) * normalY < 0.0f)
+                {
+                    normalX = -normalX;
+                    normalY = -normalY;
+                }
+
+                float distance = (origin.X - VerticesX[i]) * normalX + (origin.Y - VerticesY[i]) * normalY;
+                float speed = displacement.X * normalX + displacement.Y * normalY;
+
+                if (Mathf.IsZero(speed))
+                {
+                    if (distance > 0.0f)
+                    {
+                        return false;
+                    }
+
+                    continue;
+                }
+
+                float edgeFraction = -distance / speed;
+
+                if (speed < 0.0f)
+                {
+                    if (edgeFraction > enterFraction)
+                    {
+                        enterFraction = edgeFraction;
+                        enterEdge = i;
+                        normal = new Vector2(normalX, normalY);
+                    }
+                }
+                else if (edgeFraction < exitFraction)
+                {
+                    exitFraction = edgeFraction;
+                }
+
+                if (enterFraction > exitFraction)
+                {
+                    return false;
+                }
+            }
+
+            if (enterEdge == -1)
+            {
+                normal = -1.0f * displacement.Normalized;
+            }
+
+            fraction = enterFraction;
+            return true;
+        }
+
         //TODO: complete method
         public override bool IsIntersects(LineSegment lineSegment)
         {
@@ -36,5 +36,8 @@ namespace Swarm2D.Engine.Logic
         public PhysicsObject Collider;
         public Vector2 Point;
         public Vector2 Normal;
+
+        //from the ray origin to the point
+        public float Distance;
     }
 }
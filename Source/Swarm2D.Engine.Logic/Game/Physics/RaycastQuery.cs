@@ -0,0 +1,105 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //state of a single ray while a broadphase walks it. each thread raycasting at the same time needs its own query,
+    //it marks the objects it tested on its own marker so the shared stamps on the objects are not touched
+    internal class RaycastQuery
+    {
+        internal Vector2 Origin { get; private set; }
+        internal Vector2 Displacement { get; private set; }
+
+        //fraction of the displacement to the nearest hit so far, above 1 while nothing is hit
+        internal float Fraction { get; private set; }
+
+        internal PhysicsObject Collider { get; private set; }
+        internal Vector2 Normal { get; private set; }
+
+        internal List<PhysicsObject> Candidates { get; private set; }
+
+        private PhysicsObjectMarker _testedObjects;
+
+        internal RaycastQuery()
+        {
+            Candidates = new List<PhysicsObject>();
+            _testedObjects = new PhysicsObjectMarker();
+        }
+
+        internal void Begin(Vector2 origin, Vector2 displacement)
+        {
+            Origin = origin;
+            Displacement = displacement;
+            Fraction = float.MaxValue;
+            Collider = null;
+            Normal = Vector2.Zero;
+
+            _testedObjects.NextGeneration();
+        }
+
+        internal void Test(PhysicsObject physicsObject)
+        {
+            if (!_testedObjects.Mark(physicsObject) || physicsObject.Type == PhysicsObject.PhysicsType.Trigger)
+            {
+                return;
+            }
+
+            ShapeInstance shapeData = physicsObject.ShapeData;
+
+            float fraction;
+            Vector2 normal;
+
+            if (shapeData.Raycast(Origin, Displacement, out fraction, out normal) && fraction < Fraction)
+            {
+                Fraction = fraction;
+                Collider = physicsObject;
+                Normal = normal;
+            }
+        }
+
+        internal bool GetHit(out RaycastHit hitInfo)
+        {
+            hitInfo = new RaycastHit();
+
+            if (Collider == null)
+            {
+                return false;
+            }
+
+            hitInfo.Collider = Collider;
+            hitInfo.Normal = Normal;
+            hitInfo.Point = Origin + Displacement * Fraction;
+            hitInfo.Distance = Displacement.Length * Fraction;
+
+            return true;
+        }
+    }
+}
@@ -87,5 +87,9 @@ namespace Swarm2D.Engine.Logic
         public abstract bool IsIntersects(LineSegment lineSegment, out Vector2 normal, out Vector2 intersectionPoint);
 
         public abstract bool IsInside(Vector2 worldPosition);
+
+        //first point where the segment from origin to origin + displacement enters the shape, as a fraction of the
+        //displacement. a segment starting inside hits at 0 facing back along itself
+        internal abstract bool Raycast(Vector2 origin, Vector2 displacement, out float fraction, out Vector2 normal);
     }
 }
\ No newline at end of file
@@ -0,0 +1,310 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Logic
+{
+    //keeps the proxies sorted on the x axis, bodies move little between frames so an insertion sort is close to linear.
+    //unbounded, but every proxy is swept so large static maps with few movers are better served by the tree
+    internal class SweepAndPruneBroadphase : IBroadphase
+    {
+        private struct Proxy
+        {
+            public PhysicsObject PhysicsObject;
+            public bool IsRigidBody;
+
+            public float MinX;
+            public float MinY;
+            public float MaxX;
+            public float MaxY;
+        }
+
+        private Proxy[] _proxies;
+        private int _proxyCount;
+
+        private bool _isSorted;
+        private float _maxWidth;
+
+        internal SweepAndPruneBroadphase()
+        {
+            _proxies = new Proxy[256];
+            _isSorted = true;
+        }
+
+        public void AddPhysicsObject(PhysicsObject physicsObject)
+        {
+            //the proxy is created on the first transformation
+            physicsObject.BroadphaseProxy = -1;
+        }
+
+        public void RemovePhysicsObject(PhysicsObject physicsObject)
+        {
+            int proxyIndex = physicsObject.BroadphaseProxy;
+
+            if (proxyIndex >= 0)
+            {
+                //removed proxies are sorted to the end and dropped there
+                _proxies[proxyIndex].PhysicsObject = null;
+                _proxies[proxyIndex].IsRigidBody = false;
+                _proxies[proxyIndex].MinX = float.MaxValue;
+                _proxies[proxyIndex].MaxX = float.MaxValue;
+
+                physicsObject.BroadphaseProxy = -1;
+                _isSorted = false;
+            }
+        }
+
+        public void UpdatePhysicsObject(PhysicsObject physicsObject)
+        {
+            int proxyIndex = physicsObject.BroadphaseProxy;
+
+            if (proxyIndex < 0)
+            {
+                if (_proxyCount == _proxies.Length)
+                {
+                    Array.Resize(ref _proxies, _proxies.Length * 2);
+                }
+
+                proxyIndex = _proxyCount;
+                _proxyCount++;
+
+                _proxies[proxyIndex].PhysicsObject = physicsObject;
+                physicsObject.BroadphaseProxy = proxyIndex;
+            }
+
+            ShapeInstance shapeData = physicsObject.ShapeData;
+
+            _proxies[proxyIndex].IsRigidBody = physicsObject.Type == PhysicsObject.PhysicsType.RigidBody;
+            _proxies[proxyIndex].MinX = shapeData.MinX;
+            _proxies[proxyIndex].MinY = shapeData.MinY;
+            _proxies[proxyIndex].MaxX = shapeData.MaxX;
+            _proxies[proxyIndex].MaxY = shapeData.MaxY;
+
+            _isSorted = false;
+        }
+
+        private void Sort()
+        {
+            if (_isSorted)
+            {
+                return;
+            }
+
+            for (int i = 1; i < _proxyCount; i++)
+            {
+                Proxy proxy = _proxies[i];
+
+                int j = i - 1;
+
+                if (_proxies[j].MinX > proxy.MinX)
+                {
+                    do
+                    {
+                        _proxies[j + 1] = _proxies[j];
+
+                        if (_proxies[j + 1].PhysicsObject != null)
+                        {
+                            _proxies[j + 1].PhysicsObject.BroadphaseProxy = j + 1;
+                        }
+
+                        j--;
+                    }
+                    while (j >= 0 && _proxies[j].MinX > proxy.MinX);
+
+                    _proxies[j + 1] = proxy;
+
+                    if (proxy.PhysicsObject != null)
+                    {
+                        proxy.PhysicsObject.BroadphaseProxy = j + 1;
+                    }
+                }
+            }
+
+            while (_proxyCount > 0 && _proxies[_proxyCount - 1].PhysicsObject == null)
+            {
+                _proxyCount--;
+            }
+
+            _maxWidth = 0.0f;
+
+            for (int i = 0; i < _proxyCount; i++)
+            {
+                _maxWidth = Math.Max(_maxWidth, _proxies[i].MaxX - _proxies[i].MinX);
+            }
+
+            _isSorted = true;
+        }
+
+        public void CollectPairs(LinkedList<PhysicsObject> rigidBodies, List<BroadphasePair> pairs)
+        {
+            Sort();
+
+            for (int i = 0; i < _proxyCount; i++)
+            {
+                Proxy proxyA = _proxies[i];
+
+                for (int j = i + 1; j < _proxyCount; j++)
+                {
+                    Proxy proxyB = _proxies[j];
+
+                    if (proxyB.MinX > proxyA.MaxX)
+                    {
+                        break;
+                    }
+
+                    if ((proxyA.IsRigidBody || proxyB.IsRigidBody) && proxyA.MinY <= proxyB.MaxY && proxyB.MinY <= proxyA.MaxY)
+                    {
+                        //a pair needs an awake rigid body and starts with it
+                        bool awakeA = proxyA.IsRigidBody && !proxyA.PhysicsObject.IsSleeping;
+                        bool awakeB = proxyB.IsRigidBody && !proxyB.PhysicsObject.IsSleeping;
+
+                        if (!awakeA && !awakeB)
+                        {
+                            continue;
+                        }
+
+                        if (awakeA)
+                        {
+                            pairs.Add(new BroadphasePair(proxyA.PhysicsObject, proxyB.PhysicsObject));
+                        }
+                        else
+                        {
+                            pairs.Add(new BroadphasePair(proxyB.PhysicsObject, proxyA.PhysicsObject));
+                        }
+                    }
+                }
+            }
+        }
+
+        public void Query(float minX, float minY, float maxX, float maxY, List<PhysicsObject> result)
+        {
+            Sort();
+
+            //no proxy starting before this can reach the query
+            int first = FindFirstProxy(minX - _maxWidth);
+
+            for (int i = first; i < _proxyCount; i++)
+            {
+                Proxy proxy = _proxies[i];
+
+                if (proxy.MinX > maxX)
+                {
+                    break;
+                }
+
+                if (minX <= proxy.MaxX && proxy.MinY <= maxY && minY <= proxy.MaxY)
+                {
+                    result.Add(proxy.PhysicsObject);
+                }
+            }
+        }
+
+        public void Query(float minX, float minY, float maxX, float maxY, PhysicsObjectMarker marker, List<PhysicsObject> result)
+        {
+            int start = result.Count;
+
+            Query(minX, minY, maxX, maxY, result);
+
+            int count = start;
+
+            for (int i = start; i < result.Count; i++)
+            {
+                if (marker.Mark(result[i]))
+                {
+                    result[count++] = result[i];
+                }
+            }
+
+            result.RemoveRange(count, result.Count - count);
+        }
+
+        //proxies are only ordered on x, the objects in the bounding box of the ray are tested
+        public void Raycast(RaycastQuery query)
+        {
+            float startX = query.Origin.X;
+            float startY = query.Origin.Y;
+            float endX = startX + query.Displacement.X;
+            float endY = startY + query.Displacement.Y;
+
+            query.Candidates.Clear();
+            Query(Math.Min(startX, endX), Math.Min(startY, endY), Math.Max(startX, endX), Math.Max(startY, endY), query.Candidates);
+
+            for (int i = 0; i < query.Candidates.Count; i++)
+            {
+                query.Test(query.Candidates[i]);
+            }
+        }
+
+        //the query sorts the proxies
+        public bool CanQueryInParallel
+        {
+            get { return false; }
+        }
+
+
+        private int FindFirstProxy(float minX)
+        {
+            int low = 0;
+            int high = _proxyCount;
+
+            while (low < high)
+            {
+                int middle = (low + high) / 2;
+
+                if (_proxies[middle].MinX < minX)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+
+            return low;
+        }
+
+        public void Reset()
+        {
+            for (int i = 0; i < _proxyCount; i++)
+            {
+                if (_proxies[i].PhysicsObject != null)
+                {
+                    _proxies[i].PhysicsObject.BroadphaseProxy = -1;
+                }
+
+                _proxies[i] = new Proxy();
+            }
+
+            _proxyCount = 0;
+            _maxWidth = 0.0f;
+            _isSorted = true;
+        }
+    }
+}
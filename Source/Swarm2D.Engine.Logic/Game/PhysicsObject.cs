@@ -43,8 +43,37 @@ namespace Swarm2D.Engine.Logic
             Trigger
         }
 
-        public Vector2 Velocity { get; set; }
-        public float AngularVelocity { get; set; }
+        private Vector2 _velocity;
+        private float _angularVelocity;
+
+        //giving a sleeping body a velocity wakes its island up
+        public Vector2 Velocity
+        {
+            get { return _velocity; }
+            set
+            {
+                _velocity = value;
+
+                if (IsSleeping && !Mathf.IsZero(value))
+                {
+                    WakeUp();
+                }
+            }
+        }
+
+        public float AngularVelocity
+        {
+            get { return _angularVelocity; }
+            set
+            {
+                _angularVelocity = value;
+
+                if (IsSleeping && !Mathf.IsZero(value))
+                {
+                    WakeUp();
+                }
+            }
+        }
 
         public float Mass { get; private set; }
         public float InverseMass { get; private set; }
@@ -126,6 +155,30 @@ namespace Swarm2D.Engine.Logic
         [ComponentProperty]
         public int Layer { get; set; }
 
+        [ComponentProperty]
+        public bool CanSleep { get; set; }
+
+        //swept against the other bodies on every step, so it does not pass through thin bodies when it moves fast
+        [ComponentProperty]
+        public bool ContinuousCollisionDetection { get; set; }
+
+        //a sleeping rigid body is not integrated and not checked against other sleeping or static bodies
+        public bool IsSleeping { get; internal set; }
+
+        //seconds the body stayed under the sleep thresholds of its physics world, and where it was when that started
+        internal float SleepTime { get; set; }
+        internal Vector2 SleepAnchorPosition { get; set; }
+        internal float SleepAnchorRotation { get; set; }
+
+        internal int IslandIndex { get; set; }
+        internal int SolverIndex { get; set; }
+        internal PhysicsObject NextInSleepingIsland { get; set; }
+
+        internal bool IsAwakeRigidBody
+        {
+            get { return _type == PhysicsType.RigidBody && !IsSleeping; }
+        }
+
         public bool IsStatic
         {
             get
@@ -138,7 +191,7 @@ namespace Swarm2D.Engine.Logic
 
         internal bool RepositionedOnCurrentUpdate { get; set; }
 
-        internal LinkedList<Collision> Collisions { get; private set; }
+        internal List<Collision> Collisions { get; private set; }
 
         internal int StaticCollisionCount { get; private set; }
 
@@ -150,6 +203,23 @@ namespace Swarm2D.Engine.Logic
             }
         }
 
+        //bodies touching this one as found on the last simulation step
+        public void GetContacts(List<CollisionInfo> result)
+        {
+            for (int i = 0; i < Collisions.Count; i++)
+            {
+                Collision collision = Collisions[i];
+
+                CollisionInfo collisionInfo = new CollisionInfo();
+
+                collisionInfo.CollidedBody = collision.PhysicsObjectA == this ? collision.PhysicsObjectB : collision.PhysicsObjectA;
+                collisionInfo.Normal = collision.Normal;
+                collisionInfo.IntersectionPoint = collision.IntersectionPoint;
+
+                result.Add(collisionInfo);
+            }
+        }
+
         internal Vector2 MinimumTranslation { get; set; }
 
         internal Vector2 PreviousPosition { get; set; }
@@ -158,9 +228,16 @@ namespace Swarm2D.Engine.Logic
 
         private bool _isTransformDirty;
 
-        internal List<PhysicsObject> CurrentlyCollectedRigidBodiesToCheckWith { get; private set; }
-        internal List<PhysicsObject> CurrentlyCollectedStaticBodiesToCheckWith { get; private set; }
-        internal List<PhysicsObject> CurrentlyCollectedTriggersToCheckWith { get; private set; }
+        //unique in the physics world while the object is in it, orders the pairs of rigid bodies in the broadphase
+        internal int PhysicsId { get; set; }
+
+        //new every time the object is added to the physics world, unlike the id which is reused. it may wrap around,
+        //it is only compared for equality
+        internal int PhysicsGeneration { get; set; }
+
+        //broadphase specific, proxy index for sweep and prune, leaf node for the tree
+        internal int BroadphaseProxy { get; set; }
+        internal int BroadphaseQueryStamp { get; set; }
 
         internal LinkedListNode<PhysicsObject> NodeOnPhysicsObjectList { get; set; }
         internal LinkedListNode<PhysicsObject> NodeOnTypeList { get; set; } //rigid body, trigger list etc..
@@ -177,12 +254,9 @@ namespace Swarm2D.Engine.Logic
             _newGrids = new List<PhysicsWorldGridCell>();
             CurrentGrids = new List<PhysicsWorldGridCell>();
 
-            Collisions = new LinkedList<Collision>();
+            Collisions = new List<Collision>();
 
-            //those below had a parameter in their constructors as 64
-            CurrentlyCollectedRigidBodiesToCheckWith = new List<PhysicsObject>();
-            CurrentlyCollectedStaticBodiesToCheckWith = new List<PhysicsObject>();
-            CurrentlyCollectedTriggersToCheckWith = new List<PhysicsObject>();
+            BroadphaseProxy = -1;
         }
 
         protected override void OnAdded()
@@ -210,6 +284,12 @@ namespace Swarm2D.Engine.Logic
                 FixedRotation = false;
                 Layer = 0;
 
+                CanSleep = true;
+                IsSleeping = false;
+                SleepTime = 0.0f;
+
+                ContinuousCollisionDetection = false;
+
                 AddedToOrderdedRigidBodiesToRepositionList = false;
                 RepositionedOnCurrentUpdate = false;
             }
@@ -289,9 +369,6 @@ namespace Swarm2D.Engine.Logic
                 _newGrids.Clear();
                 CurrentGrids.Clear();
                 Collisions.Clear();
-                CurrentlyCollectedRigidBodiesToCheckWith.Clear();
-                CurrentlyCollectedStaticBodiesToCheckWith.Clear();
-                CurrentlyCollectedTriggersToCheckWith.Clear();
 
                 _shapeFilter = null;
                 ShapeData = null;
@@ -323,8 +400,25 @@ namespace Swarm2D.Engine.Logic
             }
         }
 
+        public void WakeUp()
+        {
+            if (IsSleeping)
+            {
+                PhysicsWorld.WakeUp(this);
+            }
+            else
+            {
+                SleepTime = 0.0f;
+            }
+        }
+
         public void ApplyImpulse(Vector2 impulse, Vector2 point)
         {
+            if (IsSleeping)
+            {
+                WakeUp();
+            }
+
             float pointCrossImpulse = point * impulse;
 
             Velocity += impulse * InverseMass;
@@ -335,19 +429,6 @@ namespace Swarm2D.Engine.Logic
             }
         }
 
-        internal Collision FindExistingCollisionWith(PhysicsObject physicsObject)
-        {
-            foreach (Collision collisison in Collisions)
-            {
-                if (collisison.PhysicsObjectA == physicsObject || collisison.PhysicsObjectB == physicsObject)
-                {
-                    return collisison;
-                }
-            }
-
-            return null;
-        }
-
         private bool CheckBoundingCircleWith(PhysicsObject physicsObject)
         {
             float centerDistanceSquared = (SceneEntity.GlobalPosition - physicsObject.SceneEntity.GlobalPosition).LengthSquared;
@@ -358,7 +439,7 @@ namespace Swarm2D.Engine.Logic
             return boundingCircleRadiusSquared >= centerDistanceSquared;
         }
 
-        private bool CheckAABBWith(PhysicsObject physicsObject)
+        internal bool CheckAABBWith(PhysicsObject physicsObject)
         {
             return ((physicsObject.ShapeData.MinX <= ShapeData.MinX && ShapeData.MinX <= physicsObject.ShapeData.MaxX) ||
                    (ShapeData.MinX <= physicsObject.ShapeData.MinX && physicsObject.ShapeData.MinX <= ShapeData.MaxX)) &&
@@ -367,42 +448,6 @@ namespace Swarm2D.Engine.Logic
                    (ShapeData.MinY <= physicsObject.ShapeData.MinY && physicsObject.ShapeData.MinY <= ShapeData.MaxY));
         }
 
-        internal Collision CheckIntersectionAndGetCollision(PhysicsObject physicsObject)
-        {
-            Collision collision = null;
-
-            Vector2 minmumTranslation;
-            Vector2 intersectionPoint;
-
-            if (CheckIntersection(physicsObject, out minmumTranslation, out intersectionPoint))
-            {
-                collision = FindExistingCollisionWith(physicsObject);
-
-                if (collision == null)
-                {
-                    collision = new Collision();
-
-                    collision.PhysicsObjectA = this;
-                    collision.PhysicsObjectB = physicsObject;
-
-                    collision.NewlyFoundOnCurrentUpdate = true;
-
-                }
-                else
-                {
-                    collision.NewlyFoundOnCurrentUpdate = false;
-                }
-
-                collision.MinimumTranslation = minmumTranslation;
-                collision.Normal = minmumTranslation.Normalized;
-                collision.IntersectionPoint = intersectionPoint;
-
-                collision.FoundOnCurrentUpdate = true;
-            }
-
-            return collision;
-        }
-
         internal bool CheckIntersection(PhysicsObject physicsObject, out Vector2 minimumTranslation, out Vector2 intersectionPoint)
         {
             minimumTranslation = Vector2.Zero;
@@ -445,7 +490,10 @@ namespace Swarm2D.Engine.Logic
 
             ShapeData.PrepareTransformation(ref transform);
 
-            UpdateOnGrid(PhysicsWorld.Grid);
+            if (PhysicsWorld.Broadphase != null)
+            {
+                PhysicsWorld.Broadphase.UpdatePhysicsObject(this);
+            }
         }
 
         internal void RepositionUsingCollisionInformations()
@@ -548,28 +596,55 @@ namespace Swarm2D.Engine.Logic
             CheckAndMakeTransformation();
         }
 
-        internal LinkedListNode<Collision> AddCollision(Collision collision)
+        internal void AddCollision(Collision collision)
         {
-            LinkedListNode<Collision> result = Collisions.AddLast(collision);
+            SetIndexOn(collision, Collisions.Count);
+            Collisions.Add(collision);
 
             if (collision.IsStaticCollision)
             {
                 StaticCollisionCount++;
             }
-
-            return result;
         }
 
-        internal void RemoveCollision(LinkedListNode<Collision> collisionNode)
+        //swaps the last collision into the removed one's place, so the order of Collisions is not kept
+        internal void RemoveCollision(Collision collision)
         {
-            Collisions.Remove(collisionNode);
+            int index = GetIndexOn(collision);
+            int lastIndex = Collisions.Count - 1;
 
-            if (collisionNode.Value.IsStaticCollision)
+            Debug.Assert(Collisions[index] == collision, "collision is not on this physics object");
+
+            Collision lastCollision = Collisions[lastIndex];
+            Collisions[index] = lastCollision;
+            SetIndexOn(lastCollision, index);
+            Collisions.RemoveAt(lastIndex);
+
+            SetIndexOn(collision, -1);
+
+            if (collision.IsStaticCollision)
             {
                 StaticCollisionCount--;
             }
         }
 
+        private int GetIndexOn(Collision collision)
+        {
+            return collision.PhysicsObjectA == this ? collision.IndexOnA : collision.IndexOnB;
+        }
+
+        private void SetIndexOn(Collision collision, int index)
+        {
+            if (collision.PhysicsObjectA == this)
+            {
+                collision.IndexOnA = index;
+            }
+            else
+            {
+                collision.IndexOnB = index;
+            }
+        }
+
         public bool IsInside(Vector2 worldPosition)
         {
             CheckAndMakeTransformation();
@@ -584,13 +659,12 @@ namespace Swarm2D.Engine.Logic
         internal void UpdateOnGrid(PhysicsWorldGrid grid)
         {
             float inverseGridLength = 1.0f / grid.Length;
-            int halfGridSize = grid.Size / 2;
 
-            int minGridX = (int)(ShapeData.MinX * inverseGridLength) + halfGridSize; //TODO: duplication
-            int minGridY = (int)(ShapeData.MinY * inverseGridLength) + halfGridSize;
+            int minGridX = (int)(ShapeData.MinX * inverseGridLength); //TODO: duplication
+            int minGridY = (int)(ShapeData.MinY * inverseGridLength);
 
-            int maxGridX = (int)(ShapeData.MaxX * inverseGridLength) + halfGridSize;
-            int maxGridY = (int)(ShapeData.MaxY * inverseGridLength) + halfGridSize;
+            int maxGridX = (int)(ShapeData.MaxX * inverseGridLength);
+            int maxGridY = (int)(ShapeData.MaxY * inverseGridLength);
 
             if (_minGridX != minGridX || _minGridY != minGridY || _maxGridX != maxGridX || _maxGridY != maxGridY)
             {
@@ -621,6 +695,12 @@ namespace Swarm2D.Engine.Logic
         [EntityMessageHandler(MessageType = typeof(SceneEntityTransformMatrixChangeMesssage))]
         private void OnEntityTransformMatrixChange(Message message)
         {
+            //sleeping bodies do not move by themselves, someone else moved it
+            if (IsSleeping)
+            {
+                WakeUp();
+            }
+
             MakeTransformDirty();
         }
 
@@ -55,7 +55,22 @@ namespace Swarm2D.Engine.Logic
 
         private List<PhysicsObject> _orderdedRigidBodiesToReposition;
 
-        private bool _checkParallel = false;
+        //changes whenever a static body is added or removed, so navigation can tell when its obstacles are stale
+        internal int StaticBodyVersion { get; private set; }
+
+        internal LinkedList<PhysicsObject> StaticBodies
+        {
+            get { return _staticBodies; }
+        }
+
+        private PhysicsObject[] _solverBodies;
+        private int _solverBodyCount;
+        private int[] _solverAdjacencyStarts;
+        private int[] _solverAdjacency;
+        private long[] _solverSortKeys;
+        private PhysicsObject[] _solverSortedBodies;
+        private bool _contactGraphDirty;
+
         private bool _makeParallelTransformations = false;
         private bool __resolveCollisionsParallel = false;
 
@@ -64,19 +79,69 @@ namespace Swarm2D.Engine.Logic
 
         private float _dt = 0.0f;
 
-        private LinkedList<Collision> _collisionList;
+        private ContactCache _contactCache;
+        private int _currentStep;
 
         private List<Collision> _removedCollisionsOnLastSimulate;
         private List<Collision> _addedCollisionsOnLastSimulate;
 
-        private int _debugCount = 100;
-        private double _totalDebug = 0.0f;
+        //contacts of removed physics objects, message handlers may still be walking them so they are released on the next step
+        private List<Collision> _detachedCollisions;
 
         public bool SimulationEnabled { get; set; }
         public DebugPhysicsWorldStep CurrentDebugState { get; private set; }
         public bool DoNextSimulationStep { get; set; }
 
-        internal PhysicsWorldGrid Grid { get; private set; }
+        internal IBroadphase Broadphase { get; private set; }
+
+        public int BroadphasePairCount { get; private set; }
+
+        public int ContactCount
+        {
+            get { return _contactCache.Count; }
+        }
+
+        //islands of touching rigid bodies that stay under the thresholds for SleepTime seconds are put to sleep together
+        [ComponentProperty]
+        public bool SleepingEnabled { get; set; }
+
+        //in pixels per second
+        [ComponentProperty]
+        public float SleepLinearVelocity { get; set; }
+
+        //in radians per second
+        [ComponentProperty]
+        public float SleepAngularVelocity { get; set; }
+
+        //in pixels and degrees a resting body may drift before its sleep timer restarts
+        [ComponentProperty]
+        public float SleepPositionTolerance { get; set; }
+
+        [ComponentProperty]
+        public float SleepRotationTolerance { get; set; }
+
+        [ComponentProperty]
+        public float SleepTime { get; set; }
+
+        public int AwakeBodyCount { get; private set; }
+        public int SleepingBodyCount { get; private set; }
+
+        //awake bodies of the step with their union find parents and the smallest sleep time of each island root
+        private List<PhysicsObject> _islandBodies;
+        private int[] _islandParents;
+        private float[] _islandSleepTimes;
+        private PhysicsObject[] _islandRings;
+
+        private List<PhysicsObject> _islandStack;
+
+        private List<BroadphasePair> _broadphasePairs;
+        private List<PhysicsObject> _queryResult;
+
+        private int _nextPhysicsId = 1;
+
+        //ids of removed objects are given to new ones, so the arrays kept by id only grow with the objects in the world
+        private Stack<int> _freePhysicsIds;
+        private int _physicsGeneration;
 
         public PhysicsMaterial DefaultPhysicsMaterial { get; private set; }
 
@@ -91,8 +156,38 @@ namespace Swarm2D.Engine.Logic
         private float _gridCellLength = 64.0f;
         private int _gridSize = 512;
 
+        private BroadphaseType _broadphaseType = BroadphaseType.Grid;
+        private float _broadphaseMargin = 8.0f;
+
         private int[] _layerCollisionControl = new int[32];
 
+        //one for each thread, the first one is for the calling thread
+        private RaycastQuery[] _raycastQueries;
+
+        private ParallelForDelegate _raycastBatchJob;
+        private IReadOnlyList<Ray> _raycastBatchRays;
+        private float _raycastBatchDistance;
+        private RaycastHit[] _raycastBatchResults;
+
+        private const int RaycastBatchSize = 16;
+
+        //one for each thread like the raycast queries
+        private OverlapQueryContext[] _overlapQueryContexts;
+
+        private ParallelForDelegate _overlapBatchJob;
+        private IReadOnlyList<OverlapQuery> _overlapBatchQueries;
+        private PhysicsObject[] _overlapBatchResults;
+        private int _overlapBatchResultsPerQuery;
+        private int[] _overlapBatchResultCounts;
+
+        private const int OverlapBatchSize = 16;
+
+        //a batch of rays or overlap queries runs on the job system when there are at least this many of them
+        public int ParallelQueryThreshold { get; set; }
+
+        //distance left between a swept body and what it hit, so the discrete test still finds the contact
+        private const float ContinuousCollisionSlop = 1.0f;
+
         [ComponentProperty]
         public float GridCellLength 
         {
@@ -106,6 +201,7 @@ namespace Swarm2D.Engine.Logic
             }
         }
 
+        //the grid has no bounds anymore, kept so the scenes saving it still load
         [ComponentProperty]
         public int GridSize
         {
@@ -119,6 +215,33 @@ namespace Swarm2D.Engine.Logic
             }
         }
 
+        [ComponentProperty]
+        public BroadphaseType BroadphaseType
+        {
+            get { return _broadphaseType; }
+            set
+            {
+                if (!IsInitialized)
+                {
+                    _broadphaseType = value;
+                }
+            }
+        }
+
+        //fat AABB margin of the dynamic tree, larger values mean fewer reinsertions but more false pairs
+        [ComponentProperty]
+        public float BroadphaseMargin
+        {
+            get { return _broadphaseMargin; }
+            set
+            {
+                if (!IsInitialized)
+                {
+                    _broadphaseMargin = value;
+                }
+            }
+        }
+
         private TriggerEnterMessage _triggerEnterMessage;
         private TriggerExitMessage _triggerExitMessage;
 
@@ -147,10 +270,46 @@ namespace Swarm2D.Engine.Logic
             PhysicsObjects = new LinkedList<PhysicsObject>();
 
             _orderdedRigidBodiesToReposition = new List<PhysicsObject>(16384);
-            _collisionList = new LinkedList<Collision>();
+
+            _solverBodies = new PhysicsObject[1024];
+            _solverAdjacencyStarts = new int[1025];
+            _solverAdjacency = new int[4096];
+            _solverSortKeys = new long[1024];
+            _solverSortedBodies = new PhysicsObject[1024];
+
+            _contactCache = new ContactCache();
+            _freePhysicsIds = new Stack<int>();
 
             _removedCollisionsOnLastSimulate = new List<Collision>();
             _addedCollisionsOnLastSimulate = new List<Collision>();
+            _detachedCollisions = new List<Collision>();
+
+            _broadphasePairs = new List<BroadphasePair>(16384);
+            _queryResult = new List<PhysicsObject>();
+
+            _narrowphaseJob = CheckIntersections;
+
+            _raycastQueries = new RaycastQuery[1];
+            _raycastBatchJob = RaycastBatch;
+
+            _overlapQueryContexts = new OverlapQueryContext[1];
+            _overlapBatchJob = OverlapBatch;
+            ParallelQueryThreshold = 64;
+            ParallelNarrowphase = true;
+            ParallelNarrowphaseThreshold = 512;
+
+            SleepingEnabled = true;
+            SleepLinearVelocity = 0.05f * MeterToPixel;
+            SleepAngularVelocity = 2.0f * Mathf.Deg2Rad;
+            SleepPositionTolerance = 0.08f * MeterToPixel;
+            SleepRotationTolerance = 2.0f;
+            SleepTime = 0.5f;
+
+            _islandBodies = new List<PhysicsObject>();
+            _islandParents = new int[1024];
+            _islandSleepTimes = new float[1024];
+            _islandRings = new PhysicsObject[1024];
+            _islandStack = new List<PhysicsObject>();
 
             _rigidBodies = new LinkedList<PhysicsObject>();
             _staticBodies = new LinkedList<PhysicsObject>();
@@ -172,7 +331,25 @@ namespace Swarm2D.Engine.Logic
         {
             base.OnInitialize();
 
-            Grid = new PhysicsWorldGrid(GridSize, GridCellLength);
+            switch (BroadphaseType)
+            {
+                case BroadphaseType.SweepAndPrune:
+                    Broadphase = new SweepAndPruneBroadphase();
+                    break;
+                case BroadphaseType.DynamicAabbTree:
+                    Broadphase = new DynamicAabbTreeBroadphase(BroadphaseMargin);
+                    break;
+                default:
+                    Broadphase = new GridBroadphase(GridCellLength);
+                    break;
+            }
+
+            //objects added before the world is initialized are registered now, they get their proxies on their first transformation
+            foreach (PhysicsObject physicsObject in PhysicsObjects)
+            {
+                Broadphase.AddPhysicsObject(physicsObject);
+                physicsObject.MakeTransformDirty();
+            }
         }
 
         [EntityMessageHandler(MessageType = typeof(SceneControllerUpdateMessage))]
@@ -182,14 +359,11 @@ namespace Swarm2D.Engine.Logic
             const int iterationCount = 1;
             _dt = 1.0f / (float)(frameRate * iterationCount);
 
-            Stopwatch stopwatch = new Stopwatch();
-            stopwatch.Start();
-
             //if (GameInput.GetKeyDown(KeyCode.KeyP))
             //{
-            //	_checkParallel = !_checkParallel;
+            //	ParallelNarrowphase = !ParallelNarrowphase;
             //
-            //	Debug.Log("_checkParallel: " + _checkParallel);
+            //	Debug.Log("ParallelNarrowphase: " + ParallelNarrowphase);
             //}
             //
             //if (GameInput.GetKeyDown(KeyCode.KeyO))
@@ -205,11 +379,6 @@ namespace Swarm2D.Engine.Logic
             //
             //	Debug.Log("__resolveCollisionsParallel: " + __resolveCollisionsParallel);
             //}
-            //
-            //if (GameInput.GetKeyDown(KeyCode.KeyK))
-            //{
-            //	_debugCount = 0;
-            //}
 
             //DebugRender.Disabled = false;
 
@@ -237,6 +406,8 @@ namespace Swarm2D.Engine.Logic
                     case DebugPhysicsWorldStep.ResolveCollisions:
                         CurrentDebugState = DebugPhysicsWorldStep.UpdatePositions;
                         ResolveCollisions();
+                        SendCollisionMessages();
+                        UpdateSleeping();
                         break;
                 }
             }
@@ -247,31 +418,13 @@ namespace Swarm2D.Engine.Logic
             //{
             //	DebugRender.AddDebugLine(collision.RigidBodyA.SceneEntity.LocalPosition, collision.RigidBodyA.SceneEntity.LocalPosition + collision.MinimumTranslation);
             //}
-
-            stopwatch.Stop();
-
-            if (_debugCount < 60)
-            {
-                double elapsedMiliseconds = ((double)stopwatch.ElapsedTicks * 1000.0) / (double)Stopwatch.Frequency;
-                _totalDebug += elapsedMiliseconds;
-                Debug.Log(elapsedMiliseconds + " ms");
-                _debugCount++;
-            }
-            else if (_debugCount == 60)
-            {
-                Debug.Log("Total " + _totalDebug + " ms");
-                Debug.Log("Average " + (_totalDebug / 60.0) + " ms");
-                _totalDebug = 0.0f;
-                _debugCount = 100;
-            }
-
-            stopwatch = null;
         }
 
         public override void OnIdleUpdate()
         {
             base.OnIdleUpdate();
 
+            Scene.FlushTransforms();
             MakeTransformations();
         }
 
@@ -279,29 +432,42 @@ namespace Swarm2D.Engine.Logic
         {
             CurrentDebugState = DebugPhysicsWorldStep.UpdatePositions;
 
-            Stopwatch sw = new Stopwatch();
-            sw.Start();
+            EngineProfiler profiler = Engine.Profiler;
 
+            profiler.BeginSample("PhysicsWorld.UpdatePositions");
             UpdatePositions();
+            profiler.EndSample();
 
-            long positionMs = sw.ElapsedMilliseconds;
-            sw.Stop();
-            sw.Start();
-
+            profiler.BeginSample("PhysicsWorld.CheckCollisions");
             CheckCollisions();
-            long checkMs = sw.ElapsedMilliseconds;
-            sw.Stop();
-            sw.Start();
+            profiler.EndSample();
 
+            profiler.BeginSample("PhysicsWorld.ResolveCollisions");
             ResolveCollisions();
-            long resolveMs = sw.ElapsedMilliseconds;
-            sw.Stop();
-            sw.Start();
+            profiler.EndSample();
+
+            profiler.BeginSample("PhysicsWorld.SendCollisionMessages");
+            SendCollisionMessages();
+            profiler.EndSample();
+
+            profiler.BeginSample("PhysicsWorld.Islands");
+            UpdateSleeping();
+            profiler.EndSample();
         }
 
         internal void AddPhysicsObject(PhysicsObject physicsObject)
         {
             physicsObject.NodeOnPhysicsObjectList = PhysicsObjects.AddLast(physicsObject);
+            physicsObject.PhysicsId = _freePhysicsIds.Count > 0 ? _freePhysicsIds.Pop() : _nextPhysicsId++;
+            physicsObject.PhysicsGeneration = ++_physicsGeneration;
+            physicsObject.IsSleeping = false;
+            physicsObject.SleepTime = 0.0f;
+            physicsObject.NextInSleepingIsland = null;
+
+            if (Broadphase != null)
+            {
+                Broadphase.AddPhysicsObject(physicsObject);
+            }
 
             switch (physicsObject.Type)
             {
@@ -310,6 +476,7 @@ namespace Swarm2D.Engine.Logic
                     break;
                 case PhysicsObject.PhysicsType.Static:
                     physicsObject.NodeOnTypeList = _staticBodies.AddLast(physicsObject);
+                    StaticBodyVersion++;
                     break;
                 case PhysicsObject.PhysicsType.Trigger:
                     physicsObject.NodeOnTypeList = _triggers.AddLast(physicsObject);
@@ -317,10 +484,14 @@ namespace Swarm2D.Engine.Logic
             }
 
             physicsObject.MakeTransformDirty();
+
+            _contactGraphDirty = true;
         }
 
         internal void RemovePhysicsObject(PhysicsObject physicsObject)
         {
+            _contactGraphDirty = true;
+
             PhysicsObjects.Remove(physicsObject.NodeOnPhysicsObjectList);
             physicsObject.NodeOnPhysicsObjectList = null;
 
@@ -331,6 +502,7 @@ namespace Swarm2D.Engine.Logic
                     break;
                 case PhysicsObject.PhysicsType.Static:
                     _staticBodies.Remove(physicsObject.NodeOnTypeList);
+                    StaticBodyVersion++;
                     break;
                 case PhysicsObject.PhysicsType.Trigger:
                     _triggers.Remove(physicsObject.NodeOnTypeList);
@@ -339,150 +511,198 @@ namespace Swarm2D.Engine.Logic
 
             physicsObject.NodeOnTypeList = null;
 
-            for (int i = 0; i < physicsObject.CurrentGrids.Count; i++)
+            if (Broadphase != null)
             {
-                PhysicsWorldGridCell physicsWorldGridCell = physicsObject.CurrentGrids[i];
-
-                physicsWorldGridCell.RemovePhysicsObject(physicsObject);
+                Broadphase.RemovePhysicsObject(physicsObject);
             }
 
-            physicsObject.CurrentGrids.Clear();
-
-            if (physicsObject.Collisions.Count > 0)
+            //bodies sleeping on the removed one lose their support, a sleeping removed body also leaves its island ring
+            if (physicsObject.IsSleeping)
             {
-                LinkedListNode<Collision> currentNode = physicsObject.Collisions.First;
-
-                while (currentNode != null)
-                {
-                    Collision collision = currentNode.Value;
+                WakeUp(physicsObject);
+            }
 
-                    LinkedListNode<Collision> nextNode = currentNode.Next;
+            for (int i = 0; i < physicsObject.Collisions.Count; i++)
+            {
+                Collision collision = physicsObject.Collisions[i];
 
-                    physicsObject.RemoveCollision(currentNode);
+                PhysicsObject otherPhysicsObject = collision.PhysicsObjectA == physicsObject
+                    ? collision.PhysicsObjectB
+                    : collision.PhysicsObjectA;
 
-                    PhysicsObject otherPhysicsObject = collision.PhysicsObjectA == physicsObject
-                        ? collision.PhysicsObjectB
-                        : collision.PhysicsObjectA;
+                if (otherPhysicsObject.IsSleeping)
+                {
+                    WakeUp(otherPhysicsObject);
+                }
+            }
 
-                    LinkedListNode<Collision> nodeOnOther = collision.PhysicsObjectA == physicsObject
-                        ? collision.NodeOnB
-                        : collision.NodeOnA;
+            for (int i = physicsObject.Collisions.Count - 1; i >= 0; i--)
+            {
+                Collision collision = physicsObject.Collisions[i];
 
-                    otherPhysicsObject.RemoveCollision(nodeOnOther);
-                    _collisionList.Remove(collision.NodeOnList);
+                collision.PhysicsObjectA.RemoveCollision(collision);
+                collision.PhysicsObjectB.RemoveCollision(collision);
 
-                    currentNode = nextNode;
-                }
+                _contactCache.Remove(collision);
+                _detachedCollisions.Add(collision);
             }
 
             physicsObject.RemoveTransformDirtyInformation();
+
+            //every contact of the object is gone, no pair keyed by its id is left
+            _freePhysicsIds.Push(physicsObject.PhysicsId);
         }
 
+        //finds the nearest object on the ray which is not a trigger
         public bool Raycast(Ray ray, out RaycastHit hitInfo, float distance)
         {
-            hitInfo = new RaycastHit();
+            RaycastQuery query = GetRaycastQuery(0);
+
+            query.Begin(ray.Origin, ray.Direction * distance);
+            Broadphase.Raycast(query);
 
-            LineSegment lineSegment = new LineSegment(ray.Origin, ray.Origin + ray.Direction * distance);
+            return query.GetHit(out hitInfo);
+        }
 
-            int minGridX = (int)(lineSegment.P1.X / Grid.Length) + Grid.Size / 2;
-            int minGridY = (int)(lineSegment.P1.Y / Grid.Length) + Grid.Size / 2;
+        //same as Raycast for every ray, a result without a collider is a miss. on the grid broadphase the rays are
+        //spread to the job system when there are enough of them, nothing may move the physics objects meanwhile
+        public void RaycastBatch(IReadOnlyList<Ray> rays, float distance, RaycastHit[] results)
+        {
+            Debug.Assert(results.Length >= rays.Count, "there are less results than rays");
 
-            int maxGridX = (int)(lineSegment.P2.X / Grid.Length) + Grid.Size / 2;
-            int maxGridY = (int)(lineSegment.P2.Y / Grid.Length) + Grid.Size / 2;
+            _raycastBatchRays = rays;
+            _raycastBatchDistance = distance;
+            _raycastBatchResults = results;
 
-            if (minGridX > maxGridX)
+            if (Broadphase.CanQueryInParallel && rays.Count >= ParallelQueryThreshold)
             {
-                int swapper = minGridX;
-                minGridX = maxGridX;
-                maxGridX = swapper;
-            }
+                JobSystem jobSystem = Framework.Current.JobSystem;
 
-            if (minGridY > maxGridY)
+                for (int i = 0; i < jobSystem.ThreadCount; i++)
+                {
+                    GetRaycastQuery(i);
+                }
+
+                jobSystem.ParallelFor(rays.Count, RaycastBatchSize, _raycastBatchJob);
+            }
+            else
             {
-                int swapper = minGridY;
-                minGridY = maxGridY;
-                maxGridY = swapper;
+                RaycastBatch(0, rays.Count, 0);
             }
 
-            for (int x = minGridX; x <= maxGridX; x++)
+            _raycastBatchRays = null;
+            _raycastBatchResults = null;
+        }
+
+        private void RaycastBatch(int startIndex, int endIndex, int threadIndex)
+        {
+            RaycastQuery query = _raycastQueries[threadIndex];
+
+            for (int i = startIndex; i < endIndex; i++)
             {
-                for (int y = minGridY; y <= maxGridY; y++)
-                {
-                    //TODO: it does not finds the nearest collided object
-                    foreach (PhysicsObject physicsObject in Grid[x, y].PhysicsObjects)
-                    {
-                        Vector2 normal;
-                        Vector2 intersectionPoint;
+                Ray ray = _raycastBatchRays[i];
 
-                        if (physicsObject.Type != PhysicsObject.PhysicsType.Trigger
-                            && physicsObject.ShapeData.IsIntersects(lineSegment, out normal, out intersectionPoint))
-                        {
-                            hitInfo.Collider = physicsObject;
-                            hitInfo.Normal = normal;
-                            hitInfo.Point = intersectionPoint;
+                query.Begin(ray.Origin, ray.Direction * _raycastBatchDistance);
+                Broadphase.Raycast(query);
+                query.GetHit(out _raycastBatchResults[i]);
+            }
+        }
 
-                            return true;
-                        }
-                    }
-                }
+        private RaycastQuery GetRaycastQuery(int threadIndex)
+        {
+            if (threadIndex >= _raycastQueries.Length)
+            {
+                Array.Resize(ref _raycastQueries, threadIndex + 1);
             }
 
-            return false;
+            if (_raycastQueries[threadIndex] == null)
+            {
+                _raycastQueries[threadIndex] = new RaycastQuery();
+            }
+
+            return _raycastQueries[threadIndex];
         }
 
-        public void GetPhysicsObjectsIn(Vector2 position, float radius, List<PhysicsObject> result, bool onlyRigidAndStaticBodies = false)
+        //the objects overlapping query i are written to results from i * resultsPerQuery on, and their count to
+        //resultCounts[i]. the ones past resultsPerQuery are dropped. on the grid broadphase the queries are spread to
+        //the job system when there are enough of them, nothing may move the physics objects meanwhile
+        public void OverlapBatch(IReadOnlyList<OverlapQuery> queries, PhysicsObject[] results, int resultsPerQuery, int[] resultCounts)
         {
-            Vector2 p1 = new Vector2(position.X - radius, position.Y - radius);
-            Vector2 p2 = new Vector2(position.X + radius, position.Y + radius);
+            Debug.Assert(results.Length >= queries.Count * resultsPerQuery, "results can not hold resultsPerQuery objects for every query");
+            Debug.Assert(resultCounts.Length >= queries.Count, "there are less result counts than queries");
 
-            float inverseGridLength = 1.0f / Grid.Length;
+            _overlapBatchQueries = queries;
+            _overlapBatchResults = results;
+            _overlapBatchResultsPerQuery = resultsPerQuery;
+            _overlapBatchResultCounts = resultCounts;
 
-            int minGridX = (int)(p1.X * inverseGridLength) + Grid.Size / 2;
-            int minGridY = (int)(p1.Y * inverseGridLength) + Grid.Size / 2;
+            if (Broadphase.CanQueryInParallel && queries.Count >= ParallelQueryThreshold)
+            {
+                JobSystem jobSystem = Framework.Current.JobSystem;
 
-            int maxGridX = (int)(p2.X * inverseGridLength) + Grid.Size / 2;
-            int maxGridY = (int)(p2.Y * inverseGridLength) + Grid.Size / 2;
+                for (int i = 0; i < jobSystem.ThreadCount; i++)
+                {
+                    GetOverlapQueryContext(i);
+                }
 
-            if (minGridX > maxGridX)
+                jobSystem.ParallelFor(queries.Count, OverlapBatchSize, _overlapBatchJob);
+            }
+            else
             {
-                int swapper = minGridX;
-                minGridX = maxGridX;
-                maxGridX = swapper;
+                GetOverlapQueryContext(0);
+                OverlapBatch(0, queries.Count, 0);
             }
 
-            if (minGridY > maxGridY)
+            _overlapBatchQueries = null;
+            _overlapBatchResults = null;
+            _overlapBatchResultCounts = null;
+        }
+
+        private void OverlapBatch(int startIndex, int endIndex, int threadIndex)
+        {
+            OverlapQueryContext context = _overlapQueryContexts[threadIndex];
+
+            for (int i = startIndex; i < endIndex; i++)
             {
-                int swapper = minGridY;
-                minGridY = maxGridY;
-                maxGridY = swapper;
+                OverlapQuery query = _overlapBatchQueries[i];
+
+                _overlapBatchResultCounts[i] = context.Execute(Broadphase, ref query, _overlapBatchResults, i * _overlapBatchResultsPerQuery, _overlapBatchResultsPerQuery);
             }
+        }
 
-            _checkCircle.Radius = radius;
-            _checkCircleData.PrepareTransformation(position);
+        private OverlapQueryContext GetOverlapQueryContext(int threadIndex)
+        {
+            if (threadIndex >= _overlapQueryContexts.Length)
+            {
+                Array.Resize(ref _overlapQueryContexts, threadIndex + 1);
+            }
 
-            for (int x = minGridX; x <= maxGridX; x++)
+            if (_overlapQueryContexts[threadIndex] == null)
             {
-                for (int y = minGridY; y <= maxGridY; y++)
-                {
-                    Vector2 gridP1 = new Vector2();
+                _overlapQueryContexts[threadIndex] = new OverlapQueryContext();
+            }
 
-                    gridP1.X = (x - Grid.Size / 2) * Grid.Length;
-                    gridP1.Y = (y - Grid.Size / 2) * Grid.Length;
+            return _overlapQueryContexts[threadIndex];
+        }
 
-                    Vector2 gridP2 = gridP1 + new Vector2(Grid.Length, Grid.Length);
+        public void GetPhysicsObjectsIn(Vector2 position, float radius, List<PhysicsObject> result, bool onlyRigidAndStaticBodies = false)
+        {
+            _checkCircle.Radius = radius;
+            _checkCircleData.PrepareTransformation(position);
 
-                    bool gridTotallyInside = Vector2.Distance(position, gridP1) < radius && Vector2.Distance(position, gridP2) < radius;
+            _queryResult.Clear();
+            Broadphase.Query(position.X - radius, position.Y - radius, position.X + radius, position.Y + radius, _queryResult);
 
-                    foreach (PhysicsObject physicsObject in Grid[x, y].PhysicsObjects) //TODO
+            for (int i = 0; i < _queryResult.Count; i++)
+            {
+                PhysicsObject physicsObject = _queryResult[i];
+
+                if (!onlyRigidAndStaticBodies ||
+                    onlyRigidAndStaticBodies && physicsObject.Type != PhysicsObject.PhysicsType.Trigger)
+                {
+                    if (physicsObject.ShapeData.CheckIntersection(_checkCircleData))
                     {
-                        if (!onlyRigidAndStaticBodies ||
-                            onlyRigidAndStaticBodies && physicsObject.Type != PhysicsObject.PhysicsType.Trigger)
-                        {
-                            if (gridTotallyInside || physicsObject.ShapeData.CheckIntersection(_checkCircleData))
-                            {
-                                result.Add(physicsObject);
-                            }
-                        }
+                        result.Add(physicsObject);
                     }
                 }
             }
@@ -494,6 +714,9 @@ namespace Swarm2D.Engine.Logic
         {
             MakeUpdatePositionsJob();
 
+            //moved bodies mark themselves dirty on their transform change message
+            Scene.FlushTransforms();
+
             if (_makeParallelTransformations)
             {
                 MakeTransformationsParallel();
@@ -502,6 +725,12 @@ namespace Swarm2D.Engine.Logic
             {
                 MakeTransformations();
             }
+
+            if (SweepContinuousBodies())
+            {
+                Scene.FlushTransforms();
+                MakeTransformations();
+            }
         }
 
         private void MakeUpdatePositionsJob()
@@ -526,6 +755,12 @@ namespace Swarm2D.Engine.Logic
             {
                 PhysicsObject rigidBody = currentRigidBodyNode.Value;
 
+                if (rigidBody.IsSleeping)
+                {
+                    currentRigidBodyNode = currentRigidBodyNode.Next;
+                    continue;
+                }
+
                 if (Mathf.IsZero(rigidBody.Velocity.Length))
                 {
                     rigidBody.Velocity = Vector2.Zero;
@@ -545,8 +780,11 @@ namespace Swarm2D.Engine.Logic
             {
                 PhysicsObject rigidBody = currentRigidBodyNode.Value;
 
-                rigidBody.SceneEntity.LocalPosition += rigidBody.Velocity * _dt;
-                rigidBody.SceneEntity.LocalRotation += rigidBody.AngularVelocity * Mathf.Rad2Deg * _dt;
+                if (!rigidBody.IsSleeping)
+                {
+                    rigidBody.SceneEntity.LocalPosition += rigidBody.Velocity * _dt;
+                    rigidBody.SceneEntity.LocalRotation += rigidBody.AngularVelocity * Mathf.Rad2Deg * _dt;
+                }
 
                 currentRigidBodyNode = currentRigidBodyNode.Next;
             }
@@ -557,7 +795,10 @@ namespace Swarm2D.Engine.Logic
             {
                 PhysicsObject rigidBody = currentRigidBodyNode.Value;
 
-                rigidBody.Velocity += Gravity * _dt;
+                if (!rigidBody.IsSleeping)
+                {
+                    rigidBody.Velocity += Gravity * _dt;
+                }
 
                 currentRigidBodyNode = currentRigidBodyNode.Next;
             }
@@ -589,239 +830,268 @@ namespace Swarm2D.Engine.Logic
 
         #endregion
 
-        #region Collision Detection
+        #region Continuous Collision Detection
 
-        struct CollisionCheckData
+        //bodies with continuous collision detection that moved more than half of their size in this step are swept
+        //from their previous position against what the broadphase finds on the way, and put back to the first touch.
+        //the rest of the motion is dropped, the solver handles the contact on the next checks
+        private bool SweepContinuousBodies()
         {
-            public PhysicsObject PhysicsObjectA;
-            public PhysicsObject PhysicsObjectB;
-            public Collision Collision;
-        }
-
-        private List<CollisionCheckData> _collisionCheckDatas = new List<CollisionCheckData>(131288);
-
-        private void CheckCollisions()
-        {
-            foreach (Collision collision in _collisionList)
-            {
-                collision.FoundOnCurrentUpdate = false;
-            }
-
-            _addedCollisionsOnLastSimulate.Clear();
-            _removedCollisionsOnLastSimulate.Clear();
+            bool anyBodyMoved = false;
 
-            {
-                CollectCollisionBetweenRigidAndStaticBodies();
-                CollectCollisionBetweenRigidBodies();
-                CollectCollisionBetweenRigidBodiesAndTriggers();
-            }
-            
             LinkedListNode<PhysicsObject> currentRigidBodyNode = _rigidBodies.First;
 
             while (currentRigidBodyNode != null)
             {
                 PhysicsObject rigidBody = currentRigidBodyNode.Value;
-
-                rigidBody.CurrentlyCollectedRigidBodiesToCheckWith.Clear();
-                rigidBody.CurrentlyCollectedStaticBodiesToCheckWith.Clear();
-                rigidBody.CurrentlyCollectedTriggersToCheckWith.Clear();
-
                 currentRigidBodyNode = currentRigidBodyNode.Next;
-            }
 
-            if (_checkParallel && false)
-            {
-                //Parallel.For(0, _collisionCheckDatas.Count, i =>
-                //{
-                //	CollisionCheckData collisionCheckData = _collisionCheckDatas[i];
-                //
-                //	PhysicsObject physicsObjectA = collisionCheckData.PhysicsObjectA;
-                //	PhysicsObject physicsObjectB = collisionCheckData.PhysicsObjectB;
-                //
-                //	collisionCheckData.Collision = physicsObjectA.CheckIntersectionAndGetCollision(physicsObjectB);
-                //
-                //	_collisionCheckDatas[i] = collisionCheckData;
-                //});
-            }
-            else
-            {
-                for (int i = 0; i < _collisionCheckDatas.Count; i++)
+                if (!rigidBody.ContinuousCollisionDetection || rigidBody.IsSleeping)
                 {
-                    CollisionCheckData collisionCheckData = _collisionCheckDatas[i];
+                    continue;
+                }
 
-                    PhysicsObject physicsObjectA = collisionCheckData.PhysicsObjectA;
-                    PhysicsObject physicsObjectB = collisionCheckData.PhysicsObjectB;
+                ShapeInstance shape = rigidBody.ShapeData;
 
-                    collisionCheckData.Collision = physicsObjectA.CheckIntersectionAndGetCollision(physicsObjectB);
+                Vector2 displacement = rigidBody.SceneEntity.LocalPosition - rigidBody.PreviousPosition;
 
-                    _collisionCheckDatas[i] = collisionCheckData;
+                float minimumExtent = Math.Min(shape.MaxX - shape.MinX, shape.MaxY - shape.MinY);
+
+                if (displacement.LengthSquared <= minimumExtent * minimumExtent * 0.25f)
+                {
+                    continue;
                 }
-            }
 
-            for (int i = 0; i < _collisionCheckDatas.Count; i++)
-            {
-                CollisionCheckData collisionCheckData = _collisionCheckDatas[i];
+                _queryResult.Clear();
+                Broadphase.Query(shape.MinX - Math.Max(displacement.X, 0.0f), shape.MinY - Math.Max(displacement.Y, 0.0f),
+                    shape.MaxX - Math.Min(displacement.X, 0.0f), shape.MaxY - Math.Min(displacement.Y, 0.0f), _queryResult);
 
-                Collision collision = collisionCheckData.Collision;
+                float timeOfImpact = float.MaxValue;
 
-                if (collision != null && collision.NewlyFoundOnCurrentUpdate)
+                for (int i = 0; i < _queryResult.Count; i++)
                 {
-                    PhysicsObject physicsObjectA = collisionCheckData.PhysicsObjectA;
-                    PhysicsObject physicsObjectB = collisionCheckData.PhysicsObjectB;
+                    PhysicsObject physicsObject = _queryResult[i];
+
+                    if (physicsObject == rigidBody || physicsObject.Type == PhysicsObject.PhysicsType.Trigger ||
+                        !CheckIfLayersAllowCollision(rigidBody.Layer, physicsObject.Layer))
+                    {
+                        continue;
+                    }
+
+                    //both shapes are at the end of the step, the other one is swept along with this one
+                    Vector2 relativeDisplacement = displacement;
+
+                    if (physicsObject.Type == PhysicsObject.PhysicsType.RigidBody && !physicsObject.IsSleeping)
+                    {
+                        relativeDisplacement -= physicsObject.SceneEntity.LocalPosition - physicsObject.PreviousPosition;
+                    }
+
+                    float currentTimeOfImpact;
+
+                    if (IntersectionTests.CalculateTimeOfImpact(shape, physicsObject.ShapeData, relativeDisplacement, out currentTimeOfImpact) &&
+                        currentTimeOfImpact < timeOfImpact)
+                    {
+                        timeOfImpact = currentTimeOfImpact;
+                    }
+                }
 
-                    collision.NodeOnA = physicsObjectA.AddCollision(collision);
-                    collision.NodeOnB = physicsObjectB.AddCollision(collision);
+                if (timeOfImpact > 1.0f)
+                {
+                    continue;
+                }
 
-                    collision.NodeOnList = _collisionList.AddLast(collision);
-                    _addedCollisionsOnLastSimulate.Add(collision);
+                float distance = displacement.Length;
+                float remainingDistance = distance * (1.0f - timeOfImpact);
+
+                if (remainingDistance <= ContinuousCollisionSlop)
+                {
+                    continue;
                 }
+
+                rigidBody.SceneEntity.LocalPosition -= displacement * (Math.Min(remainingDistance + ContinuousCollisionSlop, distance) / distance);
+                anyBodyMoved = true;
             }
 
-            _collisionCheckDatas.Clear();
+            return anyBodyMoved;
+        }
+
+        #endregion
+
+        #region Collision Detection
+
+        struct CollisionCheckData
+        {
+            public PhysicsObject PhysicsObjectA;
+            public PhysicsObject PhysicsObjectB;
 
-            RemoveSeperatedCollisions();
+            //written by the narrowphase, every batch writes only its own slice
+            public bool Intersects;
+            public Vector2 MinimumTranslation;
+            public Vector2 IntersectionPoint;
         }
 
-        private void CollectCollisionBetweenRigidBodies()
+        private CollisionCheckData[] _collisionCheckDatas = new CollisionCheckData[131288];
+        private int _collisionCheckDataCount;
+
+        private ParallelForDelegate _narrowphaseJob;
+
+        //narrowphase runs on the job system when there are at least this many pairs
+        public int ParallelNarrowphaseThreshold { get; set; }
+
+        public bool ParallelNarrowphase { get; set; }
+
+        private void CheckCollisions()
         {
-            LinkedListNode<PhysicsObject> currentRigidBodyANode = _rigidBodies.First;
+            //exit messages of the last step are sent, their contacts can go back to the pool
+            for (int i = 0; i < _removedCollisionsOnLastSimulate.Count; i++)
+            {
+                _contactCache.Release(_removedCollisionsOnLastSimulate[i]);
+            }
 
-            while (currentRigidBodyANode != null)
+            for (int i = 0; i < _detachedCollisions.Count; i++)
             {
-                PhysicsObject rigidBodyA = currentRigidBodyANode.Value;
+                _contactCache.Release(_detachedCollisions[i]);
+            }
 
-                for (int j = 0; j < rigidBodyA.CurrentGrids.Count; j++)
-                {
-                    LinkedListNode<PhysicsObject> currentRigidBodyBNode = rigidBodyA.CurrentGrids[j].RigidBodies.First;
+            _addedCollisionsOnLastSimulate.Clear();
+            _removedCollisionsOnLastSimulate.Clear();
+            _detachedCollisions.Clear();
 
-                    while (currentRigidBodyBNode != null)
-                    {
-                        PhysicsObject rigidBodyB = currentRigidBodyBNode.Value;
+            _currentStep++;
 
-                        if (rigidBodyA != rigidBodyB)
-                        {
-                            if (CheckIfLayersAllowCollision(rigidBodyA.Layer, rigidBodyB.Layer))
-                            {
-                                CollisionCheckData collisionCheckData = new CollisionCheckData();
-                                collisionCheckData.PhysicsObjectA = rigidBodyA;
-                                collisionCheckData.PhysicsObjectB = rigidBodyB;
-
-                                if (!rigidBodyA.CurrentlyCollectedRigidBodiesToCheckWith.Contains(rigidBodyB))
-                                {
-                                    rigidBodyA.CurrentlyCollectedRigidBodiesToCheckWith.Add(rigidBodyB);
-                                    rigidBodyB.CurrentlyCollectedRigidBodiesToCheckWith.Add(rigidBodyA);
-                                    _collisionCheckDatas.Add(collisionCheckData);
-                                }
-                            }
-                        }
+            EngineProfiler profiler = Engine.Profiler;
 
-                        currentRigidBodyBNode = currentRigidBodyBNode.Next;
-                    }
-                }
+            profiler.BeginSample("PhysicsWorld.Broadphase");
+            CollectCollisionCandidates();
+            profiler.EndSample();
+
+            profiler.BeginSample("PhysicsWorld.Narrowphase");
+
+            if (ParallelNarrowphase && _collisionCheckDataCount >= ParallelNarrowphaseThreshold)
+            {
+                //global transforms are propagated lazily on read, workers must find them up to date
+                Scene.TransformSystem.PropagateTransforms();
 
-                currentRigidBodyANode = currentRigidBodyANode.Next;
+                Framework.Current.JobSystem.ParallelFor(_collisionCheckDataCount, NarrowphaseBatchSize, _narrowphaseJob);
+            }
+            else
+            {
+                CheckIntersections(0, _collisionCheckDataCount, 0);
             }
-        }
 
-        private void CollectCollisionBetweenRigidAndStaticBodies()
-        {
-            LinkedListNode<PhysicsObject> currentRigidBodyNode = _rigidBodies.First;
+            profiler.EndSample();
 
-            while (currentRigidBodyNode != null)
+            //collisions are created and linked on this thread in pair order, so the result does not depend on the worker count
+            for (int i = 0; i < _collisionCheckDataCount; i++)
             {
-                PhysicsObject rigidBody = currentRigidBodyNode.Value;
+                CollisionCheckData collisionCheckData = _collisionCheckDatas[i];
 
-                for (int j = 0; j < rigidBody.CurrentGrids.Count; j++)
+                if (collisionCheckData.Intersects)
                 {
-                    LinkedListNode<PhysicsObject> currentStaticBodyNode = rigidBody.CurrentGrids[j].StaticBodies.First;
+                    PhysicsObject physicsObjectA = collisionCheckData.PhysicsObjectA;
+                    PhysicsObject physicsObjectB = collisionCheckData.PhysicsObjectB;
+
+                    Vector2 minimumTranslation = collisionCheckData.MinimumTranslation;
 
-                    while (currentStaticBodyNode != null)
+                    Collision collision = _contactCache.Find(physicsObjectA, physicsObjectB);
+
+                    if (collision == null)
                     {
-                        PhysicsObject staticBody = currentStaticBodyNode.Value;
+                        collision = _contactCache.Add(physicsObjectA, physicsObjectB);
+                        collision.FirstFoundStep = _currentStep;
 
-                        if (CheckIfLayersAllowCollision(rigidBody.Layer, staticBody.Layer))
-                        {
-                            CollisionCheckData collisionCheckData = new CollisionCheckData();
-                            collisionCheckData.PhysicsObjectA = rigidBody;
-                            collisionCheckData.PhysicsObjectB = staticBody;
-
-                            if (!rigidBody.CurrentlyCollectedStaticBodiesToCheckWith.Contains(staticBody))
-                            {
-                                rigidBody.CurrentlyCollectedStaticBodiesToCheckWith.Add(staticBody);
-                                _collisionCheckDatas.Add(collisionCheckData);
-                            }
-                        }
+                        physicsObjectA.AddCollision(collision);
+                        physicsObjectB.AddCollision(collision);
+                    }
+                    else if (collision.PhysicsObjectA != physicsObjectA)
+                    {
+                        //the contact was created with the pair the other way around
+                        minimumTranslation = -1.0f * minimumTranslation;
+                    }
 
-                        currentStaticBodyNode = currentStaticBodyNode.Next;
+                    collision.Update(_currentStep, minimumTranslation, collisionCheckData.IntersectionPoint);
+
+                    //pairs always start with an awake rigid body, touching a sleeping one wakes its island
+                    if (physicsObjectB.IsSleeping)
+                    {
+                        WakeUp(physicsObjectB);
                     }
                 }
-
-                currentRigidBodyNode = currentRigidBodyNode.Next;
             }
-        }
 
-        private void CollectCollisionBetweenRigidBodiesAndTriggers()
-        {
-            LinkedListNode<PhysicsObject> currentRigidBodyNode = _rigidBodies.First;
+            Array.Clear(_collisionCheckDatas, 0, _collisionCheckDataCount);
+            _collisionCheckDataCount = 0;
 
-            while (currentRigidBodyNode != null)
+            //a single pass finds both the entered and the exited contacts
+            for (int i = 0; i < _contactCache.Count;)
             {
-                PhysicsObject rigidBody = currentRigidBodyNode.Value;
+                Collision collision = _contactCache[i];
 
-                for (int j = 0; j < rigidBody.CurrentGrids.Count; j++)
+                //contacts without an awake rigid body are not checked while sleeping, they are kept as they are
+                if (collision.LastFoundStep != _currentStep &&
+                    (collision.PhysicsObjectA.IsAwakeRigidBody || collision.PhysicsObjectB.IsAwakeRigidBody))
                 {
-                    LinkedListNode<PhysicsObject> currentTriggerNode = rigidBody.CurrentGrids[j].Triggers.First;
+                    collision.PhysicsObjectA.RemoveCollision(collision);
+                    collision.PhysicsObjectB.RemoveCollision(collision);
 
-                    while (currentTriggerNode != null)
+                    //the last contact is swapped into this index, so it is checked next
+                    _contactCache.Remove(collision);
+                    _removedCollisionsOnLastSimulate.Add(collision);
+                }
+                else
+                {
+                    if (collision.FirstFoundStep == _currentStep)
                     {
-                        PhysicsObject trigger = currentTriggerNode.Value;
-
-                        if (CheckIfLayersAllowCollision(rigidBody.Layer, trigger.Layer))
-                        {
-                            CollisionCheckData collisionCheckData = new CollisionCheckData();
-                            collisionCheckData.PhysicsObjectA = rigidBody;
-                            collisionCheckData.PhysicsObjectB = trigger;
-
-                            if (!rigidBody.CurrentlyCollectedTriggersToCheckWith.Contains(trigger))
-                            {
-                                rigidBody.CurrentlyCollectedTriggersToCheckWith.Add(trigger);
-                                _collisionCheckDatas.Add(collisionCheckData);
-                            }
-                        }
-
-                        currentTriggerNode = currentTriggerNode.Next;
+                        _addedCollisionsOnLastSimulate.Add(collision);
                     }
-                }
 
-                currentRigidBodyNode = currentRigidBodyNode.Next;
+                    i++;
+                }
             }
+
+            BuildContactGraph();
         }
 
-        private void RemoveSeperatedCollisions()
+        private const int NarrowphaseBatchSize = 64;
+
+        //touches nothing but the check datas in the given range, safe to run on worker threads
+        private void CheckIntersections(int startIndex, int endIndex, int threadIndex)
         {
-            LinkedListNode<Collision> currentNode = _collisionList.First;
+            CollisionCheckData[] collisionCheckDatas = _collisionCheckDatas;
 
-            while (currentNode != null)
+            for (int i = startIndex; i < endIndex; i++)
             {
-                Collision collision = currentNode.Value;
+                Vector2 minimumTranslation;
+                Vector2 intersectionPoint;
 
-                LinkedListNode<Collision> nextNode = currentNode.Next;
+                collisionCheckDatas[i].Intersects = collisionCheckDatas[i].PhysicsObjectA.CheckIntersection(collisionCheckDatas[i].PhysicsObjectB, out minimumTranslation, out intersectionPoint);
+                collisionCheckDatas[i].MinimumTranslation = minimumTranslation;
+                collisionCheckDatas[i].IntersectionPoint = intersectionPoint;
+            }
+        }
 
-                if (!collision.FoundOnCurrentUpdate)
-                {
-                    PhysicsObject physicsObjectA = collision.PhysicsObjectA;
-                    PhysicsObject physicsObjectB = collision.PhysicsObjectB;
+        private void CollectCollisionCandidates()
+        {
+            _broadphasePairs.Clear();
+            Broadphase.CollectPairs(_rigidBodies, _broadphasePairs);
 
-                    //Debug.Log("collision exit between " + rigidBodyA.Entity.Name + " " + rigidBodyB.Entity.Name + " !");
-                    _collisionList.Remove(currentNode);
+            BroadphasePairCount = _broadphasePairs.Count;
 
-                    _removedCollisionsOnLastSimulate.Add(collision);
+            for (int i = 0; i < _broadphasePairs.Count; i++)
+            {
+                BroadphasePair broadphasePair = _broadphasePairs[i];
 
-                    physicsObjectA.RemoveCollision(collision.NodeOnA);
-                    physicsObjectB.RemoveCollision(collision.NodeOnB);
-                }
+                if (CheckIfLayersAllowCollision(broadphasePair.PhysicsObjectA.Layer, broadphasePair.PhysicsObjectB.Layer))
+                {
+                    if (_collisionCheckDataCount == _collisionCheckDatas.Length)
+                    {
+                        Array.Resize(ref _collisionCheckDatas, _collisionCheckDatas.Length * 2);
+                    }
 
-                currentNode = nextNode;
+                    _collisionCheckDatas[_collisionCheckDataCount].PhysicsObjectA = broadphasePair.PhysicsObjectA;
+                    _collisionCheckDatas[_collisionCheckDataCount].PhysicsObjectB = broadphasePair.PhysicsObjectB;
+                    _collisionCheckDataCount++;
+                }
             }
         }
 
@@ -845,136 +1115,187 @@ namespace Swarm2D.Engine.Logic
                 }
                 else
                 {
-                    foreach (Collision collision in _collisionList)
+                    for (int i = 0; i < _contactCache.Count; i++)
                     {
-                        collision.Resolve();
+                        Collision collision = _contactCache[i];
+
+                        if (collision.PhysicsObjectA.IsAwakeRigidBody || collision.PhysicsObjectB.IsAwakeRigidBody)
+                        {
+                            collision.Resolve();
+                        }
                     }
                 }
             }
-
-            SendCollisionMessages();
         }
 
-        private void SortRigidBodies()
+        //keeps the rigid bodies list stably sorted by static and then all contact counts, and builds the contacts
+        //of the step between awake rigid bodies in compressed rows following that order
+        private void BuildContactGraph()
         {
-            //_rigidBodies.Sort(RigidBodySorterForCollisionResolution);
+            int rigidBodyCount = _rigidBodies.Count;
 
-            if (_rigidBodies.Count > 1)
+            if (_solverBodies.Length < rigidBodyCount)
             {
-                bool sort = true;
+                _solverBodies = new PhysicsObject[rigidBodyCount * 2];
+                _solverAdjacencyStarts = new int[rigidBodyCount * 2 + 1];
+                _solverSortKeys = new long[rigidBodyCount * 2];
+                _solverSortedBodies = new PhysicsObject[rigidBodyCount * 2];
+            }
 
-                while (sort) //bubble sort
-                {
-                    sort = false;
+            bool sorted = true;
+            int index = 0;
+
+            for (LinkedListNode<PhysicsObject> currentRigidBodyNode = _rigidBodies.First; currentRigidBodyNode != null; currentRigidBodyNode = currentRigidBodyNode.Next)
+            {
+                PhysicsObject rigidBody = currentRigidBodyNode.Value;
 
-                    LinkedListNode<PhysicsObject> currentNode = _rigidBodies.First;
+                _solverSortedBodies[index] = rigidBody;
+                _solverSortKeys[index] = GetSortKey(rigidBody.StaticCollisionCount, rigidBody.CollisionCount, index);
 
-                    while (currentNode.Next != null)
-                    {
-                        LinkedListNode<PhysicsObject> nextNode = currentNode.Next;
+                if (index > 0 && _solverSortKeys[index] < _solverSortKeys[index - 1])
+                {
+                    sorted = false;
+                }
 
-                        if (RigidBodySorterForCollisionResolution(currentNode.Value, nextNode.Value) == 1)
-                        {
-                            PhysicsObject rigidBodySwapper = currentNode.Value;
-                            currentNode.Value = nextNode.Value;
-                            nextNode.Value = rigidBodySwapper;
+                index++;
+            }
 
-                            currentNode.Value.NodeOnTypeList = currentNode;
-                            nextNode.Value.NodeOnTypeList = nextNode;
-                            sort = true;
-                        }
+            if (!sorted)
+            {
+                //the index in the key makes the sort stable, the list keeps the order for the next step's ties
+                Array.Sort(_solverSortKeys, 0, rigidBodyCount);
 
-                        currentNode = currentNode.Next;
-                    }
+                for (int i = 0; i < rigidBodyCount; i++)
+                {
+                    LinkedListNode<PhysicsObject> node = _solverSortedBodies[(int)(_solverSortKeys[i] & SortKeyIndexMask)].NodeOnTypeList;
+
+                    _rigidBodies.Remove(node);
+                    _rigidBodies.AddLast(node);
                 }
             }
-        }
-
-        private void PrepareRepositionList()
-        {
-            SortRigidBodies();
 
-            _orderdedRigidBodiesToReposition.Clear();
+            int bodyCount = 0;
+            int edgeCount = 0;
 
+            for (LinkedListNode<PhysicsObject> currentRigidBodyNode = _rigidBodies.First; currentRigidBodyNode != null; currentRigidBodyNode = currentRigidBodyNode.Next)
             {
-                LinkedListNode<PhysicsObject> currentRigidBodyNode = _rigidBodies.First;
+                PhysicsObject rigidBody = currentRigidBodyNode.Value;
 
-                while (currentRigidBodyNode != null)
+                if (!rigidBody.IsSleeping)
                 {
-                    PhysicsObject rigidBody = currentRigidBodyNode.Value;
-
-                    rigidBody.RepositionedOnCurrentUpdate = false;
-                    rigidBody.AddedToOrderdedRigidBodiesToRepositionList = false;
-
-                    currentRigidBodyNode = currentRigidBodyNode.Next;
+                    rigidBody.SolverIndex = bodyCount;
+                    _solverBodies[bodyCount] = rigidBody;
+                    bodyCount++;
                 }
             }
 
+            for (int i = 0; i < bodyCount; i++)
             {
-                LinkedListNode<PhysicsObject> currentRigidBodyNode = _rigidBodies.Last;
+                List<Collision> collisions = _solverBodies[i].Collisions;
+
+                _solverAdjacencyStarts[i] = edgeCount;
 
-                //first we'll add rigid bodies that has collision with static objects
+                if (_solverAdjacency.Length < edgeCount + collisions.Count)
                 {
-                    while (currentRigidBodyNode != null)
-                    {
-                        PhysicsObject rigidBody = currentRigidBodyNode.Value;
+                    Array.Resize(ref _solverAdjacency, (edgeCount + collisions.Count) * 2);
+                }
 
-                        if (rigidBody.StaticCollisionCount == 0)
-                        {
-                            break;
-                        }
+                //neighbours are kept in the order of the body's collisions
+                for (int j = 0; j < collisions.Count; j++)
+                {
+                    Collision collision = collisions[j];
 
-                        rigidBody.AddedToOrderdedRigidBodiesToRepositionList = true;
-                        _orderdedRigidBodiesToReposition.Add(rigidBody);
+                    PhysicsObject neighbour = collision.PhysicsObjectA == _solverBodies[i]
+                        ? collision.PhysicsObjectB
+                        : collision.PhysicsObjectA;
 
-                        currentRigidBodyNode = currentRigidBodyNode.Previous;
+                    if (neighbour.IsAwakeRigidBody)
+                    {
+                        _solverAdjacency[edgeCount] = neighbour.SolverIndex;
+                        edgeCount++;
                     }
                 }
+            }
+
+            _solverAdjacencyStarts[bodyCount] = edgeCount;
 
+            Array.Clear(_solverBodies, bodyCount, _solverBodyCount > bodyCount ? _solverBodyCount - bodyCount : 0);
+            Array.Clear(_solverSortedBodies, 0, rigidBodyCount);
 
-                //now we'll add rigid bodies that has indirect collision with static objects
+            _solverBodyCount = bodyCount;
+            _contactGraphDirty = false;
+        }
+
+        private const int SortKeyIndexBits = 21;
+        private const long SortKeyIndexMask = (1L << SortKeyIndexBits) - 1;
+
+        private static long GetSortKey(int staticCollisionCount, int collisionCount, int index)
+        {
+            return ((long)staticCollisionCount << (SortKeyIndexBits * 2)) | ((long)collisionCount << SortKeyIndexBits) | (long)index;
+        }
+
+        //bodies touching statics come first, the ones with more static and then more contacts before the others.
+        //the rest of their islands follow in breadth first order over the contact graph, and the bodies that reach
+        //no static body at last
+        private void PrepareRepositionList()
+        {
+            if (_contactGraphDirty)
+            {
+                BuildContactGraph();
+            }
+
+            _orderdedRigidBodiesToReposition.Clear();
+
+            for (int i = 0; i < _solverBodyCount; i++)
+            {
+                _solverBodies[i].RepositionedOnCurrentUpdate = false;
+                _solverBodies[i].AddedToOrderdedRigidBodiesToRepositionList = false;
+            }
+
+            //the bodies are sorted ascending, the ones touching statics are at the end
+            int bodyIndex = _solverBodyCount - 1;
+
+            for (; bodyIndex >= 0 && _solverBodies[bodyIndex].StaticCollisionCount > 0; bodyIndex--)
+            {
+                AddToRepositionList(_solverBodies[bodyIndex]);
+            }
+
+            for (int i = 0; i < _orderdedRigidBodiesToReposition.Count; i++)
+            {
+                int solverIndex = _orderdedRigidBodiesToReposition[i].SolverIndex;
+
+                for (int j = _solverAdjacencyStarts[solverIndex]; j < _solverAdjacencyStarts[solverIndex + 1]; j++)
                 {
-                    for (int i = 0; i < _orderdedRigidBodiesToReposition.Count; i++)
-                    {
-                        //enteredCurrentLoop = true;
-                        PhysicsObject rigidBody = _orderdedRigidBodiesToReposition[i];
+                    PhysicsObject neighbour = _solverBodies[_solverAdjacency[j]];
 
-                        foreach (Collision collision in rigidBody.Collisions)
-                        {
-                            PhysicsObject neighbour = collision.PhysicsObjectA == rigidBody
-                                ? collision.PhysicsObjectB
-                                : collision.PhysicsObjectA;
-
-                            if (neighbour.Type == PhysicsObject.PhysicsType.RigidBody)
-                            {
-                                if (!neighbour.AddedToOrderdedRigidBodiesToRepositionList)
-                                {
-                                    neighbour.AddedToOrderdedRigidBodiesToRepositionList = true;
-                                    _orderdedRigidBodiesToReposition.Add(neighbour);
-                                }
-                            }
-                        }
+                    if (!neighbour.AddedToOrderdedRigidBodiesToRepositionList)
+                    {
+                        AddToRepositionList(neighbour);
                     }
                 }
+            }
 
-                //finally we'll add the ones that has no direct or indirect collision with static objects
+            for (; bodyIndex >= 0; bodyIndex--)
+            {
+                if (!_solverBodies[bodyIndex].AddedToOrderdedRigidBodiesToRepositionList)
                 {
-                    while (currentRigidBodyNode != null)
-                    {
-                        PhysicsObject rigidBody = currentRigidBodyNode.Value;
-
-                        if (!rigidBody.AddedToOrderdedRigidBodiesToRepositionList)
-                        {
-                            rigidBody.AddedToOrderdedRigidBodiesToRepositionList = true;
-                            _orderdedRigidBodiesToReposition.Add(rigidBody);
-                        }
-
-                        currentRigidBodyNode = currentRigidBodyNode.Previous;
-                    }
+                    AddToRepositionList(_solverBodies[bodyIndex]);
                 }
             }
         }
 
+        private void AddToRepositionList(PhysicsObject rigidBody)
+        {
+            rigidBody.AddedToOrderdedRigidBodiesToRepositionList = true;
+            _orderdedRigidBodiesToReposition.Add(rigidBody);
+        }
+
+        //order the rigid bodies were repositioned in on the last step
+        public void GetRepositionOrder(List<PhysicsObject> result)
+        {
+            result.AddRange(_orderdedRigidBodiesToReposition);
+        }
+
         private void RepositionCollidedBodies()
         {
             //bool enableDebugRenderAfter = false;
@@ -998,29 +1319,249 @@ namespace Swarm2D.Engine.Logic
             //}
         }
 
-        private int RigidBodySorterForCollisionResolution(PhysicsObject a, PhysicsObject b)
+        #endregion
+
+        #region Sleeping
+
+        //wakes the body up with every body sleeping in its island
+        internal void WakeUp(PhysicsObject physicsObject)
         {
-            if (a.StaticCollisionCount > b.StaticCollisionCount)
+            _contactGraphDirty = true;
+            _islandStack.Clear();
+
+            WakeUpBody(physicsObject);
+
+            while (_islandStack.Count > 0)
             {
-                return 1;
+                PhysicsObject body = _islandStack[_islandStack.Count - 1];
+                _islandStack.RemoveAt(_islandStack.Count - 1);
+
+                //the island the body fell asleep with, its contacts may have been lost on the step it slept
+                PhysicsObject islandBody = body.NextInSleepingIsland;
+                body.NextInSleepingIsland = null;
+
+                while (islandBody != null && islandBody != body)
+                {
+                    PhysicsObject nextIslandBody = islandBody.NextInSleepingIsland;
+                    islandBody.NextInSleepingIsland = null;
+
+                    if (islandBody.IsSleeping)
+                    {
+                        WakeUpBody(islandBody);
+                    }
+
+                    islandBody = nextIslandBody;
+                }
+
+                for (int i = 0; i < body.Collisions.Count; i++)
+                {
+                    Collision collision = body.Collisions[i];
+
+                    //the contact was not checked while sleeping, it is kept until the next check
+                    collision.LastFoundStep = _currentStep;
+
+                    PhysicsObject neighbour = collision.PhysicsObjectA == body
+                        ? collision.PhysicsObjectB
+                        : collision.PhysicsObjectA;
+
+                    if (neighbour.IsSleeping)
+                    {
+                        WakeUpBody(neighbour);
+                    }
+                }
             }
-            else if (a.StaticCollisionCount == b.StaticCollisionCount)
+        }
+
+        private void WakeUpBody(PhysicsObject physicsObject)
+        {
+            physicsObject.IsSleeping = false;
+            physicsObject.SleepTime = 0.0f;
+            _islandStack.Add(physicsObject);
+
+            AwakeBodyCount++;
+            SleepingBodyCount--;
+        }
+
+        private void UpdateSleeping()
+        {
+            LinkedListNode<PhysicsObject> currentRigidBodyNode;
+
+            if (!SleepingEnabled && SleepingBodyCount > 0)
             {
-                if (a.CollisionCount > b.CollisionCount)
+                for (currentRigidBodyNode = _rigidBodies.First; currentRigidBodyNode != null; currentRigidBodyNode = currentRigidBodyNode.Next)
                 {
-                    return 1;
+                    if (currentRigidBodyNode.Value.IsSleeping)
+                    {
+                        WakeUp(currentRigidBodyNode.Value);
+                    }
                 }
-                else if (a.CollisionCount < b.CollisionCount)
+            }
+
+            //transform changes of this step are delivered first, they would wake up the bodies put to sleep below
+            Scene.FlushTransforms();
+
+            if (_islandParents.Length < _rigidBodies.Count)
+            {
+                _islandParents = new int[_rigidBodies.Count * 2];
+                _islandSleepTimes = new float[_rigidBodies.Count * 2];
+                _islandRings = new PhysicsObject[_rigidBodies.Count * 2];
+            }
+
+            _islandBodies.Clear();
+
+            int awakeBodyCount = 0;
+            int sleepingBodyCount = 0;
+            bool anyBodyReadyToSleep = false;
+
+            float sleepLinearVelocitySquared = SleepLinearVelocity * SleepLinearVelocity;
+            float sleepPositionToleranceSquared = SleepPositionTolerance * SleepPositionTolerance;
+
+            currentRigidBodyNode = _rigidBodies.First;
+
+            while (currentRigidBodyNode != null)
+            {
+                PhysicsObject rigidBody = currentRigidBodyNode.Value;
+
+                if (rigidBody.IsSleeping)
                 {
-                    return -1;
+                    sleepingBodyCount++;
+                }
+                else
+                {
+                    awakeBodyCount++;
+
+                    rigidBody.IslandIndex = _islandBodies.Count;
+                    _islandParents[_islandBodies.Count] = _islandBodies.Count;
+                    _islandBodies.Add(rigidBody);
+
+                    bool slow = rigidBody.Velocity.LengthSquared <= sleepLinearVelocitySquared &&
+                        Mathf.Abs(rigidBody.AngularVelocity) <= SleepAngularVelocity;
+
+                    //stacked bodies jitter around a point from step to step, so the drift is measured from where the rest started
+                    bool drifted = rigidBody.SleepTime > 0.0f &&
+                        ((rigidBody.SceneEntity.LocalPosition - rigidBody.SleepAnchorPosition).LengthSquared > sleepPositionToleranceSquared ||
+                        Mathf.Abs(rigidBody.SceneEntity.LocalRotation - rigidBody.SleepAnchorRotation) > SleepRotationTolerance);
+
+                    //repositioning holds a supported body in place while its velocity still carries the gravity of the step,
+                    //so a rest starts when the body is slow or touches something and lasts while it does not drift
+                    bool startsResting = slow || rigidBody.CollisionCount > 0;
+
+                    if (!SleepingEnabled || !rigidBody.CanSleep || drifted || (rigidBody.SleepTime == 0.0f && !startsResting))
+                    {
+                        rigidBody.SleepTime = 0.0f;
+                    }
+                    else
+                    {
+                        if (rigidBody.SleepTime == 0.0f)
+                        {
+                            rigidBody.SleepAnchorPosition = rigidBody.SceneEntity.LocalPosition;
+                            rigidBody.SleepAnchorRotation = rigidBody.SceneEntity.LocalRotation;
+                        }
+
+                        rigidBody.SleepTime += _dt;
+                    }
+
+                    if (rigidBody.SleepTime >= SleepTime)
+                    {
+                        anyBodyReadyToSleep = true;
+                    }
+                }
+
+                currentRigidBodyNode = currentRigidBodyNode.Next;
+            }
+
+            AwakeBodyCount = awakeBodyCount;
+            SleepingBodyCount = sleepingBodyCount;
+
+            if (!anyBodyReadyToSleep)
+            {
+                return;
+            }
+
+            //islands are joined over the contacts of this step and the ones lost on it, bodies of a jittering stack
+            //lose and find their contacts on alternate steps but still belong together
+            for (int i = 0; i < _contactCache.Count; i++)
+            {
+                JoinIslands(_contactCache[i]);
+            }
+
+            for (int i = 0; i < _removedCollisionsOnLastSimulate.Count; i++)
+            {
+                JoinIslands(_removedCollisionsOnLastSimulate[i]);
+            }
+
+            for (int i = 0; i < _islandBodies.Count; i++)
+            {
+                _islandSleepTimes[i] = float.MaxValue;
+                _islandRings[i] = null;
+            }
+
+            for (int i = 0; i < _islandBodies.Count; i++)
+            {
+                int root = FindIsland(i);
+
+                if (_islandBodies[i].SleepTime < _islandSleepTimes[root])
+                {
+                    _islandSleepTimes[root] = _islandBodies[i].SleepTime;
                 }
             }
-            else if (a.StaticCollisionCount < b.StaticCollisionCount)
+
+            for (int i = 0; i < _islandBodies.Count; i++)
             {
-                return -1;
+                if (_islandSleepTimes[FindIsland(i)] >= SleepTime)
+                {
+                    PhysicsObject body = _islandBodies[i];
+                    int root = FindIsland(i);
+
+                    body.Velocity = Vector2.Zero;
+                    body.AngularVelocity = 0.0f;
+                    body.IsSleeping = true;
+
+                    //bodies of the island are linked in a ring so they wake up together
+                    PhysicsObject ring = _islandRings[root];
+
+                    if (ring == null)
+                    {
+                        _islandRings[root] = body;
+                        body.NextInSleepingIsland = body;
+                    }
+                    else
+                    {
+                        body.NextInSleepingIsland = ring.NextInSleepingIsland;
+                        ring.NextInSleepingIsland = body;
+                    }
+
+                    AwakeBodyCount--;
+                    SleepingBodyCount++;
+                }
             }
+        }
 
-            return 0;
+        //static bodies do not join islands, two piles on the same floor sleep independently
+        private void JoinIslands(Collision collision)
+        {
+            if (collision.PhysicsObjectA.IsAwakeRigidBody && collision.PhysicsObjectB.IsAwakeRigidBody)
+            {
+                int rootA = FindIsland(collision.PhysicsObjectA.IslandIndex);
+                int rootB = FindIsland(collision.PhysicsObjectB.IslandIndex);
+
+                if (rootA != rootB)
+                {
+                    _islandParents[rootB] = rootA;
+                }
+            }
+        }
+
+        private int FindIsland(int index)
+        {
+            while (_islandParents[index] != index)
+            {
+                //path halving
+                _islandParents[index] = _islandParents[_islandParents[index]];
+                index = _islandParents[index];
+            }
+
+            return index;
         }
 
         #endregion
@@ -1065,9 +1606,17 @@ namespace Swarm2D.Engine.Logic
             PhysicsObjects.Clear();
             _rigidBodies.Clear();
             _staticBodies.Clear();
+            StaticBodyVersion++;
             _triggers.Clear();
-            _collisionList.Clear();
-            Grid.Reset();
+            _contactCache.Clear();
+            AwakeBodyCount = 0;
+            SleepingBodyCount = 0;
+            _addedCollisionsOnLastSimulate.Clear();
+            _removedCollisionsOnLastSimulate.Clear();
+            _detachedCollisions.Clear();
+            _orderdedRigidBodiesToReposition.Clear();
+            _contactGraphDirty = true;
+            Broadphase.Reset();
         }
 
         private void SendCollisionMessages()
@@ -87,6 +87,13 @@ namespace Swarm2D.Engine.Logic
 
         public GameLogic GameLogic { get; internal set; }
 
+        internal SceneTransformSystem TransformSystem { get; private set; }
+
+        //milliseconds spent on incremental loading in a frame
+        public float LoadTimeBudget { get; set; }
+
+        private List<SceneLoadOperation> _loadOperations;
+
         private readonly UpdateMessage _updateMessage = new UpdateMessage();
         private readonly  SceneControllerUpdateMessage _sceneControllerUpdateMessage = new SceneControllerUpdateMessage();
 
@@ -95,6 +102,9 @@ namespace Swarm2D.Engine.Logic
             IsRunning = true;
             SceneEntities = new LinkedList<SceneEntity>();
             SceneControllers = new List<SceneController>();
+            TransformSystem = new SceneTransformSystem();
+            LoadTimeBudget = 4.0f;
+            _loadOperations = new List<SceneLoadOperation>();
 
             _entityDomain = new EntityDomain(Entity);
             Entity.ChildDomain = this;
@@ -112,6 +122,8 @@ namespace Swarm2D.Engine.Logic
 
         internal void OnIdleUpdate()
         {
+            ContinueLoading();
+
             _entityDomain.InitializeNonInitializedEntityComponents();
 
             for (int i = 0; i < SceneControllers.Count; i++)
@@ -122,6 +134,8 @@ namespace Swarm2D.Engine.Logic
             }
 
             _entityDomain.InitializeNonInitializedEntityComponents();
+
+            FlushTransforms();
         }
 
         [DomainMessageHandler(MessageType = typeof(UpdateMessage))]
@@ -133,12 +147,16 @@ namespace Swarm2D.Engine.Logic
             {
                 CurrentFrame++;
 
+                ContinueLoading();
+
                 _entityDomain.InitializeNonInitializedEntityComponents();
 
                 _updateMessage.Dt = updateMessage.Dt;
                 _sceneControllerUpdateMessage.Dt = updateMessage.Dt; 
                 Entity.SendMessage(_sceneControllerUpdateMessage);
                 SendMessage(_updateMessage);
+
+                FlushTransforms();
             }
             else
             {
@@ -146,6 +164,24 @@ namespace Swarm2D.Engine.Logic
             }
         }
 
+        //recalculates the changed world transforms and sends their SceneEntityTransformMatrixChangeMesssage,
+        //done at the end of every scene update and by the scene controllers that need up to date notifications
+        public void FlushTransforms()
+        {
+            TransformSystem.SendTransformChangeMessages();
+        }
+
+        //true if some SceneEntityTransformMatrixChangeMesssage are waiting for FlushTransforms,
+        //state cached by handlers of that message is stale until then
+        public bool HasPendingTransformChanges
+        {
+            get { return TransformSystem.HasDirtyTransforms || TransformSystem.HasPendingTransformChangeMessages; }
+        }
+
+        //flushes on every transform change instead of once per update, for scenes whose transform change handlers
+        //can not wait until the end of the update. changes made by those handlers are sent with the next flush.
+        public bool ImmediateTransformChangeMessages { get; set; }
+
         public SceneEntity FindEntity(string name)
         {
             foreach (SceneEntity sceneEntity in SceneEntities)
@@ -239,6 +275,40 @@ namespace Swarm2D.Engine.Logic
             }
         }
 
+        public void Load(SceneBinaryData sceneData)
+        {
+            SceneLoadOperation loadOperation = new SceneLoadOperation(this, sceneData);
+            loadOperation.Continue(double.PositiveInfinity);
+        }
+
+        //entities are instantiated over the next frames within LoadTimeBudget
+        public SceneLoadOperation LoadIncrementally(SceneBinaryData sceneData)
+        {
+            SceneLoadOperation loadOperation = new SceneLoadOperation(this, sceneData);
+            _loadOperations.Add(loadOperation);
+
+            return loadOperation;
+        }
+
+        internal void ContinueLoading()
+        {
+            if (_loadOperations.Count > 0)
+            {
+                long startTicks = Stopwatch.GetTimestamp();
+                double remainingBudget = LoadTimeBudget;
+
+                while (_loadOperations.Count > 0 && remainingBudget > 0.0)
+                {
+                    if (_loadOperations[0].Continue(remainingBudget))
+                    {
+                        _loadOperations.RemoveAt(0);
+                    }
+
+                    remainingBudget = LoadTimeBudget - (Stopwatch.GetTimestamp() - startTicks) * 1000.0 / Stopwatch.Frequency;
+                }
+            }
+        }
+
         public SceneData Save()
         {
             SceneData sceneData = new SceneData();
@@ -363,7 +433,12 @@ namespace Swarm2D.Engine.Logic
 
         void IEntityDomain.OnEntityParentChanged(Entity entity)
         {
+            SceneEntity sceneEntity = entity.GetComponent<SceneEntity>();
 
+            if (sceneEntity != null)
+            {
+                sceneEntity.OnEntityParentChanged();
+            }
         }
 
         public SceneEntity InstantiatePrefab(string prefabName, Vector2 position, float rotation)
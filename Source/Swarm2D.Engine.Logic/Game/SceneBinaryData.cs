@@ -0,0 +1,513 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Xml;
+using Swarm2D.Engine.Core;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //binary form of SceneData, read in place from the loaded bytes. layout, little endian:
+    //  magic, version
+    //  string table: names and string like values, each stored once
+    //  component type table: type name, then name and ComponentPropertyType of each property
+    //  entity table: name, prefab name (-1 for none), first component index and component count
+    //  component table: type index of each component, scene controllers first then entity components in order
+    //  property columns: for each type and property, (component index, value) pairs sorted by component index
+    //column values have a fixed size, strings, resources, enumerators and objects are string indices
+    public class SceneBinaryData
+    {
+        private const int Magic = 0x42443253; //"S2DB"
+        private const int Version = 1;
+
+        internal sealed class PropertyColumn
+        {
+            public string Name;
+            public ComponentPropertyType Type;
+            public ComponentPropertyInfo PropertyInfo;
+
+            public int Offset;
+            public int Count;
+            public int EntrySize;
+        }
+
+        internal sealed class ComponentType
+        {
+            public string Name;
+            public ComponentInfo ComponentInfo;
+            public PropertyColumn[] Columns;
+        }
+
+        internal struct EntityRecord
+        {
+            public int Name;
+            public int Prefab;
+            public int FirstComponent;
+            public int ComponentCount;
+        }
+
+        public byte[] Data { get; private set; }
+
+        internal string[] Strings { get; private set; }
+        internal ComponentType[] ComponentTypes { get; private set; }
+        internal EntityRecord[] Entities { get; private set; }
+        internal int[] ComponentTypeIndices { get; private set; }
+
+        public int SceneControllerCount { get; private set; }
+
+        public int EntityCount
+        {
+            get { return Entities.Length; }
+        }
+
+        private SceneBinaryData(byte[] data)
+        {
+            Data = data;
+        }
+
+        public static SceneBinaryData FromBytes(byte[] data)
+        {
+            if (data == null || data.Length < 8)
+            {
+                Debug.Log("Scene binary data is empty");
+                return null;
+            }
+
+            SceneBinaryData sceneBinaryData = new SceneBinaryData(data);
+
+            try
+            {
+                if (!sceneBinaryData.Read())
+                {
+                    return null;
+                }
+            }
+            catch (Exception e)
+            {
+                Debug.Log("Scene binary data is corrupted");
+                Debug.Log(e.Message);
+                return null;
+            }
+
+            return sceneBinaryData;
+        }
+
+        public static SceneBinaryData Load(string name)
+        {
+            return FromBytes(Resources.LoadBinaryData(name));
+        }
+
+        public static byte[] ConvertFromXML(XmlDocument xmlDocument)
+        {
+            SceneData sceneData = new SceneData();
+            sceneData.LoadFromXML(xmlDocument);
+
+            return Write(sceneData);
+        }
+
+        internal static int GetValueSize(ComponentPropertyType propertyType)
+        {
+            switch (propertyType)
+            {
+                case ComponentPropertyType.Boolean:
+                    return 1;
+                case ComponentPropertyType.Vector2:
+                    return 8;
+                default:
+                    return 4;
+            }
+        }
+
+        private bool Read()
+        {
+            DataReader reader = new DataReader(Data);
+
+            if (reader.ReadInt32() != Magic)
+            {
+                Debug.Log("Scene binary data has wrong header");
+                return false;
+            }
+
+            int version = reader.ReadInt32();
+
+            if (version != Version)
+            {
+                Debug.Log("Scene binary data version " + version + " is not supported");
+                return false;
+            }
+
+            Strings = new string[reader.ReadInt32()];
+
+            for (int i = 0; i < Strings.Length; i++)
+            {
+                int byteCount = reader.ReadInt32();
+                Strings[i] = Encoding.UTF8.GetString(Data, reader.CurrentIndex, byteCount);
+                reader.CurrentIndex += byteCount;
+            }
+
+            ComponentTypes = new ComponentType[reader.ReadInt32()];
+
+            for (int i = 0; i < ComponentTypes.Length; i++)
+            {
+                ComponentType componentType = new ComponentType();
+                componentType.Name = Strings[reader.ReadInt32()];
+                componentType.ComponentInfo = ComponentInfo.GetComponentInfo(componentType.Name);
+                componentType.Columns = new PropertyColumn[reader.ReadInt32()];
+
+                if (componentType.ComponentInfo == null)
+                {
+                    Debug.Log("Component type " + componentType.Name + " in scene data does not exist, it will be skipped");
+                }
+
+                for (int j = 0; j < componentType.Columns.Length; j++)
+                {
+                    PropertyColumn column = new PropertyColumn();
+                    column.Name = Strings[reader.ReadInt32()];
+                    column.Type = (ComponentPropertyType)reader.ReadByte();
+                    column.EntrySize = 4 + GetValueSize(column.Type);
+
+                    if (componentType.ComponentInfo != null)
+                    {
+                        ComponentPropertyInfo propertyInfo;
+                        componentType.ComponentInfo.ComponentPropertyInfos.TryGetValue(column.Name, out propertyInfo);
+
+                        if (propertyInfo != null && propertyInfo.PropertyType == column.Type)
+                        {
+                            column.PropertyInfo = propertyInfo;
+                        }
+                        else
+                        {
+                            Debug.Log("Property " + componentType.Name + "." + column.Name + " in scene data does not match the component, it will be skipped");
+                        }
+                    }
+
+                    componentType.Columns[j] = column;
+                }
+
+                ComponentTypes[i] = componentType;
+            }
+
+            Entities = new EntityRecord[reader.ReadInt32()];
+
+            for (int i = 0; i < Entities.Length; i++)
+            {
+                EntityRecord entity = new EntityRecord();
+                entity.Name = reader.ReadInt32();
+                entity.Prefab = reader.ReadInt32();
+                entity.FirstComponent = reader.ReadInt32();
+                entity.ComponentCount = reader.ReadInt32();
+
+                Entities[i] = entity;
+            }
+
+            SceneControllerCount = reader.ReadInt32();
+            ComponentTypeIndices = new int[reader.ReadInt32()];
+
+            for (int i = 0; i < ComponentTypeIndices.Length; i++)
+            {
+                ComponentTypeIndices[i] = reader.ReadInt32();
+            }
+
+            //columns are only located here, values are read while instantiating
+            for (int i = 0; i < ComponentTypes.Length; i++)
+            {
+                PropertyColumn[] columns = ComponentTypes[i].Columns;
+
+                for (int j = 0; j < columns.Length; j++)
+                {
+                    PropertyColumn column = columns[j];
+
+                    column.Count = reader.ReadInt32();
+                    column.Offset = reader.CurrentIndex;
+
+                    reader.CurrentIndex += column.Count * column.EntrySize;
+                }
+            }
+
+            if (reader.CurrentIndex != Data.Length)
+            {
+                Debug.Log("Scene binary data has wrong size");
+                return false;
+            }
+
+            return true;
+        }
+
+        #region Writing
+
+        private class ColumnBuilder
+        {
+            public string Name;
+            public ComponentPropertyType Type;
+            public List<KeyValuePair<int, string>> Values = new List<KeyValuePair<int, string>>();
+        }
+
+        private class ComponentTypeBuilder
+        {
+            public ComponentInfo ComponentInfo;
+            public List<ColumnBuilder> Columns = new List<ColumnBuilder>();
+            public Dictionary<string, ColumnBuilder> ColumnsByName = new Dictionary<string, ColumnBuilder>();
+        }
+
+        private class StringTable
+        {
+            public List<string> Strings = new List<string>();
+            private Dictionary<string, int> _indices = new Dictionary<string, int>();
+
+            public int GetIndex(string value)
+            {
+                if (value == null)
+                {
+                    value = "";
+                }
+
+                int index;
+
+                if (!_indices.TryGetValue(value, out index))
+                {
+                    index = Strings.Count;
+                    Strings.Add(value);
+                    _indices.Add(value, index);
+                }
+
+                return index;
+            }
+        }
+
+        public static byte[] Write(SceneData sceneData)
+        {
+            StringTable stringTable = new StringTable();
+
+            List<ComponentTypeBuilder> componentTypes = new List<ComponentTypeBuilder>();
+            Dictionary<string, int> componentTypeIndices = new Dictionary<string, int>();
+            List<int> components = new List<int>();
+
+            int sceneControllerCount = AddComponents(sceneData.SceneControllers, componentTypes, componentTypeIndices, components);
+
+            List<EntityRecord> entities = new List<EntityRecord>();
+
+            foreach (EntityData entityData in sceneData.Entities)
+            {
+                EntityRecord entity = new EntityRecord();
+                entity.Name = stringTable.GetIndex(entityData.Name);
+                entity.Prefab = entityData.IsInstantiatedFromPrefab ? stringTable.GetIndex(entityData.PrefabName) : -1;
+                entity.FirstComponent = components.Count;
+                entity.ComponentCount = AddComponents(entityData.Components, componentTypes, componentTypeIndices, components);
+
+                entities.Add(entity);
+            }
+
+            //string values go to the string table before it is written
+            DataWriter columnWriter = new DataWriter();
+
+            for (int i = 0; i < componentTypes.Count; i++)
+            {
+                List<ColumnBuilder> columns = componentTypes[i].Columns;
+
+                for (int j = 0; j < columns.Count; j++)
+                {
+                    ColumnBuilder column = columns[j];
+
+                    columnWriter.WriteInt32(column.Values.Count);
+
+                    for (int k = 0; k < column.Values.Count; k++)
+                    {
+                        columnWriter.WriteInt32(column.Values[k].Key);
+                        WriteValue(columnWriter, column.Type, column.Values[k].Value, stringTable);
+                    }
+                }
+            }
+
+            int[] typeNames = new int[componentTypes.Count];
+            int[][] columnNames = new int[componentTypes.Count][];
+
+            for (int i = 0; i < componentTypes.Count; i++)
+            {
+                ComponentTypeBuilder componentType = componentTypes[i];
+
+                typeNames[i] = stringTable.GetIndex(componentType.ComponentInfo.Name);
+                columnNames[i] = new int[componentType.Columns.Count];
+
+                for (int j = 0; j < componentType.Columns.Count; j++)
+                {
+                    columnNames[i][j] = stringTable.GetIndex(componentType.Columns[j].Name);
+                }
+            }
+
+            DataWriter writer = new DataWriter();
+
+            writer.WriteInt32(Magic);
+            writer.WriteInt32(Version);
+
+            writer.WriteInt32(stringTable.Strings.Count);
+
+            for (int i = 0; i < stringTable.Strings.Count; i++)
+            {
+                writer.WriteUTF8String(stringTable.Strings[i]);
+            }
+
+            writer.WriteInt32(componentTypes.Count);
+
+            for (int i = 0; i < componentTypes.Count; i++)
+            {
+                List<ColumnBuilder> columns = componentTypes[i].Columns;
+
+                writer.WriteInt32(typeNames[i]);
+                writer.WriteInt32(columns.Count);
+
+                for (int j = 0; j < columns.Count; j++)
+                {
+                    writer.WriteInt32(columnNames[i][j]);
+                    writer.WriteByte((byte)columns[j].Type);
+                }
+            }
+
+            writer.WriteInt32(entities.Count);
+
+            for (int i = 0; i < entities.Count; i++)
+            {
+                EntityRecord entity = entities[i];
+
+                writer.WriteInt32(entity.Name);
+                writer.WriteInt32(entity.Prefab);
+                writer.WriteInt32(entity.FirstComponent);
+                writer.WriteInt32(entity.ComponentCount);
+            }
+
+            writer.WriteInt32(sceneControllerCount);
+            writer.WriteInt32(components.Count);
+
+            for (int i = 0; i < components.Count; i++)
+            {
+                writer.WriteInt32(components[i]);
+            }
+
+            byte[] header = writer.GetData();
+            byte[] columnData = columnWriter.GetData();
+
+            byte[] result = new byte[header.Length + columnData.Length];
+            Buffer.BlockCopy(header, 0, result, 0, header.Length);
+            Buffer.BlockCopy(columnData, 0, result, header.Length, columnData.Length);
+
+            return result;
+        }
+
+        private static int AddComponents(IEnumerable<ComponentData> componentDatas, List<ComponentTypeBuilder> componentTypes, Dictionary<string, int> componentTypeIndices, List<int> components)
+        {
+            int count = 0;
+
+            foreach (ComponentData componentData in componentDatas)
+            {
+                ComponentInfo componentInfo = componentData.GetComponentInfo();
+
+                if (componentInfo == null)
+                {
+                    Debug.Log("Component type " + componentData.Type + " does not exist, it is not written to scene binary data");
+                    continue;
+                }
+
+                int typeIndex;
+
+                if (!componentTypeIndices.TryGetValue(componentInfo.Name, out typeIndex))
+                {
+                    typeIndex = componentTypes.Count;
+
+                    ComponentTypeBuilder newComponentType = new ComponentTypeBuilder();
+                    newComponentType.ComponentInfo = componentInfo;
+
+                    componentTypes.Add(newComponentType);
+                    componentTypeIndices.Add(componentInfo.Name, typeIndex);
+                }
+
+                ComponentTypeBuilder componentType = componentTypes[typeIndex];
+                int componentIndex = components.Count;
+
+                foreach (PropertyData propertyData in componentData.Properties)
+                {
+                    ComponentPropertyInfo propertyInfo;
+
+                    if (!componentInfo.ComponentPropertyInfos.TryGetValue(propertyData.Name, out propertyInfo))
+                    {
+                        Debug.Log("Property " + componentInfo.Name + "." + propertyData.Name + " does not exist, it is not written to scene binary data");
+                        continue;
+                    }
+
+                    ColumnBuilder column;
+
+                    if (!componentType.ColumnsByName.TryGetValue(propertyData.Name, out column))
+                    {
+                        column = new ColumnBuilder();
+                        column.Name = propertyData.Name;
+                        column.Type = propertyInfo.PropertyType;
+
+                        componentType.Columns.Add(column);
+                        componentType.ColumnsByName.Add(column.Name, column);
+                    }
+
+                    column.Values.Add(new KeyValuePair<int, string>(componentIndex, propertyData.Value));
+                }
+
+                components.Add(typeIndex);
+                count++;
+            }
+
+            return count;
+        }
+
+        //values are parsed the same way ComponentPropertyInfo.SetValueTo parses the xml strings
+        private static void WriteValue(DataWriter writer, ComponentPropertyType propertyType, string value, StringTable stringTable)
+        {
+            switch (propertyType)
+            {
+                case ComponentPropertyType.Boolean:
+                    writer.WriteByte(Convert.ToBoolean(value) ? (byte)1 : (byte)0);
+                    break;
+                case ComponentPropertyType.Float:
+                    writer.WriteFloat(Convert.ToSingle(value));
+                    break;
+                case ComponentPropertyType.Int:
+                    writer.WriteInt32(Convert.ToInt32(value));
+                    break;
+                case ComponentPropertyType.Vector2:
+                    {
+                        string[] floats = value.Split(new char[] { ';' });
+
+                        writer.WriteFloat(Convert.ToSingle(floats[0]));
+                        writer.WriteFloat(Convert.ToSingle(floats[1]));
+                    }
+                    break;
+                default:
+                    writer.WriteInt32(stringTable.GetIndex(value));
+                    break;
+            }
+        }
+
+        #endregion
+    }
+}
@@ -41,18 +41,32 @@ namespace Swarm2D.Engine.Logic
 
         public Scene Scene { get; internal set; }
 
-        private Matrix4x4 _transformMatrix;
-        private Matrix4x4 _localTransform;
         private Vector2 _localPosition;
         private Vector2 _localScale = new Vector2(1, 1);
         private float _localRotation;
-        private bool _localTransformDirty;
-        private bool _parentTransformWasDirty;
 
-        private Vector2 _globalPosition;
+        //slot of the world transform in the scene's transform system, -1 until the scene entity is initialized
+        internal int TransformIndex { get; private set; }
+
+        //number of scene entity ancestors
+        internal int Depth { get; private set; }
+
+        internal SceneEntity FirstChild { get; private set; }
+        internal SceneEntity NextSibling { get; private set; }
+        private SceneEntity _previousSibling;
+
+        internal bool LocalTransformDirty { get; set; }
+        internal bool IsDirtyRoot { get; set; }
+        internal bool TransformChangeMessagePending { get; set; }
+        internal int PropagationStamp { get; set; }
 
         private readonly SceneEntityTransformMatrixChangeMesssage _entityTransformMatrixChangeMesssage = new SceneEntityTransformMatrixChangeMesssage();
 
+        public SceneEntity()
+        {
+            TransformIndex = -1;
+        }
+
         [ComponentProperty]
         public Vector2 LocalPosition
         {
@@ -66,8 +80,6 @@ namespace Swarm2D.Engine.Logic
                 {
                     _localPosition = value;
                     SetLocalTransformDirty();
-
-                    Entity.SendMessage(_entityTransformMatrixChangeMesssage);
                 }
             }
         }
@@ -85,8 +97,6 @@ namespace Swarm2D.Engine.Logic
                 {
                     _localRotation = value;
                     SetLocalTransformDirty();
-
-                    Entity.SendMessage(_entityTransformMatrixChangeMesssage);
                 }
             }
         }
@@ -116,46 +126,26 @@ namespace Swarm2D.Engine.Logic
                 {
                     _localScale = value;
                     SetLocalTransformDirty();
-
-                    Entity.SendMessage(_entityTransformMatrixChangeMesssage);
                 }
             }
         }
 
         private void SetLocalTransformDirty()
         {
-            if (!_localTransformDirty)
-            {
-                _localTransformDirty = true;
-
-                LinkedListNode<Entity> childEntityNode = Entity.Children.First;
-
-                while (childEntityNode != null)
-                {
-                    Entity childEntity = childEntityNode.Value;
-
-                    childEntity.GetComponent<SceneEntity>().OnParentTransformDirty();
-
-                    childEntityNode = childEntityNode.Next;
-                }
-            }
+            LocalTransformDirty = true;
+            MarkAsDirtyRoot();
         }
 
-        private void OnParentTransformDirty()
+        private void MarkAsDirtyRoot()
         {
-            if (!_parentTransformWasDirty)
+            if (TransformIndex >= 0 && !IsDirtyRoot)
             {
-                _parentTransformWasDirty = true;
-
-                LinkedListNode<Entity> childEntityNode = Entity.Children.First;
+                IsDirtyRoot = true;
+                Scene.TransformSystem.AddDirtyRoot(this);
 
-                while (childEntityNode != null)
+                if (Scene.ImmediateTransformChangeMessages)
                 {
-                    Entity childEntity = childEntityNode.Value;
-
-                    childEntity.GetComponent<SceneEntity>().OnParentTransformDirty();
-
-                    childEntityNode = childEntityNode.Next;
+                    Scene.FlushTransforms();
                 }
             }
         }
@@ -164,17 +154,19 @@ namespace Swarm2D.Engine.Logic
         {
             get
             {
-                if (Parent != null)
+                if (TransformIndex < 0)
                 {
-                    if (IsTransformDirty)
-                    {
-                        RecalculateTransform();
-                    }
+                    return _localPosition;
+                }
+
+                SceneTransformSystem transformSystem = Scene.TransformSystem;
 
-                    return _globalPosition;
+                if (transformSystem.HasDirtyTransforms)
+                {
+                    transformSystem.PropagateTransforms();
                 }
 
-                return _localPosition;
+                return transformSystem.GetWorldPosition(TransformIndex);
             }
         }
 
@@ -182,14 +174,15 @@ namespace Swarm2D.Engine.Logic
         {
             get
             {
-                SceneEntity parent = Parent;
-
-                if (parent != null)
+                for (SceneEntity sceneEntity = this; sceneEntity != null; sceneEntity = sceneEntity.Parent)
                 {
-                    return parent.IsTransformDirty || _localTransformDirty || _parentTransformWasDirty;
+                    if (sceneEntity.LocalTransformDirty || sceneEntity.IsDirtyRoot)
+                    {
+                        return true;
+                    }
                 }
 
-                return _localTransformDirty || _parentTransformWasDirty;
+                return false;
             }
         }
 
@@ -197,12 +190,19 @@ namespace Swarm2D.Engine.Logic
         {
             get
             {
-                if (IsTransformDirty)
+                if (TransformIndex < 0)
+                {
+                    return Matrix4x4.Transformation2D(_localScale, _localRotation * Mathf.Deg2Rad, _localPosition);
+                }
+
+                SceneTransformSystem transformSystem = Scene.TransformSystem;
+
+                if (transformSystem.HasDirtyTransforms)
                 {
-                    RecalculateTransform();
+                    transformSystem.PropagateTransforms();
                 }
 
-                return _transformMatrix;
+                return transformSystem.GetWorldMatrix(TransformIndex);
             }
         }
 
@@ -215,57 +215,131 @@ namespace Swarm2D.Engine.Logic
         {
             Parent = Entity.Parent.GetComponent<SceneEntity>();
 
+            if (Scene != null)
+            {
+                TransformIndex = Scene.TransformSystem.AllocateSlot();
+
+                LinkToParent();
+                Depth = CalculateDepth();
+            }
+
             SetLocalTransformDirty();
-            _transformMatrix = Matrix4x4.Identity;
         }
 
-        protected override void OnDestroy()
+        internal void OnEntityParentChanged()
         {
-            Scene.OnRemoveSceneEntity(this);
+            //not initialized yet, OnInitialize finds the new parent
+            if (TransformIndex < 0)
+            {
+                return;
+            }
 
-            if (Engine.PooledMode)
+            UnlinkFromParent();
+
+            Parent = Entity.Parent.GetComponent<SceneEntity>();
+
+            LinkToParent();
+            UpdateDepth(CalculateDepth());
+
+            MarkAsDirtyRoot();
+        }
+
+        private void LinkToParent()
+        {
+            if (Parent != null)
             {
-                _transformMatrix = Matrix4x4.Identity;
-                _localTransform = Matrix4x4.Identity;
-                _localPosition = Vector2.Zero;
-                _localScale = new Vector2(1, 1);
-                _localRotation = 0.0f;
-                _localTransformDirty = false;
-                _parentTransformWasDirty = false;
-                _globalPosition = Vector2.Zero;
+                NextSibling = Parent.FirstChild;
 
-                Parent = null;
-                Scene = null;
+                if (NextSibling != null)
+                {
+                    NextSibling._previousSibling = this;
+                }
+
+                Parent.FirstChild = this;
             }
+        }
 
-            base.OnDestroy();
+        private void UnlinkFromParent()
+        {
+            if (_previousSibling != null)
+            {
+                _previousSibling.NextSibling = NextSibling;
+            }
+            else if (Parent != null && Parent.FirstChild == this)
+            {
+                Parent.FirstChild = NextSibling;
+            }
+
+            if (NextSibling != null)
+            {
+                NextSibling._previousSibling = _previousSibling;
+            }
+
+            NextSibling = null;
+            _previousSibling = null;
         }
 
-        private void RecalculateTransform()
+        private int CalculateDepth()
         {
-            if (Parent != null && Parent.IsTransformDirty)
+            int depth = 0;
+
+            Entity parentEntity = Entity.Parent;
+
+            while (parentEntity != null && parentEntity.GetComponent<SceneEntity>() != null)
             {
-                Parent.RecalculateTransform();
+                depth++;
+                parentEntity = parentEntity.Parent;
             }
 
-            if (_localTransformDirty)
+            return depth;
+        }
+
+        private void UpdateDepth(int depth)
+        {
+            Depth = depth;
+
+            for (SceneEntity child = FirstChild; child != null; child = child.NextSibling)
             {
-                _localTransform = Matrix4x4.Transformation2D(_localScale, _localRotation * Mathf.Deg2Rad, _localPosition);
-                _localTransformDirty = false;
+                child.UpdateDepth(depth + 1);
             }
+        }
+
+        internal void SendTransformChangeMessage()
+        {
+            Entity.SendMessage(_entityTransformMatrixChangeMesssage);
+        }
+
+        protected override void OnDestroy()
+        {
+            Scene.OnRemoveSceneEntity(this);
 
-            if (Parent != null && _parentTransformWasDirty)
+            //children are destroyed before their parents so they are already unlinked here
+            if (TransformIndex >= 0)
             {
-                _parentTransformWasDirty = false;
+                UnlinkFromParent();
 
-                _transformMatrix = Parent.TransformMatrix * _localTransform;
-                _globalPosition = Parent.TransformMatrix * _localPosition;
+                Scene.TransformSystem.FreeSlot(TransformIndex);
+                TransformIndex = -1;
             }
-            else
+
+            if (Engine.PooledMode)
             {
-                _transformMatrix = _localTransform;
-                _globalPosition = _localPosition;
+                _localPosition = Vector2.Zero;
+                _localScale = new Vector2(1, 1);
+                _localRotation = 0.0f;
+
+                Depth = 0;
+                FirstChild = null;
+                LocalTransformDirty = false;
+                IsDirtyRoot = false;
+                TransformChangeMessagePending = false;
+                PropagationStamp = 0;
+
+                Parent = null;
+                Scene = null;
             }
+
+            base.OnDestroy();
         }
 
         public override string ToString()
@@ -274,6 +348,8 @@ namespace Swarm2D.Engine.Logic
         }
     }
 
+    //sent by Scene.FlushTransforms to every scene entity whose world transform changed since the last flush,
+    //once per flush and not on every change (see Scene.ImmediateTransformChangeMessages)
     public class SceneEntityTransformMatrixChangeMesssage : EntityMessage
     {
 
@@ -0,0 +1,220 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //instantiates the entities of a SceneBinaryData into a scene, a chunk of entities at a time
+    //so a large scene can be spread over frames with a time budget
+    public class SceneLoadOperation
+    {
+        private const int ChunkSize = 32;
+
+        public Scene Scene { get; private set; }
+        public SceneBinaryData SceneData { get; private set; }
+
+        public int LoadedEntityCount { get; private set; }
+
+        public bool IsDone { get; private set; }
+
+        public float Progress
+        {
+            get { return SceneData.EntityCount > 0 ? (float)LoadedEntityCount / SceneData.EntityCount : 1.0f; }
+        }
+
+        private bool _sceneControllersLoaded;
+        private DataReader _reader;
+
+        //next entry to read in each property column, columns are consumed in component order
+        private int[][] _columnPositions;
+
+        internal SceneLoadOperation(Scene scene, SceneBinaryData sceneData)
+        {
+            Scene = scene;
+            SceneData = sceneData;
+
+            _reader = new DataReader(sceneData.Data);
+            _columnPositions = new int[sceneData.ComponentTypes.Length][];
+
+            for (int i = 0; i < _columnPositions.Length; i++)
+            {
+                _columnPositions[i] = new int[sceneData.ComponentTypes[i].Columns.Length];
+            }
+        }
+
+        //loads chunks until the budget is spent, returns true when every entity is loaded.
+        //at least one chunk is loaded on every call so loading always makes progress
+        internal bool Continue(double budgetMilliseconds)
+        {
+            if (IsDone)
+            {
+                return true;
+            }
+
+            long startTicks = Stopwatch.GetTimestamp();
+            long budgetTicks = double.IsPositiveInfinity(budgetMilliseconds) ? long.MaxValue : (long)(budgetMilliseconds * Stopwatch.Frequency / 1000.0);
+
+            if (!_sceneControllersLoaded)
+            {
+                LoadSceneControllers();
+                _sceneControllersLoaded = true;
+            }
+
+            int entityCount = SceneData.EntityCount;
+
+            while (LoadedEntityCount < entityCount)
+            {
+                int chunkEnd = Math.Min(LoadedEntityCount + ChunkSize, entityCount);
+
+                for (int i = LoadedEntityCount; i < chunkEnd; i++)
+                {
+                    LoadEntity(i);
+                }
+
+                LoadedEntityCount = chunkEnd;
+
+                if (Stopwatch.GetTimestamp() - startTicks >= budgetTicks)
+                {
+                    break;
+                }
+            }
+
+            IsDone = LoadedEntityCount == entityCount;
+
+            return IsDone;
+        }
+
+        private void LoadSceneControllers()
+        {
+            for (int i = 0; i < SceneData.SceneControllerCount; i++)
+            {
+                LoadComponent(Scene.Entity, i);
+            }
+        }
+
+        private void LoadEntity(int entityIndex)
+        {
+            SceneBinaryData.EntityRecord entityRecord = SceneData.Entities[entityIndex];
+
+            Entity entity;
+
+            if (entityRecord.Prefab >= 0)
+            {
+                entity = Scene.Engine.InstantiatePrefab(SceneData.Strings[entityRecord.Prefab], Scene);
+            }
+            else
+            {
+                string entityName = SceneData.Strings[entityRecord.Name];
+
+                entity = Scene.Entity.CreateChildEntity(entityName);
+                entity.Name = entityName;
+            }
+
+            for (int i = 0; i < entityRecord.ComponentCount; i++)
+            {
+                LoadComponent(entity, entityRecord.FirstComponent + i);
+            }
+        }
+
+        private void LoadComponent(Entity entity, int componentIndex)
+        {
+            int typeIndex = SceneData.ComponentTypeIndices[componentIndex];
+            SceneBinaryData.ComponentType componentType = SceneData.ComponentTypes[typeIndex];
+
+            if (componentType.ComponentInfo == null)
+            {
+                return;
+            }
+
+            Type type = componentType.ComponentInfo.ComponentType;
+
+            Component component = entity.GetComponent(type);
+
+            if (component == null)
+            {
+                component = entity.AddComponent(type);
+            }
+
+            SceneBinaryData.PropertyColumn[] columns = componentType.Columns;
+            int[] columnPositions = _columnPositions[typeIndex];
+
+            for (int i = 0; i < columns.Length; i++)
+            {
+                SceneBinaryData.PropertyColumn column = columns[i];
+                int position = columnPositions[i];
+
+                if (position < column.Count)
+                {
+                    _reader.CurrentIndex = column.Offset + position * column.EntrySize;
+
+                    if (_reader.ReadInt32() == componentIndex)
+                    {
+                        if (column.PropertyInfo != null)
+                        {
+                            ReadValueTo(component, column);
+                        }
+
+                        columnPositions[i] = position + 1;
+                    }
+                }
+            }
+        }
+
+        private void ReadValueTo(Component component, SceneBinaryData.PropertyColumn column)
+        {
+            ComponentPropertyInfo propertyInfo = column.PropertyInfo;
+
+            switch (column.Type)
+            {
+                case ComponentPropertyType.Boolean:
+                    propertyInfo.SetTypedValueTo(component, _reader.ReadByte() != 0);
+                    break;
+                case ComponentPropertyType.Float:
+                    propertyInfo.SetTypedValueTo(component, _reader.ReadFloat());
+                    break;
+                case ComponentPropertyType.Int:
+                    propertyInfo.SetTypedValueTo(component, _reader.ReadInt32());
+                    break;
+                case ComponentPropertyType.Vector2:
+                    propertyInfo.SetTypedValueTo(component, _reader.ReadVector2());
+                    break;
+                case ComponentPropertyType.String:
+                    propertyInfo.SetTypedValueTo(component, SceneData.Strings[_reader.ReadInt32()]);
+                    break;
+                default:
+                    //resources, enumerators and objects still need their string lookups
+                    propertyInfo.SetValueTo(component, SceneData.Strings[_reader.ReadInt32()]);
+                    break;
+            }
+        }
+    }
+}
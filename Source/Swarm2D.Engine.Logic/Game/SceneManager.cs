@@ -68,6 +68,12 @@ namespace Swarm2D.Engine.Logic
         private void OnNonStartedGameFrameUpdate(Message message)
         {
             _entityDomain.InitializeNonInitializedEntityComponents();
+
+            //scenes can be loaded before the game starts
+            for (int i = 0; i < LoadedScenes.Count; i++)
+            {
+                LoadedScenes[i].ContinueLoading();
+            }
         }
 
         protected override void OnAdded()
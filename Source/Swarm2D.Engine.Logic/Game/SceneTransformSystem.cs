@@ -0,0 +1,428 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Library;
+
+namespace Swarm2D.Engine.Logic
+{
+    //world transforms of the scene entities of a scene, kept as 2x3 affine matrices in flat arrays indexed by TransformIndex.
+    //changed entities are recorded as dirty roots and propagated together, parents before children, one depth level at a time.
+    //transform change messages are collected and sent in one pass by SendTransformChangeMessages.
+    internal sealed class SceneTransformSystem
+    {
+        private struct SceneEntityEntry
+        {
+            public SceneEntity SceneEntity;
+            public ComponentHandle Handle;
+
+            public SceneEntityEntry(SceneEntity sceneEntity)
+            {
+                SceneEntity = sceneEntity;
+                Handle = sceneEntity.Handle;
+            }
+
+            //false if the scene entity is destroyed (and maybe reused by the pool) after it is recorded
+            public bool IsValid
+            {
+                get { return SceneEntity.Handle == Handle && !SceneEntity.IsDestroyed; }
+            }
+        }
+
+        private const int InitialCapacity = 256;
+
+        private float[] _worldM00;
+        private float[] _worldM01;
+        private float[] _worldM02;
+        private float[] _worldM10;
+        private float[] _worldM11;
+        private float[] _worldM12;
+
+        private float[] _localM00;
+        private float[] _localM01;
+        private float[] _localM02;
+        private float[] _localM10;
+        private float[] _localM11;
+        private float[] _localM12;
+
+        private int _slotCount;
+        private Stack<int> _freeSlots;
+
+        private List<SceneEntityEntry> _dirtyRoots;
+        private List<List<SceneEntity>> _levels;
+
+        private int[] _batchSlots;
+        private int[] _batchParentSlots;
+
+        private List<SceneEntityEntry> _changedSceneEntities;
+        private List<SceneEntityEntry> _sendingSceneEntities;
+
+        private int _propagationStamp;
+
+        private bool _sendingTransformChangeMessages;
+
+        public int Count { get; private set; }
+
+        //number of transforms recalculated by the last propagation
+        public int LastPropagatedCount { get; private set; }
+
+        public SceneTransformSystem()
+        {
+            _freeSlots = new Stack<int>();
+
+            _dirtyRoots = new List<SceneEntityEntry>();
+            _levels = new List<List<SceneEntity>>();
+
+            _batchSlots = new int[InitialCapacity];
+            _batchParentSlots = new int[InitialCapacity];
+
+            _changedSceneEntities = new List<SceneEntityEntry>();
+            _sendingSceneEntities = new List<SceneEntityEntry>();
+
+            Resize(InitialCapacity);
+        }
+
+        public bool HasDirtyTransforms
+        {
+            get { return _dirtyRoots.Count > 0; }
+        }
+
+        public bool HasPendingTransformChangeMessages
+        {
+            get { return _changedSceneEntities.Count > 0; }
+        }
+
+        private void Resize(int capacity)
+        {
+            Array.Resize(ref _worldM00, capacity);
+            Array.Resize(ref _worldM01, capacity);
+            Array.Resize(ref _worldM02, capacity);
+            Array.Resize(ref _worldM10, capacity);
+            Array.Resize(ref _worldM11, capacity);
+            Array.Resize(ref _worldM12, capacity);
+
+            Array.Resize(ref _localM00, capacity);
+            Array.Resize(ref _localM01, capacity);
+            Array.Resize(ref _localM02, capacity);
+            Array.Resize(ref _localM10, capacity);
+            Array.Resize(ref _localM11, capacity);
+            Array.Resize(ref _localM12, capacity);
+        }
+
+        internal int AllocateSlot()
+        {
+            int slot;
+
+            if (_freeSlots.Count > 0)
+            {
+                slot = _freeSlots.Pop();
+            }
+            else
+            {
+                if (_slotCount == _worldM00.Length)
+                {
+                    Resize(_slotCount * 2);
+                }
+
+                slot = _slotCount;
+                _slotCount++;
+            }
+
+            _worldM00[slot] = 1.0f;
+            _worldM01[slot] = 0.0f;
+            _worldM02[slot] = 0.0f;
+            _worldM10[slot] = 0.0f;
+            _worldM11[slot] = 1.0f;
+            _worldM12[slot] = 0.0f;
+
+            Count++;
+
+            return slot;
+        }
+
+        internal void FreeSlot(int slot)
+        {
+            _freeSlots.Push(slot);
+            Count--;
+        }
+
+        internal void AddDirtyRoot(SceneEntity sceneEntity)
+        {
+            _dirtyRoots.Add(new SceneEntityEntry(sceneEntity));
+        }
+
+        internal Matrix4x4 GetWorldMatrix(int slot)
+        {
+            Matrix4x4 result = new Matrix4x4();
+
+            result.M00 = _worldM00[slot];
+            result.M01 = _worldM01[slot];
+            result.M03 = _worldM02[slot];
+
+            result.M10 = _worldM10[slot];
+            result.M11 = _worldM11[slot];
+            result.M13 = _worldM12[slot];
+
+            result.M22 = 1;
+            result.M33 = 1;
+
+            return result;
+        }
+
+        internal Vector2 GetWorldPosition(int slot)
+        {
+            return new Vector2(_worldM02[slot], _worldM12[slot]);
+        }
+
+        public void PropagateTransforms()
+        {
+            LastPropagatedCount = 0;
+
+            if (_dirtyRoots.Count == 0)
+            {
+                return;
+            }
+
+            _propagationStamp++;
+
+            int minDepth = int.MaxValue;
+
+            for (int i = 0; i < _dirtyRoots.Count; i++)
+            {
+                SceneEntityEntry entry = _dirtyRoots[i];
+                SceneEntity sceneEntity = entry.SceneEntity;
+
+                if (entry.IsValid && sceneEntity.TransformIndex >= 0)
+                {
+                    sceneEntity.IsDirtyRoot = false;
+                    sceneEntity.PropagationStamp = _propagationStamp;
+
+                    GetLevel(sceneEntity.Depth).Add(sceneEntity);
+                    minDepth = Math.Min(minDepth, sceneEntity.Depth);
+                }
+            }
+
+            _dirtyRoots.Clear();
+
+            for (int depth = minDepth; depth < _levels.Count; depth++)
+            {
+                List<SceneEntity> level = _levels[depth];
+
+                if (level.Count > 0)
+                {
+                    PropagateLevel(level, depth);
+
+                    LastPropagatedCount += level.Count;
+                    level.Clear();
+                }
+            }
+        }
+
+        private List<SceneEntity> GetLevel(int depth)
+        {
+            while (_levels.Count <= depth)
+            {
+                _levels.Add(new List<SceneEntity>());
+            }
+
+            return _levels[depth];
+        }
+
+        private void PropagateLevel(List<SceneEntity> level, int depth)
+        {
+            int count = level.Count;
+
+            if (_batchSlots.Length < count)
+            {
+                _batchSlots = new int[Math.Max(count, _batchSlots.Length * 2)];
+                _batchParentSlots = new int[_batchSlots.Length];
+            }
+
+            int[] slots = _batchSlots;
+            int[] parentSlots = _batchParentSlots;
+
+            for (int i = 0; i < count; i++)
+            {
+                SceneEntity sceneEntity = level[i];
+                int slot = sceneEntity.TransformIndex;
+
+                slots[i] = slot;
+                parentSlots[i] = sceneEntity.Parent != null ? sceneEntity.Parent.TransformIndex : -1;
+
+                if (sceneEntity.LocalTransformDirty)
+                {
+                    sceneEntity.LocalTransformDirty = false;
+
+                    float rotation = sceneEntity.LocalRotation * Mathf.Deg2Rad;
+                    float cos = Mathf.Cos(rotation);
+                    float sin = Mathf.Sin(rotation);
+
+                    Vector2 position = sceneEntity.LocalPosition;
+                    Vector2 scale = sceneEntity.LocalScale;
+
+                    _localM00[slot] = cos * scale.X;
+                    _localM01[slot] = -sin * scale.Y;
+                    _localM02[slot] = position.X;
+                    _localM10[slot] = sin * scale.X;
+                    _localM11[slot] = cos * scale.Y;
+                    _localM12[slot] = position.Y;
+                }
+
+                if (!sceneEntity.TransformChangeMessagePending)
+                {
+                    sceneEntity.TransformChangeMessagePending = true;
+                    _changedSceneEntities.Add(new SceneEntityEntry(sceneEntity));
+                }
+            }
+
+            ComposeWorldTransforms(slots, parentSlots, count);
+
+            List<SceneEntity> nextLevel = null;
+
+            for (int i = 0; i < count; i++)
+            {
+                SceneEntity child = level[i].FirstChild;
+
+                while (child != null)
+                {
+                    if (child.PropagationStamp != _propagationStamp && child.TransformIndex >= 0)
+                    {
+                        child.PropagationStamp = _propagationStamp;
+
+                        if (nextLevel == null)
+                        {
+                            nextLevel = GetLevel(depth + 1);
+                        }
+
+                        nextLevel.Add(child);
+                    }
+
+                    child = child.NextSibling;
+                }
+            }
+        }
+
+        //world = parentWorld * local for a batch of slots, parents are always on an already composed level.
+        //the loop stays scalar. net471 only ships the fixed size Vector4, Vector<T> needs the System.Numerics.Vectors package,
+        //and unlike the vertex groups of the SAT kernel the slots of a level are scattered over the arrays. a slot per lane
+        //packs ten reads and unpacks six writes per slot, a matrix row per Vector4 packs three arrays, both for a few products
+        private void ComposeWorldTransforms(int[] slots, int[] parentSlots, int count)
+        {
+            float[] worldM00 = _worldM00;
+            float[] worldM01 = _worldM01;
+            float[] worldM02 = _worldM02;
+            float[] worldM10 = _worldM10;
+            float[] worldM11 = _worldM11;
+            float[] worldM12 = _worldM12;
+
+            float[] localM00 = _localM00;
+            float[] localM01 = _localM01;
+            float[] localM02 = _localM02;
+            float[] localM10 = _localM10;
+            float[] localM11 = _localM11;
+            float[] localM12 = _localM12;
+
+            for (int i = 0; i < count; i++)
+            {
+                int slot = slots[i];
+                int parentSlot = parentSlots[i];
+
+                float l00 = localM00[slot];
+                float l01 = localM01[slot];
+                float l02 = localM02[slot];
+                float l10 = localM10[slot];
+                float l11 = localM11[slot];
+                float l12 = localM12[slot];
+
+                if (parentSlot < 0)
+                {
+                    worldM00[slot] = l00;
+                    worldM01[slot] = l01;
+                    worldM02[slot] = l02;
+                    worldM10[slot] = l10;
+                    worldM11[slot] = l11;
+                    worldM12[slot] = l12;
+                }
+                else
+                {
+                    float p00 = worldM00[parentSlot];
+                    float p01 = worldM01[parentSlot];
+                    float p10 = worldM10[parentSlot];
+                    float p11 = worldM11[parentSlot];
+
+                    worldM00[slot] = p00 * l00 + p01 * l10;
+                    worldM01[slot] = p00 * l01 + p01 * l11;
+                    worldM02[slot] = p00 * l02 + p01 * l12 + worldM02[parentSlot];
+                    worldM10[slot] = p10 * l00 + p11 * l10;
+                    worldM11[slot] = p10 * l01 + p11 * l11;
+                    worldM12[slot] = p10 * l02 + p11 * l12 + worldM12[parentSlot];
+                }
+            }
+        }
+
+        //sends one SceneEntityTransformMatrixChangeMesssage to every entity whose world transform changed since the last call,
+        //transforms changed by the handlers are sent on the next call
+        public void SendTransformChangeMessages()
+        {
+            PropagateTransforms();
+
+            //a handler flushing again only propagates, the lists are being swapped and iterated by the outer call
+            if (_changedSceneEntities.Count == 0 || _sendingTransformChangeMessages)
+            {
+                return;
+            }
+
+            _sendingTransformChangeMessages = true;
+
+            List<SceneEntityEntry> sendingSceneEntities = _changedSceneEntities;
+            _changedSceneEntities = _sendingSceneEntities;
+            _sendingSceneEntities = sendingSceneEntities;
+
+            try
+            {
+                for (int i = 0; i < sendingSceneEntities.Count; i++)
+                {
+                    SceneEntityEntry entry = sendingSceneEntities[i];
+
+                    if (entry.IsValid)
+                    {
+                        entry.SceneEntity.TransformChangeMessagePending = false;
+                        entry.SceneEntity.SendTransformChangeMessage();
+                    }
+                }
+            }
+            finally
+            {
+                sendingSceneEntities.Clear();
+
+                _sendingTransformChangeMessages = false;
+            }
+        }
+    }
+}
@@ -30,27 +30,16 @@ using System.Text;
 
 namespace Swarm2D.Engine.Logic
 {
+    //cells are created on their first use, the grid has no bounds
     public class Grid2D<T> where T : IGrid2DItem
     {
         public float Length = 64.0f;
-        public int Size = 512;
 
-        private Grid2DCell<T>[,] _grid;
-        private Grid2DCell<T> _outterGridCell;
+        private SparseGrid<Grid2DCell<T>> _grid;
 
         internal Grid2D()
         {
-            _grid = new Grid2DCell<T>[Size, Size];
-
-            _outterGridCell = new Grid2DCell<T>();
-
-            for (int i = 0; i < Size; i++)
-            {
-                for (int j = 0; j < Size; j++)
-                {
-                    _grid[i, j] = new Grid2DCell<T>(i, j);
-                }
-            }
+            _grid = new SparseGrid<Grid2DCell<T>>((x, y) => new Grid2DCell<T>(x, y));
         }
 
         internal void UpdateItem(IList<Grid2DCell<T>> oldCells, IList<Grid2DCell<T>> newCells, T item)
@@ -66,34 +55,25 @@ namespace Swarm2D.Engine.Logic
             }
         }
 
+        //only the created cells are visited
         internal void Clear()
         {
-            for (int i = 0; i < Size; i++)
+            IList<Grid2DCell<T>> cells = _grid.Cells;
+
+            for (int i = 0; i < cells.Count; i++)
             {
-                for (int j = 0; j < Size; j++)
-                {
-                    _grid[i, j].Clear();
-                }
+                cells[i].Clear();
             }
         }
 
         internal Grid2DCell<T> this[int x, int y]
         {
-            get
-            {
-                if (x < 0 || x >= Size || y < 0 || y >= Size)
-                {
-                    return _outterGridCell;
-                }
-
-                return _grid[x, y];
-            }
+            get { return _grid[x, y]; }
         }
     }
 
     public class Grid2DCell<T> where T : IGrid2DItem
     {
-        internal bool Outter { get; private set; }
         internal int X { get; private set; }
         internal int Y { get; private set; }
 
@@ -104,14 +84,7 @@ namespace Swarm2D.Engine.Logic
             X = x;
             Y = y;
 
-            Outter = false;
-            Items = new List<T>(32);
-        }
-
-        internal Grid2DCell()
-        {
-            Outter = true;
-            Items = new List<T>(32);
+            Items = new List<T>();
         }
 
         internal void AddItem(T item)
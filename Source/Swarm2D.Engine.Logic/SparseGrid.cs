@@ -0,0 +1,192 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+
+namespace Swarm2D.Engine.Logic
+{
+    //cells are created on their first use and kept in square chunks found by hashing the chunk coordinates, so the
+    //grid has no bounds and only the used area takes memory. created cells stay until Clear or until their chunk is
+    //dropped by RemoveEmptyChunks
+    public class SparseGrid<TCell> where TCell : class
+    {
+        private const int ChunkShift = 4;
+        private const int ChunkSize = 1 << ChunkShift;
+        private const int ChunkMask = ChunkSize - 1;
+
+        private const int MinimumRemoveCellCount = 4 * ChunkSize * ChunkSize;
+
+        private Dictionary<long, TCell[]> _chunks;
+        private List<TCell> _cells;
+
+        private Func<int, int, TCell> _createCell;
+
+        private int _nextRemoveCellCount;
+        private List<long> _removedChunkKeys;
+        private HashSet<TCell> _removedCells;
+        private Predicate<TCell> _isRemovedCell;
+
+        public SparseGrid(Func<int, int, TCell> createCell)
+        {
+            _createCell = createCell;
+
+            _chunks = new Dictionary<long, TCell[]>();
+            _cells = new List<TCell>();
+
+            _nextRemoveCellCount = MinimumRemoveCellCount;
+            _removedChunkKeys = new List<long>();
+            _removedCells = new HashSet<TCell>();
+            _isRemovedCell = _removedCells.Contains;
+        }
+
+        //every created cell in the order they are created
+        public IList<TCell> Cells
+        {
+            get { return _cells; }
+        }
+
+        public int CellCount
+        {
+            get { return _cells.Count; }
+        }
+
+        //creates the cell if it is not there yet
+        public TCell this[int x, int y]
+        {
+            get
+            {
+                long key = GetChunkKey(x, y);
+
+                TCell[] chunk;
+
+                if (!_chunks.TryGetValue(key, out chunk))
+                {
+                    chunk = new TCell[ChunkSize * ChunkSize];
+                    _chunks.Add(key, chunk);
+                }
+
+                int index = (x & ChunkMask) | ((y & ChunkMask) << ChunkShift);
+
+                TCell cell = chunk[index];
+
+                if (cell == null)
+                {
+                    cell = _createCell(x, y);
+                    chunk[index] = cell;
+                    _cells.Add(cell);
+                }
+
+                return cell;
+            }
+        }
+
+        //null if the cell is not created, it never writes so several threads can call it while no cell is created
+        public TCell Find(int x, int y)
+        {
+            TCell[] chunk;
+
+            if (!_chunks.TryGetValue(GetChunkKey(x, y), out chunk))
+            {
+                return null;
+            }
+
+            return chunk[(x & ChunkMask) | ((y & ChunkMask) << ChunkShift)];
+        }
+
+        public void Clear()
+        {
+            _chunks.Clear();
+            _cells.Clear();
+
+            _nextRemoveCellCount = MinimumRemoveCellCount;
+        }
+
+        //drops the chunks whose created cells are all empty, the cells must not be used after. it only looks once the
+        //created cells have doubled since the last time, so calling it every step costs about as much as creating them.
+        //the order of the cells left in Cells does not change
+        public void RemoveEmptyChunks(Predicate<TCell> isEmpty)
+        {
+            if (_cells.Count < _nextRemoveCellCount)
+            {
+                return;
+            }
+
+            foreach (KeyValuePair<long, TCell[]> chunk in _chunks)
+            {
+                if (IsChunkEmpty(chunk.Value, isEmpty))
+                {
+                    _removedChunkKeys.Add(chunk.Key);
+                }
+            }
+
+            for (int i = 0; i < _removedChunkKeys.Count; i++)
+            {
+                TCell[] chunk = _chunks[_removedChunkKeys[i]];
+
+                for (int j = 0; j < chunk.Length; j++)
+                {
+                    if (chunk[j] != null)
+                    {
+                        _removedCells.Add(chunk[j]);
+                    }
+                }
+
+                _chunks.Remove(_removedChunkKeys[i]);
+            }
+
+            if (_removedCells.Count > 0)
+            {
+                _cells.RemoveAll(_isRemovedCell);
+            }
+
+            _removedChunkKeys.Clear();
+            _removedCells.Clear();
+
+            _nextRemoveCellCount = Math.Max(MinimumRemoveCellCount, _cells.Count * 2);
+        }
+
+        private static bool IsChunkEmpty(TCell[] chunk, Predicate<TCell> isEmpty)
+        {
+            for (int i = 0; i < chunk.Length; i++)
+            {
+                if (chunk[i] != null && !isEmpty(chunk[i]))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        private static long GetChunkKey(int x, int y)
+        {
+            //shifting keeps the sign, so negative coordinates fall into their own chunks
+            return ((long)(x >> ChunkShift) << 32) | (uint)(y >> ChunkShift);
+        }
+    }
+}
@@ -35,7 +35,6 @@ namespace Swarm2D.Engine.Multiplayer.Scene
     public class GameObjectGridCell
     {
         public GameSceneServer GameSceneServer { get; private set; }
-        public bool Outter { get; private set; }
         public int X { get; private set; }
         public int Y { get; private set; }
 
@@ -58,16 +57,6 @@ namespace Swarm2D.Engine.Multiplayer.Scene
             X = x;
             Y = y;
 
-            Outter = false;
-
-            Initialize();
-        }
-
-        internal GameObjectGridCell(GameSceneServer gameSceneServer)
-        {
-            GameSceneServer = gameSceneServer;
-            Outter = true;
-
             Initialize();
         }
 
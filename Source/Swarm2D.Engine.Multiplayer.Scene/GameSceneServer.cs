@@ -59,13 +59,9 @@ namespace Swarm2D.Engine.Multiplayer.Scene
             }
         }
 
-        public int Size = 64;
+        //cells are created when a game object or a peer reaches them
+        private SparseGrid<GameObjectGridCell> _grid;
 
-        private GameObjectGridCell[,] _grid;
-
-        private GameObjectGridCell _outterGridCell;
-
-        private List<GameObjectGridCell> _allCells;
         private List<GameObjectGridCell> _cellsWithJob;
 
         private NetworkView _networkView;
@@ -106,21 +102,8 @@ namespace Swarm2D.Engine.Multiplayer.Scene
             _peersWithUnSynchronizationJob = new List<GameScenePeer>();
             _peersWithSynchronizationJob = new List<GameScenePeer>();
             _cellsWithJob = new List<GameObjectGridCell>();
-            _grid = new GameObjectGridCell[Size, Size];
-            _allCells = new List<GameObjectGridCell>();
-            _outterGridCell = new GameObjectGridCell(this);
+            _grid = new SparseGrid<GameObjectGridCell>((x, y) => new GameObjectGridCell(this, x, y));
             _gameObjectsWithDirtyTransform = new LinkedList<GameObjectServer>();
-
-            for (int i = 0; i < Size; i++)
-            {
-                for (int j = 0; j < Size; j++)
-                {
-                    GameObjectGridCell gameObjectGridCell = new GameObjectGridCell(this, i, j);
-
-                    _grid[i, j] = gameObjectGridCell;
-                    _allCells.Add(gameObjectGridCell);
-                }
-            }
         }
 
         [EntityMessageHandler(MessageType = typeof(SceneControllerUpdateMessage))]
@@ -158,6 +141,9 @@ namespace Swarm2D.Engine.Multiplayer.Scene
 
         private void DoSynchronizeJob()
         {
+            //moved game objects find their new grid cells on their transform change message
+            Scene.FlushTransforms();
+
             CurrentlySynchronizing = true;
 
             while (_gameObjectsWithDirtyTransform.Count > 0)
@@ -295,15 +281,7 @@ namespace Swarm2D.Engine.Multiplayer.Scene
 
         internal GameObjectGridCell this[int x, int y]
         {
-            get
-            {
-                if (x < 0 || x >= Size || y < 0 || y >= Size)
-                {
-                    return _outterGridCell;
-                }
-
-                return _grid[x, y];
-            }
+            get { return _grid[x, y]; }
         }
 
         public GameScenePeer GetGameScenePeerOfPeer(Peer peer)
@@ -325,32 +303,20 @@ namespace Swarm2D.Engine.Multiplayer.Scene
         {
             if (gridCell != null)
             {
-                if (gridCell.Outter)
-                {
-                    return new GameObjectGridCell[] { gridCell };
-                }
-                else
-                {
-                    List<GameObjectGridCell> result = new List<GameObjectGridCell>();
+                GameObjectGridCell[] result = new GameObjectGridCell[9];
 
-                    int startX = gridCell.X - 1;
-                    int startY = gridCell.Y - 1;
+                int startX = gridCell.X - 1;
+                int startY = gridCell.Y - 1;
 
-                    for (int i = 0; i <= 2; i++)
+                for (int i = 0; i <= 2; i++)
+                {
+                    for (int j = 0; j <= 2; j++)
                     {
-                        for (int j = 0; j <= 2; j++)
-                        {
-                            GameObjectGridCell grid = this[i + startX, j + startY];
-
-                            if (!result.Contains(grid))
-                            {
-                                result.Add(grid);
-                            }
-                        }
+                        result[i * 3 + j] = this[i + startX, j + startY];
                     }
-
-                    return result.ToArray();
                 }
+
+                return result;
             }
 
             return new GameObjectGridCell[] { };
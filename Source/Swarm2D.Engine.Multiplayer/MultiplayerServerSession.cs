@@ -41,6 +41,9 @@ namespace Swarm2D.Engine.Multiplayer
         private Stopwatch _syncTimer;
         private long _lastSyncTime = 0;
 
+        //synchronize events are sent when more than this many milliseconds passed since the last sync
+        private const long SyncIntervalMilliseconds = 100;
+
         internal override INetworkSession Session
         {
             get
@@ -122,6 +125,12 @@ namespace Swarm2D.Engine.Multiplayer
             this.ProcessEvent(reader);
         }
 
+        //network thread
+        void INetworkSessionHandler.OnNetworkActivity()
+        {
+            Engine.IdleScheduler.WakeUp();
+        }
+
         internal override void UpdateRead()
         {
             _serverSession.HandleConnectionEvents();
@@ -140,6 +149,8 @@ namespace Swarm2D.Engine.Multiplayer
                     {
                         break;
                     }
+
+                    Engine.DoneJob();
                 }
 
                 _currentlyProcessingPeer = null;
@@ -217,13 +228,17 @@ namespace Swarm2D.Engine.Multiplayer
             {
                 long currentTime = _syncTimer.ElapsedMilliseconds;
 
-                if (currentTime - _lastSyncTime > 100)
+                if (currentTime - _lastSyncTime > SyncIntervalMilliseconds)
                 {
                     _lastSyncTime = currentTime;
 
                     return true;
                 }
 
+                //the first millisecond in which the check above passes
+                long remainingTime = SyncIntervalMilliseconds + 1 - (currentTime - _lastSyncTime);
+                Engine.IdleScheduler.RequestWakeUpAt(Time.ElapsedTicks + remainingTime*Time.TicksPerSecond/1000);
+
                 return false;
             }
 
@@ -116,6 +116,21 @@ namespace Swarm2D.Library
             _data.Add(valueArray);
         }
 
+        public void WriteUTF8String(string value)
+        {
+            if (value == null)
+            {
+                value = "";
+            }
+
+            byte[] valueArray = Encoding.UTF8.GetBytes(value);
+
+            WriteInt32(valueArray.Length);
+
+            totalSize += valueArray.Length;
+            _data.Add(valueArray);
+        }
+
         public Byte[] GetData()
         {
             Byte[] data = new byte[totalSize];
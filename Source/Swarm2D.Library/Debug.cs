@@ -36,6 +36,9 @@ namespace Swarm2D.Library
     {
         private static IDebug _debug;
 
+        // platform loggers are not required to be thread safe, child engines log from several threads
+        private static readonly object DebugLock = new object();
+
         public static void Initialize(IDebug debug)
         {
             _debug = debug;
@@ -49,7 +52,10 @@ namespace Swarm2D.Library
             }
             else
             {
-                _debug.Log(log);
+                lock (DebugLock)
+                {
+                    _debug.Log(log);
+                }
             }
         }
 
@@ -64,7 +70,10 @@ namespace Swarm2D.Library
                 }
                 else
                 {
-                    _debug.Assert(condition, message);
+                    lock (DebugLock)
+                    {
+                        _debug.Assert(condition, message);
+                    }
                 }
             }
         }
@@ -44,6 +44,12 @@ namespace Swarm2D.LogicFramework
             set { _thread.Name = value; }
         }
 
+        public bool IsBackground
+        {
+            get { return _thread.IsBackground; }
+            set { _thread.IsBackground = value; }
+        }
+
         public Thread(ThreadStart threadStart)
         {
             _threadStart = threadStart;
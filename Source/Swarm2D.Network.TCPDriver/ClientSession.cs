@@ -48,7 +48,7 @@ namespace Swarm2D.Network.TCPDriver
         {
             _handler = handler;
 
-            Reader = new SocketReader(Socket);
+            Reader = new SocketReader(Socket, handler);
             Writer = new SocketWriter(Socket);
         }
 
@@ -60,6 +60,8 @@ namespace Swarm2D.Network.TCPDriver
             {
                 _connected = false;
                 _connectionHandled = false;
+
+                _handler.OnNetworkActivity();
             }
 
             return result;
@@ -105,6 +107,8 @@ namespace Swarm2D.Network.TCPDriver
                 _connectionHandled = false;
             }
 
+            _handler.OnNetworkActivity();
+
             //Debug.Log("An event completed on session " + eventArguments.LastOperation + " " + eventArguments.SocketError);
         }
 
@@ -194,6 +194,8 @@ namespace Swarm2D.Network.TCPDriver
                     {
                         _handlerWaitingDisconnectedClients.AddRange(_disconnectedClients);
                     }
+
+                    Handler.OnNetworkActivity();
                 }
 
                 _disconnectedClients.Clear();
@@ -213,6 +215,8 @@ namespace Swarm2D.Network.TCPDriver
                     {
                         _handlerWaitingConnectedClients.AddRange(_newlyConnectedClients);
                     }
+
+                    Handler.OnNetworkActivity();
                 }
 
                 _newlyConnectedClients.Clear();
@@ -50,7 +50,7 @@ namespace Swarm2D.Network.TCPDriver
             _serverSession = serverSession;
             Socket = socket;
 
-            Reader = new SocketReader(Socket);
+            Reader = new SocketReader(Socket, serverSession.Handler);
             Writer = new SocketWriter(Socket);
         }
 
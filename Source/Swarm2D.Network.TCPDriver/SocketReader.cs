@@ -57,8 +57,12 @@ namespace Swarm2D.Network.TCPDriver
 
         private bool _noError = true;
 
-        internal SocketReader(Socket socket)
+        private INetworkSessionHandler _networkSessionHandler;
+
+        internal SocketReader(Socket socket, INetworkSessionHandler networkSessionHandler)
         {
+            _networkSessionHandler = networkSessionHandler;
+
             _receivedMessages = new Queue<NetworkMessage>();
             _multiplePacketEvent = new byte[32768];
 
@@ -147,6 +151,8 @@ namespace Swarm2D.Network.TCPDriver
                             _receivedMessages.Enqueue(newlyReceivedMessage);
                         }
 
+                        _networkSessionHandler.OnNetworkActivity();
+
                         _currentlyReadData = -1;
                     }
                     else
@@ -160,6 +166,7 @@ namespace Swarm2D.Network.TCPDriver
             else
             {
                 _noError = false;
+                _networkSessionHandler.OnNetworkActivity();
             }
         }
 
@@ -31,5 +31,8 @@ namespace Swarm2D.Network
     public interface INetworkSessionHandler
     {
         void ProcessEvent(IDataReader reader);
+
+        //called from network threads when there is something to process, implementations should not block
+        void OnNetworkActivity();
     }
 }
\ No newline at end of file
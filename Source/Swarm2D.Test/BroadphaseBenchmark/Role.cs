@@ -0,0 +1,227 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+using Debug = Swarm2D.Library.Debug;
+
+namespace Swarm2D.Test.BroadphaseBenchmark
+{
+    public class Role : TestRole
+    {
+        private enum SceneKind
+        {
+            Dense,
+            Sparse,
+            MixedSize
+        }
+
+        private const int BodyCount = 2000;
+        private const int FrameCount = 200;
+
+        private Engine.Core.Engine _engine;
+        private GameLogic _gameLogic;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#    Running Broadphase        #");
+            Console.WriteLine("################################");
+
+            _engine = new Engine.Core.Engine(false);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            _gameLogic = testController.GameLogic;
+            _gameLogic.StartGame();
+
+            _engine.Profiler.Enabled = true;
+
+            foreach (SceneKind sceneKind in Enum.GetValues(typeof(SceneKind)))
+            {
+                BroadphaseType bestBroadphaseType = BroadphaseType.Grid;
+                double bestMilliseconds = double.MaxValue;
+
+                foreach (BroadphaseType broadphaseType in Enum.GetValues(typeof(BroadphaseType)))
+                {
+                    double milliseconds = Measure(sceneKind, broadphaseType);
+
+                    if (milliseconds < bestMilliseconds)
+                    {
+                        bestMilliseconds = milliseconds;
+                        bestBroadphaseType = broadphaseType;
+                    }
+                }
+
+                Console.WriteLine("best for " + sceneKind + ": " + bestBroadphaseType);
+            }
+
+            gameLogicEntity.Destroy();
+        }
+
+        //returns the physics step time in milliseconds, broadphase maintenance is a part of the position update
+        private double Measure(SceneKind sceneKind, BroadphaseType broadphaseType)
+        {
+            Entity sceneEntity = _gameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+            Scene scene = sceneEntity.GetComponent<Scene>();
+
+            PhysicsWorld physicsWorld = sceneEntity.AddComponent<PhysicsWorld>();
+            physicsWorld.BroadphaseType = broadphaseType;
+
+            System.Random random = new System.Random(12345);
+
+            switch (sceneKind)
+            {
+                case SceneKind.Dense:
+                    CreateDenseScene(scene, random);
+                    break;
+                case SceneKind.Sparse:
+                    CreateSparseScene(scene, random);
+                    break;
+                case SceneKind.MixedSize:
+                    CreateMixedSizeScene(scene, random);
+                    break;
+            }
+
+            //first frames initialize the bodies and build the broadphase
+            for (int i = 0; i < 10; i++)
+            {
+                this.Update();
+            }
+
+            GC.Collect();
+
+            _engine.Profiler.Clear();
+
+            long pairCount = 0;
+
+            for (int i = 0; i < FrameCount; i++)
+            {
+                this.Update();
+                pairCount += physicsWorld.BroadphasePairCount;
+            }
+
+            List<ProfilerSummaryEntry> summary = _engine.Profiler.GetSummary(FrameCount);
+
+            ProfilerSummaryEntry broadphase = summary.First(entry => entry.Name == "PhysicsWorld.Broadphase");
+            ProfilerSummaryEntry updatePositions = summary.First(entry => entry.Name == "PhysicsWorld.UpdatePositions");
+            ProfilerSummaryEntry checkCollisions = summary.First(entry => entry.Name == "PhysicsWorld.CheckCollisions");
+
+            int stepCount = broadphase.CallCount;
+
+            Console.WriteLine(sceneKind + " " + broadphaseType +
+                " pairs/frame:" + (pairCount / FrameCount) +
+                " broadphase:" + (broadphase.TotalMilliseconds / stepCount).ToString("F3") + "ms" +
+                " updatePositions:" + (updatePositions.TotalMilliseconds / stepCount).ToString("F3") + "ms" +
+                " checkCollisions:" + (checkCollisions.TotalMilliseconds / stepCount).ToString("F3") + "ms");
+
+            sceneEntity.Destroy();
+            this.Update();
+
+            return (updatePositions.TotalMilliseconds + checkCollisions.TotalMilliseconds) / stepCount;
+        }
+
+        //equal circles packed closely in a walled box, most pairs are real contacts
+        private void CreateDenseScene(Scene scene, System.Random random)
+        {
+            int side = (int)Math.Sqrt(BodyCount);
+            float spacing = 18.0f;
+            float halfExtent = side * spacing * 0.5f;
+
+            for (int i = 0; i < BodyCount; i++)
+            {
+                Vector2 position = new Vector2((i % side) * spacing - halfExtent, (i / side) * spacing - halfExtent);
+                PhysicsTestFixture.CreateCircle(scene, position, 8.0f, PhysicsTestFixture.RandomVelocity(random, 100.0f), PhysicsObject.PhysicsType.RigidBody);
+            }
+
+            float wallLength = halfExtent * 2.0f + 200.0f;
+
+            PhysicsTestFixture.CreateBox(scene, new Vector2(0.0f, -halfExtent - 60.0f), wallLength, 40.0f, PhysicsObject.PhysicsType.Static);
+            PhysicsTestFixture.CreateBox(scene, new Vector2(0.0f, halfExtent + 60.0f), wallLength, 40.0f, PhysicsObject.PhysicsType.Static);
+            PhysicsTestFixture.CreateBox(scene, new Vector2(-halfExtent - 60.0f, 0.0f), 40.0f, wallLength, PhysicsObject.PhysicsType.Static);
+            PhysicsTestFixture.CreateBox(scene, new Vector2(halfExtent + 60.0f, 0.0f), 40.0f, wallLength, PhysicsObject.PhysicsType.Static);
+        }
+
+        //bodies scattered over an area larger than the default grid, few contacts
+        private void CreateSparseScene(Scene scene, System.Random random)
+        {
+            float halfExtent = 40000.0f;
+
+            for (int i = 0; i < BodyCount; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(random, -halfExtent, halfExtent), PhysicsTestFixture.RandomRange(random, -halfExtent, halfExtent));
+                PhysicsTestFixture.CreateCircle(scene, position, 8.0f, PhysicsTestFixture.RandomVelocity(random, 200.0f), PhysicsObject.PhysicsType.RigidBody);
+            }
+        }
+
+        //a large static map of tiles and long walls with fewer movers of very different sizes
+        private void CreateMixedSizeScene(Scene scene, System.Random random)
+        {
+            float halfExtent = 6000.0f;
+
+            for (int i = 0; i < BodyCount * 4; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(random, -halfExtent, halfExtent), PhysicsTestFixture.RandomRange(random, -halfExtent, halfExtent));
+                float size = PhysicsTestFixture.RandomRange(random, 16.0f, 64.0f);
+
+                PhysicsTestFixture.CreateBox(scene, position, size, size, PhysicsObject.PhysicsType.Static);
+            }
+
+            for (int i = 0; i < 40; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(random, -halfExtent, halfExtent), PhysicsTestFixture.RandomRange(random, -halfExtent, halfExtent));
+
+                if (i % 2 == 0)
+                {
+                    PhysicsTestFixture.CreateBox(scene, position, 2000.0f, 30.0f, PhysicsObject.PhysicsType.Static);
+                }
+                else
+                {
+                    PhysicsTestFixture.CreateBox(scene, position, 30.0f, 2000.0f, PhysicsObject.PhysicsType.Static);
+                }
+            }
+
+            for (int i = 0; i < 20; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(random, -halfExtent, halfExtent), PhysicsTestFixture.RandomRange(random, -halfExtent, halfExtent));
+                PhysicsTestFixture.CreateBox(scene, position, 300.0f, 300.0f, PhysicsObject.PhysicsType.RigidBody);
+            }
+
+            for (int i = 0; i < BodyCount / 4; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(random, -halfExtent, halfExtent), PhysicsTestFixture.RandomRange(random, -halfExtent, halfExtent));
+                PhysicsTestFixture.CreateCircle(scene, position, PhysicsTestFixture.RandomRange(random, 4.0f, 12.0f), PhysicsTestFixture.RandomVelocity(random, 150.0f), PhysicsObject.PhysicsType.RigidBody);
+            }
+        }
+    }
+}
@@ -0,0 +1,186 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test.ChildEngineTest
+{
+    public class ChildEngineTestResource : Resource
+    {
+        public int Frame { get; private set; }
+
+        public ChildEngineTestResource(string name, int frame)
+            : base(name)
+        {
+            Frame = frame;
+        }
+    }
+
+    [PoolableComponent]
+    public class ChildEngineTestComponent : Component
+    {
+    }
+
+    //creates entities, components and resources on every update of its child engine
+    public class ChildEngineSpawner : EngineComponent
+    {
+        public string ResourcePrefix { get; set; }
+
+        public int UpdateCount { get; private set; }
+
+        [DomainMessageHandler(MessageType = typeof(UpdateMessage))]
+        private void OnUpdate(Message message)
+        {
+            Entity entity = Engine.RootEntity.CreateChildEntity("spawned " + UpdateCount);
+            entity.AddComponent<ChildEngineTestComponent>();
+
+            if (UpdateCount % 2 == 1)
+            {
+                entity.Destroy();
+            }
+
+            new ChildEngineTestResource(ResourcePrefix + UpdateCount, UpdateCount);
+
+            if (Resource.GetResource<ChildEngineTestResource>(ResourcePrefix + UpdateCount) == null)
+            {
+                throw new InvalidOperationException("resource " + ResourcePrefix + UpdateCount + " is lost");
+            }
+
+            UpdateCount++;
+        }
+    }
+
+    //updates child engines inline, on the job system and on dedicated lane threads while they create components and
+    //resources through the static component and resource tables, and checks that nothing is lost
+    public class Role : TestRole
+    {
+        private const int WorkerCount = 3;
+        private const int ChildEngineCount = 8;
+        private const int FrameCount = 50;
+
+        protected override JobSystemSettings CreateJobSystemSettings()
+        {
+            JobSystemSettings jobSystemSettings = new JobSystemSettings();
+            jobSystemSettings.WorkerCount = WorkerCount;
+
+            return jobSystemSettings;
+        }
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#     Running Child Engines    #");
+            Console.WriteLine("################################");
+
+            TestUpdate(null);
+            TestUpdate(ChildEngineUpdateMode.JobSystem);
+            TestUpdate(ChildEngineUpdateMode.DedicatedThreads);
+
+            Console.WriteLine(Failed ? "child engine test failed" : "child engine test passed");
+        }
+
+        private Engine.Core.Engine CreateParentEngine(ChildEngineUpdateMode? updateMode)
+        {
+            Engine.Core.Engine engine = new Engine.Core.Engine(true);
+
+            if (updateMode != null)
+            {
+                ChildEngineScheduler scheduler = engine.RootEntity.CreateChildEntity("Scheduler").AddComponent<ChildEngineScheduler>();
+                scheduler.UpdateMode = updateMode.Value;
+                scheduler.LaneCount = 4;
+            }
+
+            this.Initialize("Test", new FrameworkDomain[] { engine });
+
+            return engine;
+        }
+
+        private ChildEngineDomain CreateChildEngine(Engine.Core.Engine engine, string name)
+        {
+            ChildEngineDomain childEngineDomain = engine.RootEntity.CreateChildEntity(name).AddComponent<ChildEngineDomain>();
+            childEngineDomain.CreateEngine();
+
+            return childEngineDomain;
+        }
+
+        private void TestUpdate(ChildEngineUpdateMode? updateMode)
+        {
+            string modeName = updateMode == null ? "Inline" : updateMode.Value.ToString();
+
+            Engine.Core.Engine engine = CreateParentEngine(updateMode);
+
+            List<ChildEngineSpawner> spawners = new List<ChildEngineSpawner>();
+
+            for (int i = 0; i < ChildEngineCount; i++)
+            {
+                ChildEngineDomain childEngineDomain = CreateChildEngine(engine, "Child " + i);
+
+                ChildEngineSpawner spawner = childEngineDomain.ChildEngine.RootEntity.CreateChildEntity("Spawner").AddComponent<ChildEngineSpawner>();
+                spawner.ResourcePrefix = modeName + " child " + i + " frame ";
+                spawners.Add(spawner);
+            }
+
+            for (int frame = 0; frame < FrameCount; frame++)
+            {
+                this.Update();
+            }
+
+            for (int i = 0; i < spawners.Count; i++)
+            {
+                ChildEngineSpawner spawner = spawners[i];
+
+                if (spawner.UpdateCount != FrameCount)
+                {
+                    Fail(modeName + ": child " + i + " updated " + spawner.UpdateCount + " times");
+                }
+
+                for (int frame = 0; frame < FrameCount; frame++)
+                {
+                    ChildEngineTestResource resource = Resource.GetResource<ChildEngineTestResource>(spawner.ResourcePrefix + frame);
+
+                    if (resource == null || resource.Frame != frame)
+                    {
+                        Fail(modeName + ": resource " + spawner.ResourcePrefix + frame + " is lost");
+                        break;
+                    }
+                }
+
+                //every other spawned entity is destroyed, the root and the spawner are alive too
+                int childCount = spawner.Engine.RootEntity.Children.Count;
+
+                if (childCount != 1 + FrameCount / 2)
+                {
+                    Fail(modeName + ": child " + i + " has " + childCount + " entities");
+                }
+            }
+
+            engine.Destroy();
+        }
+    }
+}
@@ -0,0 +1,120 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+using Debug = Swarm2D.Library.Debug;
+
+namespace Swarm2D.Test.ContinuousCollisionTest
+{
+    //shoots circles and boxes at thin walls fast enough to pass them in a single step. the bodies without continuous
+    //collision detection must tunnel through, the ones with it must stay in front of their wall
+    public class Role : TestRole
+    {
+        private const float Speed = 6000.0f;
+        private const float WallX = 200.0f;
+        private const float WallThickness = 8.0f;
+        private const int FrameCount = 60;
+
+        private Engine.Core.Engine _engine;
+        private GameLogic _gameLogic;
+
+        private Scene _scene;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#    Running Continuous        #");
+            Console.WriteLine("################################");
+
+            _engine = new Engine.Core.Engine(false);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            _gameLogic = testController.GameLogic;
+            _gameLogic.StartGame();
+
+            Entity sceneEntity = _gameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+            _scene = sceneEntity.GetComponent<Scene>();
+
+            PhysicsWorld physicsWorld = sceneEntity.AddComponent<PhysicsWorld>();
+            physicsWorld.Gravity = Vector2.Zero;
+
+            List<PhysicsObject> discreteBodies = new List<PhysicsObject>();
+            List<PhysicsObject> continuousBodies = new List<PhysicsObject>();
+
+            for (int lane = 0; lane < 4; lane++)
+            {
+                float laneY = lane * 100.0f;
+
+                PhysicsTestFixture.CreateBox(_scene, new Vector2(WallX, laneY), WallThickness, 80.0f, PhysicsObject.PhysicsType.Static);
+
+                PhysicsObject body = lane % 2 == 0 ? PhysicsTestFixture.CreateCircle(_scene, new Vector2(0.0f, laneY), 10.0f) : PhysicsTestFixture.CreateBox(_scene, new Vector2(0.0f, laneY), 20.0f, 20.0f, PhysicsObject.PhysicsType.RigidBody);
+                body.Velocity = new Vector2(Speed, 0.0f);
+                body.ContinuousCollisionDetection = lane >= 2;
+
+                if (body.ContinuousCollisionDetection)
+                {
+                    continuousBodies.Add(body);
+                }
+                else
+                {
+                    discreteBodies.Add(body);
+                }
+            }
+
+            float maxContinuousX = float.MinValue;
+
+            for (int frame = 0; frame < FrameCount; frame++)
+            {
+                this.Update();
+
+                for (int i = 0; i < continuousBodies.Count; i++)
+                {
+                    maxContinuousX = Math.Max(maxContinuousX, continuousBodies[i].SceneEntity.LocalPosition.X);
+                }
+            }
+
+            for (int i = 0; i < discreteBodies.Count; i++)
+            {
+                Check("discrete body " + i + " did not tunnel, x:" + discreteBodies[i].SceneEntity.LocalPosition.X, discreteBodies[i].SceneEntity.LocalPosition.X > WallX);
+            }
+
+            Check("continuous body passed its wall, x:" + maxContinuousX, maxContinuousX < WallX);
+
+            Console.WriteLine(Failed ? "continuous collision test failed" : "continuous collision test passed");
+
+            gameLogicEntity.Destroy();
+        }
+    }
+}
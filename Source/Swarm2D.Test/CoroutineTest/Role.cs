@@ -0,0 +1,343 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+
+namespace Swarm2D.Test.CoroutineTest
+{
+    //checks the coroutine scheduler on a millisecond clock driven by the test: timers across every level of the wheel
+    //and past its maximum delay wake in due order and never early, wake up and poll tasks hand the coroutine back at
+    //the right time, a wait on a coroutine that was pooled and started again is over, and waiting or sleeping
+    //coroutines of destroyed owners are stopped
+    public class Role : TestRole
+    {
+        //seconds, the ones past 67108.863 are parked in the last level of the wheel, once or twice
+        private static readonly float[] SleepDelays = { 16.384f, 0.005f, 150000.0f, 0.256f, 1048.576f, 0.255f, 70000.0f, 16.383f, 5000.0f, 1048.575f, 20.0f, 0.3f };
+
+        private const int DestroyedOwnerCount = 100;
+
+        private long _time;
+
+        private CoroutineManager _coroutineManager;
+        private CoroutineTestOwner _owner;
+
+        private List<int> _wakeOrder = new List<int>();
+        private List<long> _wakeTimes = new List<long>();
+        private int _stepCount;
+
+        public override long ElapsedTicks { get { return _time; } }
+
+        public override long TicksPerSecond { get { return 1000; } }
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#      Running Coroutine       #");
+            Console.WriteLine("################################");
+
+            Engine.Core.Engine engine = new Engine.Core.Engine(false);
+            this.Initialize("Test", new FrameworkDomain[] { engine });
+
+            _coroutineManager = engine.RootEntity.CreateChildEntity("CoroutineManager").AddComponent<CoroutineManager>();
+            _owner = engine.RootEntity.CreateChildEntity("Owner").AddComponent<CoroutineTestOwner>();
+
+            TestTimers();
+            TestWakeUpAndPoll();
+            TestPooledWait();
+            TestDestroyedOwners(engine);
+
+            Console.WriteLine(Failed ? "coroutine test failed" : "coroutine test passed");
+        }
+
+        private void Step(long time)
+        {
+            _time = time;
+            Update();
+        }
+
+        private void TestTimers()
+        {
+            long startTime = _time;
+
+            for (int i = 0; i < SleepDelays.Length; i++)
+            {
+                _coroutineManager.StartCoroutine(_owner, Sleep, i);
+            }
+
+            Step(startTime);
+
+            Check("sleeping coroutines after start", _coroutineManager.SleepingCoroutineCount == SleepDelays.Length);
+
+            //the same expression TimerCoroutineTask uses for its due time
+            int[] dueOrder = Enumerable.Range(0, SleepDelays.Length).OrderBy(i => (long)(SleepDelays[i] * 1000.0f)).ToArray();
+
+            for (int i = 0; i < dueOrder.Length; i++)
+            {
+                int index = dueOrder[i];
+                long dueTime = startTime + (long)(SleepDelays[index] * 1000.0f);
+
+                Step(dueTime - 1);
+
+                if (_wakeOrder.Count != i)
+                {
+                    Fail("coroutine sleeping for " + SleepDelays[_wakeOrder[_wakeOrder.Count - 1]] + " seconds woke before its due time");
+                    return;
+                }
+
+                Step(dueTime);
+
+                if (_wakeOrder.Count != i + 1 || _wakeOrder[i] != index || _wakeTimes[i] != dueTime)
+                {
+                    Fail("coroutine sleeping for " + SleepDelays[index] + " seconds did not wake at " + dueTime);
+                    return;
+                }
+            }
+
+            Check("sleeping coroutines after timers", _coroutineManager.SleepingCoroutineCount == 0);
+        }
+
+        private IEnumerator<CoroutineTask> Sleep(Coroutine coroutine)
+        {
+            int index = (int)coroutine.Parameter;
+
+            yield return coroutine.Wait(SleepDelays[index]);
+
+            _wakeOrder.Add(index);
+            _wakeTimes.Add(_time);
+        }
+
+        private void TestWakeUpAndPoll()
+        {
+            //a wake up task keeps the coroutine out of the ready list until it is signalled
+            _stepCount = 0;
+            _coroutineManager.StartCoroutine(_owner, StepOnSignal, false);
+
+            Step(_time + 1);
+            Step(_time + 1);
+            Step(_time + 1);
+
+            Check("wake up task is waiting", _stepCount == 1 && _coroutineManager.WaitingCoroutineCount == 1 && _coroutineManager.ReadyCoroutineCount == 0);
+
+            _signalTask.Signal();
+
+            Check("signalled coroutine is ready", _coroutineManager.WaitingCoroutineCount == 0 && _coroutineManager.ReadyCoroutineCount == 1);
+
+            Step(_time + 1);
+
+            Check("signalled coroutine resumed", _stepCount == 2);
+
+            //a wake up task that is already over when it is yielded is polled, nothing would wake the coroutine
+            _stepCount = 0;
+            _coroutineManager.StartCoroutine(_owner, StepOnSignal, true);
+
+            Step(_time + 1);
+
+            Check("finished wake up task is not waiting", _stepCount == 1 && _coroutineManager.WaitingCoroutineCount == 0);
+
+            Step(_time + 1);
+
+            Check("finished wake up task resumed", _stepCount == 2);
+
+            //a poll task stays in the ready list and resumes in the update it is over
+            _stepCount = 0;
+            _coroutineManager.StartCoroutine(_owner, StepOnPoll);
+
+            Step(_time + 1);
+            Step(_time + 1);
+
+            Check("poll task is ready", _stepCount == 1 && _coroutineManager.ReadyCoroutineCount == 1 && _coroutineManager.WaitingCoroutineCount == 0);
+
+            _pollTask.Done = true;
+
+            Step(_time + 1);
+
+            Check("poll task resumed", _stepCount == 2 && _coroutineManager.ReadyCoroutineCount == 0);
+        }
+
+        private SignalCoroutineTask _signalTask;
+        private PollCoroutineTask _pollTask;
+
+        private IEnumerator<CoroutineTask> StepOnSignal(Coroutine coroutine)
+        {
+            _stepCount++;
+
+            _signalTask = coroutine.AddTask<SignalCoroutineTask>();
+
+            if ((bool)coroutine.Parameter)
+            {
+                _signalTask.Signal();
+            }
+
+            yield return _signalTask;
+
+            _stepCount++;
+        }
+
+        private IEnumerator<CoroutineTask> StepOnPoll(Coroutine coroutine)
+        {
+            _stepCount++;
+
+            _pollTask = coroutine.AddTask<PollCoroutineTask>();
+
+            yield return _pollTask;
+
+            _stepCount++;
+        }
+
+        private void TestPooledWait()
+        {
+            Step(_time + 1);
+
+            Coroutine waited = _coroutineManager.StartCoroutine(_owner, StepOnPoll);
+            _stepCount = 0;
+
+            Step(_time + 1);
+
+            _waitedCoroutine = waited;
+            _waiterResumed = false;
+            _coroutineManager.StartCoroutine(_owner, WaitForCoroutine);
+
+            Step(_time + 1);
+
+            Check("waiter is waiting for the coroutine", _coroutineManager.WaitingCoroutineCount == 1);
+
+            //the waited coroutine finishes and wakes the waiter for the next update
+            _pollTask.Done = true;
+
+            Step(_time + 1);
+
+            Check("waited coroutine is pooled", _stepCount == 2 && _coroutineManager.PooledCoroutineCount > 0);
+
+            //the pooled coroutine runs again before the waiter resumes, the waiter must not wait for the new run
+            Coroutine reused = _coroutineManager.StartCoroutine(_owner, StepOnPoll);
+
+            Check("pooled coroutine is reused", ReferenceEquals(reused, waited));
+
+            Step(_time + 1);
+
+            Check("waiter resumed after the waited coroutine was reused", _waiterResumed);
+            Check("waiter is not waiting", _coroutineManager.WaitingCoroutineCount == 0);
+
+            _pollTask.Done = true;
+
+            Step(_time + 1);
+        }
+
+        private Coroutine _waitedCoroutine;
+        private bool _waiterResumed;
+
+        private IEnumerator<CoroutineTask> WaitForCoroutine(Coroutine coroutine)
+        {
+            WaitCoroutineTask waitTask = coroutine.AddTask<WaitCoroutineTask>();
+            waitTask.Initialize(_waitedCoroutine);
+
+            yield return waitTask;
+
+            _waiterResumed = true;
+        }
+
+        private void TestDestroyedOwners(Engine.Core.Engine engine)
+        {
+            CoroutineTestOwner owner = engine.RootEntity.CreateChildEntity("DestroyedOwner").AddComponent<CoroutineTestOwner>();
+
+            _stepCount = 0;
+
+            List<Coroutine> waitingCoroutines = new List<Coroutine>();
+
+            //more than the manager checks in one update
+            for (int i = 0; i < DestroyedOwnerCount; i++)
+            {
+                waitingCoroutines.Add(_coroutineManager.StartCoroutine(owner, StepOnSignal, false));
+            }
+
+            Coroutine sleepingCoroutine = _coroutineManager.StartCoroutine(owner, SleepForASecond);
+
+            Step(_time + 1);
+
+            Check("coroutines of the owner are waiting", _coroutineManager.WaitingCoroutineCount == DestroyedOwnerCount && _coroutineManager.SleepingCoroutineCount == 1);
+
+            int pooledCoroutineCount = _coroutineManager.PooledCoroutineCount;
+
+            owner.Entity.Destroy();
+
+            for (int i = 0; i < 4; i++)
+            {
+                Step(_time + 1);
+            }
+
+            Check("waiting coroutines of a destroyed owner woke", _coroutineManager.WaitingCoroutineCount == 0);
+            Check("waiting coroutines of a destroyed owner did not resume", _stepCount == DestroyedOwnerCount);
+            Check("coroutines stopped in a task are destroyed", waitingCoroutines.All(coroutine => coroutine.IsDestroyed));
+            Check("coroutines stopped in a task are not pooled", _coroutineManager.PooledCoroutineCount == pooledCoroutineCount);
+
+            //a sleeping coroutine is only stopped once it is due, its timer is over by then so it is pooled
+            Check("sleeping coroutine of a destroyed owner waits for its timer", _coroutineManager.SleepingCoroutineCount == 1);
+
+            Step(_time + 1000);
+
+            Check("sleeping coroutine of a destroyed owner is stopped", !sleepingCoroutine.IsDestroyed && _coroutineManager.SleepingCoroutineCount == 0);
+            Check("sleeping coroutine of a destroyed owner is pooled", _coroutineManager.PooledCoroutineCount == pooledCoroutineCount + 1);
+            Check("sleeping coroutine of a destroyed owner did not resume", _stepCount == DestroyedOwnerCount);
+        }
+
+        private IEnumerator<CoroutineTask> SleepForASecond(Coroutine coroutine)
+        {
+            yield return coroutine.Wait(1.0f);
+
+            _stepCount++;
+        }
+    }
+
+    public class CoroutineTestOwner : Component
+    {
+    }
+
+    public class SignalCoroutineTask : CoroutineTask
+    {
+        private bool _signalled;
+
+        public void Signal()
+        {
+            _signalled = true;
+            WakeUpCoroutine();
+        }
+
+        public override bool IsFinished { get { return _signalled; } }
+
+        protected override CoroutineWaitMode WaitMode { get { return CoroutineWaitMode.WakeUp; } }
+    }
+
+    public class PollCoroutineTask : CoroutineTask
+    {
+        public bool Done { get; set; }
+
+        public override bool IsFinished { get { return Done; } }
+    }
+}
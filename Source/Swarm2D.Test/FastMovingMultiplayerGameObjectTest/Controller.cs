@@ -60,6 +60,7 @@ namespace Swarm2D.Test.FastMovingMultiplayerGameObjectTest
 
             PhysicsObject rigidBody = avatarPrefab.AddComponent<PhysicsObject>();
             rigidBody.Material = characterMaterial;
+            rigidBody.ContinuousCollisionDetection = true;
 
             avatarPrefab.AddComponent<NetworkView>();
             avatarPrefab.AddComponent<GameObject>();
@@ -0,0 +1,515 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test.FlowFieldTest
+{
+    //checks flow field distances against grid A*, follows the directions to the goals, checks that updated fields match
+    //new ones after cell and obstacle changes, checks the cache order and that fields prepared on worker threads match
+    //the ones integrated on the main thread, then measures a swarm on 512x512
+    public class Role : TestRole
+    {
+        private const int WorkerCount = 3;
+
+        private const float Tolerance = 0.001f;
+        private const float DiagonalCost = 1.41421356f;
+
+        protected override JobSystemSettings CreateJobSystemSettings()
+        {
+            JobSystemSettings jobSystemSettings = new JobSystemSettings();
+            jobSystemSettings.WorkerCount = WorkerCount;
+
+            return jobSystemSettings;
+        }
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#      Running Flow Field      #");
+            Console.WriteLine("################################");
+
+            System.Random random = new System.Random(12345);
+
+            TestDistances(CreateMap(120, 90, random), random);
+            TestUpdates(CreateMap(120, 90, random), random);
+            TestCache(CreateMap(40, 40, random));
+            TestPrepare(CreateMap(200, 200, random), random);
+
+            Measure(512, random);
+
+            Console.WriteLine(Failed ? "flow field test failed" : "flow field test passed");
+        }
+
+        private void TestDistances(NavigationGrid grid, System.Random random)
+        {
+            FlowFieldCache cache = new FlowFieldCache(grid, 4);
+            GridPathfindingContext gridContext = new GridPathfindingContext();
+
+            int unreachableCount = 0;
+
+            for (int goal = 0; goal < 10; goal++)
+            {
+                int goalX, goalY;
+                GetRandomCell(grid, random, out goalX, out goalY);
+
+                FlowField field = cache.GetFlowField(goalX, goalY);
+
+                for (int i = 0; i < 50; i++)
+                {
+                    int startX, startY;
+                    GetRandomCell(grid, random, out startX, out startY);
+
+                    float distance = field.GetDistance(startX, startY);
+                    float expectedDistance = gridContext.FindPath(grid, startX, startY, goalX, goalY) ? gridContext.PathCost : float.PositiveInfinity;
+
+                    if (float.IsPositiveInfinity(expectedDistance))
+                    {
+                        unreachableCount++;
+                    }
+
+                    if (!AreEqual(distance, expectedDistance))
+                    {
+                        Fail("distance from " + startX + "," + startY + " to " + goalX + "," + goalY + " is " + distance + " expected " + expectedDistance);
+                    }
+
+                    CheckFollow(grid, field, startX, startY);
+                }
+            }
+
+            Console.WriteLine("distances checked, " + unreachableCount + " of 500 starts could not reach their goals");
+        }
+
+        //stepping along the directions must reach the goal over valid moves adding up to the distance
+        private void CheckFollow(NavigationGrid grid, FlowField field, int x, int y)
+        {
+            float distance = field.GetDistance(x, y);
+
+            if (float.IsPositiveInfinity(distance))
+            {
+                if (field.GetDirection(grid.CellToWorld(x, y)) != Vector2.Zero)
+                {
+                    Fail("unreachable cell " + x + "," + y + " has a direction");
+                }
+
+                return;
+            }
+
+            float length = 0.0f;
+            int nextX, nextY;
+
+            for (int step = 0; step < grid.Width * grid.Height && field.GetNextCell(x, y, out nextX, out nextY); step++)
+            {
+                int offsetX = nextX - x;
+                int offsetY = nextY - y;
+
+                if (!grid.IsWalkable(nextX, nextY) ||
+                    (offsetX != 0 && offsetY != 0 && (!grid.IsWalkable(x + offsetX, y) || !grid.IsWalkable(x, y + offsetY))))
+                {
+                    Fail("flow field makes an invalid move from " + x + "," + y + " to " + nextX + "," + nextY);
+                    return;
+                }
+
+                length += offsetX != 0 && offsetY != 0 ? DiagonalCost : 1.0f;
+
+                x = nextX;
+                y = nextY;
+            }
+
+            if (x != field.GoalX || y != field.GoalY)
+            {
+                Fail("following the flow field stopped at " + x + "," + y + " before the goal " + field.GoalX + "," + field.GoalY);
+            }
+            else if (Math.Abs(length * grid.CellSize - distance) > Tolerance * Math.Max(1.0f, distance))
+            {
+                Fail("following the flow field took " + length + " to the goal, its distance is " + distance);
+            }
+        }
+
+        //fields brought up to date after every batch of changes must match fields integrated from scratch
+        private void TestUpdates(NavigationGrid grid, System.Random random)
+        {
+            FlowFieldCache cache = new FlowFieldCache(grid, 4);
+
+            int[] goals = new int[8];
+
+            for (int i = 0; i < 4; i++)
+            {
+                GetRandomCell(grid, random, out goals[i * 2], out goals[i * 2 + 1]);
+                cache.GetFlowField(goals[i * 2], goals[i * 2 + 1]);
+            }
+
+            List<Box> obstacles = new List<Box>();
+
+            for (int batch = 0; batch < 40; batch++)
+            {
+                //every tenth batch changes too many cells to patch the fields
+                int changeCount = batch % 10 == 9 ? 100 : 1 + random.Next(8);
+
+                for (int i = 0; i < changeCount; i++)
+                {
+                    int x = random.Next(grid.Width);
+                    int y = random.Next(grid.Height);
+
+                    grid.SetWalkable(x, y, !grid.IsWalkable(x, y));
+                }
+
+                //also drops walls on the goals now and then
+                if (batch % 7 == 3)
+                {
+                    int goal = random.Next(4);
+                    grid.SetWalkable(goals[goal * 2], goals[goal * 2 + 1], !grid.IsWalkable(goals[goal * 2], goals[goal * 2 + 1]));
+                }
+
+                if (obstacles.Count > 0 && random.Next(3) == 0)
+                {
+                    int index = random.Next(obstacles.Count);
+                    grid.RemoveObstacle(obstacles[index]);
+                    obstacles.RemoveAt(index);
+                }
+                else
+                {
+                    Box box = new Box();
+                    box.Position = new Vector2(random.Next(grid.Width - 10), random.Next(grid.Height - 10));
+                    box.Size = new Vector2(1 + random.Next(10), 1 + random.Next(10));
+
+                    grid.AddObstacle(box);
+                    obstacles.Add(box);
+                }
+
+                FlowFieldCache newCache = new FlowFieldCache(grid, 1);
+
+                for (int i = 0; i < 4; i++)
+                {
+                    FlowField field = cache.GetFlowField(goals[i * 2], goals[i * 2 + 1]);
+                    FlowField newField = newCache.GetFlowField(goals[i * 2], goals[i * 2 + 1]);
+
+                    if (!CompareFields(grid, field, newField, "batch " + batch))
+                    {
+                        break;
+                    }
+                }
+            }
+
+            if (cache.MissCount != 4)
+            {
+                Fail("cache of the updated fields missed " + cache.MissCount + " times");
+            }
+
+            Console.WriteLine("updated fields checked over 40 batches of changes");
+        }
+
+        private bool CompareFields(NavigationGrid grid, FlowField field, FlowField expectedField, string name)
+        {
+            for (int y = 0; y < grid.Height; y++)
+            {
+                for (int x = 0; x < grid.Width; x++)
+                {
+                    if (!AreEqual(field.GetDistance(x, y), expectedField.GetDistance(x, y)))
+                    {
+                        Fail(name + ": distance of " + x + "," + y + " to " + field.GoalX + "," + field.GoalY + " is " +
+                            field.GetDistance(x, y) + " expected " + expectedField.GetDistance(x, y));
+                        return false;
+                    }
+
+                    //the directions may differ on ties, they only need to lead to the goal on a shortest way
+                    int nextX, nextY;
+
+                    if (field.GetNextCell(x, y, out nextX, out nextY) != expectedField.GetNextCell(x, y, out nextX, out nextY))
+                    {
+                        Fail(name + ": cell " + x + "," + y + " has a direction only in one of the fields");
+                        return false;
+                    }
+
+                    if (field.GetNextCell(x, y, out nextX, out nextY))
+                    {
+                        float step = nextX != x && nextY != y ? DiagonalCost : 1.0f;
+
+                        if (!AreEqual(field.GetDistance(x, y), field.GetDistance(nextX, nextY) + step * grid.CellSize))
+                        {
+                            Fail(name + ": cell " + x + "," + y + " does not step to a closer cell");
+                            return false;
+                        }
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        private void TestCache(NavigationGrid grid)
+        {
+            FlowFieldCache cache = new FlowFieldCache(grid, 2);
+
+            FlowField first = cache.GetFlowField(1, 1);
+            FlowField second = cache.GetFlowField(2, 2);
+
+            if (cache.GetFlowField(1, 1) != first)
+            {
+                Fail("cache did not keep the first field");
+            }
+
+            //the second field is the least recently used now, the third goal takes it over
+            FlowField third = cache.GetFlowField(3, 3);
+
+            if (third != second || third.GoalX != 3 || third.GoalY != 3)
+            {
+                Fail("cache did not give the least recently used field to the new goal");
+            }
+
+            if (cache.GetFlowField(1, 1) != first || cache.GetFlowField(-1, 0) != null)
+            {
+                Fail("cache lost the first field");
+            }
+
+            cache.GetFlowField(2, 2);
+
+            if (cache.Count != 2 || cache.HitCount != 2 || cache.MissCount != 4)
+            {
+                Fail("cache has " + cache.Count + " fields after " + cache.HitCount + " hits and " + cache.MissCount + " misses");
+            }
+        }
+
+        //integration on worker threads must give the same fields as on the main thread
+        private void TestPrepare(NavigationGrid grid, System.Random random)
+        {
+            List<Vector2> goals = new List<Vector2>();
+
+            for (int i = 0; i < 6; i++)
+            {
+                int x, y;
+                GetRandomCell(grid, random, out x, out y);
+
+                goals.Add(grid.CellToWorld(x, y));
+            }
+
+            //the same goal twice is integrated once
+            goals.Add(goals[0]);
+
+            FlowFieldCache cache = new FlowFieldCache(grid, 8);
+            FlowFieldCache serialCache = new FlowFieldCache(grid, 8);
+
+            for (int round = 0; round < 3; round++)
+            {
+                cache.Prepare(goals);
+
+                for (int i = 0; i < goals.Count; i++)
+                {
+                    FlowField field = cache.GetFlowField(goals[i]);
+                    FlowField serialField = serialCache.GetFlowField(goals[i]);
+
+                    for (int y = 0; y < grid.Height; y++)
+                    {
+                        for (int x = 0; x < grid.Width; x++)
+                        {
+                            int nextX, nextY, serialNextX, serialNextY;
+
+                            if (field.GetDistance(x, y) != serialField.GetDistance(x, y) ||
+                                field.GetNextCell(x, y, out nextX, out nextY) != serialField.GetNextCell(x, y, out serialNextX, out serialNextY) ||
+                                nextX != serialNextX || nextY != serialNextY)
+                            {
+                                Fail("prepared field of goal " + i + " differs at " + x + "," + y);
+                                y = grid.Height;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                //the next round patches the prepared fields
+                for (int i = 0; i < 20; i++)
+                {
+                    int x = random.Next(grid.Width);
+                    int y = random.Next(grid.Height);
+
+                    grid.SetWalkable(x, y, !grid.IsWalkable(x, y));
+                }
+            }
+
+            if (cache.MissCount != 6)
+            {
+                Fail("prepared cache missed " + cache.MissCount + " times");
+            }
+        }
+
+        private void Measure(int size, System.Random random)
+        {
+            NavigationGrid grid = CreateMap(size, size, random);
+
+            const int goalCount = 8;
+            const int agentCount = 100000;
+
+            List<Vector2> goals = new List<Vector2>();
+
+            for (int i = 0; i < goalCount * 2; i++)
+            {
+                int x, y;
+                GetRandomCell(grid, random, out x, out y);
+
+                goals.Add(grid.CellToWorld(x, y));
+            }
+
+            FlowFieldCache cache = new FlowFieldCache(grid, goalCount);
+
+            Stopwatch stopwatch = Stopwatch.StartNew();
+
+            for (int i = 0; i < goalCount; i++)
+            {
+                cache.GetFlowField(goals[i]);
+            }
+
+            double integrateMilliseconds = stopwatch.Elapsed.TotalMilliseconds / goalCount;
+
+            //the other half of the goals takes over all the fields
+            stopwatch.Restart();
+            cache.Prepare(goals.GetRange(goalCount, goalCount));
+            double prepareMilliseconds = stopwatch.Elapsed.TotalMilliseconds / goalCount;
+
+            Vector2[] agents = new Vector2[agentCount];
+
+            for (int i = 0; i < agents.Length; i++)
+            {
+                int x, y;
+                GetRandomCell(grid, random, out x, out y);
+
+                agents[i] = grid.CellToWorld(x, y);
+            }
+
+            FlowField field = cache.GetFlowField(goals[goalCount]);
+            int movingCount = 0;
+
+            stopwatch.Restart();
+
+            for (int i = 0; i < agents.Length; i++)
+            {
+                Vector2 direction = field.GetDirection(agents[i]);
+
+                if (direction.X != 0.0f || direction.Y != 0.0f)
+                {
+                    movingCount++;
+                }
+            }
+
+            double lookupMilliseconds = stopwatch.Elapsed.TotalMilliseconds;
+
+            //a wall cell added and removed somewhere on the map
+            stopwatch.Restart();
+
+            for (int i = 0; i < 20; i++)
+            {
+                int x, y;
+                GetRandomCell(grid, random, out x, out y);
+
+                grid.SetWalkable(x, y, false);
+                cache.GetFlowField(goals[goalCount]);
+                grid.SetWalkable(x, y, true);
+                cache.GetFlowField(goals[goalCount]);
+            }
+
+            double updateMilliseconds = stopwatch.Elapsed.TotalMilliseconds / 40;
+
+            GridPathfindingContext gridContext = new GridPathfindingContext();
+            int goalX, goalY;
+            grid.WorldToCell(goals[goalCount], out goalX, out goalY);
+
+            const int searchCount = 20;
+
+            stopwatch.Restart();
+
+            for (int i = 0; i < searchCount; i++)
+            {
+                int x, y;
+                grid.WorldToCell(agents[i], out x, out y);
+
+                gridContext.FindPath(grid, x, y, goalX, goalY);
+            }
+
+            double searchMilliseconds = stopwatch.Elapsed.TotalMilliseconds / searchCount;
+
+            Console.WriteLine(size + "x" + size + ": integration " + integrateMilliseconds.ToString("F2") + "ms, prepared on " + (WorkerCount + 1) +
+                " threads " + prepareMilliseconds.ToString("F2") + "ms per field, " + agentCount + " agent lookups " + lookupMilliseconds.ToString("F2") +
+                "ms (" + movingCount + " moving), cell change " + updateMilliseconds.ToString("F3") + "ms, grid search per agent " +
+                searchMilliseconds.ToString("F2") + "ms");
+        }
+
+        //an open map scattered with wall blocks, some of them hollow rooms with no door
+        private static NavigationGrid CreateMap(int width, int height, System.Random random)
+        {
+            NavigationGrid grid = new NavigationGrid(width, height, 1.0f, Vector2.Zero);
+
+            int blockCount = width * height / 60;
+
+            for (int block = 0; block < blockCount; block++)
+            {
+                int blockWidth = 1 + random.Next(8);
+                int blockHeight = 1 + random.Next(8);
+                int blockX = random.Next(width - blockWidth);
+                int blockY = random.Next(height - blockHeight);
+
+                bool hollow = block % 25 == 0 && blockWidth > 2 && blockHeight > 2;
+
+                for (int y = blockY; y < blockY + blockHeight; y++)
+                {
+                    for (int x = blockX; x < blockX + blockWidth; x++)
+                    {
+                        if (!hollow || x == blockX || y == blockY || x == blockX + blockWidth - 1 || y == blockY + blockHeight - 1)
+                        {
+                            grid.SetWalkable(x, y, false);
+                        }
+                    }
+                }
+            }
+
+            return grid;
+        }
+
+        private static void GetRandomCell(NavigationGrid grid, System.Random random, out int x, out int y)
+        {
+            do
+            {
+                x = random.Next(grid.Width);
+                y = random.Next(grid.Height);
+            }
+            while (!grid.IsWalkable(x, y));
+        }
+
+        private static bool AreEqual(float value, float expectedValue)
+        {
+            if (float.IsPositiveInfinity(value) || float.IsPositiveInfinity(expectedValue))
+            {
+                return value == expectedValue;
+            }
+
+            return Math.Abs(value - expectedValue) <= Tolerance * Math.Max(1.0f, expectedValue);
+        }
+    }
+}
@@ -0,0 +1,118 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test
+{
+    public class GridNode : INavigableNode
+    {
+        public int NavigationIndex { get; private set; }
+        public List<INavigableNode> Neighbours { get; private set; }
+        public Vector2 Position { get; private set; }
+        public INavigableWorld NavigableWorld { get; private set; }
+
+        public GridNode(GridWorld world, int index, Vector2 position)
+        {
+            NavigableWorld = world;
+            NavigationIndex = index;
+            Position = position;
+            Neighbours = new List<INavigableNode>(8);
+        }
+    }
+
+    //grid with random walls for the pathfinding roles, 4 or 8 connected. diagonal moves may not cut the corners of walls
+    public class GridWorld : INavigableWorld
+    {
+        public GridNode[] Nodes { get; private set; }
+
+        private List<GridNode> _openNodes;
+
+        public GridWorld(int width, int height, float wallRatio, bool diagonalMoves, System.Random random)
+        {
+            Nodes = new GridNode[width * height];
+            _openNodes = new List<GridNode>();
+
+            bool[] walls = new bool[width * height];
+
+            for (int i = 0; i < walls.Length; i++)
+            {
+                walls[i] = random.NextDouble() < wallRatio;
+
+                if (!walls[i])
+                {
+                    Nodes[i] = new GridNode(this, i, new Vector2((i % width) * 10.0f, (i / width) * 10.0f));
+                    _openNodes.Add(Nodes[i]);
+                }
+            }
+
+            foreach (GridNode node in _openNodes)
+            {
+                int x = node.NavigationIndex % width;
+                int y = node.NavigationIndex / width;
+
+                for (int offsetY = -1; offsetY <= 1; offsetY++)
+                {
+                    for (int offsetX = -1; offsetX <= 1; offsetX++)
+                    {
+                        int neighbourX = x + offsetX;
+                        int neighbourY = y + offsetY;
+
+                        if ((offsetX == 0 && offsetY == 0) || neighbourX < 0 || neighbourY < 0 || neighbourX >= width || neighbourY >= height)
+                        {
+                            continue;
+                        }
+
+                        if (!diagonalMoves && offsetX != 0 && offsetY != 0)
+                        {
+                            continue;
+                        }
+
+                        if (walls[neighbourY * width + neighbourX] || walls[y * width + neighbourX] || walls[neighbourY * width + x])
+                        {
+                            continue;
+                        }
+
+                        node.Neighbours.Add(Nodes[neighbourY * width + neighbourX]);
+                    }
+                }
+            }
+        }
+
+        public IEnumerable<INavigableNode> NavigableNodes
+        {
+            get { return _openNodes.Cast<INavigableNode>(); }
+        }
+
+        public GridNode GetRandomNode(System.Random random)
+        {
+            return _openNodes[random.Next(_openNodes.Count)];
+        }
+    }
+}
@@ -0,0 +1,267 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test.HandleTest
+{
+    public class HandleTestMessage : EntityMessage
+    {
+    }
+
+    [PoolableComponent]
+    public class HandleTestComponent : Component
+    {
+        public int MessageCount { get; set; }
+
+        [EntityMessageHandler(MessageType = typeof(HandleTestMessage))]
+        private void OnHandleTestMessage(Message message)
+        {
+            MessageCount++;
+        }
+    }
+
+    //checks that a pooled entity or component taken again gets a new generation, that handles of destroyed objects
+    //resolve to null, that handles keep resolving while the tables grow over many chunks, that reused components
+    //get their messages once, and that non pooled engines give no handles
+    public class Role : TestRole
+    {
+        //more than a few chunks of the handle table
+        private const int EntityCount = 5000;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#       Running Handles        #");
+            Console.WriteLine("################################");
+
+            Engine.Core.Engine engine = new Engine.Core.Engine(true);
+            this.Initialize("Test", new FrameworkDomain[] { engine });
+
+            TestReuse(engine);
+            TestMessageHandlerReuse(engine);
+            TestGrowth(engine);
+            TestNonPooled();
+
+            Console.WriteLine(Failed ? "handle test failed" : "handle test passed");
+        }
+
+        private void TestReuse(Engine.Core.Engine engine)
+        {
+            Entity entity = engine.RootEntity.CreateChildEntity("entity");
+            HandleTestComponent component = entity.AddComponent<HandleTestComponent>();
+
+            EntityHandle entityHandle = entity.Handle;
+            ComponentHandle componentHandle = component.Handle;
+
+            //every entity has components of the engine too, their slots are freed and taken again with the test component
+            Dictionary<int, int> componentGenerations = new Dictionary<int, int>();
+
+            foreach (Component entityComponent in entity.Components)
+            {
+                componentGenerations.Add(entityComponent.Handle.Index, entityComponent.Handle.Generation);
+            }
+
+            if (entityHandle.IsNull || componentHandle.IsNull)
+            {
+                Fail("pooled engine gave a null handle");
+                return;
+            }
+
+            if (engine.GetEntity(entityHandle) != entity || engine.GetComponent(componentHandle) != component ||
+                engine.GetComponent<HandleTestComponent>(componentHandle) != component)
+            {
+                Fail("handles do not resolve to their objects");
+            }
+
+            entity.Destroy();
+
+            if (engine.GetEntity(entityHandle) != null || engine.GetComponent(componentHandle) != null)
+            {
+                Fail("handles of destroyed objects still resolve");
+            }
+
+            //the pool gives the same objects back, the slots are the same but the generations are not
+            Entity newEntity = engine.RootEntity.CreateChildEntity("new entity");
+            HandleTestComponent newComponent = newEntity.AddComponent<HandleTestComponent>();
+
+            if (newEntity != entity || newComponent != component)
+            {
+                Fail("pool did not reuse the destroyed objects");
+            }
+
+            if (newEntity.Handle.Index != entityHandle.Index || newEntity.Handle.Generation != entityHandle.Generation + 1)
+            {
+                Fail("reused entity slot got handle " + newEntity.Handle + " after " + entityHandle);
+            }
+
+            foreach (Component entityComponent in newEntity.Components)
+            {
+                int generation;
+
+                if (!componentGenerations.TryGetValue(entityComponent.Handle.Index, out generation) || entityComponent.Handle.Generation != generation + 1)
+                {
+                    Fail("reused component slot got handle " + entityComponent.Handle);
+                }
+            }
+
+            if (engine.GetEntity(entityHandle) != null || engine.GetComponent(componentHandle) != null)
+            {
+                Fail("stale handles resolve to the reused objects");
+            }
+
+            if (engine.GetEntity(newEntity.Handle) != newEntity || engine.GetComponent(newComponent.Handle) != newComponent)
+            {
+                Fail("handles of the reused objects do not resolve");
+            }
+
+            if (engine.GetEntity(EntityHandle.Null) != null || engine.GetComponent(ComponentHandle.Null) != null)
+            {
+                Fail("null handles resolve to an object");
+            }
+
+            newEntity.Destroy();
+        }
+
+        private void TestGrowth(Engine.Core.Engine engine)
+        {
+            List<Entity> entities = new List<Entity>();
+            List<EntityHandle> handles = new List<EntityHandle>();
+            HashSet<uint> handleValues = new HashSet<uint>();
+
+            for (int i = 0; i < EntityCount; i++)
+            {
+                Entity entity = engine.RootEntity.CreateChildEntity("entity " + i);
+                entity.AddComponent<HandleTestComponent>();
+
+                entities.Add(entity);
+                handles.Add(entity.Handle);
+
+                if (!handleValues.Add(entity.Handle.Value))
+                {
+                    Fail("handle " + entity.Handle + " is given twice");
+                }
+            }
+
+            for (int i = 0; i < EntityCount; i++)
+            {
+                if (engine.GetEntity(handles[i]) != entities[i])
+                {
+                    Fail("handle " + handles[i] + " does not resolve after the table grew");
+                    break;
+                }
+            }
+
+            //every other entity is destroyed and taken again, the old handles must not find the new ones
+            for (int i = 0; i < EntityCount; i += 2)
+            {
+                entities[i].Destroy();
+            }
+
+            for (int i = 0; i < EntityCount; i += 2)
+            {
+                entities[i] = engine.RootEntity.CreateChildEntity("entity again " + i);
+            }
+
+            for (int i = 0; i < EntityCount; i++)
+            {
+                bool destroyed = i % 2 == 0;
+                Entity found = engine.GetEntity(handles[i]);
+
+                if (destroyed ? found != null : found != entities[i])
+                {
+                    Fail("handle " + handles[i] + " resolved to " + found);
+                    break;
+                }
+            }
+
+            PoolStatistics statistics = engine.GetEntityPoolStatistics();
+
+            //the root entity and the engine's own entities are alive too
+            if (statistics.Live < EntityCount || statistics.HighWater < statistics.Live)
+            {
+                Fail("entity pool has " + statistics.Live + " live and " + statistics.HighWater + " at most");
+            }
+
+            for (int i = 0; i < EntityCount; i++)
+            {
+                entities[i].Destroy();
+            }
+        }
+
+        //a pooled component keeps its handler delegates, they must be registered once on the new entity
+        private void TestMessageHandlerReuse(Engine.Core.Engine engine)
+        {
+            Entity entity = engine.RootEntity.CreateChildEntity("entity");
+            HandleTestComponent component = entity.AddComponent<HandleTestComponent>();
+
+            entity.SendMessage(new HandleTestMessage());
+            entity.Destroy();
+
+            for (int i = 0; i < 3; i++)
+            {
+                Entity newEntity = engine.RootEntity.CreateChildEntity("new entity");
+                HandleTestComponent newComponent = newEntity.AddComponent<HandleTestComponent>();
+
+                if (newComponent != component)
+                {
+                    Fail("pool did not reuse the destroyed component");
+                }
+
+                newComponent.MessageCount = 0;
+
+                newEntity.SendMessage(new HandleTestMessage());
+
+                if (newComponent.MessageCount != 1)
+                {
+                    Fail("reused component got " + newComponent.MessageCount + " messages instead of 1");
+                }
+
+                newEntity.Destroy();
+            }
+        }
+
+        private void TestNonPooled()
+        {
+            Engine.Core.Engine engine = new Engine.Core.Engine(false);
+
+            Entity entity = engine.RootEntity.CreateChildEntity("entity");
+            HandleTestComponent component = entity.AddComponent<HandleTestComponent>();
+
+            if (!entity.Handle.IsNull || !component.Handle.IsNull)
+            {
+                Fail("non pooled engine gave handles");
+            }
+
+            entity.Destroy();
+            engine.Destroy();
+        }
+    }
+}
@@ -0,0 +1,417 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+using Debug = Swarm2D.Library.Debug;
+
+namespace Swarm2D.Test.HierarchicalPathfindingTest
+{
+    //checks hierarchical paths on dungeon maps against grid A*, checks that clusters rebuilt after changes give the
+    //same paths as a full build, follows static physics objects and measures both searches on 512x512 and 2048x2048
+    public class Role : TestRole
+    {
+        //hierarchical paths cut corners only at the transitions, they are never much longer than the shortest ones
+        private const float MaxCostRatio = 1.5f;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#   Running Hierarchical Path  #");
+            Console.WriteLine("################################");
+
+            System.Random random = new System.Random(12345);
+
+            //not a multiple of the cluster sizes, so the last clusters are smaller
+            NavigationGrid grid = CreateDungeon(200, 150, random);
+
+            TestPaths(grid, 8, random);
+            TestPaths(grid, 16, random);
+            TestUpdates(grid, random);
+            TestObstacles();
+
+            Measure(512, 30, random);
+            Measure(2048, 4, random);
+
+            Console.WriteLine(Failed ? "hierarchical pathfinding test failed" : "hierarchical pathfinding test passed");
+        }
+
+        private void TestPaths(NavigationGrid grid, int clusterSize, System.Random random)
+        {
+            HierarchicalPathfinder pathfinder = new HierarchicalPathfinder(grid, clusterSize);
+            GridPathfindingContext gridContext = new GridPathfindingContext();
+            HierarchicalPath path = new HierarchicalPath();
+            List<Vector2> cells = new List<Vector2>();
+
+            double costRatioSum = 0.0;
+            int foundCount = 0;
+
+            for (int i = 0; i < 300; i++)
+            {
+                int startX, startY, endX, endY;
+                GetRandomCell(grid, random, out startX, out startY);
+                GetRandomCell(grid, random, out endX, out endY);
+
+                bool expectedFound = gridContext.FindPath(grid, startX, startY, endX, endY);
+                bool found = pathfinder.FindPath(startX, startY, endX, endY, path);
+
+                if (found != expectedFound)
+                {
+                    Fail("cluster size " + clusterSize + ": search " + i + " found " + found + " expected " + expectedFound);
+                    continue;
+                }
+
+                if (!found)
+                {
+                    continue;
+                }
+
+                if (path.Cost < gridContext.PathCost - 0.01f || path.Cost > gridContext.PathCost * MaxCostRatio + 0.01f)
+                {
+                    Fail("cluster size " + clusterSize + ": search " + i + " cost " + path.Cost + " shortest " + gridContext.PathCost);
+                }
+
+                cells.Clear();
+
+                if (!path.Refine(cells))
+                {
+                    Fail("cluster size " + clusterSize + ": search " + i + " could not be refined");
+                    continue;
+                }
+
+                CheckCells(grid, cells, startX, startY, endX, endY, path.Cost);
+
+                costRatioSum += gridContext.PathCost > 0.0f ? path.Cost / gridContext.PathCost : 1.0;
+                foundCount++;
+            }
+
+            Console.WriteLine("cluster size " + clusterSize + ": " + pathfinder.NodeCount + " nodes, paths " +
+                ((costRatioSum / Math.Max(1, foundCount) - 1.0) * 100.0).ToString("F2") + "% longer than the shortest on average");
+        }
+
+        //walkable neighbour cells from the start to the end that add up to the cost of the path
+        private void CheckCells(NavigationGrid grid, List<Vector2> cells, int startX, int startY, int endX, int endY, float cost)
+        {
+            int previousX, previousY, x, y;
+
+            grid.WorldToCell(cells[0], out previousX, out previousY);
+            grid.WorldToCell(cells[cells.Count - 1], out x, out y);
+
+            if (previousX != startX || previousY != startY || x != endX || y != endY)
+            {
+                Fail("refined path does not go from the start to the end");
+                return;
+            }
+
+            float length = 0.0f;
+
+            for (int i = 1; i < cells.Count; i++)
+            {
+                grid.WorldToCell(cells[i], out x, out y);
+
+                int offsetX = x - previousX;
+                int offsetY = y - previousY;
+
+                if (Math.Abs(offsetX) > 1 || Math.Abs(offsetY) > 1 || (offsetX == 0 && offsetY == 0) || !grid.IsWalkable(x, y) ||
+                    (offsetX != 0 && offsetY != 0 && (!grid.IsWalkable(previousX + offsetX, previousY) || !grid.IsWalkable(previousX, previousY + offsetY))))
+                {
+                    Fail("refined path makes an invalid move from " + previousX + "," + previousY + " to " + x + "," + y);
+                    return;
+                }
+
+                length += Vector2.Distance(cells[i - 1], cells[i]);
+
+                previousX = x;
+                previousY = y;
+            }
+
+            if (Math.Abs(length - cost) > 0.01f * Math.Max(1.0f, cost))
+            {
+                Fail("refined path is " + length + " long, its cost is " + cost);
+            }
+        }
+
+        //after every batch of changes the updated pathfinder must find paths as long as a pathfinder built from scratch
+        private void TestUpdates(NavigationGrid grid, System.Random random)
+        {
+            HierarchicalPathfinder pathfinder = new HierarchicalPathfinder(grid, 16);
+            HierarchicalPath path = new HierarchicalPath();
+            HierarchicalPath expectedPath = new HierarchicalPath();
+
+            int rebuiltClusterCount = 0;
+
+            for (int batch = 0; batch < 20; batch++)
+            {
+                for (int i = 0; i < 10; i++)
+                {
+                    int x = random.Next(grid.Width);
+                    int y = random.Next(grid.Height);
+
+                    grid.SetWalkable(x, y, !grid.IsWalkable(x, y));
+                }
+
+                pathfinder.Update();
+                rebuiltClusterCount += pathfinder.LastRebuiltClusterCount;
+
+                HierarchicalPathfinder builtPathfinder = new HierarchicalPathfinder(grid, 16);
+
+                if (builtPathfinder.NodeCount != pathfinder.NodeCount)
+                {
+                    Fail("updated pathfinder has " + pathfinder.NodeCount + " nodes, a new one " + builtPathfinder.NodeCount);
+                }
+
+                for (int i = 0; i < 30; i++)
+                {
+                    int startX, startY, endX, endY;
+                    GetRandomCell(grid, random, out startX, out startY);
+                    GetRandomCell(grid, random, out endX, out endY);
+
+                    bool found = pathfinder.FindPath(startX, startY, endX, endY, path);
+                    bool expectedFound = builtPathfinder.FindPath(startX, startY, endX, endY, expectedPath);
+
+                    if (found != expectedFound || (found && Math.Abs(path.Cost - expectedPath.Cost) > 0.01f))
+                    {
+                        Fail("batch " + batch + ": updated pathfinder found " + path.Cost + " expected " + expectedPath.Cost);
+                    }
+                }
+            }
+
+            Console.WriteLine("updates rebuilt " + rebuiltClusterCount / 20 + " clusters per batch of 10 changed cells");
+        }
+
+        private void TestObstacles()
+        {
+            Engine.Core.Engine engine = new Engine.Core.Engine(false);
+
+            TestController testController = engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            testController.GameLogic.StartGame();
+
+            Entity sceneEntity = testController.GameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+            Scene scene = sceneEntity.GetComponent<Scene>();
+            sceneEntity.AddComponent<PhysicsWorld>();
+
+            //an open 64x64 room of 10 pixel cells with its origin at 0, 0
+            NavigationGridController controller = sceneEntity.AddComponent<NavigationGridController>();
+            controller.Initialize(64, 64, 10.0f, Vector2.Zero);
+
+            //the first update initializes the scene
+            this.Update();
+
+            HierarchicalPath path = new HierarchicalPath();
+            controller.Pathfinder.FindPath(2, 32, 61, 32, path);
+            float openCost = path.Cost;
+
+            //a wall across the room with a gap at the top
+            Entity wall = scene.CreateChildEntity("wall");
+            wall.GetComponent<SceneEntity>().LocalPosition = new Vector2(320.0f, 280.0f);
+
+            BoxShapeFilter boxShapeFilter = wall.AddComponent<BoxShapeFilter>();
+            boxShapeFilter.Width = 20.0f;
+            boxShapeFilter.Height = 560.0f;
+
+            PhysicsObject physicsObject = wall.AddComponent<PhysicsObject>();
+            physicsObject.Type = PhysicsObject.PhysicsType.Static;
+
+            this.Update();
+
+            if (controller.Grid.IsWalkable(32, 32) || !controller.Grid.IsWalkable(32, 60))
+            {
+                Fail("static wall did not block the cells under it");
+            }
+
+            if (!controller.Pathfinder.FindPath(2, 32, 61, 32, path) || path.Cost <= openCost + 100.0f)
+            {
+                Fail("path does not go around the static wall");
+            }
+
+            wall.Destroy();
+            this.Update();
+
+            if (!controller.Grid.IsWalkable(32, 32) || !controller.Pathfinder.FindPath(2, 32, 61, 32, path) || Math.Abs(path.Cost - openCost) > 0.01f)
+            {
+                Fail("removed static wall still blocks the way");
+            }
+
+            gameLogicEntity.Destroy();
+        }
+
+        private void Measure(int size, int gridSearchCount, System.Random random)
+        {
+            NavigationGrid grid = CreateDungeon(size, size, random);
+
+            Stopwatch stopwatch = Stopwatch.StartNew();
+            HierarchicalPathfinder pathfinder = new HierarchicalPathfinder(grid, 16);
+            double buildMilliseconds = stopwatch.Elapsed.TotalMilliseconds;
+
+            const int searchCount = 200;
+
+            int[] starts = new int[searchCount * 2];
+            int[] ends = new int[searchCount * 2];
+
+            for (int i = 0; i < searchCount; i++)
+            {
+                GetRandomCell(grid, random, out starts[i * 2], out starts[i * 2 + 1]);
+                GetRandomCell(grid, random, out ends[i * 2], out ends[i * 2 + 1]);
+            }
+
+            HierarchicalPath path = new HierarchicalPath();
+            List<Vector2> cells = new List<Vector2>(4096);
+
+            stopwatch.Restart();
+
+            for (int i = 0; i < searchCount; i++)
+            {
+                pathfinder.FindPath(starts[i * 2], starts[i * 2 + 1], ends[i * 2], ends[i * 2 + 1], path);
+            }
+
+            double searchMilliseconds = stopwatch.Elapsed.TotalMilliseconds / searchCount;
+
+            stopwatch.Restart();
+
+            for (int i = 0; i < searchCount; i++)
+            {
+                cells.Clear();
+
+                if (pathfinder.FindPath(starts[i * 2], starts[i * 2 + 1], ends[i * 2], ends[i * 2 + 1], path))
+                {
+                    path.Refine(cells);
+                }
+            }
+
+            double refinedSearchMilliseconds = stopwatch.Elapsed.TotalMilliseconds / searchCount;
+
+            GridPathfindingContext gridContext = new GridPathfindingContext();
+
+            stopwatch.Restart();
+
+            for (int i = 0; i < gridSearchCount; i++)
+            {
+                gridContext.FindPath(grid, starts[i * 2], starts[i * 2 + 1], ends[i * 2], ends[i * 2 + 1]);
+            }
+
+            double gridSearchMilliseconds = stopwatch.Elapsed.TotalMilliseconds / gridSearchCount;
+
+            //a wall cell added and removed somewhere in the middle of the map
+            stopwatch.Restart();
+
+            for (int i = 0; i < 20; i++)
+            {
+                int x, y;
+                GetRandomCell(grid, random, out x, out y);
+
+                grid.SetWalkable(x, y, false);
+                pathfinder.Update();
+                grid.SetWalkable(x, y, true);
+                pathfinder.Update();
+            }
+
+            double updateMilliseconds = stopwatch.Elapsed.TotalMilliseconds / 40;
+
+            Console.WriteLine(size + "x" + size + ": build " + buildMilliseconds.ToString("F1") + "ms, " + pathfinder.NodeCount + " nodes, " +
+                "hierarchical search " + searchMilliseconds.ToString("F3") + "ms, refined " + refinedSearchMilliseconds.ToString("F3") + "ms, " +
+                "grid search " + gridSearchMilliseconds.ToString("F3") + "ms, cell change " + updateMilliseconds.ToString("F3") + "ms");
+        }
+
+        //rooms joined by corridors into a chain, every tenth room is left closed off
+        private static NavigationGrid CreateDungeon(int width, int height, System.Random random)
+        {
+            NavigationGrid grid = new NavigationGrid(width, height, 1.0f, Vector2.Zero);
+
+            for (int y = 0; y < height; y++)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    grid.SetWalkable(x, y, false);
+                }
+            }
+
+            int roomCount = Math.Max(2, width * height / 500);
+            int previousX = -1;
+            int previousY = -1;
+
+            for (int room = 0; room < roomCount; room++)
+            {
+                int roomWidth = 4 + random.Next(16);
+                int roomHeight = 4 + random.Next(16);
+                int roomX = 1 + random.Next(Math.Max(1, width - roomWidth - 2));
+                int roomY = 1 + random.Next(Math.Max(1, height - roomHeight - 2));
+
+                Carve(grid, roomX, roomY, roomX + roomWidth - 1, roomY + roomHeight - 1);
+
+                int centerX = roomX + roomWidth / 2;
+                int centerY = roomY + roomHeight / 2;
+
+                if (room % 10 == 9)
+                {
+                    continue;
+                }
+
+                if (previousX >= 0)
+                {
+                    int corridorWidth = random.Next(3);
+
+                    Carve(grid, Math.Min(previousX, centerX), previousY, Math.Max(previousX, centerX), previousY + corridorWidth);
+                    Carve(grid, centerX, Math.Min(previousY, centerY), centerX + corridorWidth, Math.Max(previousY, centerY));
+                }
+
+                previousX = centerX;
+                previousY = centerY;
+            }
+
+            return grid;
+        }
+
+        private static void Carve(NavigationGrid grid, int minX, int minY, int maxX, int maxY)
+        {
+            for (int y = minY; y <= maxY; y++)
+            {
+                for (int x = minX; x <= maxX; x++)
+                {
+                    grid.SetWalkable(x, y, true);
+                }
+            }
+        }
+
+        private static void GetRandomCell(NavigationGrid grid, System.Random random, out int x, out int y)
+        {
+            do
+            {
+                x = random.Next(grid.Width);
+                y = random.Next(grid.Height);
+            }
+            while (!grid.IsWalkable(x, y));
+        }
+    }
+}
@@ -0,0 +1,338 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Threading;
+using Swarm2D.Engine.Core;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test.JobSystemTest
+{
+    //checks that parallel fors run every index once on valid thread indices, nested and from threads outside of the job
+    //system, that dependent jobs wait for their dependencies, and that exceptions of jobs are thrown on the waiting
+    //thread. a job system without workers is checked on threads of its own
+    public class Role : TestRole
+    {
+        private const int WorkerCount = 3;
+
+        protected override JobSystemSettings CreateJobSystemSettings()
+        {
+            JobSystemSettings jobSystemSettings = new JobSystemSettings();
+            jobSystemSettings.WorkerCount = WorkerCount;
+
+            return jobSystemSettings;
+        }
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#      Running Job System      #");
+            Console.WriteLine("################################");
+
+            JobSystem jobSystem = Framework.Current.JobSystem;
+
+            if (jobSystem.CurrentThreadIndex != 0)
+            {
+                Fail("thread running the test has index " + jobSystem.CurrentThreadIndex);
+            }
+
+            TestCoverage(jobSystem, "owner thread", 0);
+            TestNesting(jobSystem);
+            TestDependencies(jobSystem);
+            TestExceptions(jobSystem, "owner thread");
+
+            //the same checks still pass after the exceptions
+            TestCoverage(jobSystem, "after exceptions", 0);
+
+            RunOnThread(() =>
+            {
+                if (jobSystem.CurrentThreadIndex != -1)
+                {
+                    Fail("thread outside of the job system has index " + jobSystem.CurrentThreadIndex);
+                }
+
+                //the owner thread only waits for this thread, the workers run everything
+                TestCoverage(jobSystem, "outside thread", 1);
+                TestExceptions(jobSystem, "outside thread");
+            });
+
+            TestWithoutWorkers();
+
+            Console.WriteLine(Failed ? "job system test failed" : "job system test passed");
+        }
+
+        private void TestCoverage(JobSystem jobSystem, string name, int minimumThreadIndex)
+        {
+            int[] counts = { 1, 7, 1000, 100003 };
+            int[] batchSizes = { 1, 16, 5000 };
+
+            for (int i = 0; i < counts.Length; i++)
+            {
+                for (int j = 0; j < batchSizes.Length; j++)
+                {
+                    int[] visits = new int[counts[i]];
+                    int invalidThreadIndex = int.MinValue;
+
+                    jobSystem.ParallelFor(counts[i], batchSizes[j], (startIndex, endIndex, threadIndex) =>
+                    {
+                        if (threadIndex < minimumThreadIndex || threadIndex >= jobSystem.ThreadCount || threadIndex != jobSystem.CurrentThreadIndex)
+                        {
+                            invalidThreadIndex = threadIndex;
+                        }
+
+                        for (int k = startIndex; k < endIndex; k++)
+                        {
+                            Interlocked.Increment(ref visits[k]);
+                        }
+                    });
+
+                    if (invalidThreadIndex != int.MinValue)
+                    {
+                        Fail(name + ": batch ran on thread index " + invalidThreadIndex);
+                    }
+
+                    int missed = visits.Count(visitCount => visitCount != 1);
+
+                    if (missed > 0)
+                    {
+                        Fail(name + ": " + missed + " of " + counts[i] + " indices did not run once with batch size " + batchSizes[j]);
+                    }
+                }
+            }
+        }
+
+        private void TestNesting(JobSystem jobSystem)
+        {
+            const int outerCount = 16;
+            const int innerCount = 500;
+
+            int[] visits = new int[outerCount * innerCount];
+
+            jobSystem.ParallelFor(outerCount, 1, (outerStart, outerEnd, outerThreadIndex) =>
+            {
+                for (int outer = outerStart; outer < outerEnd; outer++)
+                {
+                    int offset = outer * innerCount;
+
+                    jobSystem.ParallelFor(innerCount, 8, (innerStart, innerEnd, innerThreadIndex) =>
+                    {
+                        for (int inner = innerStart; inner < innerEnd; inner++)
+                        {
+                            Interlocked.Increment(ref visits[offset + inner]);
+                        }
+                    });
+                }
+            });
+
+            if (visits.Any(visitCount => visitCount != 1))
+            {
+                Fail("nested parallel fors did not run every index once");
+            }
+        }
+
+        private void TestDependencies(JobSystem jobSystem)
+        {
+            for (int i = 0; i < 100; i++)
+            {
+                int firstDone = 0;
+                bool orderBroken = false;
+
+                JobCounter first = jobSystem.ScheduleParallelFor(64, 1, (startIndex, endIndex, threadIndex) =>
+                {
+                    Thread.SpinWait(100);
+                    Interlocked.Add(ref firstDone, endIndex - startIndex);
+                });
+
+                JobCounter second = jobSystem.Schedule(() =>
+                {
+                    orderBroken |= Volatile.Read(ref firstDone) != 64;
+                }, first);
+
+                jobSystem.Wait(second);
+
+                if (orderBroken)
+                {
+                    Fail("dependent job ran before its dependency was done");
+                    return;
+                }
+            }
+        }
+
+        private void TestExceptions(JobSystem jobSystem, string name)
+        {
+            try
+            {
+                jobSystem.ParallelFor(1000, 1, (startIndex, endIndex, threadIndex) =>
+                {
+                    if (startIndex <= 500 && 500 < endIndex)
+                    {
+                        ThrowFromJob();
+                    }
+                });
+
+                Fail(name + ": parallel for did not throw the exception of its job");
+            }
+            catch (InvalidOperationException exception)
+            {
+                if (!exception.StackTrace.Contains("ThrowFromJob"))
+                {
+                    Fail(name + ": exception lost the stack trace of the job\n" + exception.StackTrace);
+                }
+            }
+
+            JobCounter counter = new JobCounter();
+            jobSystem.Schedule(ThrowFromJob, counter, null);
+            jobSystem.Schedule(() => { }, counter, null);
+
+            try
+            {
+                jobSystem.Wait(counter);
+                Fail(name + ": waiting for a counter did not throw the exception of its job");
+            }
+            catch (InvalidOperationException)
+            {
+            }
+
+            //a counter throws its exception once, it can be used again afterwards
+            try
+            {
+                jobSystem.Wait(counter);
+            }
+            catch (Exception)
+            {
+                Fail(name + ": waiting again for a counter threw again");
+            }
+        }
+
+        private static void ThrowFromJob()
+        {
+            throw new InvalidOperationException("thrown by a job");
+        }
+
+        //every thread runs its own jobs with index 0, never two of them at the same time
+        private void TestWithoutWorkers()
+        {
+            RunOnThread(() =>
+            {
+                JobSystemSettings settings = new JobSystemSettings();
+                settings.WorkerCount = 0;
+
+                JobSystem jobSystem = new JobSystem(settings);
+
+                TestCoverage(jobSystem, "no workers", 0);
+                TestNesting(jobSystem);
+                TestDependencies(jobSystem);
+                TestExceptions(jobSystem, "no workers");
+
+                int runningCount = 0;
+                int maxRunningCount = 0;
+                int invalidThreadIndexCount = 0;
+
+                Action runJobs = () =>
+                {
+                    if (jobSystem.CurrentThreadIndex != -1)
+                    {
+                        Interlocked.Increment(ref invalidThreadIndexCount);
+                    }
+
+                    for (int i = 0; i < 200; i++)
+                    {
+                        jobSystem.ParallelFor(4, 1, (startIndex, endIndex, threadIndex) =>
+                        {
+                            int running = Interlocked.Increment(ref runningCount);
+                            InterlockedMax(ref maxRunningCount, running);
+
+                            if (threadIndex != 0 || jobSystem.CurrentThreadIndex != 0)
+                            {
+                                Interlocked.Increment(ref invalidThreadIndexCount);
+                            }
+
+                            Thread.SpinWait(200);
+                            Interlocked.Decrement(ref runningCount);
+                        });
+                    }
+                };
+
+                Thread[] threads = new Thread[4];
+
+                for (int i = 0; i < threads.Length; i++)
+                {
+                    threads[i] = new Thread(() => runJobs());
+                    threads[i].Start();
+                }
+
+                for (int i = 0; i < threads.Length; i++)
+                {
+                    threads[i].Join();
+                }
+
+                if (maxRunningCount != 1 || invalidThreadIndexCount != 0)
+                {
+                    Fail("without workers " + maxRunningCount + " threads ran jobs at the same time, " + invalidThreadIndexCount + " with a wrong index");
+                }
+
+                jobSystem.Shutdown();
+            });
+        }
+
+        private static void InterlockedMax(ref int location, int value)
+        {
+            int current = Volatile.Read(ref location);
+
+            while (value > current)
+            {
+                int previous = Interlocked.CompareExchange(ref location, value, current);
+
+                if (previous == current)
+                {
+                    break;
+                }
+
+                current = previous;
+            }
+        }
+
+        private void RunOnThread(Action action)
+        {
+            Thread thread = new Thread(() =>
+            {
+                try
+                {
+                    action();
+                }
+                catch (Exception exception)
+                {
+                    Fail("unexpected exception " + exception);
+                }
+            });
+
+            thread.Start();
+            thread.Join();
+        }
+    }
+}
@@ -0,0 +1,168 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+using Debug = Swarm2D.Library.Debug;
+
+namespace Swarm2D.Test.NarrowphaseDeterminismTest
+{
+    //simulates the same pile in two scenes, one with the serial and one with the parallel narrowphase,
+    //and checks that every body ends up bit for bit at the same state on every frame
+    public class Role : TestRole
+    {
+        private const int ColumnCount = 30;
+        private const int RowCount = 30;
+        private const int FrameCount = 300;
+        private const int WorkerCount = 4;
+
+        private Engine.Core.Engine _engine;
+        private GameLogic _gameLogic;
+
+        protected override JobSystemSettings CreateJobSystemSettings()
+        {
+            JobSystemSettings jobSystemSettings = new JobSystemSettings();
+            jobSystemSettings.WorkerCount = WorkerCount;
+
+            return jobSystemSettings;
+        }
+
+        public override void DoTest()
+        {
+            Console.WriteLine("#####################################");
+            Console.WriteLine("#  Running Narrowphase Determinism  #");
+            Console.WriteLine("#####################################");
+
+            _engine = new Engine.Core.Engine(false);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            _gameLogic = testController.GameLogic;
+            _gameLogic.StartGame();
+
+            List<PhysicsObject> serialBodies = new List<PhysicsObject>();
+            List<PhysicsObject> parallelBodies = new List<PhysicsObject>();
+
+            PhysicsWorld serialWorld = CreatePile(serialBodies);
+            serialWorld.ParallelNarrowphase = false;
+
+            PhysicsWorld parallelWorld = CreatePile(parallelBodies);
+            parallelWorld.ParallelNarrowphase = true;
+            parallelWorld.ParallelNarrowphaseThreshold = 0;
+
+            long pairCount = 0;
+
+            for (int frame = 0; frame < FrameCount; frame++)
+            {
+                this.Update();
+
+                pairCount += parallelWorld.BroadphasePairCount;
+
+                int mismatch = FindMismatch(serialBodies, parallelBodies);
+
+                if (mismatch >= 0)
+                {
+                    Fail("narrowphase determinism failed on frame " + frame + " body " + mismatch +
+                        " serial: " + serialBodies[mismatch].SceneEntity.LocalPosition +
+                        " parallel: " + parallelBodies[mismatch].SceneEntity.LocalPosition);
+
+                    gameLogicEntity.Destroy();
+                    return;
+                }
+            }
+
+            Console.WriteLine("narrowphase determinism passed, " + FrameCount + " frames, " + (pairCount / FrameCount) + " pairs/frame, " +
+                Framework.Current.JobSystem.WorkerCount + " workers");
+
+            gameLogicEntity.Destroy();
+        }
+
+        private PhysicsWorld CreatePile(List<PhysicsObject> bodies)
+        {
+            Entity sceneEntity = _gameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+            Scene scene = sceneEntity.GetComponent<Scene>();
+
+            PhysicsWorld physicsWorld = sceneEntity.AddComponent<PhysicsWorld>();
+            physicsWorld.Gravity = new Vector2(0.0f, 9.81f * PhysicsWorld.MeterToPixel);
+
+            float width = ColumnCount * 32.0f;
+
+            PhysicsTestFixture.CreateBox(scene, new Vector2(0.0f, 40.0f), width + 200.0f, 40.0f, PhysicsObject.PhysicsType.Static);
+            PhysicsTestFixture.CreateBox(scene, new Vector2(-width * 0.5f - 60.0f, -RowCount * 16.0f), 40.0f, RowCount * 40.0f, PhysicsObject.PhysicsType.Static);
+            PhysicsTestFixture.CreateBox(scene, new Vector2(width * 0.5f + 60.0f, -RowCount * 16.0f), 40.0f, RowCount * 40.0f, PhysicsObject.PhysicsType.Static);
+
+            for (int row = 0; row < RowCount; row++)
+            {
+                for (int column = 0; column < ColumnCount; column++)
+                {
+                    //rows are shifted a little so the pile collapses instead of standing still
+                    Vector2 position = new Vector2(column * 32.0f - width * 0.5f + (row % 2) * 8.0f, -row * 31.0f);
+
+                    PhysicsObject physicsObject;
+
+                    if ((row + column) % 2 == 0)
+                    {
+                        physicsObject = PhysicsTestFixture.CreateBox(scene, position, 28.0f, 28.0f, PhysicsObject.PhysicsType.RigidBody);
+                    }
+                    else
+                    {
+                        physicsObject = PhysicsTestFixture.CreateCircle(scene, position, 15.0f);
+                    }
+
+                    bodies.Add(physicsObject);
+                }
+            }
+
+            return physicsWorld;
+        }
+
+        private static int FindMismatch(List<PhysicsObject> serialBodies, List<PhysicsObject> parallelBodies)
+        {
+            for (int i = 0; i < serialBodies.Count; i++)
+            {
+                PhysicsObject serialBody = serialBodies[i];
+                PhysicsObject parallelBody = parallelBodies[i];
+
+                if (serialBody.SceneEntity.LocalPosition != parallelBody.SceneEntity.LocalPosition ||
+                    serialBody.SceneEntity.LocalRotation != parallelBody.SceneEntity.LocalRotation ||
+                    serialBody.Velocity != parallelBody.Velocity ||
+                    serialBody.AngularVelocity != parallelBody.AngularVelocity)
+                {
+                    return i;
+                }
+            }
+
+            return -1;
+        }
+    }
+}
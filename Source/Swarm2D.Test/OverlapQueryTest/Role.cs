@@ -0,0 +1,296 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+using Debug = Swarm2D.Library.Debug;
+
+namespace Swarm2D.Test.OverlapQueryTest
+{
+    //runs the same circle, box and polygon queries in the same static scene on every broadphase, they must find the
+    //same objects with no duplicates, on the allowed layers only. circle queries are checked against circles by hand
+    public class Role : TestRole
+    {
+        private const int BodyCount = 1500;
+        private const int QueryCount = 6000;
+        private const int ResultsPerQuery = 64;
+        private const float Extent = 2000.0f;
+
+        private Engine.Core.Engine _engine;
+        private GameLogic _gameLogic;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#    Running Overlap Query     #");
+            Console.WriteLine("################################");
+
+            _engine = new Engine.Core.Engine(false);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            _gameLogic = testController.GameLogic;
+            _gameLogic.StartGame();
+
+            OverlapQuery[] queries = CreateQueries();
+
+            List<Entity> sceneEntities = new List<Entity>();
+            List<HashSet<string>> expectedResults = null;
+
+            foreach (BroadphaseType broadphaseType in new BroadphaseType[] { BroadphaseType.SweepAndPrune, BroadphaseType.DynamicAabbTree, BroadphaseType.Grid })
+            {
+                List<HashSet<string>> results = Run(broadphaseType, queries, sceneEntities);
+
+                if (expectedResults == null)
+                {
+                    expectedResults = results;
+                    continue;
+                }
+
+                int mismatchCount = 0;
+
+                for (int i = 0; i < QueryCount; i++)
+                {
+                    if (!expectedResults[i].SetEquals(results[i]))
+                    {
+                        mismatchCount++;
+                    }
+                }
+
+                Check(broadphaseType + " mismatches: " + mismatchCount, mismatchCount == 0);
+            }
+
+            for (int i = 0; i < sceneEntities.Count; i++)
+            {
+                sceneEntities[i].Destroy();
+            }
+
+            this.Update();
+
+            Console.WriteLine(Failed ? "overlap query test failed" : "overlap query test passed");
+
+            gameLogicEntity.Destroy();
+        }
+
+        private OverlapQuery[] CreateQueries()
+        {
+            System.Random random = new System.Random(777);
+
+            OverlapQuery[] queries = new OverlapQuery[QueryCount];
+
+            for (int i = 0; i < QueryCount; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(random, -Extent, Extent), PhysicsTestFixture.RandomRange(random, -Extent, Extent));
+                int layerMask = i % 3 == 0 ? OverlapQuery.AllLayers : random.Next(1, 16);
+
+                switch (i % 3)
+                {
+                    case 0:
+                        queries[i] = OverlapQuery.Circle(position, PhysicsTestFixture.RandomRange(random, 10.0f, 150.0f), layerMask);
+                        break;
+                    case 1:
+                        Vector2 halfSize = new Vector2(PhysicsTestFixture.RandomRange(random, 10.0f, 150.0f), PhysicsTestFixture.RandomRange(random, 10.0f, 150.0f));
+                        queries[i] = OverlapQuery.Box(position - halfSize, position + halfSize, layerMask);
+                        break;
+                    default:
+                        //a triangle pointing somewhere
+                        float angle = PhysicsTestFixture.RandomRange(random, 0.0f, Mathf.PI * 2.0f);
+                        float size = PhysicsTestFixture.RandomRange(random, 20.0f, 200.0f);
+
+                        Vector2[] vertices = new Vector2[3];
+
+                        for (int j = 0; j < 3; j++)
+                        {
+                            float vertexAngle = angle + j * Mathf.PI * 2.0f / 3.0f;
+                            vertices[j] = position + new Vector2(Mathf.Cos(vertexAngle), Mathf.Sin(vertexAngle)) * size;
+                        }
+
+                        queries[i] = OverlapQuery.Polygon(vertices, 3, layerMask);
+                        break;
+                }
+
+                queries[i].IncludeTriggers = i % 5 == 0;
+            }
+
+            return queries;
+        }
+
+        private List<HashSet<string>> Run(BroadphaseType broadphaseType, OverlapQuery[] queries, List<Entity> sceneEntities)
+        {
+            Entity sceneEntity = _gameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+            sceneEntities.Add(sceneEntity);
+
+            Scene scene = sceneEntity.GetComponent<Scene>();
+
+            PhysicsWorld physicsWorld = sceneEntity.AddComponent<PhysicsWorld>();
+            physicsWorld.BroadphaseType = broadphaseType;
+            physicsWorld.Gravity = Vector2.Zero;
+
+            List<CircleShapeFilter> circles = CreateScene(scene);
+
+            for (int i = 0; i < 2; i++)
+            {
+                this.Update();
+            }
+
+            PhysicsObject[] results = new PhysicsObject[QueryCount * ResultsPerQuery];
+            int[] resultCounts = new int[QueryCount];
+
+            Stopwatch stopwatch = Stopwatch.StartNew();
+            physicsWorld.OverlapBatch(queries, results, ResultsPerQuery, resultCounts);
+            double batchMilliseconds = stopwatch.Elapsed.TotalMilliseconds;
+
+            List<HashSet<string>> names = new List<HashSet<string>>();
+
+            int duplicateCount = 0;
+            int filterErrorCount = 0;
+            int circleErrorCount = 0;
+            int fullCount = 0;
+            long foundCount = 0;
+
+            for (int i = 0; i < QueryCount; i++)
+            {
+                HashSet<string> queryNames = new HashSet<string>();
+
+                for (int j = 0; j < resultCounts[i]; j++)
+                {
+                    PhysicsObject physicsObject = results[i * ResultsPerQuery + j];
+
+                    if (!queryNames.Add(physicsObject.Entity.Name))
+                    {
+                        duplicateCount++;
+                    }
+
+                    if ((queries[i].LayerMask & (1 << physicsObject.Layer)) == 0 ||
+                        !queries[i].IncludeTriggers && physicsObject.Type == PhysicsObject.PhysicsType.Trigger)
+                    {
+                        filterErrorCount++;
+                    }
+                }
+
+                if (resultCounts[i] == ResultsPerQuery)
+                {
+                    fullCount++;
+                }
+
+                foundCount += resultCounts[i];
+                names.Add(queryNames);
+
+                if (queries[i].Type == OverlapShapeType.Circle)
+                {
+                    circleErrorCount += CheckCircleQuery(circles, queries[i], queryNames);
+                }
+            }
+
+            Check(broadphaseType + " duplicates: " + duplicateCount, duplicateCount == 0);
+            Check(broadphaseType + " filter errors: " + filterErrorCount, filterErrorCount == 0);
+            Check(broadphaseType + " circle errors: " + circleErrorCount, circleErrorCount == 0);
+            Check(broadphaseType + " full results: " + fullCount, fullCount == 0);
+
+            Console.WriteLine(broadphaseType + " " + QueryCount + " queries found:" + foundCount + " batch:" + batchMilliseconds.ToString("F2") + "ms");
+
+            return names;
+        }
+
+        //circle bodies are found by their distance, compared with what the query found among the circles
+        private int CheckCircleQuery(List<CircleShapeFilter> circles, OverlapQuery query, HashSet<string> queryNames)
+        {
+            int errorCount = 0;
+
+            foreach (CircleShapeFilter circleShapeFilter in circles)
+            {
+                PhysicsObject physicsObject = circleShapeFilter.Entity.GetComponent<PhysicsObject>();
+
+                if (physicsObject.Type == PhysicsObject.PhysicsType.Trigger && !query.IncludeTriggers)
+                {
+                    continue;
+                }
+
+                float distance = (circleShapeFilter.Entity.GetComponent<SceneEntity>().LocalPosition - query.Position).Length;
+                float sumOfRadiuses = circleShapeFilter.Radius + query.Radius;
+
+                //too close to the border to tell
+                if (Math.Abs(distance - sumOfRadiuses) < 0.01f)
+                {
+                    continue;
+                }
+
+                if ((distance < sumOfRadiuses) != queryNames.Contains(circleShapeFilter.Entity.Name))
+                {
+                    errorCount++;
+                }
+            }
+
+            return errorCount;
+        }
+
+        //the same seed builds the same bodies in every scene, names tell them apart between scenes
+        private List<CircleShapeFilter> CreateScene(Scene scene)
+        {
+            System.Random random = new System.Random(1234);
+
+            List<CircleShapeFilter> circles = new List<CircleShapeFilter>();
+
+            for (int i = 0; i < BodyCount; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(random, -Extent, Extent), PhysicsTestFixture.RandomRange(random, -Extent, Extent));
+
+                Entity entity = scene.CreateChildEntity("body" + i);
+                entity.GetComponent<SceneEntity>().LocalPosition = position;
+
+                if (i % 2 == 0)
+                {
+                    CircleShapeFilter circleShapeFilter = entity.AddComponent<CircleShapeFilter>();
+                    circleShapeFilter.Radius = PhysicsTestFixture.RandomRange(random, 4.0f, 40.0f);
+
+                    circles.Add(circleShapeFilter);
+                }
+                else
+                {
+                    entity.GetComponent<SceneEntity>().LocalRotation = PhysicsTestFixture.RandomRange(random, 0.0f, 360.0f);
+
+                    BoxShapeFilter boxShapeFilter = entity.AddComponent<BoxShapeFilter>();
+                    boxShapeFilter.Width = PhysicsTestFixture.RandomRange(random, 8.0f, 120.0f);
+                    boxShapeFilter.Height = PhysicsTestFixture.RandomRange(random, 8.0f, 120.0f);
+                }
+
+                PhysicsObject physicsObject = entity.AddComponent<PhysicsObject>();
+                physicsObject.Type = i % 7 == 0 ? PhysicsObject.PhysicsType.Trigger : PhysicsObject.PhysicsType.Static;
+                physicsObject.Layer = i % 4;
+            }
+
+            return circles;
+        }
+    }
+}
@@ -0,0 +1,352 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Threading;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test.PathfindingServiceTest
+{
+    //requests paths from a pathfinding service on worker threads and time sliced on the main thread, checks them against
+    //synchronous searches, and checks the priorities, the shared identical requests, cancelling and the coroutine task
+    public class Role : TestRole
+    {
+        private const int WorkerCount = 3;
+        private const int MaxUpdateCount = 1000;
+
+        private Engine.Core.Engine _engine;
+        private GameLogic _gameLogic;
+        private PathfindingService _pathfindingService;
+        private GridWorld _world;
+
+        protected override JobSystemSettings CreateJobSystemSettings()
+        {
+            JobSystemSettings jobSystemSettings = new JobSystemSettings();
+            jobSystemSettings.WorkerCount = WorkerCount;
+
+            return jobSystemSettings;
+        }
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#  Running Pathfinding Service #");
+            Console.WriteLine("################################");
+
+            _engine = new Engine.Core.Engine(false);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+            CoroutineManager coroutineManager = _engine.RootEntity.CreateChildEntity("CoroutineManager").AddComponent<CoroutineManager>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            _gameLogic = testController.GameLogic;
+            _gameLogic.StartGame();
+
+            Entity sceneEntity = _gameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+
+            System.Random random = new System.Random(12345);
+
+            _world = new GridWorld(64, 64, 0.25f, false, random);
+
+            _pathfindingService = sceneEntity.AddComponent<PathfindingService>();
+            _pathfindingService.NavigableWorld = _world;
+
+            TestResults(random, true);
+            TestResults(random, false);
+            TestSharedRequests(random);
+            TestCancel(random);
+            TestPriorities(random);
+            TestInvalidation(random);
+            TestCoroutine(coroutineManager, random);
+
+            Console.WriteLine(Failed ? "pathfinding service test failed" : "pathfinding service test passed");
+
+            gameLogicEntity.Destroy();
+        }
+
+        private void TestResults(System.Random random, bool useWorkerThreads)
+        {
+            _pathfindingService.UseWorkerThreads = useWorkerThreads;
+
+            string mode = useWorkerThreads ? "worker threads" : "time sliced";
+
+            PathRequest[] requests = new PathRequest[100];
+
+            for (int i = 0; i < requests.Length; i++)
+            {
+                requests[i] = _pathfindingService.RequestPath(_world.GetRandomNode(random), _world.GetRandomNode(random), random.Next(4));
+            }
+
+            int updateCount = UpdateUntilDone(requests);
+
+            for (int i = 0; i < requests.Length; i++)
+            {
+                NavigationPath expectedPath = new NavigationPath(requests[i].StartNode, requests[i].EndNode);
+
+                if (expectedPath.NodeCount == 0)
+                {
+                    CheckStatus(mode, requests[i], PathRequestStatus.NotFound);
+                    continue;
+                }
+
+                CheckStatus(mode, requests[i], PathRequestStatus.Found);
+
+                NavigationPath path = requests[i].Path;
+
+                //the snapshot nodes are mapped back to the nodes of the world
+                if (path == null || path.NodeCount != expectedPath.NodeCount || path[0] != requests[i].EndNode ||
+                    path[path.NodeCount - 1] != requests[i].StartNode || !(path[0] is GridNode))
+                {
+                    Fail(mode + ": path " + i + " differs from the synchronous search");
+                }
+            }
+
+            Console.WriteLine(mode + ": " + requests.Length + " requests done in " + updateCount + " updates");
+        }
+
+        private void TestSharedRequests(System.Random random)
+        {
+            _pathfindingService.UseWorkerThreads = true;
+
+            INavigableNode startNode = _world.GetRandomNode(random);
+            INavigableNode endNode = _world.GetRandomNode(random);
+
+            PathRequest[] requests = new PathRequest[3];
+
+            for (int i = 0; i < requests.Length; i++)
+            {
+                requests[i] = _pathfindingService.RequestPath(startNode, endNode);
+            }
+
+            if (_pathfindingService.PendingSearchCount != 1)
+            {
+                Fail("identical requests made " + _pathfindingService.PendingSearchCount + " searches");
+            }
+
+            UpdateUntilDone(requests);
+
+            for (int i = 1; i < requests.Length; i++)
+            {
+                if (requests[i].Status != requests[0].Status || requests[i].Path != requests[0].Path)
+                {
+                    Fail("identical requests got different results");
+                }
+            }
+
+            //the search is over, the next identical request searches again
+            PathRequest laterRequest = _pathfindingService.RequestPath(startNode, endNode);
+            UpdateUntilDone(new PathRequest[] { laterRequest });
+
+            if (laterRequest.Path == requests[0].Path)
+            {
+                Fail("a request made after the search was over joined it");
+            }
+        }
+
+        private void TestCancel(System.Random random)
+        {
+            _pathfindingService.UseWorkerThreads = true;
+
+            INavigableNode startNode = _world.GetRandomNode(random);
+            INavigableNode endNode = _world.GetRandomNode(random);
+
+            PathRequest cancelledRequest = _pathfindingService.RequestPath(startNode, endNode);
+            PathRequest request = _pathfindingService.RequestPath(startNode, endNode);
+            PathRequest lonelyRequest = _pathfindingService.RequestPath(_world.GetRandomNode(random), _world.GetRandomNode(random));
+
+            bool callbackCalled = false;
+            cancelledRequest.Completed = completedRequest => callbackCalled = true;
+
+            cancelledRequest.Cancel();
+            lonelyRequest.Cancel();
+
+            CheckStatus("cancel", cancelledRequest, PathRequestStatus.Cancelled);
+            CheckStatus("cancel", lonelyRequest, PathRequestStatus.Cancelled);
+
+            if (!callbackCalled)
+            {
+                Fail("cancelling did not call the completion callback");
+            }
+
+            UpdateUntilDone(new PathRequest[] { request });
+
+            if (request.Status == PathRequestStatus.Cancelled || cancelledRequest.Status != PathRequestStatus.Cancelled)
+            {
+                Fail("cancelling a shared request cancelled the others");
+            }
+
+            if (_pathfindingService.PendingSearchCount != 0 || _pathfindingService.RunningSearchCount != 0)
+            {
+                Fail("cancelled search is still queued");
+            }
+
+            PathRequest unknownRequest = _pathfindingService.RequestPath(new GridNode(null, 1 << 20, Vector2.Zero), endNode);
+            UpdateUntilDone(new PathRequest[] { unknownRequest });
+            CheckStatus("unknown node", unknownRequest, PathRequestStatus.NotFound);
+        }
+
+        //time sliced searches run one at a time, so the completion order is the order of the priorities
+        private void TestPriorities(System.Random random)
+        {
+            _pathfindingService.UseWorkerThreads = false;
+            _pathfindingService.TimeSliceMilliseconds = 0.0f;
+
+            List<int> completedPriorities = new List<int>();
+            PathRequest[] requests = new PathRequest[30];
+
+            for (int i = 0; i < requests.Length; i++)
+            {
+                requests[i] = _pathfindingService.RequestPath(_world.GetRandomNode(random), _world.GetRandomNode(random), i % 3);
+                requests[i].Completed = completedRequest => completedPriorities.Add(completedRequest.Priority);
+            }
+
+            UpdateUntilDone(requests);
+
+            for (int i = 1; i < completedPriorities.Count; i++)
+            {
+                if (completedPriorities[i] > completedPriorities[i - 1])
+                {
+                    Fail("priority " + completedPriorities[i] + " completed after " + completedPriorities[i - 1]);
+                    break;
+                }
+            }
+
+            _pathfindingService.TimeSliceMilliseconds = 2.0f;
+        }
+
+        private void TestInvalidation(System.Random random)
+        {
+            _pathfindingService.UseWorkerThreads = true;
+
+            GridNode endNode = _world.GetRandomNode(random);
+            GridNode startNode = _world.GetRandomNode(random);
+
+            while (startNode == endNode)
+            {
+                startNode = _world.GetRandomNode(random);
+            }
+
+            //cut the end node off, the service keeps the old graph until it is told
+            foreach (INavigableNode neighbour in endNode.Neighbours)
+            {
+                neighbour.Neighbours.Remove(endNode);
+            }
+
+            List<INavigableNode> removedNeighbours = new List<INavigableNode>(endNode.Neighbours);
+            endNode.Neighbours.Clear();
+
+            _pathfindingService.InvalidateNavigationGraph();
+
+            PathRequest request = _pathfindingService.RequestPath(startNode, endNode);
+            UpdateUntilDone(new PathRequest[] { request });
+            CheckStatus("invalidation", request, PathRequestStatus.NotFound);
+
+            foreach (INavigableNode neighbour in removedNeighbours)
+            {
+                neighbour.Neighbours.Add(endNode);
+                endNode.Neighbours.Add(neighbour);
+            }
+
+            _pathfindingService.InvalidateNavigationGraph();
+        }
+
+        private void TestCoroutine(CoroutineManager coroutineManager, System.Random random)
+        {
+            _pathfindingService.UseWorkerThreads = true;
+
+            INavigableNode startNode = _world.GetRandomNode(random);
+            INavigableNode endNode = _world.GetRandomNode(random);
+            NavigationPath expectedPath = new NavigationPath(startNode, endNode);
+
+            bool finished = false;
+            NavigationPath foundPath = null;
+
+            coroutineManager.StartCoroutine(_pathfindingService, coroutine => FindPath(coroutine, startNode, endNode, path =>
+            {
+                foundPath = path;
+                finished = true;
+            }));
+
+            for (int i = 0; i < MaxUpdateCount && !finished; i++)
+            {
+                this.Update();
+                Thread.Sleep(1);
+            }
+
+            if (!finished)
+            {
+                Fail("coroutine waiting for a path did not finish");
+            }
+            else if ((foundPath == null ? 0 : foundPath.NodeCount) != expectedPath.NodeCount)
+            {
+                Fail("coroutine got a different path");
+            }
+        }
+
+        private IEnumerator<CoroutineTask> FindPath(Coroutine coroutine, INavigableNode startNode, INavigableNode endNode, Action<NavigationPath> onFinished)
+        {
+            FindPathTask findPathTask = coroutine.AddTask<FindPathTask>();
+            findPathTask.Initialize(_pathfindingService, startNode, endNode);
+            yield return findPathTask;
+
+            onFinished(findPathTask.Path);
+        }
+
+        private int UpdateUntilDone(PathRequest[] requests)
+        {
+            for (int updateCount = 0; updateCount < MaxUpdateCount; updateCount++)
+            {
+                if (requests.All(request => request.IsDone))
+                {
+                    return updateCount;
+                }
+
+                this.Update();
+
+                //a frame takes a while, the workers need the time to search
+                Thread.Sleep(1);
+            }
+
+            Fail("requests were not done in " + MaxUpdateCount + " updates");
+
+            return MaxUpdateCount;
+        }
+
+        private void CheckStatus(string name, PathRequest request, PathRequestStatus expectedStatus)
+        {
+            if (request.Status != expectedStatus)
+            {
+                Fail(name + ": request is " + request.Status + " expected " + expectedStatus);
+            }
+        }
+    }
+}
@@ -0,0 +1,233 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+using Debug = Swarm2D.Library.Debug;
+
+namespace Swarm2D.Test.PathfindingTest
+{
+    //compares the costs of A* paths on a grid with walls against dijkstra, runs the same searches on the job system
+    //at the same time and measures the searches on a large grid
+    public class Role : TestRole
+    {
+        private const int WorkerCount = 3;
+
+        protected override JobSystemSettings CreateJobSystemSettings()
+        {
+            JobSystemSettings jobSystemSettings = new JobSystemSettings();
+            jobSystemSettings.WorkerCount = WorkerCount;
+
+            return jobSystemSettings;
+        }
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#    Running Pathfinding       #");
+            Console.WriteLine("################################");
+
+            System.Random random = new System.Random(12345);
+
+            GridWorld smallWorld = new GridWorld(48, 48, 0.3f, true, random);
+
+            INavigableNode[] starts = new INavigableNode[200];
+            INavigableNode[] ends = new INavigableNode[starts.Length];
+
+            for (int i = 0; i < starts.Length; i++)
+            {
+                starts[i] = smallWorld.GetRandomNode(random);
+                ends[i] = smallWorld.GetRandomNode(random);
+            }
+
+            float[] costs = new float[starts.Length];
+            int unreachableCount = 0;
+
+            for (int i = 0; i < starts.Length; i++)
+            {
+                NavigationPath path = new NavigationPath(starts[i], ends[i]);
+                costs[i] = CheckPath(path, starts[i], ends[i]);
+
+                float expectedCost = Dijkstra(smallWorld, starts[i], ends[i]);
+
+                if (float.IsPositiveInfinity(expectedCost))
+                {
+                    unreachableCount++;
+                }
+
+                if (float.IsPositiveInfinity(expectedCost) != float.IsPositiveInfinity(costs[i]) ||
+                    (!float.IsPositiveInfinity(expectedCost) && Math.Abs(costs[i] - expectedCost) > 0.01f))
+                {
+                    Fail("search " + i + " cost " + costs[i] + " expected " + expectedCost);
+                }
+            }
+
+            Console.WriteLine(unreachableCount + " of " + starts.Length + " searches had no path");
+
+            //searches share the world but not their state, each thread uses a context of its own
+            float[] parallelCosts = new float[starts.Length];
+
+            Framework.Current.JobSystem.ParallelFor(starts.Length, 4, (startIndex, endIndex, threadIndex) =>
+            {
+                for (int i = startIndex; i < endIndex; i++)
+                {
+                    NavigationPath path = new NavigationPath(starts[i], ends[i]);
+                    parallelCosts[i] = GetPathCost(path);
+                }
+            });
+
+            for (int i = 0; i < starts.Length; i++)
+            {
+                if (parallelCosts[i] != costs[i] && !(float.IsPositiveInfinity(parallelCosts[i]) && float.IsPositiveInfinity(costs[i])))
+                {
+                    Fail("parallel search " + i + " cost " + parallelCosts[i] + " expected " + costs[i]);
+                }
+            }
+
+            Measure(random);
+
+            Console.WriteLine(Failed ? "pathfinding test failed" : "pathfinding test passed");
+        }
+
+        private void Measure(System.Random random)
+        {
+            GridWorld largeWorld = new GridWorld(512, 512, 0.25f, true, random);
+            PathfindingContext context = new PathfindingContext();
+
+            const int searchCount = 50;
+            int pathNodeCount = 0;
+
+            Stopwatch stopwatch = Stopwatch.StartNew();
+
+            for (int i = 0; i < searchCount; i++)
+            {
+                NavigationPath path = new NavigationPath(largeWorld.GetRandomNode(random), largeWorld.GetRandomNode(random), context);
+                pathNodeCount += path.NodeCount;
+            }
+
+            stopwatch.Stop();
+
+            Console.WriteLine("512x512 grid: " + (stopwatch.Elapsed.TotalMilliseconds / searchCount).ToString("F3") + "ms per search, " +
+                (pathNodeCount / searchCount) + " nodes per path");
+        }
+
+        //checks that the path goes from the end to the start over neighbours and returns its cost
+        private float CheckPath(NavigationPath path, INavigableNode startNode, INavigableNode endNode)
+        {
+            if (path.NodeCount == 0)
+            {
+                return float.PositiveInfinity;
+            }
+
+            if (path[0] != endNode || path[path.NodeCount - 1] != startNode)
+            {
+                Fail("path does not go from the end to the start");
+            }
+
+            for (int i = 1; i < path.NodeCount; i++)
+            {
+                if (!path[i].Neighbours.Contains(path[i - 1]))
+                {
+                    Fail("path jumps between nodes which are not neighbours");
+                }
+            }
+
+            return GetPathCost(path);
+        }
+
+        private static float GetPathCost(NavigationPath path)
+        {
+            if (path.NodeCount == 0)
+            {
+                return float.PositiveInfinity;
+            }
+
+            float cost = 0.0f;
+
+            for (int i = path.NodeCount - 1; i > 0; i--)
+            {
+                cost += Vector2.Distance(path[i].Position, path[i - 1].Position);
+            }
+
+            return cost;
+        }
+
+        //quadratic dijkstra, slow but obviously right
+        private static float Dijkstra(GridWorld world, INavigableNode startNode, INavigableNode endNode)
+        {
+            int nodeCount = world.Nodes.Length;
+
+            float[] distances = new float[nodeCount];
+            bool[] visited = new bool[nodeCount];
+
+            for (int i = 0; i < nodeCount; i++)
+            {
+                distances[i] = float.PositiveInfinity;
+            }
+
+            distances[startNode.NavigationIndex] = 0.0f;
+
+            while (true)
+            {
+                int current = -1;
+
+                for (int i = 0; i < nodeCount; i++)
+                {
+                    if (!visited[i] && !float.IsPositiveInfinity(distances[i]) && (current < 0 || distances[i] < distances[current]))
+                    {
+                        current = i;
+                    }
+                }
+
+                if (current < 0 || current == endNode.NavigationIndex)
+                {
+                    break;
+                }
+
+                visited[current] = true;
+
+                GridNode currentNode = world.Nodes[current];
+
+                foreach (INavigableNode neighbour in currentNode.Neighbours)
+                {
+                    float distance = distances[current] + Vector2.Distance(currentNode.Position, neighbour.Position);
+
+                    if (distance < distances[neighbour.NavigationIndex])
+                    {
+                        distances[neighbour.NavigationIndex] = distance;
+                    }
+                }
+            }
+
+            return distances[endNode.NavigationIndex];
+        }
+    }
+}
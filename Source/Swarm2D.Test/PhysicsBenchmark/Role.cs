@@ -0,0 +1,546 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+using Debug = Swarm2D.Library.Debug;
+
+namespace Swarm2D.Test.PhysicsBenchmark
+{
+    //steps canonical scenes headlessly with a fixed seed and writes a json line for each of them with the physics phase
+    //timings, the allocations and a checksum of the final physics state. the checksum only changes when the simulation does.
+    //the json lines are all that is written to stdout, the engine logging goes to stderr. -output writes them to a file too
+    //usage: PhysicsBenchmark [-frames count] [-seed value] [-scenario name] [-broadphase type] [-output file]
+    public class Role : TestRole
+    {
+        private enum Scenario
+        {
+            BoxPile,
+            CircleRain,
+            StaticMap,
+            Crowd
+        }
+
+        private static readonly string[] PhaseSampleNames =
+        {
+            "PhysicsWorld.UpdatePositions",
+            "PhysicsWorld.CheckCollisions",
+            "PhysicsWorld.ResolveCollisions",
+            "PhysicsWorld.SendCollisionMessages",
+            "PhysicsWorld.Islands"
+        };
+
+        private static readonly string[] PhaseNames =
+        {
+            "updatePositions",
+            "checkCollisions",
+            "resolveCollisions",
+            "sendCollisionMessages",
+            "islands"
+        };
+
+        //first frames initialize the bodies and build the broadphase, they are stepped but not measured
+        private const int WarmupFrameCount = 10;
+
+        private const int CharacterCount = 1000;
+        private const float CharacterSpeed = 150.0f;
+
+        private int _frameCount = 300;
+        private int _seed = 12345;
+        private BroadphaseType _broadphaseType = BroadphaseType.Grid;
+        private List<Scenario> _scenarios;
+        private string _outputPath;
+
+        private Engine.Core.Engine _engine;
+        private GameLogic _gameLogic;
+
+        private Scene _scene;
+        private System.Random _random;
+
+        private double[] _phaseMilliseconds;
+        private double[] _phaseMaxMilliseconds;
+        private double[] _framePhaseMilliseconds;
+        private int _stepCount;
+
+        private List<PhysicsObject> _characters;
+        private List<Vector2> _characterTargets;
+
+        public Role(string[] args)
+        {
+            LogWriter = Console.Error;
+
+            _scenarios = new List<Scenario>();
+
+            foreach (Scenario scenario in Enum.GetValues(typeof(Scenario)))
+            {
+                _scenarios.Add(scenario);
+            }
+
+            //args[0] is the role name
+            for (int i = 1; i + 1 < args.Length; i += 2)
+            {
+                string name = args[i];
+                string value = args[i + 1];
+
+                bool valid = true;
+
+                if (name == "-frames")
+                {
+                    int frameCount;
+                    valid = int.TryParse(value, out frameCount) && frameCount > 0;
+
+                    if (valid)
+                    {
+                        _frameCount = frameCount;
+                    }
+                }
+                else if (name == "-seed")
+                {
+                    valid = int.TryParse(value, out _seed);
+                }
+                else if (name == "-scenario")
+                {
+                    valid = Enum.IsDefined(typeof(Scenario), value);
+
+                    if (valid)
+                    {
+                        _scenarios.Clear();
+                        _scenarios.Add((Scenario)Enum.Parse(typeof(Scenario), value));
+                    }
+                }
+                else if (name == "-broadphase")
+                {
+                    valid = Enum.IsDefined(typeof(BroadphaseType), value);
+
+                    if (valid)
+                    {
+                        _broadphaseType = (BroadphaseType)Enum.Parse(typeof(BroadphaseType), value);
+                    }
+                }
+                else if (name == "-output")
+                {
+                    _outputPath = value;
+                }
+                else
+                {
+                    valid = false;
+                }
+
+                if (!valid)
+                {
+                    Debug.Log("PhysicsBenchmark: ignoring argument " + name + " " + value);
+                }
+            }
+
+            _phaseMilliseconds = new double[PhaseSampleNames.Length];
+            _phaseMaxMilliseconds = new double[PhaseSampleNames.Length];
+            _framePhaseMilliseconds = new double[PhaseSampleNames.Length];
+        }
+
+        public override void DoTest()
+        {
+            Console.Error.WriteLine("################################");
+            Console.Error.WriteLine("#    Running PhysicsBenchmark  #");
+            Console.Error.WriteLine("################################");
+
+            AppDomain.MonitoringIsEnabled = true;
+
+            _engine = new Engine.Core.Engine(false);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            _gameLogic = testController.GameLogic;
+            _gameLogic.StartGame();
+
+            _engine.Profiler.Enabled = true;
+
+            StringBuilder output = new StringBuilder();
+
+            foreach (Scenario scenario in _scenarios)
+            {
+                string result = Measure(scenario);
+
+                Console.WriteLine(result);
+                output.Append(result).Append('\n');
+            }
+
+            if (_outputPath != null)
+            {
+                File.WriteAllText(_outputPath, output.ToString());
+            }
+
+            gameLogicEntity.Destroy();
+        }
+
+        private string Measure(Scenario scenario)
+        {
+            Entity sceneEntity = _gameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+            _scene = sceneEntity.GetComponent<Scene>();
+
+            PhysicsWorld physicsWorld = sceneEntity.AddComponent<PhysicsWorld>();
+            physicsWorld.BroadphaseType = _broadphaseType;
+
+            _random = new System.Random(_seed);
+
+            switch (scenario)
+            {
+                case Scenario.BoxPile:
+                    CreateBoxPile(physicsWorld);
+                    break;
+                case Scenario.CircleRain:
+                    CreateCircleRain(physicsWorld);
+                    break;
+                case Scenario.StaticMap:
+                    CreateStaticMap();
+                    break;
+                case Scenario.Crowd:
+                    CreateCrowd();
+                    break;
+            }
+
+            for (int i = 0; i < WarmupFrameCount; i++)
+            {
+                Step(scenario);
+            }
+
+            GC.Collect();
+            GC.WaitForPendingFinalizers();
+            GC.Collect();
+
+            for (int i = 0; i < _phaseMilliseconds.Length; i++)
+            {
+                _phaseMilliseconds[i] = 0.0;
+                _phaseMaxMilliseconds[i] = 0.0;
+            }
+
+            _stepCount = 0;
+
+            int[] collectionCounts = new int[GC.MaxGeneration + 1];
+
+            for (int generation = 0; generation < collectionCounts.Length; generation++)
+            {
+                collectionCounts[generation] = GC.CollectionCount(generation);
+            }
+
+            long allocatedBytes = AppDomain.CurrentDomain.MonitoringTotalAllocatedMemorySize;
+
+            Stopwatch stopwatch = Stopwatch.StartNew();
+
+            for (int i = 0; i < _frameCount; i++)
+            {
+                Step(scenario);
+                AccumulatePhases();
+            }
+
+            stopwatch.Stop();
+
+            allocatedBytes = AppDomain.CurrentDomain.MonitoringTotalAllocatedMemorySize - allocatedBytes;
+
+            StringBuilder result = new StringBuilder();
+
+            result.Append("{\"scenario\":\"").Append(scenario).Append('"');
+            result.Append(",\"broadphase\":\"").Append(_broadphaseType).Append('"');
+            result.Append(",\"seed\":").Append(_seed);
+            result.Append(",\"frames\":").Append(_frameCount);
+            result.Append(",\"steps\":").Append(_stepCount);
+            result.Append(",\"bodies\":").Append(physicsWorld.PhysicsObjects.Count);
+            result.Append(",\"awakeBodies\":").Append(physicsWorld.AwakeBodyCount);
+            result.Append(",\"frameMs\":").Append(FormatMilliseconds(stopwatch.Elapsed.TotalMilliseconds / _frameCount));
+
+            result.Append(",\"phases\":{");
+
+            for (int i = 0; i < PhaseNames.Length; i++)
+            {
+                if (i > 0)
+                {
+                    result.Append(',');
+                }
+
+                double averageMilliseconds = _stepCount > 0 ? _phaseMilliseconds[i] / _stepCount : 0.0;
+
+                result.Append('"').Append(PhaseNames[i]).Append("\":{");
+                result.Append("\"avgMs\":").Append(FormatMilliseconds(averageMilliseconds));
+                result.Append(",\"maxMs\":").Append(FormatMilliseconds(_phaseMaxMilliseconds[i]));
+                result.Append('}');
+            }
+
+            result.Append('}');
+
+            result.Append(",\"allocatedBytes\":").Append(allocatedBytes);
+            result.Append(",\"allocatedBytesPerFrame\":").Append(allocatedBytes / _frameCount);
+
+            for (int generation = 0; generation < collectionCounts.Length; generation++)
+            {
+                result.Append(",\"gen").Append(generation).Append("Collections\":").Append(GC.CollectionCount(generation) - collectionCounts[generation]);
+            }
+
+            result.Append(",\"checksum\":\"").Append(ComputeChecksum(physicsWorld).ToString("x16")).Append('"');
+            result.Append('}');
+
+            _characters = null;
+            _characterTargets = null;
+
+            sceneEntity.Destroy();
+            this.Update();
+
+            return result.ToString();
+        }
+
+        private void Step(Scenario scenario)
+        {
+            if (scenario == Scenario.Crowd)
+            {
+                SteerCharacters();
+            }
+
+            this.Update();
+        }
+
+        //a frame may contain no physics step, the averages are per step and the maximums per frame
+        private void AccumulatePhases()
+        {
+            EngineProfiler profiler = _engine.Profiler;
+
+            if (profiler.FrameCount == 0)
+            {
+                return;
+            }
+
+            List<ProfilerSample> samples = profiler.GetFrame(0).Samples;
+
+            for (int i = 0; i < _framePhaseMilliseconds.Length; i++)
+            {
+                _framePhaseMilliseconds[i] = 0.0;
+            }
+
+            for (int sampleIndex = 0; sampleIndex < samples.Count; sampleIndex++)
+            {
+                ProfilerSample sample = samples[sampleIndex];
+
+                for (int i = 0; i < PhaseSampleNames.Length; i++)
+                {
+                    if (string.Equals(sample.Name, PhaseSampleNames[i], StringComparison.Ordinal))
+                    {
+                        _framePhaseMilliseconds[i] += (sample.EndTicks - sample.StartTicks) * 1000.0 / Stopwatch.Frequency;
+
+                        if (i == 0)
+                        {
+                            _stepCount++;
+                        }
+
+                        break;
+                    }
+                }
+            }
+
+            for (int i = 0; i < _framePhaseMilliseconds.Length; i++)
+            {
+                _phaseMilliseconds[i] += _framePhaseMilliseconds[i];
+                _phaseMaxMilliseconds[i] = Math.Max(_phaseMaxMilliseconds[i], _framePhaseMilliseconds[i]);
+            }
+        }
+
+        //fnv-1a over the exact bits of the transforms and velocities in the order the bodies were added
+        private static ulong ComputeChecksum(PhysicsWorld physicsWorld)
+        {
+            ulong hash = 14695981039346656037UL;
+
+            foreach (PhysicsObject physicsObject in physicsWorld.PhysicsObjects)
+            {
+                SceneEntity sceneEntity = physicsObject.SceneEntity;
+
+                hash = Hash(hash, sceneEntity.LocalPosition.X);
+                hash = Hash(hash, sceneEntity.LocalPosition.Y);
+                hash = Hash(hash, sceneEntity.LocalRotation);
+                hash = Hash(hash, physicsObject.Velocity.X);
+                hash = Hash(hash, physicsObject.Velocity.Y);
+                hash = Hash(hash, physicsObject.AngularVelocity);
+            }
+
+            return hash;
+        }
+
+        private static ulong Hash(ulong hash, float value)
+        {
+            //the conversion to double is exact, so are the bits
+            ulong bits = (ulong)BitConverter.DoubleToInt64Bits(value);
+
+            for (int i = 0; i < 8; i++)
+            {
+                hash ^= (bits >> (i * 8)) & 0xff;
+                hash *= 1099511628211UL;
+            }
+
+            return hash;
+        }
+
+        private static string FormatMilliseconds(double milliseconds)
+        {
+            return milliseconds.ToString("F4", CultureInfo.InvariantCulture);
+        }
+
+        //columns of boxes dropped into a walled bin, they settle into a pile with many resting contacts
+        private void CreateBoxPile(PhysicsWorld physicsWorld)
+        {
+            physicsWorld.Gravity = new Vector2(0.0f, 9.81f * PhysicsWorld.MeterToPixel);
+            physicsWorld.DefaultPhysicsMaterial.Restutition = 0.1f;
+
+            const int columnCount = 20;
+            const int rowCount = 25;
+            const float boxSize = 28.0f;
+            const float columnDistance = 36.0f;
+
+            float width = columnCount * columnDistance;
+
+            CreateBin(width, 0.0f);
+
+            for (int row = 0; row < rowCount; row++)
+            {
+                for (int column = 0; column < columnCount; column++)
+                {
+                    float x = -width * 0.5f + columnDistance * (column + 0.5f) + PhysicsTestFixture.RandomRange(_random, -2.0f, 2.0f);
+                    float y = -boxSize * 0.5f - 2.0f - row * (boxSize + 4.0f);
+
+                    PhysicsTestFixture.CreateBox(_scene, new Vector2(x, y), boxSize, boxSize, PhysicsObject.PhysicsType.RigidBody);
+                }
+            }
+        }
+
+        //circles of different sizes falling from different heights into a walled bin, new contacts appear on every step
+        private void CreateCircleRain(PhysicsWorld physicsWorld)
+        {
+            physicsWorld.Gravity = new Vector2(0.0f, 9.81f * PhysicsWorld.MeterToPixel);
+            physicsWorld.DefaultPhysicsMaterial.Restutition = 0.3f;
+
+            const int circleCount = 1000;
+            const float width = 1200.0f;
+
+            CreateBin(width, 0.0f);
+
+            for (int i = 0; i < circleCount; i++)
+            {
+                float radius = PhysicsTestFixture.RandomRange(_random, 4.0f, 10.0f);
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(_random, -width * 0.5f + 20.0f, width * 0.5f - 20.0f), PhysicsTestFixture.RandomRange(_random, -8000.0f, -200.0f));
+
+                PhysicsTestFixture.CreateCircle(_scene, position, radius, new Vector2(PhysicsTestFixture.RandomRange(_random, -50.0f, 50.0f), 0.0f), PhysicsObject.PhysicsType.RigidBody);
+            }
+        }
+
+        //a large static map of tiles and long walls with few movers of very different sizes
+        private void CreateStaticMap()
+        {
+            const float halfExtent = 6000.0f;
+
+            for (int i = 0; i < 8000; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent), PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent));
+                float size = PhysicsTestFixture.RandomRange(_random, 16.0f, 64.0f);
+
+                PhysicsTestFixture.CreateBox(_scene, position, size, size, PhysicsObject.PhysicsType.Static);
+            }
+
+            for (int i = 0; i < 40; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent), PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent));
+
+                if (i % 2 == 0)
+                {
+                    PhysicsTestFixture.CreateBox(_scene, position, 2000.0f, 30.0f, PhysicsObject.PhysicsType.Static);
+                }
+                else
+                {
+                    PhysicsTestFixture.CreateBox(_scene, position, 30.0f, 2000.0f, PhysicsObject.PhysicsType.Static);
+                }
+            }
+
+            for (int i = 0; i < 200; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent), PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent));
+                float radius = i % 10 == 0 ? PhysicsTestFixture.RandomRange(_random, 40.0f, 120.0f) : PhysicsTestFixture.RandomRange(_random, 4.0f, 12.0f);
+
+                PhysicsTestFixture.CreateCircle(_scene, position, radius, PhysicsTestFixture.RandomVelocity(_random, 150.0f), PhysicsObject.PhysicsType.RigidBody);
+            }
+        }
+
+        //characters walking to random targets in a crowded square, they push each other on every step
+        private void CreateCrowd()
+        {
+            const float halfExtent = 600.0f;
+
+            _characters = new List<PhysicsObject>();
+            _characterTargets = new List<Vector2>();
+
+            for (int i = 0; i < CharacterCount; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent), PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent));
+
+                PhysicsObject character = PhysicsTestFixture.CreateCircle(_scene, position, 10.0f, Vector2.Zero, PhysicsObject.PhysicsType.RigidBody);
+                character.FixedRotation = true;
+
+                _characters.Add(character);
+                _characterTargets.Add(new Vector2(PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent), PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent)));
+            }
+        }
+
+        private void SteerCharacters()
+        {
+            const float halfExtent = 600.0f;
+
+            for (int i = 0; i < _characters.Count; i++)
+            {
+                PhysicsObject character = _characters[i];
+                Vector2 toTarget = _characterTargets[i] - character.SceneEntity.LocalPosition;
+
+                if (toTarget.Length < 20.0f)
+                {
+                    _characterTargets[i] = new Vector2(PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent), PhysicsTestFixture.RandomRange(_random, -halfExtent, halfExtent));
+                    toTarget = _characterTargets[i] - character.SceneEntity.LocalPosition;
+                }
+
+                character.Velocity = toTarget.Normalized * CharacterSpeed;
+            }
+        }
+
+        private void CreateBin(float width, float floorY)
+        {
+            float wallHeight = 10000.0f;
+
+            PhysicsTestFixture.CreateBox(_scene, new Vector2(0.0f, floorY + 20.0f), width + 80.0f, 40.0f, PhysicsObject.PhysicsType.Static);
+            PhysicsTestFixture.CreateBox(_scene, new Vector2(-width * 0.5f - 20.0f, floorY - wallHeight * 0.5f), 40.0f, wallHeight, PhysicsObject.PhysicsType.Static);
+            PhysicsTestFixture.CreateBox(_scene, new Vector2(width * 0.5f + 20.0f, floorY - wallHeight * 0.5f), 40.0f, wallHeight, PhysicsObject.PhysicsType.Static);
+        }
+    }
+}
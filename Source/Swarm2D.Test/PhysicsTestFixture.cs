@@ -0,0 +1,83 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test
+{
+    //bodies and random values shared by the physics test roles and benchmarks
+    public static class PhysicsTestFixture
+    {
+        public static PhysicsObject CreateBox(Scene scene, Vector2 position, float width, float height, PhysicsObject.PhysicsType type)
+        {
+            Entity entity = scene.CreateChildEntity("box");
+            entity.GetComponent<SceneEntity>().LocalPosition = position;
+
+            BoxShapeFilter boxShapeFilter = entity.AddComponent<BoxShapeFilter>();
+            boxShapeFilter.Width = width;
+            boxShapeFilter.Height = height;
+
+            PhysicsObject physicsObject = entity.AddComponent<PhysicsObject>();
+            physicsObject.Type = type;
+
+            return physicsObject;
+        }
+
+        public static PhysicsObject CreateCircle(Scene scene, Vector2 position, float radius)
+        {
+            return CreateCircle(scene, position, radius, Vector2.Zero, PhysicsObject.PhysicsType.RigidBody);
+        }
+
+        public static PhysicsObject CreateCircle(Scene scene, Vector2 position, float radius, Vector2 velocity, PhysicsObject.PhysicsType type)
+        {
+            Entity entity = scene.CreateChildEntity("circle");
+            entity.GetComponent<SceneEntity>().LocalPosition = position;
+
+            CircleShapeFilter circleShapeFilter = entity.AddComponent<CircleShapeFilter>();
+            circleShapeFilter.Radius = radius;
+
+            PhysicsObject physicsObject = entity.AddComponent<PhysicsObject>();
+            physicsObject.Type = type;
+            physicsObject.Velocity = velocity;
+
+            return physicsObject;
+        }
+
+        public static float RandomRange(System.Random random, float min, float max)
+        {
+            return min + (float)random.NextDouble() * (max - min);
+        }
+
+        public static Vector2 RandomVelocity(System.Random random, float speed)
+        {
+            return new Vector2(RandomRange(random, -speed, speed), RandomRange(random, -speed, speed));
+        }
+    }
+}
@@ -0,0 +1,198 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test.PrefabSpawnBenchmark
+{
+    //spawns the same prefab on a pooled engine through the former reflection copy and through the spawn plan
+    public class Role : TestRole
+    {
+        private const string PrefabName = "ProjectilePrefab";
+        private const int SpawnCount = 10000;
+        private const int RoundCount = 5;
+
+        private Engine.Core.Engine _engine;
+        private Scene _scene;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#    Running PrefabSpawn       #");
+            Console.WriteLine("################################");
+
+            _engine = new Engine.Core.Engine(true);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            GameLogic gameLogic = testController.GameLogic;
+
+            Entity sceneEntity = gameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+            _scene = sceneEntity.GetComponent<Scene>();
+
+            CreatePrefab();
+
+            Vector2[] positions = new Vector2[SpawnCount];
+
+            for (int i = 0; i < SpawnCount; i++)
+            {
+                positions[i] = new Vector2(i % 100, i / 100);
+            }
+
+            //first round compiles the spawn plan and warms the pools
+            MeasureReflection(positions);
+            MeasureSpawnPlan(positions);
+
+            double reflectionTotal = 0.0;
+            double spawnPlanTotal = 0.0;
+
+            for (int i = 0; i < RoundCount; i++)
+            {
+                reflectionTotal += MeasureReflection(positions);
+                spawnPlanTotal += MeasureSpawnPlan(positions);
+            }
+
+            Console.WriteLine("reflection spawn: " + (SpawnCount * RoundCount / reflectionTotal).ToString("F0") + " entities/s");
+            Console.WriteLine("spawn plan spawn: " + (SpawnCount * RoundCount / spawnPlanTotal).ToString("F0") + " entities/s");
+
+            gameLogicEntity.Destroy();
+        }
+
+        private void CreatePrefab()
+        {
+            Entity prefab = _engine.CreatePrefab(PrefabName);
+
+            SceneEntity sceneEntity = prefab.AddComponent<SceneEntity>();
+            sceneEntity.LocalRotation = 45.0f;
+            sceneEntity.LocalScale = new Vector2(2.0f, 2.0f);
+
+            CircleShapeFilter circleShapeFilter = prefab.AddComponent<CircleShapeFilter>();
+            circleShapeFilter.Radius = 4.0f;
+        }
+
+        //the instantiation before spawn plans, properties are copied through reflection and boxed
+        private SceneEntity InstantiateWithReflection(Entity prefab, Vector2 position, float rotation)
+        {
+            Entity clonedPrefab = _scene.Entity.CreateChildEntity(prefab.Name + "(Clone)");
+
+            foreach (Component componentPrefab in prefab.Components)
+            {
+                Component clonedComponent = clonedPrefab.GetComponent(componentPrefab.GetType());
+
+                if (clonedComponent == null)
+                {
+                    clonedComponent = clonedPrefab.AddComponent(componentPrefab.GetType());
+                }
+
+                foreach (ComponentPropertyInfo propertyInfo in componentPrefab.GetComponentInfo().ComponentPropertyInfos.Values)
+                {
+                    object value = propertyInfo.GetValueAsObjectFrom(componentPrefab);
+                    propertyInfo.SetValueTo(clonedComponent, value);
+                }
+            }
+
+            SceneEntity sceneEntity = clonedPrefab.GetComponent<SceneEntity>();
+            sceneEntity.LocalPosition = position;
+            sceneEntity.LocalRotation = rotation;
+
+            return sceneEntity;
+        }
+
+        private double MeasureReflection(Vector2[] positions)
+        {
+            Entity prefab = _engine.GetPrefab(PrefabName);
+            SceneEntity[] sceneEntities = new SceneEntity[positions.Length];
+
+            GC.Collect();
+
+            Stopwatch stopwatch = Stopwatch.StartNew();
+
+            for (int i = 0; i < positions.Length; i++)
+            {
+                sceneEntities[i] = InstantiateWithReflection(prefab, positions[i], 45.0f);
+            }
+
+            stopwatch.Stop();
+
+            CheckAndDestroy(sceneEntities, positions);
+
+            return stopwatch.Elapsed.TotalSeconds;
+        }
+
+        private double MeasureSpawnPlan(Vector2[] positions)
+        {
+            SceneEntity[] sceneEntities = new SceneEntity[positions.Length];
+
+            GC.Collect();
+
+            Stopwatch stopwatch = Stopwatch.StartNew();
+
+            for (int i = 0; i < positions.Length; i++)
+            {
+                sceneEntities[i] = _scene.InstantiatePrefab(PrefabName, positions[i], 45.0f);
+            }
+
+            stopwatch.Stop();
+
+            CheckAndDestroy(sceneEntities, positions);
+
+            return stopwatch.Elapsed.TotalSeconds;
+        }
+
+        private void CheckAndDestroy(SceneEntity[] sceneEntities, Vector2[] positions)
+        {
+            for (int i = 0; i < sceneEntities.Length; i++)
+            {
+                SceneEntity sceneEntity = sceneEntities[i];
+                CircleShapeFilter circleShapeFilter = sceneEntity.GetComponent<CircleShapeFilter>();
+
+                if (sceneEntity.LocalPosition != positions[i] || sceneEntity.LocalRotation != 45.0f ||
+                    sceneEntity.LocalScale != new Vector2(2.0f, 2.0f) || circleShapeFilter == null || circleShapeFilter.Radius != 4.0f)
+                {
+                    Fail("clone " + i + " does not match the prefab");
+                    break;
+                }
+            }
+
+            //initializes the clones like a frame would before they are destroyed
+            this.Update();
+
+            for (int i = 0; i < sceneEntities.Length; i++)
+            {
+                sceneEntities[i].Entity.Destroy();
+            }
+        }
+    }
+}
@@ -35,13 +35,54 @@ namespace Swarm2D.Test
 {
     class Program
     {
-        static void Main(string[] args)
+        //roles by the name given as the first argument, the multiplayer test runs when no role is given
+        private static readonly Dictionary<string, Func<string[], TestRole>> Roles = new Dictionary<string, Func<string[], TestRole>>
         {
-            var test1 = new FastMovingMultiplayerGameObjectTest.Role();
+            { "BroadphaseBenchmark", args => new BroadphaseBenchmark.Role() },
+            { "ChildEngineTest", args => new ChildEngineTest.Role() },
+            { "ContinuousCollisionTest", args => new ContinuousCollisionTest.Role() },
+            { "CoroutineTest", args => new CoroutineTest.Role() },
+            { "FlowFieldTest", args => new FlowFieldTest.Role() },
+            { "HandleTest", args => new HandleTest.Role() },
+            { "HierarchicalPathfindingTest", args => new HierarchicalPathfindingTest.Role() },
+            { "JobSystemTest", args => new JobSystemTest.Role() },
+            { "NarrowphaseDeterminismTest", args => new NarrowphaseDeterminismTest.Role() },
+            { "OverlapQueryTest", args => new OverlapQueryTest.Role() },
+            { "PathfindingServiceTest", args => new PathfindingServiceTest.Role() },
+            { "PathfindingTest", args => new PathfindingTest.Role() },
+            { "PhysicsBenchmark", args => new PhysicsBenchmark.Role(args) },
+            { "PrefabSpawnBenchmark", args => new PrefabSpawnBenchmark.Role() },
+            { "RaycastTest", args => new RaycastTest.Role() },
+            { "RepositionOrderTest", args => new RepositionOrderTest.Role() },
+            { "SatBenchmark", args => new SatBenchmark.Role() },
+            { "SceneBinaryTest", args => new SceneBinaryTest.Role() },
+            { "SleepingTest", args => new SleepingTest.Role() },
+            { "TransformPropagationTest", args => new TransformPropagationTest.Role() },
+        };
 
-            test1.DoTest();
+        static int Main(string[] args)
+        {
+            TestRole test;
+            Func<string[], TestRole> createRole;
+
+            if (args.Length > 0 && Roles.TryGetValue(args[0], out createRole))
+            {
+                test = createRole(args);
+            }
+            else
+            {
+                test = new FastMovingMultiplayerGameObjectTest.Role();
+            }
+
+            test.Run();
+
+            //benchmarks run headless on ci with no console to wait on
+            if (!Console.IsInputRedirected)
+            {
+                Console.ReadKey();
+            }
 
-            Console.ReadKey();
+            return test.Failed ? 1 : 0;
         }
 
     }
@@ -0,0 +1,216 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+using Debug = Swarm2D.Library.Debug;
+
+namespace Swarm2D.Test.RaycastTest
+{
+    //casts the same rays in the same static scene on every broadphase. the grid walks its cells along the ray, the
+    //others test everything in the bounding box of the ray, so they must all find the same nearest hit. batches must
+    //agree with single rays
+    public class Role : TestRole
+    {
+        private const int BodyCount = 600;
+        private const int RayCount = 20000;
+        private const float Extent = 3000.0f;
+        private const float RayDistance = 1500.0f;
+
+        private Engine.Core.Engine _engine;
+        private GameLogic _gameLogic;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#    Running Raycast           #");
+            Console.WriteLine("################################");
+
+            _engine = new Engine.Core.Engine(false);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            _gameLogic = testController.GameLogic;
+            _gameLogic.StartGame();
+
+            System.Random random = new System.Random(4321);
+
+            Ray[] rays = new Ray[RayCount];
+
+            for (int i = 0; i < RayCount; i++)
+            {
+                Vector2 origin = new Vector2(PhysicsTestFixture.RandomRange(random, -Extent, Extent), PhysicsTestFixture.RandomRange(random, -Extent, Extent));
+                float angle = PhysicsTestFixture.RandomRange(random, 0.0f, Mathf.PI * 2.0f);
+
+                rays[i] = new Ray(origin, new Vector2(Mathf.Cos(angle), Mathf.Sin(angle)));
+            }
+
+            //scenes are kept until the end, hits of every broadphase are compared by the names of their colliders
+            List<Entity> sceneEntities = new List<Entity>();
+
+            RaycastHit[] expectedHits = null;
+
+            foreach (BroadphaseType broadphaseType in new BroadphaseType[] { BroadphaseType.SweepAndPrune, BroadphaseType.DynamicAabbTree, BroadphaseType.Grid })
+            {
+                RaycastHit[] hits = Cast(broadphaseType, rays, sceneEntities);
+
+                if (expectedHits == null)
+                {
+                    expectedHits = hits;
+                    continue;
+                }
+
+                int mismatchCount = 0;
+
+                for (int i = 0; i < RayCount; i++)
+                {
+                    if (!IsSameHit(expectedHits[i], hits[i]))
+                    {
+                        mismatchCount++;
+                    }
+                }
+
+                Check(broadphaseType + " mismatches: " + mismatchCount, mismatchCount == 0);
+            }
+
+            int hitCount = expectedHits.Count(hit => hit.Collider != null);
+            Console.WriteLine("hits: " + hitCount + "/" + RayCount);
+            Check("no hits", hitCount > 0 && hitCount < RayCount);
+
+            for (int i = 0; i < sceneEntities.Count; i++)
+            {
+                sceneEntities[i].Destroy();
+            }
+
+            this.Update();
+
+            Console.WriteLine(Failed ? "raycast test failed" : "raycast test passed");
+
+            gameLogicEntity.Destroy();
+        }
+
+        private RaycastHit[] Cast(BroadphaseType broadphaseType, Ray[] rays, List<Entity> sceneEntities)
+        {
+            Entity sceneEntity = _gameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+            sceneEntities.Add(sceneEntity);
+            Scene scene = sceneEntity.GetComponent<Scene>();
+
+            PhysicsWorld physicsWorld = sceneEntity.AddComponent<PhysicsWorld>();
+            physicsWorld.BroadphaseType = broadphaseType;
+            physicsWorld.Gravity = Vector2.Zero;
+
+            CreateScene(scene);
+
+            for (int i = 0; i < 2; i++)
+            {
+                this.Update();
+            }
+
+            RaycastHit[] hits = new RaycastHit[rays.Length];
+
+            Stopwatch stopwatch = Stopwatch.StartNew();
+
+            for (int i = 0; i < rays.Length; i++)
+            {
+                physicsWorld.Raycast(rays[i], out hits[i], RayDistance);
+            }
+
+            double singleMilliseconds = stopwatch.Elapsed.TotalMilliseconds;
+
+            RaycastHit[] batchHits = new RaycastHit[rays.Length];
+
+            stopwatch.Restart();
+            physicsWorld.RaycastBatch(rays, RayDistance, batchHits);
+            double batchMilliseconds = stopwatch.Elapsed.TotalMilliseconds;
+
+            int mismatchCount = 0;
+
+            for (int i = 0; i < rays.Length; i++)
+            {
+                if (!IsSameHit(hits[i], batchHits[i]))
+                {
+                    mismatchCount++;
+                }
+            }
+
+            Check(broadphaseType + " batch mismatches: " + mismatchCount, mismatchCount == 0);
+
+            Console.WriteLine(broadphaseType + " " + rays.Length + " rays single:" + singleMilliseconds.ToString("F2") + "ms batch:" + batchMilliseconds.ToString("F2") + "ms");
+
+            return hits;
+        }
+
+        //the same seed builds the same bodies in every scene, names tell them apart between scenes
+        private void CreateScene(Scene scene)
+        {
+            System.Random random = new System.Random(1234);
+
+            for (int i = 0; i < BodyCount; i++)
+            {
+                Vector2 position = new Vector2(PhysicsTestFixture.RandomRange(random, -Extent, Extent), PhysicsTestFixture.RandomRange(random, -Extent, Extent));
+
+                Entity entity = scene.CreateChildEntity("body" + i);
+                entity.GetComponent<SceneEntity>().LocalPosition = position;
+
+                if (i % 2 == 0)
+                {
+                    CircleShapeFilter circleShapeFilter = entity.AddComponent<CircleShapeFilter>();
+                    circleShapeFilter.Radius = PhysicsTestFixture.RandomRange(random, 4.0f, 40.0f);
+                }
+                else
+                {
+                    entity.GetComponent<SceneEntity>().LocalRotation = PhysicsTestFixture.RandomRange(random, 0.0f, 360.0f);
+
+                    BoxShapeFilter boxShapeFilter = entity.AddComponent<BoxShapeFilter>();
+                    boxShapeFilter.Width = PhysicsTestFixture.RandomRange(random, 8.0f, 120.0f);
+                    boxShapeFilter.Height = PhysicsTestFixture.RandomRange(random, 8.0f, 120.0f);
+                }
+
+                PhysicsObject physicsObject = entity.AddComponent<PhysicsObject>();
+                physicsObject.Type = PhysicsObject.PhysicsType.Static;
+            }
+        }
+
+        private static bool IsSameHit(RaycastHit hitA, RaycastHit hitB)
+        {
+            if (hitA.Collider == null || hitB.Collider == null)
+            {
+                return hitA.Collider == hitB.Collider;
+            }
+
+            //overlapping bodies can be hit at the same distance, any of them is the nearest
+            return Math.Abs(hitA.Distance - hitB.Distance) < 0.01f;
+        }
+    }
+}
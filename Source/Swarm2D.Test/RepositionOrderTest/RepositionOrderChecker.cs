@@ -0,0 +1,135 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test.RepositionOrderTest
+{
+    //added after the physics world, so it compares the reposition order of every step right after it is simulated.
+    //the expected order is the one the former bubble sort over the rigid bodies list and the search from the bodies
+    //touching statics produced. the list stayed sorted from step to step, so ties keep their order of the previous step
+    public class RepositionOrderChecker : SceneController
+    {
+        public PhysicsWorld PhysicsWorld { get; set; }
+
+        public int StepCount { get; private set; }
+        public int MismatchCount { get; private set; }
+
+        private List<PhysicsObject> _sortedRigidBodies;
+
+        private List<PhysicsObject> _order;
+        private List<PhysicsObject> _expectedOrder;
+
+        protected override void OnAdded()
+        {
+            base.OnAdded();
+
+            _sortedRigidBodies = new List<PhysicsObject>();
+            _order = new List<PhysicsObject>();
+            _expectedOrder = new List<PhysicsObject>();
+        }
+
+        //in the order they are added to the physics world
+        public void AddRigidBody(PhysicsObject rigidBody)
+        {
+            _sortedRigidBodies.Add(rigidBody);
+        }
+
+        [EntityMessageHandler(MessageType = typeof(SceneControllerUpdateMessage))]
+        private void OnUpdate(Message message)
+        {
+            _order.Clear();
+            PhysicsWorld.GetRepositionOrder(_order);
+
+            _expectedOrder.Clear();
+            CalculateExpectedOrder(_expectedOrder);
+
+            if (!_order.SequenceEqual(_expectedOrder))
+            {
+                MismatchCount++;
+            }
+
+            StepCount++;
+        }
+
+        private void CalculateExpectedOrder(List<PhysicsObject> result)
+        {
+            Dictionary<PhysicsObject, List<CollisionInfo>> contacts = new Dictionary<PhysicsObject, List<CollisionInfo>>();
+            Dictionary<PhysicsObject, int> staticContactCounts = new Dictionary<PhysicsObject, int>();
+
+            foreach (PhysicsObject rigidBody in _sortedRigidBodies)
+            {
+                List<CollisionInfo> bodyContacts = new List<CollisionInfo>();
+                rigidBody.GetContacts(bodyContacts);
+
+                contacts[rigidBody] = bodyContacts;
+                staticContactCounts[rigidBody] = bodyContacts.Count(contact => contact.CollidedBody.IsStatic);
+            }
+
+            _sortedRigidBodies = _sortedRigidBodies
+                .OrderBy(rigidBody => staticContactCounts[rigidBody])
+                .ThenBy(rigidBody => contacts[rigidBody].Count)
+                .ToList();
+
+            HashSet<PhysicsObject> added = new HashSet<PhysicsObject>();
+
+            int index = _sortedRigidBodies.Count - 1;
+
+            //bodies touching statics from the end
+            for (; index >= 0 && staticContactCounts[_sortedRigidBodies[index]] > 0; index--)
+            {
+                added.Add(_sortedRigidBodies[index]);
+                result.Add(_sortedRigidBodies[index]);
+            }
+
+            //their neighbours breadth first
+            for (int i = 0; i < result.Count; i++)
+            {
+                foreach (CollisionInfo contact in contacts[result[i]])
+                {
+                    if (contact.CollidedBody.Type == PhysicsObject.PhysicsType.RigidBody && added.Add(contact.CollidedBody))
+                    {
+                        result.Add(contact.CollidedBody);
+                    }
+                }
+            }
+
+            //the rest from the end
+            for (; index >= 0; index--)
+            {
+                if (added.Add(_sortedRigidBodies[index]))
+                {
+                    result.Add(_sortedRigidBodies[index]);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,142 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test.RepositionOrderTest
+{
+    //simulates piles of boxes on a floor and a pair falling in the air, the checker compares the reposition order of
+    //every step with the one of the former sort
+    public class Role : TestRole
+    {
+        private const int StepCount = 300;
+        private const int MaxFrameCount = 3000;
+
+        private Engine.Core.Engine _engine;
+        private GameLogic _gameLogic;
+
+        private Scene _scene;
+        private PhysicsWorld _physicsWorld;
+        private RepositionOrderChecker _checker;
+
+        private List<List<PhysicsObject>> _piles;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#    Running Reposition Order  #");
+            Console.WriteLine("################################");
+
+            _engine = new Engine.Core.Engine(false);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            _gameLogic = testController.GameLogic;
+            _gameLogic.StartGame();
+
+            CreateScene();
+
+            for (int frame = 0; frame < MaxFrameCount && _checker.StepCount < StepCount; frame++)
+            {
+                this.Update();
+            }
+
+            bool pilesStand = true;
+
+            foreach (List<PhysicsObject> pile in _piles)
+            {
+                float height = pile[0].SceneEntity.LocalPosition.Y - pile[pile.Count - 1].SceneEntity.LocalPosition.Y;
+
+                if (height < (pile.Count - 1) * 28.0f * 0.8f)
+                {
+                    pilesStand = false;
+                }
+            }
+
+            Console.WriteLine("steps:" + _checker.StepCount + " mismatches:" + _checker.MismatchCount + " piles stand:" + pilesStand);
+
+            Check("reposition order", _checker.StepCount >= StepCount && _checker.MismatchCount == 0 && pilesStand);
+
+            Console.WriteLine(Failed ? "reposition order test failed" : "reposition order test passed");
+
+            gameLogicEntity.Destroy();
+        }
+
+        private void CreateScene()
+        {
+            Entity sceneEntity = _gameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+            _scene = sceneEntity.GetComponent<Scene>();
+
+            _physicsWorld = sceneEntity.AddComponent<PhysicsWorld>();
+            _physicsWorld.Gravity = new Vector2(0.0f, 9.81f * PhysicsWorld.MeterToPixel);
+            _physicsWorld.DefaultPhysicsMaterial.Restutition = 0.1f;
+            _physicsWorld.SleepingEnabled = false;
+
+            _checker = sceneEntity.AddComponent<RepositionOrderChecker>();
+            _checker.PhysicsWorld = _physicsWorld;
+
+            CreateBox(new Vector2(0.0f, 40.0f), 1200.0f, 40.0f, PhysicsObject.PhysicsType.Static);
+
+            _piles = new List<List<PhysicsObject>>();
+
+            for (int pileIndex = 0; pileIndex < 4; pileIndex++)
+            {
+                List<PhysicsObject> pile = new List<PhysicsObject>();
+
+                for (int row = 0; row < pileIndex + 2; row++)
+                {
+                    pile.Add(CreateBox(new Vector2(-300.0f + pileIndex * 150.0f, -row * 30.0f), 28.0f, 28.0f, PhysicsObject.PhysicsType.RigidBody));
+                }
+
+                _piles.Add(pile);
+            }
+
+            //two boxes side by side touch nothing static until they land
+            CreateBox(new Vector2(300.0f, -400.0f), 28.0f, 28.0f, PhysicsObject.PhysicsType.RigidBody);
+            CreateBox(new Vector2(327.0f, -400.0f), 28.0f, 28.0f, PhysicsObject.PhysicsType.RigidBody);
+        }
+
+        private PhysicsObject CreateBox(Vector2 position, float width, float height, PhysicsObject.PhysicsType type)
+        {
+            PhysicsObject physicsObject = PhysicsTestFixture.CreateBox(_scene, position, width, height, type);
+
+            if (type == PhysicsObject.PhysicsType.RigidBody)
+            {
+                _checker.AddRigidBody(physicsObject);
+            }
+
+            return physicsObject;
+        }
+    }
+}
@@ -0,0 +1,152 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test.SatBenchmark
+{
+    //compares the flat array polygon kernel with the edge list path on the same transformed pairs
+    public class Role : TestRole
+    {
+        private const int PairCount = 1024;
+        private const int RepeatCount = 200;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#    Running SAT Kernel        #");
+            Console.WriteLine("################################");
+
+            Measure("box/box", CreateRegularPolygon("box", 4, 20.0f));
+            Measure("12-gon/12-gon", CreateRegularPolygon("12-gon", 12, 20.0f));
+        }
+
+        private Polygon CreateRegularPolygon(string name, int vertexCount, float radius)
+        {
+            Polygon polygon = new Polygon(name);
+
+            for (int i = 0; i < vertexCount; i++)
+            {
+                float angle = (Mathf.PI * 2.0f * i) / vertexCount + Mathf.PI / vertexCount;
+                polygon.Vertices.Add(new Vector2(Mathf.Cos(angle) * radius, Mathf.Sin(angle) * radius));
+            }
+
+            return polygon;
+        }
+
+        private PolygonInstance CreateInstance(Polygon polygon, System.Random random)
+        {
+            PolygonInstance polygonInstance = new PolygonInstance(polygon);
+            polygonInstance.Initialize();
+
+            //about half of the pairs overlap
+            Vector2 position = new Vector2((float)random.NextDouble() * 60.0f, (float)random.NextDouble() * 60.0f);
+            float rotation = (float)random.NextDouble() * Mathf.PI * 2.0f;
+
+            Matrix4x4 transform = Matrix4x4.Transformation2D(new Vector2(1.0f, 1.0f), rotation, position);
+            polygonInstance.PrepareTransformation(ref transform);
+
+            return polygonInstance;
+        }
+
+        private void Measure(string name, Polygon polygon)
+        {
+            System.Random random = new System.Random(1234);
+
+            PolygonInstance[] polygonsA = new PolygonInstance[PairCount];
+            PolygonInstance[] polygonsB = new PolygonInstance[PairCount];
+
+            for (int i = 0; i < PairCount; i++)
+            {
+                polygonsA[i] = CreateInstance(polygon, random);
+                polygonsB[i] = CreateInstance(polygon, random);
+            }
+
+            int intersectionCount = 0;
+            int mismatchCount = 0;
+
+            for (int i = 0; i < PairCount; i++)
+            {
+                Vector2 minimumTranslation, intersectionPoint;
+                Vector2 referenceMinimumTranslation, referenceIntersectionPoint;
+
+                bool intersects = IntersectionTests.CheckIntersectionAndProduceResult(polygonsA[i], polygonsB[i], out minimumTranslation, out intersectionPoint);
+                bool referenceIntersects = IntersectionTests.CheckIntersectionAndProduceResult((IPolygonInstance)polygonsA[i], (IPolygonInstance)polygonsB[i], out referenceMinimumTranslation, out referenceIntersectionPoint);
+
+                if (intersects != referenceIntersects ||
+                    minimumTranslation.X != referenceMinimumTranslation.X || minimumTranslation.Y != referenceMinimumTranslation.Y ||
+                    intersectionPoint.X != referenceIntersectionPoint.X || intersectionPoint.Y != referenceIntersectionPoint.Y)
+                {
+                    mismatchCount++;
+                }
+
+                if (intersects)
+                {
+                    intersectionCount++;
+                }
+            }
+
+            Check(name + " mismatches: " + mismatchCount, mismatchCount == 0);
+
+            double referenceMilliseconds = Time(polygonsA, polygonsB, true);
+            double milliseconds = Time(polygonsA, polygonsB, false);
+
+            Console.WriteLine(name + " pairs:" + PairCount + " intersecting:" + intersectionCount + " mismatches:" + mismatchCount +
+                " edgeList:" + (referenceMilliseconds * 1000000.0 / (PairCount * RepeatCount)).ToString("0.0") + "ns/pair" +
+                " flat:" + (milliseconds * 1000000.0 / (PairCount * RepeatCount)).ToString("0.0") + "ns/pair" +
+                " speedup:" + (referenceMilliseconds / milliseconds).ToString("0.00") + "x");
+        }
+
+        private double Time(PolygonInstance[] polygonsA, PolygonInstance[] polygonsB, bool useEdgeList)
+        {
+            Stopwatch stopwatch = Stopwatch.StartNew();
+
+            for (int repeat = 0; repeat < RepeatCount; repeat++)
+            {
+                for (int i = 0; i < PairCount; i++)
+                {
+                    Vector2 minimumTranslation, intersectionPoint;
+
+                    if (useEdgeList)
+                    {
+                        IntersectionTests.CheckIntersectionAndProduceResult((IPolygonInstance)polygonsA[i], (IPolygonInstance)polygonsB[i], out minimumTranslation, out intersectionPoint);
+                    }
+                    else
+                    {
+                        IntersectionTests.CheckIntersectionAndProduceResult(polygonsA[i], polygonsB[i], out minimumTranslation, out intersectionPoint);
+                    }
+                }
+            }
+
+            return stopwatch.Elapsed.TotalMilliseconds;
+        }
+    }
+}
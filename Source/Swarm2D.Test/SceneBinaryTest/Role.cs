@@ -0,0 +1,397 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using System.Xml;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test.SceneBinaryTest
+{
+    public enum SceneBinaryTestMode
+    {
+        Idle,
+        Patrol,
+        Chase
+    }
+
+    public class SceneBinaryTestController : SceneController
+    {
+        [ComponentProperty]
+        public int Seed { get; set; }
+
+        [ComponentProperty]
+        public string Title { get; set; }
+    }
+
+    public class SceneBinaryTestComponent : Component
+    {
+        [ComponentProperty]
+        public bool Active { get; set; }
+
+        [ComponentProperty]
+        public float Speed { get; set; }
+
+        [ComponentProperty]
+        public int Count { get; set; }
+
+        [ComponentProperty]
+        public Vector2 Offset { get; set; }
+
+        [ComponentProperty]
+        public string Label { get; set; }
+
+        [ComponentProperty]
+        public SceneBinaryTestMode Mode { get; set; }
+    }
+
+    public class SceneBinaryTestTag : Component
+    {
+        [ComponentProperty]
+        public int Tag { get; set; }
+    }
+
+    //loads the same scene with Scene.Load(SceneData) and incrementally from the converted SceneBinaryData
+    //with a small time budget, then compares the entities and every property value of the two scenes
+    public class Role : TestRole
+    {
+        private const string PrefabName = "SceneBinaryTestPrefab";
+        private const int EntityCount = 300;
+
+        private Engine.Core.Engine _engine;
+        private GameLogic _gameLogic;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#  Running Scene Binary Test    #");
+            Console.WriteLine("################################");
+
+            _engine = new Engine.Core.Engine(true);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            _gameLogic = testController.GameLogic;
+            _gameLogic.StartGame();
+
+            CreatePrefab();
+
+            SceneData sceneData = CreateSceneData();
+
+            byte[] bytes = SceneBinaryData.Write(sceneData);
+            byte[] bytesFromXML = SceneBinaryData.ConvertFromXML(sceneData.SaveToXML());
+
+            if (!bytes.SequenceEqual(bytesFromXML))
+            {
+                Fail("converting the xml of the scene gives different binary data than writing the scene data");
+            }
+
+            SceneBinaryData sceneBinaryData = SceneBinaryData.FromBytes(bytesFromXML);
+
+            if (sceneBinaryData.EntityCount != EntityCount || sceneBinaryData.SceneControllerCount != 1)
+            {
+                Fail("binary data has " + sceneBinaryData.EntityCount + " entities and " + sceneBinaryData.SceneControllerCount + " scene controllers");
+            }
+
+            Scene sceneFromData = CreateScene("SceneFromData");
+            sceneFromData.Load(sceneData);
+
+            Scene sceneFromBinary = CreateScene("SceneFromBinary");
+            sceneFromBinary.LoadTimeBudget = 0.01f;
+
+            SceneLoadOperation loadOperation = sceneFromBinary.LoadIncrementally(sceneBinaryData);
+
+            int frameCount = 0;
+
+            while (!loadOperation.IsDone && frameCount < 10000)
+            {
+                this.Update();
+                frameCount++;
+            }
+
+            if (!loadOperation.IsDone)
+            {
+                Fail("incremental load did not finish, " + loadOperation.LoadedEntityCount + " entities loaded");
+            }
+            else if (frameCount < 2)
+            {
+                Fail("incremental load with a small budget finished in " + frameCount + " frames");
+            }
+
+            //initializes the components of the last loaded entities
+            for (int i = 0; i < 3; i++)
+            {
+                this.Update();
+            }
+
+            CheckAgainstData(sceneFromBinary, sceneData);
+            CompareScenes(sceneFromData, sceneFromBinary);
+
+            Console.WriteLine("incremental load took " + frameCount + " frames");
+            Console.WriteLine(Failed ? "scene binary test failed" : "scene binary test passed");
+
+            gameLogicEntity.Destroy();
+        }
+
+        private void CreatePrefab()
+        {
+            Entity prefab = _engine.CreatePrefab(PrefabName);
+
+            SceneBinaryTestComponent component = prefab.AddComponent<SceneBinaryTestComponent>();
+            component.Active = true;
+            component.Speed = 7.5f;
+            component.Count = 3;
+            component.Offset = new Vector2(1.0f, 2.0f);
+            component.Label = "prefab";
+            component.Mode = SceneBinaryTestMode.Patrol;
+        }
+
+        private Scene CreateScene(string name)
+        {
+            Entity sceneEntity = _gameLogic.SceneManager.Entity.CreateChildEntity(name);
+            return sceneEntity.GetComponent<Scene>();
+        }
+
+        //plain and prefab entities, every entity sets only some of the properties so property columns are sparse
+        private static SceneData CreateSceneData()
+        {
+            SceneData sceneData = new SceneData();
+
+            ComponentData controllerData = sceneData.AddSceneController<SceneBinaryTestController>();
+            controllerData.SetPropertyValue("Seed", "42");
+            controllerData.SetPropertyValue("Title", "round trip");
+
+            for (int i = 0; i < EntityCount; i++)
+            {
+                EntityData entityData = sceneData.AddEntity("Entity" + i);
+
+                if (i % 5 == 0)
+                {
+                    entityData.PrefabName = PrefabName;
+
+                    if (i % 10 == 0)
+                    {
+                        ComponentData prefabComponentData = entityData.AddComponent<SceneBinaryTestComponent>();
+                        prefabComponentData.SetPropertyValue("Count", i.ToString());
+                        prefabComponentData.SetPropertyValue("Mode", SceneBinaryTestMode.Chase.ToString());
+                    }
+                }
+                else
+                {
+                    ComponentData componentData = entityData.AddComponent<SceneBinaryTestComponent>();
+
+                    switch (i % 3)
+                    {
+                        case 0:
+                            componentData.SetPropertyValue("Active", (i % 2 == 0).ToString());
+                            componentData.SetPropertyValue("Speed", (i * 0.25f).ToString());
+                            break;
+                        case 1:
+                            componentData.SetPropertyValue("Offset", (i * 0.5f) + ";" + (-i * 2.0f));
+                            componentData.SetPropertyValue("Label", "label" + i);
+                            break;
+                        default:
+                            componentData.SetPropertyValue("Count", (-i).ToString());
+                            componentData.SetPropertyValue("Mode", SceneBinaryTestMode.Patrol.ToString());
+                            componentData.SetPropertyValue("Speed", (i * -1.5f).ToString());
+                            break;
+                    }
+                }
+
+                if (i % 4 == 0)
+                {
+                    ComponentData tagData = entityData.AddComponent<SceneBinaryTestTag>();
+                    tagData.SetPropertyValue("Tag", (i * 7).ToString());
+                }
+
+                if (i % 3 == 0)
+                {
+                    ComponentData sceneEntityData = entityData.AddComponent<SceneEntity>();
+                    sceneEntityData.SetPropertyValue("LocalPosition", i + ";" + (i * 0.5f));
+
+                    if (i % 6 == 0)
+                    {
+                        sceneEntityData.SetPropertyValue("LocalRotation", (i * 1.25f).ToString());
+                    }
+                }
+            }
+
+            return sceneData;
+        }
+
+        private static string GetValue(Component component, string propertyName)
+        {
+            return component.GetComponentInfo().ComponentPropertyInfos[propertyName].GetValueAsStringFrom(component);
+        }
+
+        //every property written in the scene data is set on the loaded components
+        private void CheckAgainstData(Scene scene, SceneData sceneData)
+        {
+            foreach (ComponentData controllerData in sceneData.SceneControllers)
+            {
+                Component controller = scene.Entity.GetComponent(controllerData.Type);
+
+                if (controller == null)
+                {
+                    Fail("scene controller " + controllerData.Type + " is not loaded");
+                    continue;
+                }
+
+                CheckComponentAgainstData("scene controller", controller, controllerData);
+            }
+
+            List<EntityData> entities = sceneData.Entities.ToList();
+            List<SceneEntity> sceneEntities = scene.SceneEntities.ToList();
+
+            if (entities.Count != sceneEntities.Count)
+            {
+                Fail("scene has " + sceneEntities.Count + " entities, scene data has " + entities.Count);
+                return;
+            }
+
+            for (int i = 0; i < entities.Count; i++)
+            {
+                EntityData entityData = entities[i];
+                Entity entity = sceneEntities[i].Entity;
+
+                if (entity.IsInstantiatedFromPrefab != entityData.IsInstantiatedFromPrefab ||
+                    (entityData.IsInstantiatedFromPrefab && entity.PrefabName != entityData.PrefabName))
+                {
+                    Fail(entityData.Name + " is loaded as " + entity.Name + " with the wrong prefab");
+                }
+
+                if (!entityData.IsInstantiatedFromPrefab && entity.Name != entityData.Name)
+                {
+                    Fail(entityData.Name + " is loaded with the name " + entity.Name);
+                }
+
+                foreach (ComponentData componentData in entityData.Components)
+                {
+                    Component component = entity.GetComponent(componentData.Type);
+
+                    if (component == null)
+                    {
+                        Fail(componentData.Type + " of " + entityData.Name + " is not loaded");
+                        continue;
+                    }
+
+                    CheckComponentAgainstData(entityData.Name, component, componentData);
+                }
+
+                //properties that are not in the scene data keep the values of the prefab
+                if (entityData.IsInstantiatedFromPrefab)
+                {
+                    SceneBinaryTestComponent component = entity.GetComponent<SceneBinaryTestComponent>();
+
+                    if (component == null || component.Label != "prefab" || component.Speed != 7.5f || !component.Active)
+                    {
+                        Fail(entityData.Name + " lost the property values of its prefab");
+                    }
+                }
+            }
+        }
+
+        private void CheckComponentAgainstData(string owner, Component component, ComponentData componentData)
+        {
+            foreach (PropertyData propertyData in componentData.Properties)
+            {
+                string value = GetValue(component, propertyData.Name);
+
+                if (value != propertyData.Value)
+                {
+                    Fail(owner + ": " + componentData.Type + "." + propertyData.Name + " is " + value + ", expected " + propertyData.Value);
+                }
+            }
+        }
+
+        private void CompareScenes(Scene expectedScene, Scene scene)
+        {
+            CompareComponents("scene", expectedScene.Entity, scene.Entity);
+
+            List<SceneEntity> expectedEntities = expectedScene.SceneEntities.ToList();
+            List<SceneEntity> sceneEntities = scene.SceneEntities.ToList();
+
+            if (expectedEntities.Count != sceneEntities.Count)
+            {
+                Fail("scenes have " + expectedEntities.Count + " and " + sceneEntities.Count + " entities");
+                return;
+            }
+
+            for (int i = 0; i < expectedEntities.Count; i++)
+            {
+                Entity expected = expectedEntities[i].Entity;
+                Entity entity = sceneEntities[i].Entity;
+
+                if (expected.Name != entity.Name || expected.IsInstantiatedFromPrefab != entity.IsInstantiatedFromPrefab ||
+                    expected.PrefabName != entity.PrefabName)
+                {
+                    Fail("entity " + i + " is " + expected.Name + " in one scene and " + entity.Name + " in the other");
+                }
+
+                CompareComponents(expected.Name, expected, entity);
+            }
+        }
+
+        private void CompareComponents(string owner, Entity expected, Entity entity)
+        {
+            if (expected.Components.Count != entity.Components.Count)
+            {
+                Fail(owner + " has " + expected.Components.Count + " and " + entity.Components.Count + " components");
+                return;
+            }
+
+            for (int i = 0; i < expected.Components.Count; i++)
+            {
+                Component expectedComponent = expected.Components[i];
+                Component component = entity.Components[i];
+
+                ComponentInfo componentInfo = expectedComponent.GetComponentInfo();
+
+                if (componentInfo != component.GetComponentInfo())
+                {
+                    Fail(owner + " has " + componentInfo.Name + " and " + component.GetComponentInfo().Name + " at the same index");
+                    continue;
+                }
+
+                foreach (ComponentPropertyInfo componentPropertyInfo in componentInfo.ComponentPropertyInfos.Values)
+                {
+                    string expectedValue = componentPropertyInfo.GetValueAsStringFrom(expectedComponent);
+                    string value = componentPropertyInfo.GetValueAsStringFrom(component);
+
+                    if (expectedValue != value)
+                    {
+                        Fail(owner + ": " + componentInfo.Name + "." + componentPropertyInfo.Name + " is " + value + ", expected " + expectedValue);
+                    }
+                }
+            }
+        }
+    }
+}
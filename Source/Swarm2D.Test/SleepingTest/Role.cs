@@ -0,0 +1,218 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+using Debug = Swarm2D.Library.Debug;
+
+namespace Swarm2D.Test.SleepingTest
+{
+    //lets separate stacks of boxes settle on a floor until they sleep, then wakes them by an impulse, a transform change and a contact.
+    //every stack is an island of its own, waking one must not wake the others
+    public class Role : TestRole
+    {
+        private const int PileCount = 4;
+        private const int PileHeight = 3;
+        private const int MaxSettleFrameCount = 1200;
+
+        private Engine.Core.Engine _engine;
+        private GameLogic _gameLogic;
+
+        private Scene _scene;
+        private PhysicsWorld _physicsWorld;
+        private List<List<PhysicsObject>> _piles;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#    Running Sleeping          #");
+            Console.WriteLine("################################");
+
+            _engine = new Engine.Core.Engine(false);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            _gameLogic = testController.GameLogic;
+            _gameLogic.StartGame();
+
+            CreateScene();
+
+            int bodyCount = PileCount * PileHeight;
+
+            SettleAll("initial");
+
+            //an impulse wakes the whole island of the body but not the other piles
+            _piles[0][0].ApplyImpulse(new Vector2(0.0f, -2000.0f), Vector2.Zero);
+            Check("impulse", _physicsWorld.SleepingBodyCount == bodyCount - PileHeight && AllAwake(_piles[0]));
+
+            SettleAll("after impulse");
+
+            //moving a sleeping body from outside wakes it on its transform change
+            PhysicsObject movedBody = _piles[1][_piles[1].Count - 1];
+            movedBody.SceneEntity.LocalPosition += new Vector2(0.0f, -40.0f);
+            this.Update();
+            Check("transform change", !movedBody.IsSleeping);
+
+            SettleAll("after transform change");
+
+            //a box dropped on a sleeping pile wakes it when they touch
+            List<PhysicsObject> pile = _piles[2];
+            PhysicsObject topBody = pile[pile.Count - 1];
+            PhysicsObject droppedBody = PhysicsTestFixture.CreateBox(_scene, topBody.SceneEntity.LocalPosition + new Vector2(0.0f, -120.0f), 28.0f, 28.0f, PhysicsObject.PhysicsType.RigidBody);
+
+            bool pileWoke = false;
+
+            for (int frame = 0; frame < 120 && !pileWoke; frame++)
+            {
+                this.Update();
+                pileWoke = !topBody.IsSleeping;
+            }
+
+            Check("contact", pileWoke);
+
+            pile.Add(droppedBody);
+            SettleAll("after contact");
+
+            MeasureSleepingScene();
+
+            Console.WriteLine(Failed ? "sleeping test failed" : "sleeping test passed");
+
+            gameLogicEntity.Destroy();
+        }
+
+        private void CreateScene()
+        {
+            Entity sceneEntity = _gameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+            _scene = sceneEntity.GetComponent<Scene>();
+
+            _physicsWorld = sceneEntity.AddComponent<PhysicsWorld>();
+            _physicsWorld.Gravity = new Vector2(0.0f, 9.81f * PhysicsWorld.MeterToPixel);
+            _physicsWorld.DefaultPhysicsMaterial.Restutition = 0.1f;
+
+            const float pileDistance = 100.0f;
+            float width = PileCount * pileDistance;
+
+            PhysicsTestFixture.CreateBox(_scene, new Vector2(0.0f, 40.0f), width * 3.0f, 40.0f, PhysicsObject.PhysicsType.Static);
+
+            _piles = new List<List<PhysicsObject>>();
+
+            for (int pileIndex = 0; pileIndex < PileCount; pileIndex++)
+            {
+                List<PhysicsObject> pile = new List<PhysicsObject>();
+                float pileX = -width * 0.5f + pileDistance * (pileIndex + 0.5f);
+
+                for (int row = 0; row < PileHeight; row++)
+                {
+                    pile.Add(PhysicsTestFixture.CreateBox(_scene, new Vector2(pileX, -row * 30.0f), 28.0f, 28.0f, PhysicsObject.PhysicsType.RigidBody));
+                }
+
+                _piles.Add(pile);
+            }
+        }
+
+        private void SettleAll(string name)
+        {
+            for (int frame = 0; frame < MaxSettleFrameCount; frame++)
+            {
+                this.Update();
+
+                if (_physicsWorld.AwakeBodyCount == 0 && _physicsWorld.SleepingBodyCount > 0)
+                {
+                    Console.WriteLine(name + ": all " + _physicsWorld.SleepingBodyCount + " bodies sleep after " + frame + " frames");
+                    return;
+                }
+            }
+
+            Check(name + " settle, awake:" + _physicsWorld.AwakeBodyCount + " sleeping:" + _physicsWorld.SleepingBodyCount, false);
+        }
+
+        private void MeasureSleepingScene()
+        {
+            const int frameCount = 120;
+
+            _engine.Profiler.Enabled = true;
+
+            _engine.Profiler.Clear();
+
+            for (int frame = 0; frame < frameCount; frame++)
+            {
+                this.Update();
+            }
+
+            double sleepingMilliseconds = GetStepMilliseconds(frameCount);
+
+            _physicsWorld.SleepingEnabled = false;
+            _engine.Profiler.Clear();
+
+            for (int frame = 0; frame < frameCount; frame++)
+            {
+                this.Update();
+            }
+
+            double awakeMilliseconds = GetStepMilliseconds(frameCount);
+
+            _engine.Profiler.Enabled = false;
+
+            Console.WriteLine("step with sleeping bodies:" + sleepingMilliseconds.ToString("0.000") + "ms, with the same bodies awake:" + awakeMilliseconds.ToString("0.000") + "ms");
+        }
+
+        private double GetStepMilliseconds(int frameCount)
+        {
+            double milliseconds = 0.0;
+
+            foreach (ProfilerSummaryEntry entry in _engine.Profiler.GetSummary(frameCount))
+            {
+                if (entry.Name == "PhysicsWorld.UpdatePositions" || entry.Name == "PhysicsWorld.CheckCollisions" ||
+                    entry.Name == "PhysicsWorld.ResolveCollisions" || entry.Name == "PhysicsWorld.Islands")
+                {
+                    milliseconds += entry.TotalMilliseconds;
+                }
+            }
+
+            return milliseconds / frameCount;
+        }
+
+        private static bool AllAwake(List<PhysicsObject> bodies)
+        {
+            for (int i = 0; i < bodies.Count; i++)
+            {
+                if (bodies[i].IsSleeping)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    }
+}
@@ -28,6 +28,7 @@ using Swarm2D.Library;
 using System;
 using System.Collections.Generic;
 using System.Diagnostics;
+using System.IO;
 using System.Linq;
 using System.Reflection;
 using System.Text;
@@ -41,15 +42,42 @@ namespace Swarm2D.Test
     {
         public abstract void DoTest();
 
+        //set by Fail, Program exits with an error code when it is
+        public bool Failed { get; private set; }
+
+        //where the engine logging goes, a role whose stdout is read by tools moves it to stderr
+        protected TextWriter LogWriter { get; set; }
+
+        public void Run()
+        {
+            //the thread running the test owns the job system
+            CreateJobSystem();
+            DoTest();
+        }
+
+        protected void Fail(string message)
+        {
+            Console.WriteLine("FAILED: " + message);
+            Failed = true;
+        }
+
+        protected void Check(string name, bool condition)
+        {
+            if (!condition)
+            {
+                Fail(name);
+            }
+        }
+
         void IDebug.Log(object log)
         {
-            Console.WriteLine(log);
+            LogWriter.WriteLine(log);
         }
 
         void IDebug.Assert(bool condition, string message)
         {
             StackTrace stackTrace = new StackTrace();
-            Console.WriteLine("Assertion Failed!\n" + stackTrace + "\n" + message);
+            LogWriter.WriteLine("Assertion Failed!\n" + stackTrace + "\n" + message);
         }
 
         private FrameworkDomain[] _frameworkDomains;
@@ -58,6 +86,7 @@ namespace Swarm2D.Test
 
         protected TestRole()
         {
+            LogWriter = Console.Out;
             Debug.Initialize(this);
         }
 
@@ -201,5 +230,8 @@ namespace Swarm2D.Test
         public override long ElapsedTicks { get { return _currentFrame; } }
 
         public override long TicksPerSecond { get { return 50; } }
+
+        //ticks are counted by frames here
+        public override bool TicksAreFrameDriven { get { return true; } }
     }
 }
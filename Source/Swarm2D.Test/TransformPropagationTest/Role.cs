@@ -0,0 +1,396 @@
+﻿/******************************************************************************
+Copyright (c) 2015 Koray Kiyakoglu
+
+http://www.swarm2d.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+******************************************************************************/
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Text;
+using Swarm2D.Engine.Core;
+using Swarm2D.Engine.Logic;
+using Swarm2D.Library;
+
+namespace Swarm2D.Test.TransformPropagationTest
+{
+    //counts the transform change messages of its entity and keeps the world position seen by the last one,
+    //optionally moves another scene entity from the handler
+    public class TransformChangeListener : Component
+    {
+        public int MessageCount { get; set; }
+        public Vector2 LastGlobalPosition { get; private set; }
+
+        public SceneEntity EntityToMove { get; set; }
+
+        [EntityMessageHandler(MessageType = typeof(SceneEntityTransformMatrixChangeMesssage))]
+        private void OnTransformMatrixChange(Message message)
+        {
+            MessageCount++;
+            LastGlobalPosition = GetComponent<SceneEntity>().GlobalPosition;
+
+            if (EntityToMove != null)
+            {
+                EntityToMove.LocalPosition += new Vector2(1.0f, 0.0f);
+            }
+        }
+    }
+
+    //checks world transforms of parent and child chains, reparenting, and when and how often the transform change
+    //messages are sent by Scene.FlushTransforms
+    public class Role : TestRole
+    {
+        private const float Tolerance = 0.001f;
+
+        private Engine.Core.Engine _engine;
+        private GameLogic _gameLogic;
+        private Scene _scene;
+
+        public override void DoTest()
+        {
+            Console.WriteLine("################################");
+            Console.WriteLine("#  Running Transform Propagation #");
+            Console.WriteLine("################################");
+
+            _engine = new Engine.Core.Engine(true);
+
+            TestController testController = _engine.RootEntity.AddComponent<TestController>();
+
+            this.Initialize("Test", new FrameworkDomain[] { _engine });
+
+            Entity gameLogicEntity = testController.CreateGame();
+            _gameLogic = testController.GameLogic;
+            _gameLogic.StartGame();
+
+            Entity sceneEntity = _gameLogic.SceneManager.Entity.CreateChildEntity("Scene");
+            _scene = sceneEntity.GetComponent<Scene>();
+
+            TestChain();
+            TestReparenting();
+            TestHandlerChanges();
+            TestImmediateMessages();
+
+            Console.WriteLine(Failed ? "transform propagation test failed" : "transform propagation test passed");
+
+            gameLogicEntity.Destroy();
+        }
+
+        private SceneEntity CreateSceneEntity(Entity parent, string name, Vector2 position, float rotation, Vector2 scale)
+        {
+            Entity entity = parent.CreateChildEntity(name);
+            entity.AddComponent<TransformChangeListener>();
+
+            SceneEntity sceneEntity = entity.GetComponent<SceneEntity>();
+            sceneEntity.LocalPosition = position;
+            sceneEntity.LocalRotation = rotation;
+            sceneEntity.LocalScale = scale;
+
+            return sceneEntity;
+        }
+
+        //the first update of the game only starts it, components of new entities are initialized on the next ones
+        private void UpdateFrames()
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                this.Update();
+            }
+        }
+
+        private static Matrix4x4 LocalMatrix(SceneEntity sceneEntity)
+        {
+            return Matrix4x4.Transformation2D(sceneEntity.LocalScale, sceneEntity.LocalRotation * Mathf.Deg2Rad, sceneEntity.LocalPosition);
+        }
+
+        //world transform calculated by walking the parents
+        private static Matrix4x4 ExpectedWorldMatrix(SceneEntity sceneEntity)
+        {
+            Matrix4x4 result = LocalMatrix(sceneEntity);
+
+            for (Entity parent = sceneEntity.Entity.Parent; parent != null; parent = parent.Parent)
+            {
+                SceneEntity parentSceneEntity = parent.GetComponent<SceneEntity>();
+
+                if (parentSceneEntity == null)
+                {
+                    break;
+                }
+
+                result = LocalMatrix(parentSceneEntity) * result;
+            }
+
+            return result;
+        }
+
+        private static TransformChangeListener Listener(SceneEntity sceneEntity)
+        {
+            return sceneEntity.Entity.GetComponent<TransformChangeListener>();
+        }
+
+        private void ResetListeners(params SceneEntity[] sceneEntities)
+        {
+            foreach (SceneEntity sceneEntity in sceneEntities)
+            {
+                Listener(sceneEntity).MessageCount = 0;
+            }
+        }
+
+        private void CheckWorld(string testName, SceneEntity sceneEntity)
+        {
+            Matrix4x4 expected = ExpectedWorldMatrix(sceneEntity);
+            Matrix4x4 actual = sceneEntity.TransformMatrix;
+
+            bool equal = Math.Abs(expected.M00 - actual.M00) < Tolerance && Math.Abs(expected.M01 - actual.M01) < Tolerance &&
+                         Math.Abs(expected.M03 - actual.M03) < Tolerance && Math.Abs(expected.M10 - actual.M10) < Tolerance &&
+                         Math.Abs(expected.M11 - actual.M11) < Tolerance && Math.Abs(expected.M13 - actual.M13) < Tolerance;
+
+            Vector2 expectedPosition = new Vector2(expected.M03, expected.M13);
+
+            if (!equal || (sceneEntity.GlobalPosition - expectedPosition).Length > Tolerance)
+            {
+                Fail(testName + ": world transform of " + sceneEntity + " is wrong, position " + sceneEntity.GlobalPosition + " expected " + expectedPosition);
+            }
+        }
+
+        private void CheckMessageCount(string testName, SceneEntity sceneEntity, int expected)
+        {
+            int messageCount = Listener(sceneEntity).MessageCount;
+
+            if (messageCount != expected)
+            {
+                Fail(testName + ": " + sceneEntity + " got " + messageCount + " transform change messages, expected " + expected);
+            }
+        }
+
+        private void TestChain()
+        {
+            SceneEntity a = CreateSceneEntity(_scene.Entity, "A", new Vector2(100.0f, 0.0f), 90.0f, new Vector2(1.0f, 1.0f));
+            SceneEntity b = CreateSceneEntity(a.Entity, "B", new Vector2(10.0f, 0.0f), 30.0f, new Vector2(2.0f, 1.0f));
+            SceneEntity c = CreateSceneEntity(b.Entity, "C", new Vector2(0.0f, 5.0f), -45.0f, new Vector2(1.0f, 3.0f));
+
+            UpdateFrames();
+
+            CheckWorld("chain", a);
+            CheckWorld("chain", b);
+            CheckWorld("chain", c);
+
+            ResetListeners(a, b, c);
+
+            //many changes before a flush are one message per entity, reads before the flush are already up to date
+            a.LocalPosition = new Vector2(50.0f, 50.0f);
+            a.LocalRotation = 180.0f;
+            b.LocalPosition = new Vector2(20.0f, 0.0f);
+            a.LocalScale = new Vector2(0.5f, 0.5f);
+
+            if (!_scene.HasPendingTransformChanges)
+            {
+                Fail("chain: no pending transform changes after a move");
+            }
+
+            CheckWorld("chain before flush", c);
+            CheckMessageCount("chain before flush", a, 0);
+
+            _scene.FlushTransforms();
+
+            if (_scene.HasPendingTransformChanges)
+            {
+                Fail("chain: pending transform changes after a flush");
+            }
+
+            CheckMessageCount("chain", a, 1);
+            CheckMessageCount("chain", b, 1);
+            CheckMessageCount("chain", c, 1);
+
+            //handlers see the world position of the flush
+            if ((Listener(c).LastGlobalPosition - c.GlobalPosition).Length > Tolerance)
+            {
+                Fail("chain: handler of C saw " + Listener(c).LastGlobalPosition + " instead of " + c.GlobalPosition);
+            }
+
+            //a change of a child does not notify its parent
+            ResetListeners(a, b, c);
+
+            c.LocalRotation = 10.0f;
+            _scene.FlushTransforms();
+
+            CheckMessageCount("child move", a, 0);
+            CheckMessageCount("child move", b, 0);
+            CheckMessageCount("child move", c, 1);
+            CheckWorld("child move", c);
+
+            //nothing changed, nothing is sent
+            ResetListeners(a, b, c);
+
+            _scene.FlushTransforms();
+
+            CheckMessageCount("empty flush", a, 0);
+            CheckMessageCount("empty flush", c, 0);
+
+            a.Entity.Destroy();
+        }
+
+        private void TestReparenting()
+        {
+            SceneEntity a = CreateSceneEntity(_scene.Entity, "A", new Vector2(-100.0f, 20.0f), 0.0f, new Vector2(1.0f, 1.0f));
+            SceneEntity b = CreateSceneEntity(a.Entity, "B", new Vector2(10.0f, 10.0f), 45.0f, new Vector2(1.0f, 1.0f));
+            SceneEntity c = CreateSceneEntity(b.Entity, "C", new Vector2(5.0f, 0.0f), 0.0f, new Vector2(2.0f, 2.0f));
+            SceneEntity d = CreateSceneEntity(_scene.Entity, "D", new Vector2(300.0f, 300.0f), 270.0f, new Vector2(1.5f, 1.5f));
+
+            UpdateFrames();
+
+            ResetListeners(a, b, c, d);
+
+            //C moves under D with its local transform
+            c.Entity.Parent = d.Entity;
+
+            CheckWorld("reparent", c);
+
+            _scene.FlushTransforms();
+
+            CheckMessageCount("reparent", c, 1);
+            CheckMessageCount("reparent", b, 0);
+            CheckMessageCount("reparent", d, 0);
+
+            //the old parent chain does not reach C any more, the new one does
+            ResetListeners(a, b, c, d);
+
+            a.LocalPosition = new Vector2(0.0f, 0.0f);
+            _scene.FlushTransforms();
+
+            CheckMessageCount("old parent move", b, 1);
+            CheckMessageCount("old parent move", c, 0);
+
+            d.LocalRotation = 0.0f;
+            _scene.FlushTransforms();
+
+            CheckMessageCount("new parent move", c, 1);
+            CheckWorld("new parent move", c);
+
+            //B with its subtree moves one level deeper, under C
+            ResetListeners(a, b, c, d);
+
+            SceneEntity e = CreateSceneEntity(b.Entity, "E", new Vector2(1.0f, 2.0f), 0.0f, new Vector2(1.0f, 1.0f));
+            UpdateFrames();
+
+            ResetListeners(e);
+
+            b.Entity.Parent = c.Entity;
+            d.LocalPosition = new Vector2(-50.0f, 0.0f);
+
+            _scene.FlushTransforms();
+
+            CheckWorld("deeper reparent", b);
+            CheckWorld("deeper reparent", e);
+            CheckMessageCount("deeper reparent", e, 1);
+
+            a.Entity.Destroy();
+            d.Entity.Destroy();
+        }
+
+        private void TestHandlerChanges()
+        {
+            SceneEntity a = CreateSceneEntity(_scene.Entity, "A", new Vector2(0.0f, 0.0f), 0.0f, new Vector2(1.0f, 1.0f));
+            SceneEntity b = CreateSceneEntity(_scene.Entity, "B", new Vector2(0.0f, 0.0f), 0.0f, new Vector2(1.0f, 1.0f));
+
+            UpdateFrames();
+
+            ResetListeners(a, b);
+
+            //a handler of A moves B, B is sent with the next flush
+            Listener(a).EntityToMove = b;
+
+            a.LocalPosition = new Vector2(5.0f, 5.0f);
+            _scene.FlushTransforms();
+
+            Listener(a).EntityToMove = null;
+
+            CheckMessageCount("handler move", a, 1);
+            CheckMessageCount("handler move", b, 0);
+
+            if (!_scene.HasPendingTransformChanges)
+            {
+                Fail("handler move: the move of a handler is not pending");
+            }
+
+            _scene.FlushTransforms();
+
+            CheckMessageCount("handler move", b, 1);
+            CheckWorld("handler move", b);
+
+            a.Entity.Destroy();
+            b.Entity.Destroy();
+        }
+
+        private void TestImmediateMessages()
+        {
+            SceneEntity a = CreateSceneEntity(_scene.Entity, "A", new Vector2(0.0f, 0.0f), 0.0f, new Vector2(1.0f, 1.0f));
+            SceneEntity b = CreateSceneEntity(a.Entity, "B", new Vector2(1.0f, 0.0f), 0.0f, new Vector2(1.0f, 1.0f));
+
+            UpdateFrames();
+
+            ResetListeners(a, b);
+
+            _scene.ImmediateTransformChangeMessages = true;
+
+            a.LocalPosition = new Vector2(10.0f, 0.0f);
+
+            CheckMessageCount("immediate", a, 1);
+            CheckMessageCount("immediate", b, 1);
+
+            if ((Listener(b).LastGlobalPosition - new Vector2(11.0f, 0.0f)).Length > Tolerance)
+            {
+                Fail("immediate: handler of B saw " + Listener(b).LastGlobalPosition);
+            }
+
+            a.LocalRotation = 90.0f;
+
+            CheckMessageCount("immediate", a, 2);
+            CheckMessageCount("immediate", b, 2);
+            CheckWorld("immediate", b);
+
+            //the flush of a move made by a handler is nested in the flush sending to the handler, it is sent afterwards
+            SceneEntity c = CreateSceneEntity(_scene.Entity, "C", new Vector2(0.0f, 0.0f), 0.0f, new Vector2(1.0f, 1.0f));
+
+            UpdateFrames();
+
+            ResetListeners(a, b, c);
+
+            Listener(a).EntityToMove = c;
+            a.LocalPosition = new Vector2(20.0f, 0.0f);
+            Listener(a).EntityToMove = null;
+
+            CheckMessageCount("immediate handler move", a, 1);
+            CheckMessageCount("immediate handler move", b, 1);
+            CheckMessageCount("immediate handler move", c, 0);
+
+            _scene.FlushTransforms();
+
+            CheckMessageCount("immediate handler move", a, 1);
+            CheckMessageCount("immediate handler move", c, 1);
+            CheckWorld("immediate handler move", c);
+
+            _scene.ImmediateTransformChangeMessages = false;
+
+            a.Entity.Destroy();
+            c.Entity.Destroy();
+        }
+    }
+}
@@ -62,6 +62,8 @@ namespace Swarm2D.Unity.Logic
         {
             _resourcesPath = resourcesPath;
             _frameworkDomains = frameworkDomains;
+
+            CreateJobSystem();
         }
 
         public override void Start()
@@ -244,5 +246,7 @@ namespace Swarm2D.Unity.Logic
         public override long ElapsedTicks { get { return (long)(UnityEngine.Time.time * 1000.0f); } }
 
         public override long TicksPerSecond { get { return 1000; } }
+
+        public override bool TicksAreFrameDriven { get { return true; } }
     }
 }
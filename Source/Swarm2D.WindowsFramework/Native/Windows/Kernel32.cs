@@ -41,5 +41,11 @@ namespace Swarm2D.WindowsFramework.Native.Windows
 
         [DllImport("kernel32.dll", CharSet = CharSet.Auto)]
         public static extern int GetLastError();
+
+        [DllImport("kernel32.dll")]
+        public static extern IntPtr GetCurrentThread();
+
+        [DllImport("kernel32.dll", SetLastError = true)]
+        public static extern UIntPtr SetThreadAffinityMask(IntPtr hThread, UIntPtr dwThreadAffinityMask);
     }
 }
@@ -62,6 +62,18 @@ namespace Swarm2D.WindowsFramework
         {
             Resources.Initialize(resourcesPath);
             _frameworkDomains = frameworkDomains;
+
+            //domains are updated together, the main loop waits once when all of them are idle
+            foreach (FrameworkDomain frameworkDomain in _frameworkDomains)
+            {
+                Engine.Core.Engine engine = frameworkDomain as Engine.Core.Engine;
+
+                if (engine != null)
+                {
+                    engine.WaitWhenIdle = false;
+                    engine.IdleScheduler = IdleScheduler;
+                }
+            }
         }
 
         void MessageLoop()
@@ -71,20 +83,31 @@ namespace Swarm2D.WindowsFramework
 
         void MainLoop()
         {
+            CreateJobSystem();
+
             _timer.Start();
 
             while (true)
             {
-                Update();
+                if (Update())
+                {
+                    IdleScheduler.Wait();
+                }
             }
         }
 
-        void Update()
+        //returns true if all domains are idle
+        bool Update()
         {
+            bool idle = true;
+
             foreach (FrameworkDomain frameworkDomain in _frameworkDomains)
             {
                 frameworkDomain.Update();
+                idle &= frameworkDomain.IsIdle;
             }
+
+            return idle;
         }
 
         public override void Start()
@@ -167,6 +190,11 @@ namespace Swarm2D.WindowsFramework
             Thread.Sleep(1);
         }
 
+        public override void SetCurrentThreadAffinity(int processorIndex)
+        {
+            Kernel32.SetThreadAffinityMask(Kernel32.GetCurrentThread(), new UIntPtr(1ul << processorIndex));
+        }
+
         public override Assembly[] GetGameAssemblies()
         {
             return LogicFramework.PlatformHelper.GetGameAssemblies();
@@ -67,6 +67,18 @@ namespace Swarm2D.WindowsFramework
             {
                 _frameworkDomainThreads = new Thread[1];
                 CreateThread(0);
+
+                //domains are updated together, the loop waits once when all of them are idle
+                foreach (FrameworkDomain frameworkDomain in _frameworkDomains)
+                {
+                    Engine.Core.Engine engine = frameworkDomain as Engine.Core.Engine;
+
+                    if (engine != null)
+                    {
+                        engine.WaitWhenIdle = false;
+                        engine.IdleScheduler = IdleScheduler;
+                    }
+                }
             }
             else
             {
@@ -102,13 +114,23 @@ namespace Swarm2D.WindowsFramework
         {
             if (SingleThreaded)
             {
+                CreateJobSystem();
+
                 while (true)
                 {
+                    bool idle = true;
+
                     for (int i = 0; i < _frameworkDomains.Length; i++)
                     {
                         FrameworkDomain frameworkDomain = _frameworkDomains[i];
 
                         frameworkDomain.Update();
+                        idle &= frameworkDomain.IsIdle;
+                    }
+
+                    if (idle)
+                    {
+                        IdleScheduler.Wait();
                     }
                 }
             }
@@ -133,6 +155,9 @@ namespace Swarm2D.WindowsFramework
             }
             else
             {
+                //every domain has a thread of its own, none of them owns the job system
+                CreateJobSystem();
+
                 for (int i = 0; i < _frameworkDomains.Length; i++)
                 {
                     _frameworkDomainThreads[i].Start(_frameworkDomains[i]);
@@ -225,6 +250,11 @@ namespace Swarm2D.WindowsFramework
             Thread.Sleep(1);
         }
 
+        public override void SetCurrentThreadAffinity(int processorIndex)
+        {
+            Kernel32.SetThreadAffinityMask(Kernel32.GetCurrentThread(), new UIntPtr(1ul << processorIndex));
+        }
+
         public override Assembly[] GetGameAssemblies()
         {
             return LogicFramework.PlatformHelper.GetGameAssemblies();
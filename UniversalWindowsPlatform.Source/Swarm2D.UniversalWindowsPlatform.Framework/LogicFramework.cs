@@ -56,6 +56,8 @@ namespace Swarm2D.UniversalWindowsPlatform.Framework
         {
             _resourcesPath = resourcesPath;
             _frameworkDomains = frameworkDomains;
+
+            CreateJobSystem();
         }
 
         public override void Start()
@@ -15,6 +15,9 @@ namespace Swarm2D.UniversalWindowsPlatform.Framework
 
         public string Name { get; set; }
 
+        //tasks never keep the process alive, the flag is only kept for the callers
+        public bool IsBackground { get; set; }
+
         public Thread(ThreadStart threadStart)
         {
             _threadStart = threadStart;